@@ -334,6 +334,31 @@ namespace GMlib {
   }
 
 
+  /*! void  DMatrix<T>::swap(DMatrix<T>& v)
+   *  \brief Exchange the contents with v.
+   *
+   *  Exchange the contents with v, the memory is handed over,
+   *  as in DVector::swap().
+   */
+  template <typename T>
+  inline
+  void  DMatrix<T>::swap(DMatrix<T>& v) {
+
+    if(&v == this) return;
+
+    const bool in_init   = _p == _init;
+    const bool v_in_init = v._p == v._init;
+    for(int i=0; i<4; i++) _init[i].swap(v._init[i]);
+
+    std::swap(_p, v._p);
+    if(v_in_init) _p   = _init;
+    if(in_init)   v._p = v._init;
+
+    std::swap(_n, v._n);
+    std::swap(_private, v._private);
+  }
+
+
   template <typename T>
   inline
   void  DMatrix<T>::setIdentity() {
@@ -53,6 +53,7 @@ namespace GMlib{
     void                resetDim(int i, int j);
     void                setDim(int i, int j);
     void                setIdentity();
+    void                swap(DMatrix<T>& v);
     DVector<T>          toDVector() const;
     DMatrix<T>&         transpose();
 
@@ -105,6 +106,13 @@ namespace GMlib{
   }
 
 
+  template <typename T>
+  inline
+  void swap(DMatrix<T>& a, DMatrix<T>& b) {
+    a.swap(b);
+  }
+
+
   #ifdef GM_STREAM
     //********************************************************
     //******  Template iostream operators for DMatrix  ******
@@ -29,6 +29,7 @@
 
 // STL includes
 #include <algorithm>
+#include <utility>
 
 
 
@@ -404,6 +405,32 @@ namespace GMlib {
   }
 
 
+  /*! void  DVector<T>::swap(DVector<T>& v)
+   *  \brief Exchange the contents with v.
+   *
+   *  Exchange the contents with v, the memory is handed over,
+   *  only the (at most 4) elements kept inside the vectors are swapped one by one.
+   */
+  template <typename T>
+  inline
+  void  DVector<T>::swap(DVector<T>& v) {
+
+    if(&v == this) return;
+
+    using std::swap;
+    const bool in_init   = _p == _init;
+    const bool v_in_init = v._p == v._init;
+    for(int i=0; i<4; i++) swap(_init[i], v._init[i]);
+
+    std::swap(_p, v._p);
+    if(v_in_init) _p   = _init;
+    if(in_init)   v._p = v._init;
+
+    std::swap(_n, v._n);
+    std::swap(_private, v._private);
+  }
+
+
   /*! Array<T>&	DVector<T>::toArray() const
    *  \brief Pending Documentation
    *
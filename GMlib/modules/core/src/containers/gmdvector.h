@@ -88,6 +88,7 @@ namespace GMlib {
     void                  push_front(const DVector<T>& v);
     void                  resetDim(int i);
     void                  setDim(int i);
+    void                  swap(DVector<T>& v);
 
     const Array<T>&       toArray() const;
 
@@ -144,6 +145,13 @@ namespace GMlib {
   }
 
 
+  template <typename T>
+  inline
+  void swap(DVector<T>& a, DVector<T>& b) {
+    a.swap(b);
+  }
+
+
   #ifdef GM_STREAM
 
   // *****************************
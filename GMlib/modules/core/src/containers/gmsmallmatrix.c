@@ -0,0 +1,132 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+
+
+#include "gmsmallmatrix.h"
+
+
+
+namespace GMlib {
+
+
+  template <typename T, int N1, int N2>
+  inline
+  SmallMatrix<T,N1,N2>::SmallMatrix( int i, int j ) {
+
+    setDim(i, j);
+  }
+
+
+  /*! \brief Copy the elements of a DMatrix, the first N1 x N2 if it is larger */
+  template <typename T, int N1, int N2>
+  inline
+  SmallMatrix<T,N1,N2>::SmallMatrix( const DMatrix<T>& m ) {
+
+    *this = m;
+  }
+
+
+  template <typename T, int N1, int N2>
+  inline
+  int SmallMatrix<T,N1,N2>::getDim1() const {
+
+    return _n;
+  }
+
+
+  template <typename T, int N1, int N2>
+  inline
+  int SmallMatrix<T,N1,N2>::getDim2() const {
+
+    return _n > 0 ? _p[0].getDim() : 0;
+  }
+
+
+  /*! \brief Set the dimensions, never allocates
+   *
+   *  The contents are not touched, as for DMatrix::setDim().
+   *  Dimensions outside [0,N1] x [0,N2] are clamped to it, check
+   *  getDim1() and getDim2().
+   *  \param[in] i Number of rows
+   *  \param[in] j Number of columns
+   */
+  template <typename T, int N1, int N2>
+  inline
+  void SmallMatrix<T,N1,N2>::setDim( int i, int j ) {
+
+    _n = i < 0 ? 0 : ( i > N1 ? N1 : i );
+    for( int k = 0; k < _n; k++ ) _p[k].setDim(j);
+  }
+
+
+  template <typename T, int N1, int N2>
+  inline
+  DMatrix<T> SmallMatrix<T,N1,N2>::toDMatrix() const {
+
+    DMatrix<T> m( getDim1(), getDim2() );
+    for( int i = 0; i < getDim1(); i++ )
+      for( int j = 0; j < getDim2(); j++ )
+        m[i][j] = _p[i](j);
+    return m;
+  }
+
+
+  template <typename T, int N1, int N2>
+  inline
+  SmallMatrix<T,N1,N2>& SmallMatrix<T,N1,N2>::operator = ( const DMatrix<T>& m ) {
+
+    setDim( m.getDim1(), m.getDim2() );
+    for( int i = 0; i < getDim1(); i++ )
+      for( int j = 0; j < getDim2(); j++ )
+        _p[i][j] = m(i)(j);
+    return *this;
+  }
+
+
+  template <typename T, int N1, int N2>
+  inline
+  SmallVector<T,N2>& SmallMatrix<T,N1,N2>::operator [] ( int i ) {
+
+    return _p[i];
+  }
+
+
+  template <typename T, int N1, int N2>
+  inline
+  const SmallVector<T,N2>& SmallMatrix<T,N1,N2>::operator [] ( int i ) const {
+
+    return _p[i];
+  }
+
+
+  template <typename T, int N1, int N2>
+  inline
+  const SmallVector<T,N2>& SmallMatrix<T,N1,N2>::operator () ( int i ) const {
+
+    return _p[i];
+  }
+
+
+} // END namespace GMlib
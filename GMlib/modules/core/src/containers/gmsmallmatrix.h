@@ -0,0 +1,107 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+/*! \file gmsmallmatrix.h
+ *
+ *  Interface for the Small Matrix class.
+ *
+ *  A SmallMatrix has dynamic dimensions like DMatrix, but the elements
+ *  are always stored inline (no heap allocation). The dimensions can not
+ *  exceed the compile time capacity N1 x N2.
+ */
+
+
+#ifndef GM_CORE_CONTAINERS_SMALLMATRIX_H
+#define GM_CORE_CONTAINERS_SMALLMATRIX_H
+
+
+
+// GMlib includes
+#include "gmsmallvector.h"
+#include "gmdmatrix.h"
+
+
+namespace GMlib {
+
+
+  /*! \class SmallMatrix gmsmallmatrix.h <gmSmallMatrix>
+   *  \brief Fixed capacity matrix with dynamic dimensions
+   *
+   *  Fixed capacity matrix with dynamic dimensions.
+   *  Used for a surface position and its partial derivatives,
+   *  element [i][j] is the i-th u- and the j-th v-derivative.
+   *  The object can be returned by value, it never touches the heap.
+   */
+  template <typename T, int N1 = 4, int N2 = 4>
+  class SmallMatrix {
+  public:
+    SmallMatrix( int i = 0, int j = 0 );
+    SmallMatrix( const DMatrix<T>& m );
+
+    int                         getDim1() const;
+    int                         getDim2() const;
+    void                        setDim( int i, int j );
+
+    DMatrix<T>                  toDMatrix() const;
+
+    SmallMatrix<T,N1,N2>&       operator = ( const DMatrix<T>& m );
+
+    SmallVector<T,N2>&          operator [] ( int i );
+    const SmallVector<T,N2>&    operator [] ( int i ) const;
+    const SmallVector<T,N2>&    operator () ( int i ) const;
+
+  private:
+    int                         _n;
+    SmallVector<T,N2>           _p[N1];
+
+  }; // END class SmallMatrix
+
+
+
+  #ifdef GM_STREAM
+
+  template <typename T_Stream, typename T, int N1, int N2>
+  T_Stream& operator << ( T_Stream& out, const SmallMatrix<T,N1,N2>& v ) {
+
+    out << v.getDim1() << GMseparator::element() << v.getDim2() << GMseparator::group();
+    for( int i = 0; i < v.getDim1(); i++ ) {
+      for( int j = 0; j < v.getDim2(); j++ ) out << v(i)(j) << GMseparator::element();
+      out << GMseparator::group();
+    }
+    return out;
+  }
+
+  #endif
+
+
+} // END namespace GMlib
+
+
+// Include implementations
+#include "gmsmallmatrix.c"
+
+
+
+
+#endif // GM_CORE_CONTAINERS_SMALLMATRIX_H
@@ -0,0 +1,131 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+
+
+#include "gmsmallvector.h"
+
+
+
+namespace GMlib {
+
+
+  template <typename T, int N>
+  inline
+  SmallVector<T,N>::SmallVector( int i ) {
+
+    setDim(i);
+  }
+
+
+  /*! \brief Copy the elements of a DVector, the first N if it is larger */
+  template <typename T, int N>
+  inline
+  SmallVector<T,N>::SmallVector( const DVector<T>& v ) {
+
+    *this = v;
+  }
+
+
+  template <typename T, int N>
+  inline
+  int SmallVector<T,N>::getDim() const {
+
+    return _n;
+  }
+
+
+  template <typename T, int N>
+  inline
+  T* SmallVector<T,N>::getPtr() {
+
+    return _p;
+  }
+
+
+  template <typename T, int N>
+  inline
+  const T* SmallVector<T,N>::getPtr() const {
+
+    return _p;
+  }
+
+
+  /*! \brief Set the dimension, never allocates
+   *
+   *  The contents are not touched, as for DVector::setDim().
+   *  A dimension outside [0,N] is clamped to it, check getDim().
+   *  \param[in] i The new dimension
+   */
+  template <typename T, int N>
+  inline
+  void SmallVector<T,N>::setDim( int i ) {
+
+    _n = i < 0 ? 0 : ( i > N ? N : i );
+  }
+
+
+  template <typename T, int N>
+  inline
+  DVector<T> SmallVector<T,N>::toDVector() const {
+
+    return DVector<T>( _n, _p );
+  }
+
+
+  template <typename T, int N>
+  inline
+  SmallVector<T,N>& SmallVector<T,N>::operator = ( const DVector<T>& v ) {
+
+    setDim( v.getDim() );
+    for( int i = 0; i < _n; i++ ) _p[i] = v(i);
+    return *this;
+  }
+
+
+  template <typename T, int N>
+  inline
+  T& SmallVector<T,N>::operator [] ( int i ) {
+
+    return _p[i];
+  }
+
+
+  template <typename T, int N>
+  inline
+  const T& SmallVector<T,N>::operator [] ( int i ) const {
+
+    return _p[i];
+  }
+
+
+  template <typename T, int N>
+  inline
+  const T& SmallVector<T,N>::operator () ( int i ) const {
+
+    return _p[i];
+  }
+
+
+} // END namespace GMlib
@@ -0,0 +1,108 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+/*! \file gmsmallvector.h
+ *
+ *  Interface for the Small Vector class.
+ *
+ *  A SmallVector has a dynamic dimension like DVector, but the elements
+ *  are always stored inline (no heap allocation). The dimension can not
+ *  exceed the compile time capacity N.
+ */
+
+
+#ifndef GM_CORE_CONTAINERS_SMALLVECTOR_H
+#define GM_CORE_CONTAINERS_SMALLVECTOR_H
+
+
+
+// GMlib includes
+#include "gmdvector.h"
+
+
+namespace GMlib {
+
+
+  /*! \class SmallVector gmsmallvector.h <gmSmallVector>
+   *  \brief Fixed capacity vector with dynamic dimension
+   *
+   *  Fixed capacity vector with dynamic dimension.
+   *  Used for small results like a position and its derivatives,
+   *  where a DVector would otherwise be resized for every evaluation.
+   *  The object can be returned by value, it never touches the heap.
+   */
+  template <typename T, int N = 4>
+  class SmallVector {
+  public:
+    SmallVector( int i = 0 );
+    SmallVector( const DVector<T>& v );
+
+    static constexpr int  getCapacity() { return N; }
+    int                   getDim() const;
+    T*                    getPtr();
+    const T*              getPtr() const;
+    void                  setDim( int i );
+
+    DVector<T>            toDVector() const;
+
+    SmallVector<T,N>&     operator = ( const DVector<T>& v );
+
+    T&                    operator [] ( int i );
+    const T&              operator [] ( int i ) const;
+    const T&              operator () ( int i ) const;
+
+  private:
+    int                   _n;
+    T                     _p[N];
+
+  }; // END class SmallVector
+
+
+
+  #ifdef GM_STREAM
+
+  template <typename T_Stream, typename T, int N>
+  T_Stream& operator << ( T_Stream& out, const SmallVector<T,N>& v ) {
+
+    out << v.getDim() << GMseparator::group();
+
+    for( int i = 0; i < v.getDim(); i++ )
+      out << v(i) << GMseparator::element();
+
+    return out;
+  }
+
+  #endif
+
+
+} // END namespace GMlib
+
+
+// Include implementations
+#include "gmsmallvector.c"
+
+
+
+
+#endif // GM_CORE_CONTAINERS_SMALLVECTOR_H
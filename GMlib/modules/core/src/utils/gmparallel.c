@@ -0,0 +1,94 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+
+
+namespace GMlib {
+
+  namespace Private {
+
+    inline
+    int& noThreads() {
+
+      static int no_threads = 0;
+      return no_threads;
+    }
+
+  } // END namespace Private
+
+
+  inline
+  int getNoThreads() {
+
+    int& no_threads = Private::noThreads();
+    if( no_threads < 1 ) {
+      no_threads = int( std::thread::hardware_concurrency() );
+      if( no_threads < 1 ) no_threads = 1;
+    }
+    return no_threads;
+  }
+
+
+  inline
+  void setNoThreads( int no_threads ) {
+
+    Private::noThreads() = no_threads;
+  }
+
+
+  template <typename Func>
+  inline
+  void parallelFor( int begin, int end, Func f, int min_chunk ) {
+
+    const int size = end - begin;
+    if( size <= 0 ) return;
+    if( min_chunk < 1 ) min_chunk = 1;
+
+    int no_chunks = size / min_chunk;
+    if( no_chunks > getNoThreads() ) no_chunks = getNoThreads();
+    if( no_chunks < 2 ) {
+      f( begin, end );
+      return;
+    }
+
+    TaskPool&        pool = TaskPool::getShared();
+    std::atomic<int> remaining( no_chunks-1 );
+
+    // The remainder is spread over the first chunks
+    const int chunk = size / no_chunks;
+    const int rest  = size % no_chunks;
+    int b = begin;
+    for( int i = 0; i < no_chunks-1; i++ ) {
+      const int e = b + chunk + (i < rest ? 1 : 0);
+      pool.push( [f, b, e, &remaining]() mutable { f( b, e ); remaining--; } );
+      b = e;
+    }
+    f( b, end );
+
+    // Nothing is touched by a chunk after it is counted down
+    while( remaining.load() > 0 )
+      if( !pool.runOne() ) std::this_thread::yield();
+  }
+
+} // END namespace GMlib
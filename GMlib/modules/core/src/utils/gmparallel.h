@@ -0,0 +1,68 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_CORE_UTILS_PARALLEL_H
+#define GM_CORE_UTILS_PARALLEL_H
+
+#include "gmtaskgraph.h"
+
+// stl
+#include <atomic>
+#include <thread>
+
+namespace GMlib {
+
+
+  /*! \brief  Number of threads used by parallelFor (at least 1)
+   *
+   *  Defaults to the hardware concurrency, can be set lower (e.g. to 1 for
+   *  serial runs when debugging or measuring).
+   */
+  int   getNoThreads();
+  void  setNoThreads( int no_threads );
+
+
+  /*! \brief  Runs f(begin,end) on disjoint chunks of [begin,end) in parallel
+   *
+   *  The range is split in at most getNoThreads() contiguous chunks of at least
+   *  \a min_chunk elements, run on the shared TaskPool. The last chunk is run
+   *  on the calling thread, which then helps the pool until all chunks are
+   *  done. Ranges shorter than 2*min_chunk are run serially. \a f must only
+   *  write to data owned by its chunk.
+   *
+   *  \param[in] begin      First index
+   *  \param[in] end        One past the last index
+   *  \param[in] f          Callable taking (int chunk_begin, int chunk_end)
+   *  \param[in] min_chunk  Smallest chunk worth a thread of its own
+   */
+  template <typename Func>
+  void  parallelFor( int begin, int end, Func f, int min_chunk = 1 );
+
+
+} // END namespace GMlib
+
+// Include inline parallel function implementations
+#include "gmparallel.c"
+
+#endif // GM_CORE_UTILS_PARALLEL_H
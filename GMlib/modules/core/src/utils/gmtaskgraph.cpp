@@ -0,0 +1,339 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#include "gmtaskgraph.h"
+
+#include "gmparallel.h"
+
+// stl
+#include <algorithm>
+#include <chrono>
+
+
+namespace GMlib {
+
+
+  namespace {
+
+    // The pool and queue of the current thread, if it is a worker
+    thread_local const TaskPool*  tl_pool  = nullptr;
+    thread_local int              tl_queue = 0;
+
+  } // END anonymous namespace
+
+
+
+  TaskPool::TaskPool( int no_workers ) : _pending(0), _next(0), _stop(false) {
+
+    if( no_workers < 0 ) no_workers = 0;
+
+    const int no_queues = no_workers > 0 ? no_workers : 1;
+    for( int i = 0; i < no_queues; i++ )
+      _queues.emplace_back( new Queue );
+
+    for( int i = 0; i < no_workers; i++ )
+      _workers.emplace_back( &TaskPool::work, this, i );
+  }
+
+
+  TaskPool::~TaskPool() {
+
+    {
+      std::lock_guard<std::mutex> lock( _sleep_m );
+      _stop = true;
+    }
+    _sleep_cv.notify_all();
+
+    for( auto& t : _workers )
+      t.join();
+  }
+
+
+  /*! TaskPool& TaskPool::getShared()
+   *  \brief The pool shared by the library, made at the first call
+   *
+   *  Sized by getNoThreads() at that time.
+   */
+  TaskPool& TaskPool::getShared() {
+
+    static TaskPool pool( getNoThreads() - 1 );
+    return pool;
+  }
+
+
+  /*! TaskPool& TaskPool::getBackground()
+   *  \brief The pool for background work, made at the first call
+   *
+   *  Sized as the shared pool, but with at least one worker, as nobody
+   *  helps it by runOne(). See PSurf::replotAsync().
+   */
+  TaskPool& TaskPool::getBackground() {
+
+    static TaskPool pool( std::max( getNoThreads() - 1, 1 ) );
+    return pool;
+  }
+
+
+  int TaskPool::getNoWorkers() const {
+
+    return int(_workers.size());
+  }
+
+
+  int TaskPool::getOwnQueue() const {
+
+    return tl_pool == this ? tl_queue : -1;
+  }
+
+
+  /*! void TaskPool::push( Task task )
+   *  \brief Queues a task, it is run by a worker or by a thread in runOne()
+   */
+  void TaskPool::push( Task task ) {
+
+    int q = getOwnQueue();
+    if( q < 0 ) q = int( _next++ % _queues.size() );
+
+    {
+      std::lock_guard<std::mutex> lock( _queues[size_t(q)]->m );
+      _queues[size_t(q)]->tasks.push_back( std::move(task) );
+    }
+    _pending++;
+
+    { std::lock_guard<std::mutex> lock( _sleep_m ); }
+    _sleep_cv.notify_one();
+  }
+
+
+  bool TaskPool::take( int own, Task& task ) {
+
+    const int n = int(_queues.size());
+
+    // Newest of the own queue
+    if( own >= 0 ) {
+      Queue& q = *_queues[size_t(own)];
+      std::lock_guard<std::mutex> lock( q.m );
+      if( !q.tasks.empty() ) {
+        task = std::move( q.tasks.back() );
+        q.tasks.pop_back();
+        _pending--;
+        return true;
+      }
+    }
+
+    // Oldest of the others
+    for( int k = 1; k <= n; k++ ) {
+      const int i = ( ( own >= 0 ? own : 0 ) + k ) % n;
+      Queue& q = *_queues[size_t(i)];
+      std::lock_guard<std::mutex> lock( q.m );
+      if( !q.tasks.empty() ) {
+        task = std::move( q.tasks.front() );
+        q.tasks.pop_front();
+        _pending--;
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  /*! bool TaskPool::runOne()
+   *  \brief Runs one queued task on the calling thread, false if there was none
+   */
+  bool TaskPool::runOne() {
+
+    if( _pending.load() <= 0 ) return false;
+
+    Task task;
+    if( !take( getOwnQueue(), task ) ) return false;
+    task();
+    return true;
+  }
+
+
+  void TaskPool::work( int index ) {
+
+    tl_pool  = this;
+    tl_queue = index;
+
+    Task task;
+    while( true ) {
+
+      if( take( index, task ) ) {
+        task();
+        task = nullptr;
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock( _sleep_m );
+      _sleep_cv.wait_for( lock, std::chrono::milliseconds(10), [this]{ return _stop || _pending.load() > 0; } );
+      if( _stop ) return;
+    }
+  }
+
+
+
+
+  TaskGraph::TaskGraph() {}
+
+
+  /*! int TaskGraph::insertTask( std::function<void()> f, bool main_thread )
+   *  \brief Adds a task, returns its index
+   *
+   *  \param[in] f            The work
+   *  \param[in] main_thread  Must be run by the thread calling run()
+   */
+  int TaskGraph::insertTask( std::function<void()> f, bool main_thread ) {
+
+    _nodes.push_back( Node{ std::move(f), main_thread, {}, 0 } );
+    return int(_nodes.size()) - 1;
+  }
+
+
+  /*! void TaskGraph::insertEdge( int before, int after )
+   *  \brief Task \a after is not started before task \a before is done
+   */
+  void TaskGraph::insertEdge( int before, int after ) {
+
+    _nodes[size_t(before)].next.push_back( after );
+    _nodes[size_t(after)].no_before++;
+  }
+
+
+  void TaskGraph::clear() {
+
+    _nodes.clear();
+  }
+
+
+  int TaskGraph::getSize() const {
+
+    return int(_nodes.size());
+  }
+
+
+  /*! bool TaskGraph::isAcyclic() const
+   *  \brief False if the edges make a cycle, then the graph can not be run
+   */
+  bool TaskGraph::isAcyclic() const {
+
+    std::vector<int> no_before( _nodes.size() );
+    std::vector<int> ready;
+    for( size_t i = 0; i < _nodes.size(); i++ )
+      if( ( no_before[i] = _nodes[i].no_before ) == 0 ) ready.push_back( int(i) );
+
+    size_t no_done = 0;
+    while( !ready.empty() ) {
+      const int i = ready.back();
+      ready.pop_back();
+      no_done++;
+      for( int j : _nodes[size_t(i)].next )
+        if( --no_before[size_t(j)] == 0 ) ready.push_back( j );
+    }
+    return no_done == _nodes.size();
+  }
+
+
+  /*! bool TaskGraph::run( TaskPool& pool )
+   *  \brief Runs all tasks, returns when they are done
+   *
+   *  Returns false, without running anything, if the edges make a cycle.
+   *  The graph is kept, and can be run again.
+   *
+   *  The state of the run is shared with the queued tasks, so it lives
+   *  until the last of them has left, even if run() has returned.
+   */
+  bool TaskGraph::run( TaskPool& pool ) {
+
+    if( !isAcyclic() ) return false;
+
+    const size_t n = _nodes.size();
+    if( n == 0 ) return true;
+
+    struct State {
+      std::unique_ptr<std::atomic<int>[]> no_before;
+      int                       remaining;
+      std::mutex                main_m;
+      std::condition_variable   main_cv;
+      std::deque<int>           main_ready;
+      std::function<void(int)>  ready;
+      std::function<void(int)>  finish;
+    };
+
+    const std::shared_ptr<State> state = std::make_shared<State>();
+    state->no_before.reset( new std::atomic<int>[n] );
+    for( size_t i = 0; i < n; i++ ) state->no_before[i] = _nodes[i].no_before;
+    state->remaining = int(n);
+
+    // Held weakly by the state itself, strongly by each queued task
+    const std::weak_ptr<State> weak = state;
+    state->finish = [this, weak]( int i ) {
+      const std::shared_ptr<State> s = weak.lock();
+      for( int j : _nodes[size_t(i)].next )
+        if( --s->no_before[size_t(j)] == 0 ) s->ready( j );
+
+      std::lock_guard<std::mutex> lock( s->main_m );
+      if( --s->remaining == 0 ) s->main_cv.notify_all();
+    };
+    state->ready = [this, weak, &pool]( int i ) {
+      const std::shared_ptr<State> s = weak.lock();
+      if( _nodes[size_t(i)].main_thread ) {
+        std::lock_guard<std::mutex> lock( s->main_m );
+        s->main_ready.push_back( i );
+        s->main_cv.notify_all();
+      }
+      else
+        pool.push( [this, s, i]{ _nodes[size_t(i)].f(); s->finish( i ); } );
+    };
+
+    for( size_t i = 0; i < n; i++ )
+      if( _nodes[i].no_before == 0 ) state->ready( int(i) );
+
+    while( true ) {
+
+      int i = -1;
+      {
+        std::lock_guard<std::mutex> lock( state->main_m );
+        if( state->remaining == 0 ) break;
+        if( !state->main_ready.empty() ) {
+          i = state->main_ready.front();
+          state->main_ready.pop_front();
+        }
+      }
+      if( i >= 0 ) {
+        _nodes[size_t(i)].f();
+        state->finish( i );
+        continue;
+      }
+
+      if( pool.runOne() ) continue;
+
+      std::unique_lock<std::mutex> lock( state->main_m );
+      state->main_cv.wait_for( lock, std::chrono::microseconds(100),
+                               [&]{ return !state->main_ready.empty() || state->remaining == 0; } );
+    }
+    return true;
+  }
+
+} // END namespace GMlib
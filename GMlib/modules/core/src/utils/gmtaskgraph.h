@@ -0,0 +1,130 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_CORE_UTILS_TASKGRAPH_H
+#define GM_CORE_UTILS_TASKGRAPH_H
+
+// stl
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GMlib {
+
+
+  /*! \class  TaskPool gmtaskgraph.h <gmTaskGraph>
+   *  \brief  Work stealing thread pool
+   *
+   *  Each worker has its own queue. Tasks pushed by a worker go to its own queue,
+   *  tasks pushed from other threads are spread over the queues. A worker takes
+   *  the newest task of its own queue, and when that is empty it steals the
+   *  oldest task of another queue. Threads waiting for tasks to finish can help
+   *  by runOne().
+   *
+   *  The shared pool (getShared()) has getNoThreads()-1 workers, the thread
+   *  waiting for the work is the last one. With one thread there are no workers,
+   *  and all tasks are run by runOne() on the waiting thread.
+   *
+   *  Long running work that nobody waits for goes to the background pool
+   *  (getBackground()), so a thread helping the shared pool never picks it up.
+   */
+  class TaskPool {
+  public:
+    using Task = std::function<void()>;
+
+    explicit TaskPool( int no_workers );
+    ~TaskPool();
+
+    static TaskPool&            getShared();
+    static TaskPool&            getBackground();
+
+    int                         getNoWorkers() const;
+    void                        push( Task task );
+    bool                        runOne();
+
+    TaskPool( const TaskPool& ) = delete;
+    TaskPool&                   operator = ( const TaskPool& ) = delete;
+
+  private:
+    struct Queue {
+      std::mutex                m;
+      std::deque<Task>          tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread>    _workers;
+    std::atomic<int>            _pending;
+    std::atomic<unsigned int>   _next;
+    std::mutex                  _sleep_m;
+    std::condition_variable     _sleep_cv;
+    bool                        _stop;
+
+    int                         getOwnQueue() const;
+    bool                        take( int own, Task& task );
+    void                        work( int index );
+
+  }; // END class TaskPool
+
+
+
+  /*! \class  TaskGraph gmtaskgraph.h <gmTaskGraph>
+   *  \brief  Tasks with ordering edges, run on a TaskPool
+   *
+   *  A task is run when all tasks with an edge to it are done. Tasks marked as
+   *  main thread tasks are run by the thread calling run(), in the order they
+   *  become ready, the rest are run on the pool. The calling thread helps the
+   *  pool while waiting.
+   */
+  class TaskGraph {
+  public:
+    TaskGraph();
+
+    int                         insertTask( std::function<void()> f, bool main_thread = false );
+    void                        insertEdge( int before, int after );
+    void                        clear();
+
+    int                         getSize() const;
+    bool                        isAcyclic() const;
+    bool                        run( TaskPool& pool = TaskPool::getShared() );
+
+  private:
+    struct Node {
+      std::function<void()>     f;
+      bool                      main_thread;
+      std::vector<int>          next;
+      int                       no_before;
+    };
+
+    std::vector<Node>           _nodes;
+
+  }; // END class TaskGraph
+
+} // END namespace GMlib
+
+#endif // GM_CORE_UTILS_TASKGRAPH_H
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <core/containers/gmdvector.h>
+#include <core/containers/gmdmatrix.h>
+using namespace GMlib;
+
+namespace {
+
+  // Sizes up to 4 are kept inside the containers, larger ones are allocated
+  DMatrix<int> numbered( int m1, int m2, int first ) {
+    DMatrix<int> a( m1, m2 );
+    for( int i = 0; i < m1; i++ )
+      for( int j = 0; j < m2; j++ )
+        a[i][j] = first + i*m2 + j;
+    return a;
+  }
+
+  bool isNumbered( const DMatrix<int>& a, int m1, int m2, int first ) {
+    if( a.getDim1() != m1 || a.getDim2() != m2 ) return false;
+    for( int i = 0; i < m1; i++ )
+      for( int j = 0; j < m2; j++ )
+        if( a(i)(j) != first + i*m2 + j ) return false;
+    return true;
+  }
+
+
+  TEST(DVector, Swap_hands_over_the_memory) {
+
+    DVector<int> a( 100, 1 ), b( 3, 2 );
+    const int* pa = a.getPtr();
+
+    a.swap( b );
+    EXPECT_EQ( a.getDim(), 3 );
+    EXPECT_EQ( b.getDim(), 100 );
+    EXPECT_EQ( b.getPtr(), pa );
+    for( int i = 0; i < a.getDim(); i++ ) EXPECT_EQ( a[i], 2 );
+    for( int i = 0; i < b.getDim(); i++ ) EXPECT_EQ( b[i], 1 );
+
+    // Both kept inside
+    DVector<int> c( 2, 3 );
+    a.swap( c );
+    EXPECT_EQ( a.getDim(), 2 );
+    EXPECT_EQ( a[1], 3 );
+    EXPECT_EQ( c.getDim(), 3 );
+    EXPECT_EQ( c[2], 2 );
+
+    // The swapped vectors can grow and be copied as before
+    a.setDim( 10 );
+    c = b;
+    EXPECT_EQ( c.getDim(), 100 );
+    EXPECT_EQ( c[99], 1 );
+  }
+
+
+  TEST(DMatrix, Swap_any_sizes) {
+
+    const int dims[][2] = { { 2, 3 }, { 3, 8 }, { 7, 2 }, { 9, 9 } };
+    for( auto& d : dims ) {
+      for( auto& e : dims ) {
+        DMatrix<int> a = numbered( d[0], d[1], 0 ), b = numbered( e[0], e[1], 1000 );
+        a.swap( b );
+        EXPECT_TRUE( isNumbered( a, e[0], e[1], 1000 ) );
+        EXPECT_TRUE( isNumbered( b, d[0], d[1], 0 ) );
+
+        swap( a, b );
+        EXPECT_TRUE( isNumbered( a, d[0], d[1], 0 ) );
+        EXPECT_TRUE( isNumbered( b, e[0], e[1], 1000 ) );
+      }
+    }
+  }
+
+
+  TEST(DMatrix, Swap_nested_matrices) {
+
+    DMatrix< DMatrix<int> > a( 6, 2 ), b( 2, 6 );
+    for( int i = 0; i < 6; i++ )
+      for( int j = 0; j < 2; j++ ) {
+        a[i][j] = numbered( 3, 5, 10*i + j );
+        b[j][i] = numbered( 5, 3, 10*i + j );
+      }
+
+    a.swap( b );
+    for( int i = 0; i < 6; i++ )
+      for( int j = 0; j < 2; j++ ) {
+        EXPECT_TRUE( isNumbered( a(j)(i), 5, 3, 10*i + j ) );
+        EXPECT_TRUE( isNumbered( b(i)(j), 3, 5, 10*i + j ) );
+      }
+  }
+
+} // END anonymous namespace
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <core/utils/gmtaskgraph.h>
+#include <core/utils/gmparallel.h>
+using namespace GMlib;
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  TEST(TaskGraph, Tasks_run_after_the_tasks_before_them) {
+
+    TaskPool pool( 3 );
+    TaskGraph graph;
+
+    // A chain of layers, each task of a layer after all tasks of the layer before
+    const int no_layers = 20, width = 8;
+    std::vector<std::atomic<int>> done( no_layers );
+    std::atomic<int> errors( 0 );
+    std::vector<int> prev;
+    for( int l = 0; l < no_layers; l++ ) {
+      std::vector<int> layer;
+      for( int k = 0; k < width; k++ ) {
+        layer.push_back( graph.insertTask( [&, l]{
+          if( l > 0 && done[size_t(l-1)].load() != width ) errors++;
+          done[size_t(l)]++;
+        } ) );
+        for( int p : prev ) graph.insertEdge( p, layer.back() );
+      }
+      prev = layer;
+    }
+
+    EXPECT_EQ( graph.getSize(), no_layers * width );
+    EXPECT_TRUE( graph.run( pool ) );
+    EXPECT_EQ( errors.load(), 0 );
+    EXPECT_EQ( done[size_t(no_layers-1)].load(), width );
+
+    // The graph can be run again
+    for( auto& d : done ) d = 0;
+    EXPECT_TRUE( graph.run( pool ) );
+    EXPECT_EQ( errors.load(), 0 );
+  }
+
+
+  TEST(TaskGraph, Main_thread_tasks_run_on_the_calling_thread) {
+
+    TaskPool pool( 2 );
+    TaskGraph graph;
+
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<int> wrong_thread( 0 );
+    std::mutex m;
+    std::vector<int> order;
+
+    int last = -1;
+    for( int i = 0; i < 10; i++ ) {
+      const int worker = graph.insertTask( []{} );
+      const int main   = graph.insertTask( [&, i]{
+        if( std::this_thread::get_id() != caller ) wrong_thread++;
+        std::lock_guard<std::mutex> lock( m );
+        order.push_back( i );
+      }, true );
+      graph.insertEdge( worker, main );
+      if( last >= 0 ) graph.insertEdge( last, main );
+      last = main;
+    }
+
+    EXPECT_TRUE( graph.run( pool ) );
+    EXPECT_EQ( wrong_thread.load(), 0 );
+    ASSERT_EQ( int(order.size()), 10 );
+    for( int i = 0; i < 10; i++ ) EXPECT_EQ( order[size_t(i)], i );
+  }
+
+
+  TEST(TaskGraph, Cycles_are_not_run) {
+
+    TaskPool pool( 0 );
+    TaskGraph graph;
+
+    int n = 0;
+    const int a = graph.insertTask( [&]{ n++; } );
+    const int b = graph.insertTask( [&]{ n++; } );
+    const int c = graph.insertTask( [&]{ n++; } );
+    graph.insertEdge( a, b );
+    graph.insertEdge( b, c );
+    EXPECT_TRUE( graph.isAcyclic() );
+
+    graph.insertEdge( c, a );
+    EXPECT_FALSE( graph.isAcyclic() );
+    EXPECT_FALSE( graph.run( pool ) );
+    EXPECT_EQ( n, 0 );
+
+    graph.clear();
+    graph.insertTask( [&]{ n++; } );
+    EXPECT_TRUE( graph.run( pool ) );
+    EXPECT_EQ( n, 1 );
+  }
+
+
+  TEST(TaskGraph, Short_runs_back_to_back) {
+
+    TaskPool pool( 3 );
+
+    // Workers may still be leaving their last task when run() returns, and
+    // the next run, on a new graph, must not be disturbed by that
+    int n = 0;
+    for( int r = 0; r < 2000; r++ ) {
+      TaskGraph graph;
+      std::atomic<int> k( 0 );
+      const int a = graph.insertTask( [&]{ k++; } );
+      for( int i = 0; i < 4; i++ ) graph.insertEdge( a, graph.insertTask( [&]{ k++; } ) );
+      EXPECT_TRUE( graph.run( pool ) );
+      n += k.load();
+    }
+    EXPECT_EQ( n, 2000 * 5 );
+  }
+
+
+  TEST(TaskGraph, ParallelFor_covers_the_range_once) {
+
+    std::vector<int> hits( 1000, 0 );
+    parallelFor( 0, 1000, [&]( int b, int e ) { for( int i = b; i < e; i++ ) hits[size_t(i)]++; }, 7 );
+    for( int h : hits ) EXPECT_EQ( h, 1 );
+
+    // A range shorter than two chunks is one call
+    int calls = 0;
+    parallelFor( 0, 10, [&]( int b, int e ) { calls++; EXPECT_EQ( e-b, 10 ); }, 8 );
+    EXPECT_EQ( calls, 1 );
+  }
+
+
+  TEST(TaskGraph, ParallelFor_on_the_shared_pool) {
+
+    setNoThreads( 4 );
+
+    // Each index once, also when nested and when run from a pool task
+    std::vector<std::atomic<int>> hits( 1000 );
+    for( auto& h : hits ) h = 0;
+
+    parallelFor( 0, 10, [&]( int b, int e ) {
+      for( int i = b; i < e; i++ )
+        parallelFor( 100*i, 100*(i+1), [&]( int c, int d ) {
+          for( int j = c; j < d; j++ ) hits[size_t(j)]++;
+        }, 10 );
+    } );
+
+    TaskGraph graph;
+    graph.insertTask( [&]{
+      parallelFor( 0, 1000, [&]( int b, int e ) { for( int i = b; i < e; i++ ) hits[size_t(i)]++; } );
+    } );
+    EXPECT_TRUE( graph.run() );
+
+    for( auto& h : hits ) EXPECT_EQ( h.load(), 2 );
+
+    setNoThreads( 0 );
+  }
+
+}
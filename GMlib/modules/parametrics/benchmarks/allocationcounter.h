@@ -0,0 +1,35 @@
+#ifndef GM_PARAMETRICS_BENCHMARKS_ALLOCATIONCOUNTER_H
+#define GM_PARAMETRICS_BENCHMARKS_ALLOCATIONCOUNTER_H
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+/*!
+ * Counting heap allocations, for the "allocs" counters of the benchmarks.
+ * Replaces the global operator new and delete, so it must be included by
+ * one source file of a benchmark only. GCC sees free() of memory from
+ * operator new where these are inlined, see CMakeLists.txt.
+ */
+inline std::atomic<long> no_allocs{0};
+
+void* operator new(std::size_t size)
+{
+  ++no_allocs;
+  if (void* p = std::malloc(size)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](std::size_t size)
+{
+  ++no_allocs;
+  if (void* p = std::malloc(size)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+
+#endif // GM_PARAMETRICS_BENCHMARKS_ALLOCATIONCOUNTER_H
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+
+#include <gmParametricsModule>
+using namespace GMlib;
+
+
+/*!
+ * \brief BM_PSurf_replot
+ * The reference, a replot(m,m,2,2) of a torus without curvature
+ */
+static void BM_PSurf_replot(benchmark::State& state)
+{
+  const int m = int(state.range(0));
+  PTorus<float> torus(3.0f, 1.0f, 1.0f);
+  torus.replot(m, m, 2, 2);
+  while (state.KeepRunning()) torus.replot();
+}
+BENCHMARK(BM_PSurf_replot)->Unit(benchmark::kMillisecond)->Arg(128)->Arg(512);
+
+
+/*!
+ * \brief BM_PSurf_curvaturePointwise
+ * Mean curvature at all samples by getCurvatureMean(u,v), evaluating again
+ */
+static void BM_PSurf_curvaturePointwise(benchmark::State& state)
+{
+  const int m = int(state.range(0));
+  PTorus<float> torus(3.0f, 1.0f, 1.0f);
+  torus.replot(m, m, 2, 2);
+
+  DMatrix<float> mean(m, m);
+  const float du = torus.getParDeltaU() / (m - 1);
+  const float dv = torus.getParDeltaV() / (m - 1);
+  while (state.KeepRunning())
+    for (int i = 0; i < m; ++i)
+      for (int j = 0; j < m; ++j)
+        mean[i][j] = torus.getCurvatureMean(torus.getParStartU() + i * du, torus.getParStartV() + j * dv);
+}
+BENCHMARK(BM_PSurf_curvaturePointwise)->Unit(benchmark::kMillisecond)->Arg(128)->Arg(512);
+
+
+/*!
+ * \brief BM_PSurf_computeCurvatures
+ * All four fields from the replot samples, the argument is the number of threads
+ */
+static void BM_PSurf_computeCurvatures(benchmark::State& state)
+{
+  const int m = int(state.range(0));
+  PTorus<float> torus(3.0f, 1.0f, 1.0f);
+  torus.replot(m, m, 2, 2);
+
+  const int no_threads = getNoThreads();
+  setNoThreads(int(state.range(1)));
+  DMatrix<float> gauss, mean, kmax, kmin;
+  while (state.KeepRunning()) torus.getCurvatures(&gauss, &mean, &kmax, &kmin);
+  setNoThreads(no_threads);
+}
+BENCHMARK(BM_PSurf_computeCurvatures)
+  ->Unit(benchmark::kMillisecond)
+  ->Args({128, 1})->Args({512, 1})->Args({512, 4});
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+
+#include <gmParametricsModule>
+using namespace GMlib;
+
+#include <memory>
+#include <vector>
+
+
+/*!
+ * Cubic B-spline curves wandering around in the plane z = 0, about [0,10]^2
+ */
+static std::vector<std::unique_ptr<PBSplineCurve<float>>> makeCurves(int n)
+{
+  std::vector<std::unique_ptr<PBSplineCurve<float>>> curves;
+  unsigned int seed = 1;
+  auto rnd = [&seed]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / float(1 << 24); };
+
+  for (int i = 0; i < n; ++i) {
+    DVector<Vector<float, 3>> c(8);
+    Vector<float, 3> p(10.0f * rnd(), 10.0f * rnd(), 0.0f);
+    for (int j = 0; j < c.getDim(); ++j) {
+      c[j] = p;
+      p += Vector<float, 3>(2.0f * rnd() - 1.0f, 2.0f * rnd() - 1.0f, 0.0f);
+    }
+    curves.emplace_back(new PBSplineCurve<float>(c, 3, false));
+  }
+  return curves;
+}
+
+
+/*!
+ * \brief BM_PCurveIntersection_intersectAll
+ * All pairs of n B-spline curves
+ */
+static void BM_PCurveIntersection_intersectAll(benchmark::State& state)
+{
+  const auto curves = makeCurves(int(state.range(0)));
+  std::vector<const PCurve<float, 3>*> c;
+  for (const auto& p : curves) c.push_back(p.get());
+
+  PCurveIntersection<float> isect;
+  std::size_t               pairs = 0;
+  while (state.KeepRunning()) pairs = isect.intersectAll(c).size();
+
+  state.counters["candidates"] = isect.getNoCandidates();
+  state.counters["pairs"]      = double(pairs);
+}
+BENCHMARK(BM_PCurveIntersection_intersectAll)->Unit(benchmark::kMillisecond)->Arg(64)->Arg(256);
+
+
+/*!
+ * \brief BM_PCurveIntersection_curvesTorus
+ * n B-spline curves against a torus
+ */
+static void BM_PCurveIntersection_curvesTorus(benchmark::State& state)
+{
+  const auto curves = makeCurves(int(state.range(0)));
+  std::vector<const PCurve<float, 3>*> c;
+  for (const auto& p : curves) c.push_back(p.get());
+
+  PTorus<float> torus(3.0f, 1.0f, 1.0f);
+  torus.translate(Vector<float, 3>(5.0f, 5.0f, 0.0f));
+
+  PCurveIntersection<float> isect;
+  std::size_t               hits = 0;
+  while (state.KeepRunning()) {
+    hits = 0;
+    for (const auto& h : isect.intersectAll(c, torus)) hits += h.size();
+  }
+
+  state.counters["candidates"] = isect.getNoCandidates();
+  state.counters["hits"]       = double(hits);
+}
+BENCHMARK(BM_PCurveIntersection_curvesTorus)->Unit(benchmark::kMillisecond)->Arg(64)->Arg(256);
+
+
+BENCHMARK_MAIN();
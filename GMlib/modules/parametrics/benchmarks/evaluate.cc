@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+
+#include "allocationcounter.h"
+
+#include <gmParametricsModule>
+using namespace GMlib;
+
+
+static DVector<Vector<float, 3>> controlPoints()
+{
+  DVector<Vector<float, 3>> c(6);
+  for (int i = 0; i < c.getDim(); ++i)
+    c[i] = Vector<float, 3>(float(i), float(i * i) / 5.0f, 1.0f);
+  return c;
+}
+
+template <typename Func>
+static void runCurve(benchmark::State& state, Func eval)
+{
+  const int d   = int(state.range(0));
+  long      ev  = 0;
+  long      all = 0;
+
+  while (state.KeepRunning()) {
+    const long a0 = no_allocs;
+    for (int i = 0; i < 1000; ++i) eval(0.001f * i, i % (d + 1));
+    all += no_allocs - a0;
+    ev += 1000;
+  }
+  state.counters["allocs"] = double(all) / double(ev);
+}
+
+
+/*!
+ * \brief BM_PBezierCurve_evaluateParent
+ * The reference returning evaluator, alternating between 0 and d derivatives
+ */
+static void BM_PBezierCurve_evaluateParent(benchmark::State& state)
+{
+  PBezierCurve<float> curve(controlPoints());
+  runCurve(state, [&](float t, int d) {
+    benchmark::DoNotOptimize(curve.evaluateParent(t, d)[0]);
+  });
+}
+BENCHMARK(BM_PBezierCurve_evaluateParent)
+  ->Unit(benchmark::kMicrosecond)
+  ->DenseRange(0, 3);
+
+
+/*!
+ * \brief BM_PBezierCurve_evaluateParentSmall
+ * The by value evaluator, the result is stored inline
+ */
+static void BM_PBezierCurve_evaluateParentSmall(benchmark::State& state)
+{
+  PBezierCurve<float> curve(controlPoints());
+  runCurve(state, [&](float t, int d) {
+    benchmark::DoNotOptimize(curve.evaluateParentSmall(t, d));
+  });
+}
+BENCHMARK(BM_PBezierCurve_evaluateParentSmall)
+  ->Unit(benchmark::kMicrosecond)
+  ->DenseRange(0, 3);
+
+
+static void BM_PBSplineCurve_evaluateParentSmall(benchmark::State& state)
+{
+  PBSplineCurve<float> curve(controlPoints(), 3, false);
+  runCurve(state, [&](float t, int d) {
+    benchmark::DoNotOptimize(curve.evaluateParentSmall(t, d));
+  });
+}
+BENCHMARK(BM_PBSplineCurve_evaluateParentSmall)
+  ->Unit(benchmark::kMicrosecond)
+  ->DenseRange(0, 3);
+
+
+static void BM_PSphere_evaluateParentSmall(benchmark::State& state)
+{
+  PSphere<float> sphere(1.0f);
+  runCurve(state, [&](float u, int d) {
+    benchmark::DoNotOptimize(sphere.evaluateParentSmall(u, 0.3f, d, d));
+  });
+}
+BENCHMARK(BM_PSphere_evaluateParentSmall)
+  ->Unit(benchmark::kMicrosecond)
+  ->DenseRange(0, 3);
+
+
+BENCHMARK_MAIN();
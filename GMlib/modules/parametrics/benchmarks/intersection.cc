@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>
+
+#include <gmParametricsModule>
+using namespace GMlib;
+
+
+static void runIntersection(benchmark::State& state, PSurf<float,3>* s1, PSurf<float,3>* s2)
+{
+  PSurfIntersection<float> isect(s1, s2, int(state.range(0)), int(state.range(0)));
+  while (state.KeepRunning()) benchmark::DoNotOptimize(isect.compute());
+
+  state.counters["candidates"] = isect.getNoCandidates();
+  state.counters["curves"]     = isect.getNoCurves();
+}
+
+
+/*!
+ * \brief BM_PSurfIntersection_torusCylinder
+ * Two closed curves, the cylinder cutting through the torus tube
+ */
+static void BM_PSurfIntersection_torusCylinder(benchmark::State& state)
+{
+  PTorus<float>    torus(3.0f, 1.0f, 1.0f);
+  PCylinder<float> cylinder(3.5f, 3.5f, 4.0f);
+  runIntersection(state, &torus, &cylinder);
+}
+BENCHMARK(BM_PSurfIntersection_torusCylinder)->Unit(benchmark::kMillisecond)->Arg(16)->Arg(32)->Arg(64);
+
+
+/*!
+ * \brief BM_PSurfIntersection_erbsPlane
+ * An ERBS surface approximating a torus, cut by a plane
+ */
+static void BM_PSurfIntersection_erbsPlane(benchmark::State& state)
+{
+  PTorus<float>    torus(3.0f, 1.0f, 1.0f);
+  PERBSSurf<float> erbs(&torus, 6, 6, 2, 2);
+  PPlane<float>    plane(Point<float,3>(-5.0f, -5.0f, 0.3f), Vector<float,3>(10.0f, 0.0f, 0.0f), Vector<float,3>(0.0f, 10.0f, 0.0f));
+  runIntersection(state, &erbs, &plane);
+}
+BENCHMARK(BM_PSurfIntersection_erbsPlane)->Unit(benchmark::kMillisecond)->Arg(16)->Arg(32)->Arg(64);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <gmParametricsModule>
+#include <gmSceneModule>
+using namespace GMlib;
+
+#include <vector>
+
+
+/*!
+ * 4 x 4 tori in the plane z = 0, 32 x 32 samples each
+ */
+static void makeScene(Scene& scene)
+{
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j) {
+      PTorus<float>* t = new PTorus<float>(3.0f, 1.0f, 1.0f);
+      t->replot(32, 32, 1, 1);
+      t->translateGlobal(Vector<float, 3>(9.0f * i, 9.0f * j, 0.0f));
+      scene.insert(t);
+    }
+  scene.prepare();
+}
+
+/*!
+ * n rays from a point above the scene, spread over the tori
+ */
+static void makeRays(int n, std::vector<Point<float, 3>>& o, std::vector<Vector<float, 3>>& d)
+{
+  o.assign(n, Point<float, 3>(13.5f, 13.5f, 30.0f));
+  d.resize(n);
+  unsigned int seed = 1;
+  auto rnd = [&seed]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / float(1 << 24); };
+  for (int k = 0; k < n; ++k)
+    d[k] = Point<float, 3>(-4.0f + 35.0f * rnd(), -4.0f + 35.0f * rnd(), 0.0f) - o[k];
+}
+
+
+/*!
+ * \brief BM_Scene_intersectRay
+ * One ray at a time
+ */
+static void BM_Scene_intersectRay(benchmark::State& state)
+{
+  Scene scene;
+  makeScene(scene);
+  std::vector<Point<float, 3>>  o;
+  std::vector<Vector<float, 3>> d;
+  makeRays(int(state.range(0)), o, d);
+
+  int hits = 0;
+  while (state.KeepRunning()) {
+    hits = 0;
+    RayHit hit;
+    for (std::size_t k = 0; k < o.size(); ++k) hits += scene.intersectRay(o[k], d[k], hit) ? 1 : 0;
+  }
+
+  state.counters["hits"] = hits;
+  state.counters["rays"] = benchmark::Counter(double(o.size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Scene_intersectRay)->Unit(benchmark::kMillisecond)->Arg(4096)->Arg(65536);
+
+
+/*!
+ * \brief BM_Scene_intersectRays
+ * The batch, on the worker threads
+ */
+static void BM_Scene_intersectRays(benchmark::State& state)
+{
+  Scene scene;
+  makeScene(scene);
+  std::vector<Point<float, 3>>  o;
+  std::vector<Vector<float, 3>> d;
+  makeRays(int(state.range(0)), o, d);
+
+  std::vector<RayHit> hits;
+  while (state.KeepRunning()) scene.intersectRays(o, d, hits);
+
+  state.counters["threads"] = getNoThreads();
+  state.counters["rays"]    = benchmark::Counter(double(o.size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Scene_intersectRays)->Unit(benchmark::kMillisecond)->Arg(4096)->Arg(65536);
+
+
+BENCHMARK_MAIN();
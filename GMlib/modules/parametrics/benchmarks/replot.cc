@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+
+#include "allocationcounter.h"
+
+#include <gmParametricsModule>
+using namespace GMlib;
+
+#include <memory>
+#include <vector>
+
+
+/*!
+ * \brief runFrames
+ * One frame is a replot of all the surfaces, as done by
+ * a localSimulate() calling replot(25,25,d,d) on each of them.
+ */
+static void runFrames(benchmark::State& state, bool shrink)
+{
+  const int no_surfaces = int(state.range(0));
+  const int d           = int(state.range(1));
+
+  std::vector<std::unique_ptr<PTorus<float>>> surfs;
+  for (int i = 0; i < no_surfaces; ++i)
+    surfs.emplace_back(new PTorus<float>(3.0f + 0.01f * i, 1.0f, 1.0f));
+
+  // First frame, makes the sample buffers
+  for (auto& s : surfs) s->replot(25, 25, d, d);
+
+  long frames = 0;
+  long allocs = 0;
+  while (state.KeepRunning()) {
+    const long a0 = no_allocs;
+    for (auto& s : surfs) {
+      s->replot(25, 25, d, d);
+      if (shrink) s->shrinkSampleBuffers();
+    }
+    allocs += no_allocs - a0;
+    ++frames;
+  }
+  state.counters["allocs"] = double(allocs) / double(frames);
+  state.counters["peak_kB"] = double(surfs.front()->getSampleBufferPeakSize()) / 1024.0;
+}
+
+
+/*!
+ * \brief BM_PSurf_replot_reuse
+ * The sample buffers are kept between frames
+ */
+static void BM_PSurf_replot_reuse(benchmark::State& state)
+{
+  runFrames(state, false);
+}
+BENCHMARK(BM_PSurf_replot_reuse)
+  ->Unit(benchmark::kMillisecond)
+  ->Args({100, 1})
+  ->Args({100, 3});
+
+
+/*!
+ * \brief BM_PSurf_replot_shrink
+ * The sample buffers are freed after each replot, as when they were local to replot()
+ */
+static void BM_PSurf_replot_shrink(benchmark::State& state)
+{
+  runFrames(state, true);
+}
+BENCHMARK(BM_PSurf_replot_shrink)
+  ->Unit(benchmark::kMillisecond)
+  ->Args({100, 1})
+  ->Args({100, 3});
+
+
+BENCHMARK_MAIN();
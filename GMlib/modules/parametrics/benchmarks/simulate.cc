@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+
+#include <gmParametricsModule>
+#include <gmSceneModule>
+#include <core/utils/gmtaskgraph.h>
+using namespace GMlib;
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+
+/*!
+ * \brief A circle pulsating in localSimulate(), resampled on the simulating
+ * thread and replotted later, as marked by setEditDone()
+ */
+class PulsingCircle : public PCircle<float> {
+public:
+  PulsingCircle(float r) : PCircle<float>(r), _t(0.0) { this->setThreadSafe(true); }
+
+protected:
+  void localSimulate(double dt) override {
+    _t += dt;
+    this->_r = 2.0f + 0.5f * float(std::sin(_t));
+    this->resample();
+    this->setEditDone();
+  }
+
+private:
+  double _t;
+};
+
+
+/*!
+ * \brief BM_Scene_simulate_curves
+ * One frame is Scene::simulate() and Scene::prepare() of the animated curves,
+ * serially or on the shared TaskPool.
+ */
+static void BM_Scene_simulate_curves(benchmark::State& state)
+{
+  const int  no_curves  = int(state.range(0));
+  const int  no_samples = int(state.range(1));
+  const bool parallel   = state.range(2) != 0;
+
+  Scene scene;
+  std::vector<std::unique_ptr<PulsingCircle>> curves;
+  for (int i = 0; i < no_curves; ++i) {
+    curves.emplace_back(new PulsingCircle(2.0f));
+    curves.back()->sample(no_samples, 1);
+    curves.back()->translate(Vector<float,3>(float(i % 20) * 5.0f, float(i / 20) * 5.0f, 0.0f));
+    scene.insert(curves.back().get());
+  }
+  if (parallel) scene.enableParallelSimulate();
+  scene.enabledFixedDt();
+  scene.setFixedDt(0.01);
+  scene.start();
+
+  for (auto _ : state) {
+    scene.simulate();
+    scene.prepare();
+  }
+  state.counters["threads"] = parallel ? double(TaskPool::getShared().getNoWorkers() + 1) : 1.0;
+
+  for (auto& c : curves) scene.remove(c.get());
+}
+BENCHMARK(BM_Scene_simulate_curves)
+  ->Unit(benchmark::kMillisecond)
+  ->Args({200, 500, 0})
+  ->Args({200, 500, 1})
+  ->Args({200, 5000, 0})
+  ->Args({200, 5000, 1});
+
+
+BENCHMARK_MAIN();
@@ -268,6 +268,25 @@ namespace GMlib {
   //**************************************************
 
 
+  /*! bool PBezierCurve<T>::getBezierSegments( std::vector<DVector<Vector<T,3>>>& c, std::vector<T>& t ) const
+   *  The curve is one Bezier segment, the control polygon in global coordinates.
+   *
+   *  \param[out] c  The control points
+   *  \param[out] t  The start and end parameter values
+   *  \return        true
+   */
+  template <typename T>
+  bool PBezierCurve<T>::getBezierSegments( std::vector<DVector<Vector<T,3>>>& c, std::vector<T>& t ) const {
+
+    c.assign( 1, _c );
+    this->_toGlobal( c[0], true );
+    t.assign( { this->getParStart(), this->getParEnd() } );
+    return true;
+  }
+
+
+
+
   /*! void PBezierCurve<T>::sample( int m, int d )
    *  To sample and plot the curve.
    *
@@ -393,10 +412,9 @@ void PBezierCurve<T>::toggleSelectors() {
   void PBezierCurve<T>::eval( T t, int d, bool /*l*/ ) const {
 
     // Compute the Bernstein-Hermite Polynomials
-    DMatrix< T > bhp;
-    EvaluatorStatic<T>::evaluateBhp( bhp, getDegree(), this->_map(t), 1/this->_sc );
+    EvaluatorStatic<T>::evaluateBhp( _bhp, getDegree(), this->_map(t), 1/this->_sc );
 
-    multEval(this->_p, bhp, d);
+    multEval(this->_p, _bhp, d);
   }
 
 
@@ -80,6 +80,7 @@ namespace GMlib {
     void            toggleSelectors() override;
 
     // virtual from PCurve
+    bool            getBezierSegments( std::vector<DVector<Vector<T,3>>>& c, std::vector<T>& t ) const override;
     void            sample( int m, int d ) override;
     void            showSelectors( T rad = T(1), bool grid = true,
                                    const Color& selector_color = GMcolor::darkBlue(),
@@ -106,6 +107,7 @@ namespace GMlib {
 
     // Pre-evaluation of bernstein polynomials at the sample values (basis functions)
     mutable std::vector<DMatrix<T>> _pre;        //!< Pre-evaluated basis functions
+    mutable DMatrix<T>              _bhp;        //!< Basis matrix for eval(), kept to reuse its memory
 
     mutable bool                    _c_moved;    //!< Mark that we are editing, moving controll points
     mutable std::vector<EditSet>    _pos_change; //!< The step vector of control points that has been moved
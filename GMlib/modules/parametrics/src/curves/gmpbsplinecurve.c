@@ -421,6 +421,50 @@ template <typename T>
 
 
 
+  /*! bool PBSplineCurve<T>::getBezierSegments( std::vector<DVector<Vector<T,3>>>& c, std::vector<T>& t ) const
+   *  The Bezier segments of the non-empty knot intervals, in global coordinates.
+   *  The Bezier point j of the interval [a,b] is the blossom of the curve
+   *  at (a,...,a,b,...,b) with j b's, computed by de Boor's algorithm.
+   *
+   *  \param[out] c  The control points of the segments
+   *  \param[out] t  The knots between the segments
+   *  \return        true
+   */
+  template <typename T>
+  bool PBSplineCurve<T>::getBezierSegments( std::vector<DVector<Vector<T,3>>>& c, std::vector<T>& t ) const {
+
+    c.clear();
+    t.assign( 1, this->_unmap( _t(_d) ) );
+
+    DVector<Vector<T,3>> p(_k);
+    for( int i = _d; i < _t.getDim() - _k; i++ ) {
+      if( _t(i+1) <= _t(i) ) continue;
+
+      const IndexBsp ind( i, _k, _c.getDim() );
+      DVector<Vector<T,3>> b(_k);
+      for( int j = 0; j <= _d; j++ ) {
+
+        for( int l = 0; l <= _d; l++ ) p[l] = _c(ind[l]);
+        for( int r = 1; r <= _d; r++ ) {
+          const T u = r <= _d - j ? _t(i) : _t(i+1);
+          for( int l = _d; l >= r; l-- ) {
+            const int   kk = i - _d + l;
+            const T     w  = ( u - _t(kk) ) / ( _t(kk + _d + 1 - r) - _t(kk) );
+            p[l] = (1 - w) * p(l-1) + w * p(l);
+          }
+        }
+        b[j] = p(_d);
+      }
+
+      this->_toGlobal( b, true );
+      c.push_back( b );
+      t.push_back( this->_unmap( _t(i+1) ) );
+    }
+    return true;
+  }
+
+
+
   /*! bool PBSplineCurve<T>::isClosed() const
    *  To see if the curve is closed or not.
    */
@@ -549,10 +593,9 @@ template <typename T>
   void PBSplineCurve<T>::eval( T t, int d, bool l ) const {
 
       // Make the B-spline Hermite matrix
-      DMatrix<T> bsp;
-      int idx = EvaluatorStatic<T>::evaluateBSp( bsp, t, _t, _d);
-      IndexBsp ind(idx, _k, _c.getDim());
-      multEval(this->_p, bsp, ind, d);
+      int idx = EvaluatorStatic<T>::evaluateBSp( _bsp, t, _t, _d);
+      _ind.init(idx, _k, _c.getDim());
+      multEval(this->_p, _bsp, _ind, d);
   }
 
 
@@ -89,6 +89,7 @@ class SelectorGridVisualizer;
     void            toggleClose() override;
 
     // from PCurve
+    bool            getBezierSegments( std::vector<DVector<Vector<T,3>>>& c, std::vector<T>& t ) const override;
     bool            isClosed() const override;
     void            sample( int m, int d ) override;
     void            showSelectors( T radius = T(1), bool grid = true,
@@ -126,6 +127,8 @@ class SelectorGridVisualizer;
     // Partitioning of the curve based on continuity criteria
     mutable int                      _pct;        //!< Partition criteria (continuity C^_pct)
     mutable std::vector<PreBasis<T>> _pre_basis;  //!< Pre-evaluated basis functions for each partition
+    mutable DMatrix<T>               _bsp;        //!< B-spline Hermite matrix for eval(), kept to reuse its memory
+    mutable IndexBsp                 _ind;        //!< Control point indices for eval(), kept to reuse its memory
 
     mutable bool                 _c_moved;    //!< Mark that we are editing, moving controll points
     mutable std::vector<EditSet> _pos_change; //!< The step vector of control points that is moved
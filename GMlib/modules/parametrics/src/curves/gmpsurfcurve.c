@@ -94,50 +94,6 @@ namespace GMlib {
   }
 
 
-  template <typename T>
-  void PSurfCurve<T>::resample( DVector< DVector< Vector<T, 3> > >& p, int m, int d, T start, T end )
-  {
-      if (_der_curve && _plot)
-      {
-        T du = (end-start)/(m-1);
-        p.setDim(m);
-
-        for( int i = 0; i < m - 1; i++ )
-        {
-          p[i].setDim(d+1);
-          eval1(start + i * du, 1);
-          p[i][0] = this->_p[0];
-          eval2(start + i * du, d-1);
-          for(int j=1; j<d;j++)
-             p[i][j] = this->_p[j-1];
-        }
-        p[m-1].setDim(d+1);
-        eval1(end, 1);
-        p[m-1][0] = this->_p[0];
-        eval2(end, d-1);
-        for(int j=1; j<d;j++)
-           p[m-1][j] = this->_p[j-1];
-
-        switch( this->_dm )
-        {
-          case GM_DERIVATION_EXPLICIT:
-            // Do nothing, evaluator algorithms for explicite calculation of derivatives
-            // should be defined in the eval( ... ) function enclosed by
-            // if( this->_derivation_method == this->EXPLICIT ) { ... eval algorithms for derivatives ... }
-            break;
-
-          case GM_DERIVATION_DD:
-          default:
-          //  _evalDerDD( p, d, du );
-            break;
-        };
-      }
-      else
-        PCurve<T,3>::resample(  p, m, d, start, end );
-  }
-
-
-
 
   //***************************************************
   // Overrided (public) virtual functons from PCurve **
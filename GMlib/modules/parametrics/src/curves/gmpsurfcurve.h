@@ -48,8 +48,6 @@ namespace GMlib {
 
 
     void                togglePlot();
-     void               resample( DVector< DVector< Vector<T, 3> > >& p,
-                                      int m, int d, T start, T end ) override;
 
 
     //****************************************
@@ -29,7 +29,9 @@
 #include <core/utils/gmdivideddifferences.h>
 
 // stl
+#include <cassert>
 #include <cmath>
+#include <algorithm>
 
 namespace GMlib {
 
@@ -52,6 +54,8 @@ namespace GMlib {
     _tr                  = T(0);
     _sc                  = T(1);
     _is_scaled           = false;
+    _lod_no_levels       = 0;
+    _lod_switch          = false;
     setNoDer(2);
 
     this->_lighted       = false;
@@ -80,6 +84,9 @@ namespace GMlib {
     _sc                  = copy._sc;
     _is_scaled           = copy._is_scaled;
     _sampler             = &_visu;
+    _lod_no_levels       = copy._lod_no_levels;
+    _lod_switch          = false;
+    _lod                 = copy._lod;
     setNoDer(2);
   }
 
@@ -248,6 +255,71 @@ namespace GMlib {
 
 
 
+  /*! SmallVector<Vector<T,n>,4> PCurve<T,n>::evaluateSmall( T t, int d ) const
+   *  Evaluator for the curve, returning by value.
+   *  Computing values in local coordinate system.
+   *  The result is stored inline, no heap memory is used, and
+   *  no static or shared result buffer is involved.
+   *  At most 3 derivatives are computed, see getDim() of the result.
+   *
+   *  \param[in] t   The parameter value to compute at
+   *  \param[in] d   The number of derivatives to compute (max 3)
+   *  \return        Position and d-derivatives in local coordinates
+   */
+  template <typename T, int n>
+  SmallVector<Vector<T,n>,4> PCurve<T,n>::evaluateSmall( T t, int d ) const {
+
+    SmallVector<Vector<T,n>,4> p(d+1);
+    _eval( t, p.getDim()-1 );
+
+    for( int i = 0; i < p.getDim(); i++ )
+      p[i] = _p[i];
+
+    return p;
+  }
+
+
+
+
+
+  /*! SmallVector<Vector<T,n>,4> PCurve<T,n>::evaluateGlobalSmall( T t, int d ) const
+   *  Evaluator for the curve, returning by value.
+   *  Computing values in global (scene) coordinate system
+   *
+   *  \param[in] t   The parameter value to compute at
+   *  \param[in] d   The number of derivatives to compute (max 3)
+   *  \return        Position and d-derivatives in global coordinates
+   */
+  template <typename T, int n>
+  SmallVector<Vector<T,n>,4> PCurve<T,n>::evaluateGlobalSmall( T t, int d ) const {
+
+    return _evalSmall( t, d, this->_present.template toType<T>() );
+  }
+
+
+
+
+
+  /*! SmallVector<Vector<T,n>,4> PCurve<T,n>::evaluateParentSmall( T t, int d ) const
+   *  Evaluator for the curve, returning by value.
+   *  Computing values in parent coordinate system.
+   *  Unlike evaluateParent() this one do not share a static result vector,
+   *  and it do not scale the cached local evaluation.
+   *
+   *  \param[in] t   The parameter value to compute at
+   *  \param[in] d   The number of derivatives to compute (max 3)
+   *  \return        Position and d-derivatives in the coordinate system of the parent
+   */
+  template <typename T, int n>
+  SmallVector<Vector<T,n>,4> PCurve<T,n>::evaluateParentSmall( T t, int d ) const {
+
+    return _evalSmall( t, d, this->_matrix.template toType<T>() );
+  }
+
+
+
+
+
   /*! void PCurve<T,n>::estimateClpPar( const Point<T,n>& p, T& t, int m) const
    *  To estimate parameter value for closest point
    *  To be used before getClosestPoint if we do not have a good guess
@@ -632,6 +704,55 @@ namespace GMlib {
   }
 
 
+
+
+
+  /*! bool PCurve<T,n>::getBezierSegments( std::vector<DVector<Vector<T,n>>>& c, std::vector<T>& t ) const
+   *  The curve as a sequence of Bezier segments, for curves having a control polygon.
+   *  Segment i is defined on [t[i],t[i+1]] and is inside the convex hull of c[i].
+   *  The default is that the curve has no such representation.
+   *
+   *  \param[out] c  The control points of the segments, in global coordinates
+   *  \param[out] t  The parameter values at the joins of the segments (one more than c)
+   *  \return        true if the curve is given by Bezier segments
+   */
+  template <typename T, int n>
+  bool PCurve<T,n>::getBezierSegments( std::vector<DVector<Vector<T,n>>>& /*c*/, std::vector<T>& /*t*/ ) const {
+
+    return false;
+  }
+
+
+
+
+
+  /*! bool PCurve<T,n>::getGlobalSamples( std::vector<T>& t, std::vector<DVector<Vector<T,n>>>& p ) const
+   *  The samples made for plotting, in increasing parameter order and in global coordinates.
+   *  The partitions are joined, a sample at a join is only given once.
+   *
+   *  \param[out] t  The parameter values of the samples
+   *  \param[out] p  Positions and the sampled derivatives
+   *  \return        false if the curve is not sampled
+   */
+  template <typename T, int n>
+  bool PCurve<T,n>::getGlobalSamples( std::vector<T>& t, std::vector<DVector<Vector<T,n>>>& p ) const {
+
+    t.clear();
+    p.clear();
+    for( unsigned int i = 0; i < _visu.size(); i++ ) {
+      const Partition& v = _visu[i];
+      if( v.sample_val.size() != v.size() ) return false;
+      for( unsigned int j = 0; j < v.size(); j++ ) {
+        if( !t.empty() && v[j] <= t.back() ) continue;
+        t.push_back( v[j] );
+        p.push_back( v.sample_val[j] );
+        _toGlobal( p.back() );
+      }
+    }
+    return t.size() > 1;
+  }
+
+
   //*******************************************************
   //***  Virtual functons for pre-samling  and plotting  **
   //*******************************************************
@@ -662,11 +783,17 @@ namespace GMlib {
   template <typename T, int n>
   void PCurve<T,n>::sample( int m, int d ) {
 
+    assert( this->isOnRenderingThread() );
+
+    // Going back to a level of detail already sampled
+    if( _lod_switch && _lodSampleCached( m ) ) return;
+
     _checkSampleVal( m, d );
 
     if(_visu.size()>1) std::cerr << "Error, more than 1 partition in simple curve!!";
 
     preSample( _visu[0], _visu.no_sample, _visu.no_derivatives, getParStart(), getParEnd() );
+    _lodStore();
   }
 
 
@@ -1135,6 +1262,36 @@ namespace GMlib {
 
 
 
+    /*! SmallVector<Vector<T,n>,4> PCurve<T,n>::_evalSmall( T t, int d, const HqMatrix<T,3>& mat ) const
+     *  Evaluate and transform position and d derivatives by mat.
+     *  The scaling is done on the result, not on the cached evaluation.
+     *  \param[in]  t     The parameter value for the evaluation
+     *  \param[in]  d     The number of derivatives to compute (max 3)
+     *  \param[in]  mat   The transformation to apply
+     */
+    template <typename T, int n>
+    inline
+    SmallVector<Vector<T,n>,4> PCurve<T,n>::_evalSmall( T t, int d, const HqMatrix<T,3>& mat ) const {
+
+      SmallVector<Vector<T,n>,4> p(d+1);
+      _eval( t, p.getDim()-1 );
+
+      for( int i = 0; i < p.getDim(); i++ )
+        p[i] = _p[i];
+
+      if(this->_scale.isActive())
+        for( int i = 0; i < p.getDim(); i++ )
+          p[i] %= this->_scale.getScale();
+
+      p[0] = mat * p[0].toPoint();
+      for( int i = 1; i < p.getDim(); i++ )
+        p[i] = mat * p[i];
+
+      return p;
+    }
+
+
+
     /*! T PCurve<T,n>::_integral(T a, T b, double eps) const
      *  Curve integration, using Romberg integration method.
      *  \param[in]  a    start parameter value
@@ -1185,6 +1342,39 @@ namespace GMlib {
 
 
 
+    /*! T PCurve<T,n>::_unmap( T t ) const
+     *  Mapping paramerer values from function value to defined value, the inverse of _map()
+     *  \param[in]    t   parameter value in function domain
+     *  \return           parameter value in defined coordinates
+     */
+    template <typename T, int n>
+    inline
+    T PCurve<T,n>::_unmap( T t ) const {
+
+       return getStartP() + _tr + ( t - getStartP())*_sc;
+    }
+
+
+
+    /*! void PCurve<T,n>::_toGlobal( DVector<Vector<T,n>>& c, bool points ) const
+     *  From local to global coordinates
+     *  \param[in-out]    c        Position and derivatives, or control points
+     *  \param[in]        points   All are points (control points), else only the first is a point
+     */
+    template <typename T, int n>
+    inline
+    void PCurve<T,n>::_toGlobal( DVector<Vector<T,n>>& c, bool points ) const {
+
+      const HqMatrix<T,3> mat = this->_present.template toType<T>();
+      for( int i = 0; i < c.getDim(); i++ ) {
+        if(this->_scale.isActive())
+          c[i] %= this->_scale.getScale();
+        c[i] = ( i == 0 || points ) ? Vector<T,n>( mat * c[i].toPoint() ) : Vector<T,n>( mat * c[i] );
+      }
+    }
+
+
+
     /*! void PCurve<T,n>::_corrEval( T s, int d ) const
      *  Mapping paramerer values from defined value to function value
      *  \param[in]    s   scaling value to scale derivatives
@@ -1215,7 +1405,190 @@ namespace GMlib {
         // Correct derivatives
         if( d < 0 )             d = _visu.no_derivatives;
         else _visu.no_derivatives = d;
+        // A new sampling (not from setLodLevel()) makes new levels of detail
+        _lodReset( m );
     }
 
 
+
+  /*! void PCurve<T,n>::enableLod( int levels )
+   *  Turn on level of detail, for use with a LodController.
+   *  Level 0 is the present sampling, each following level has about half
+   *  the number of samples, down to 3 samples. There are 2 to 4 levels.
+   *  For curves sampled by PCurve::sample() the samples of each level are kept,
+   *  curves with their own sample() are sampled again at each change of level.
+   *  A new sample(m,d) makes the levels from its sampling.
+   *
+   *  \param[in] levels  The number of levels of detail
+   */
+  template <typename T, int n>
+  void PCurve<T,n>::enableLod( int levels ) {
+
+    _lod_no_levels = std::min( std::max( levels, 2 ), 4 );
+    _lodReset( _visu.no_sample );
+  }
+
+
+
+  /*! void PCurve<T,n>::disableLod()
+   *  Turn off level of detail, and go back to the finest level.
+   */
+  template <typename T, int n>
+  void PCurve<T,n>::disableLod() {
+
+    if( _lod.empty() ) return;
+
+    const int  m      = _lod[0].m;
+    const bool coarse = this->_lod_level != 0;
+
+    _lod_no_levels = 0;
+    _lod.clear();
+    this->_lod_level = 0;
+
+    if( coarse ) {
+      sample( m, _visu.no_derivatives );
+      replot();
+      this->setEditDone( false );
+    }
+  }
+
+
+
+  template <typename T, int n>
+  inline
+  bool PCurve<T,n>::isLodEnabled() const {
+
+    return _lod_no_levels > 0;
+  }
+
+
+
+  template <typename T, int n>
+  inline
+  int PCurve<T,n>::getLodLevels() const {
+
+    return int(_lod.size());
+  }
+
+
+
+  /*! int PCurve<T,n>::getLodSamples( int level ) const
+   *  The number of samples at a level of detail.
+   *
+   *  \param[in] level  The level of detail, 0 is the finest
+   *  \return The number of samples, 0 if there is no such level
+   */
+  template <typename T, int n>
+  int PCurve<T,n>::getLodSamples( int level ) const {
+
+    if( level < 0 || level >= int(_lod.size()) ) return 0;
+
+    return _lod[level].m;
+  }
+
+
+
+  /*! void PCurve<T,n>::setLodLevel( int level )
+   *  Sample the curve at a level of detail, using the samples kept
+   *  for that level if there are any, and hand them to the visualizers.
+   *
+   *  \param[in] level  The level of detail, 0 is the finest
+   */
+  template <typename T, int n>
+  void PCurve<T,n>::setLodLevel( int level ) {
+
+    if( _lod.empty() ) return;
+
+    level = std::min( std::max( level, 0 ), int(_lod.size()) - 1 );
+    if( level == this->_lod_level ) return;
+
+    this->_lod_level = level;
+
+    _lod_switch = true;
+    sample( _lod[level].m, _visu.no_derivatives );
+    _lod_switch = false;
+
+    // The visualizers get the new samples now, not by the next edit replot
+    replot();
+    this->setEditDone( false );
+  }
+
+
+
+  /*! void PCurve<T,n>::_lodReset( int m ) const
+   *  Make the levels of detail from a sampling of m samples, dropping
+   *  the samples kept. Does nothing if the sampling comes from setLodLevel().
+   */
+  template <typename T, int n>
+  void PCurve<T,n>::_lodReset( int m ) const {
+
+    if( _lod_switch || _lod_no_levels < 1 ) return;
+
+    _lod.resize( 1 );
+    _lod[0].m = m;
+
+    for( int k = 1; k < _lod_no_levels; k++ ) {
+
+      const int mk = ( ( _lod[k-1].m - 1 ) >> 1 ) + 1;
+      if( mk < 3 ) break;
+
+      _lod.resize( k+1 );
+      _lod[k].m = mk;
+    }
+
+    for( unsigned int i = 0; i < _lod.size(); i++ )
+      _lod[i].cached = false;
+    this->_lod_level = 0;
+  }
+
+
+
+  /*! void PCurve<T,n>::_lodStore() const
+   *  Keep the samples just made by PCurve::sample() for the level of detail having this sampling.
+   */
+  template <typename T, int n>
+  void PCurve<T,n>::_lodStore() const {
+
+    if( _visu.size() != 1 ) return;
+
+    int k = this->_lod_level;
+    if( k < 0 || k >= int(_lod.size()) || _lod[k].m != _visu.no_sample ) {
+      for( k = 0; k < int(_lod.size()); k++ )
+        if( _lod[k].m == _visu.no_sample ) break;
+      if( k == int(_lod.size()) ) return;
+    }
+
+    LodLevel& l   = _lod[k];
+    l.t           = _visu[0];
+    l.sample_val  = _visu[0].sample_val;
+    l.sur_sphere  = _visu[0].sur_sphere;
+    l.cached      = true;
+    this->_lod_level = k;
+  }
+
+
+
+  /*! bool PCurve<T,n>::_lodSampleCached( int m ) const
+   *  Restore the samples kept for the level of detail with m samples.
+   *  \return false if no samples are kept for this sampling
+   */
+  template <typename T, int n>
+  bool PCurve<T,n>::_lodSampleCached( int m ) const {
+
+    if( _visu.size() != 1 ) return false;
+
+    int k = 0;
+    while( k < int(_lod.size()) && !( _lod[k].cached && _lod[k].m == m ) ) k++;
+    if( k == int(_lod.size()) ) return false;
+
+    const LodLevel& l = _lod[k];
+    _visu[0]            = l.t;
+    _visu[0].sample_val = l.sample_val;
+    _visu[0].sur_sphere = l.sur_sphere;
+    _visu.no_sample     = m;
+
+    return true;
+  }
+
+
   } // END namespace GMlib
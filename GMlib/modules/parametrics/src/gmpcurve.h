@@ -33,6 +33,7 @@
 // gmlib
 #include <core/containers/gmarray.h>
 #include <core/containers/gmdvector.h>
+#include <core/containers/gmsmallvector.h>
 
 
 
@@ -90,6 +91,10 @@ namespace GMlib {
     DVector<Vector<T,n> >&       evaluate( int i, int j=0 ) const;
     DVector<Vector<T,n> >&       evaluateParent( int i, int j=0 ) const;
 
+    SmallVector<Vector<T,n>,4>   evaluateSmall( T t, int d ) const;
+    SmallVector<Vector<T,n>,4>   evaluateGlobalSmall( T t, int d ) const;
+    SmallVector<Vector<T,n>,4>   evaluateParentSmall( T t, int d ) const;
+
     //****  Closest point functons  ****
     virtual void                 estimateClpPar( const Point<T,n>& q, T& t, int m=30) const;
     bool                         getClosestPoint(const Point<T,n>& q, T& t, Point<T,n>& p,
@@ -136,11 +141,24 @@ namespace GMlib {
     void                         replot() const override;
     int                          getNumber() const override {return _number;}
 
+    //****  Level of detail, see LodController  ****
+    void                         enableLod( int levels = 3 );
+    void                         disableLod();
+    bool                         isLodEnabled() const;
+    // Virtual from SceneObject
+    int                          getLodLevels() const override;
+    int                          getLodSamples( int level ) const override;
+    void                         setLodLevel( int level ) override;
+
     // To set the actual domain. All mappings (both parametric and scaling of derivatives) will then automatical be done.
     void                         setDomain( T start, T end );
     void                         setDomainScale( T sc );
     void                         setDomainTrans( T tr );
 
+    //****  Bounding data, see PCurveBvh  ****
+    virtual bool                 getBezierSegments( std::vector<DVector<Vector<T,n>>>& c, std::vector<T>& t ) const;
+    bool                         getGlobalSamples( std::vector<T>& t, std::vector<DVector<Vector<T,n>>>& p ) const;
+
     void                         setNumber(int m) {_number = m;}
     void                         setNoDer( int d );
     virtual void                 setSurroundingSphere( const std::vector< DVector< Vector<T,n> > >& p ) const;
@@ -186,6 +204,18 @@ namespace GMlib {
 
     const int                    _der_implemented;
 
+    // Level of detail, the samples of each level are kept (single partition curves)
+    struct LodLevel {
+      int                               m;          //!< Number of samples
+      bool                              cached;     //!< The samples below are up to date
+      std::vector<T>                    t;          //!< Parameter values of the samples
+      std::vector<DVector<Vector<T,3>>> sample_val; //!< Vertices and derivatives
+      Sphere<T,3>                       sur_sphere; //!< Surrounding sphere
+    };
+    int                          _lod_no_levels; //!< Number of levels asked for, 0 if no level of detail
+    bool                         _lod_switch;    //!< Sampling from setLodLevel()
+    mutable std::vector<LodLevel> _lod;          //!< The levels, 0 is the finest
+
 
     // The three following functions defines the curve.
     // The first one is the formula, the two other set the domain conected to the formula
@@ -223,11 +253,18 @@ namespace GMlib {
 
 
     T                            _map(T t) const;
+    T                            _unmap(T t) const;
+    void                         _toGlobal( DVector<Vector<T,n>>& c, bool points = false ) const;
     void                         _checkSampleVal( int& m, int& d ) const;
 
+    void                         _lodReset( int m ) const;
+    void                         _lodStore() const;
+    bool                         _lodSampleCached( int m ) const;
+
 
   private:
     void                         _eval( T t, int d, bool left = true  ) const;
+    SmallVector<Vector<T,n>,4>   _evalSmall( T t, int d, const HqMatrix<T,3>& mat ) const;
     T                            _integral(T a, T b, double eps) const;
     void                         _corrEval(T sc, int d) const;
 
@@ -31,7 +31,9 @@
 
 
 // stl
+#include <cassert>
 #include <cmath>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 
@@ -56,6 +58,14 @@ namespace GMlib {
     _tr_v                           = T(0);
     _sc_v                           = T(1);
     _resample                       = false;
+    _resample_request               = 0x0;
+    _resample_k                     = 0;
+    _staged                         = false;
+    _staged_second_der              = false;
+    _sample_peak                    = 0;
+    _lod_no_levels                  = 0;
+    _lod_switch                     = false;
+    _ray_bvh_valid                  = false;
 
     setNoDer( 2 );
 
@@ -87,7 +97,25 @@ namespace GMlib {
     _no_der_u     = copy._no_sam_u;
     _no_der_v     = copy._no_sam_v;
 
-    _resample     = false;
+    _resample         = false;
+    _resample_request = 0x0;
+    _resample_k       = 0;
+
+    _staged             = copy._staged;
+    _staged_second_der  = copy._staged_second_der;
+    _sample_peak        = 0;
+
+    _lod_no_levels      = copy._lod_no_levels;
+    _lod_switch         = false;
+
+    // The sampling of the levels of detail, not their samples
+    _lod.resize( copy._lod.size() );
+    for( unsigned int i = 0; i < _lod.size(); i++ ) {
+      _lod[i].m1 = copy._lod[i].m1;
+      _lod[i].m2 = copy._lod[i].m2;
+    }
+
+    _ray_bvh_valid      = false;
 
     _default_visualizer = 0x0;
   }
@@ -95,6 +123,7 @@ namespace GMlib {
   template <typename T, int n>
   PSurf<T,n>::~PSurf() {
 
+    _cancelReplotAsync();
     enableDefaultVisualizer( false );
     if( _default_visualizer )
       delete _default_visualizer;
@@ -250,6 +279,74 @@ namespace GMlib {
 
 
 
+  /*! SmallMatrix<Vector<T,n>,4,4> PSurf<T,n>::evaluateSmall( T u, T v, int d1, int d2 ) const
+   *  Evaluator for the surface, returning by value.
+   *  Computing values in local coordinate system.
+   *  The result is stored inline, no heap memory is used.
+   *  At most 3 derivatives in each direction are computed, see
+   *  getDim1() and getDim2() of the result.
+   *
+   *  \param[in] u   The u-parameter value to compute at
+   *  \param[in] v   The v-parameter value to compute at
+   *  \param[in] d1  The number of derivatives in u-direction (max 3)
+   *  \param[in] d2  The number of derivatives in v-direction (max 3)
+   *  \return        Position and partial derivatives in local coordinates
+   */
+  template <typename T, int n>
+  inline
+  SmallMatrix<Vector<T,n>,4,4> PSurf<T,n>::evaluateSmall( T u, T v, int d1, int d2 ) const {
+
+    SmallMatrix<Vector<T,n>,4,4> p(d1+1, d2+1);
+    _eval( u, v, p.getDim1()-1, p.getDim2()-1 );
+
+    for( int i = 0; i < p.getDim1(); i++ )
+      for( int j = 0; j < p.getDim2(); j++ )
+        p[i][j] = _p[i][j];
+
+    return p;
+  }
+
+
+
+  /*! SmallMatrix<Vector<T,n>,4,4> PSurf<T,n>::evaluateParentSmall( T u, T v, int d1, int d2 ) const
+   *  Evaluator for the surface, returning by value.
+   *  Computing values in parent coordinate system.
+   *  Unlike evaluateParent() this one do not share a result matrix.
+   *
+   *  \param[in] u   The u-parameter value to compute at
+   *  \param[in] v   The v-parameter value to compute at
+   *  \param[in] d1  The number of derivatives in u-direction (max 3)
+   *  \param[in] d2  The number of derivatives in v-direction (max 3)
+   *  \return        Position and partial derivatives in the coordinate system of the parent
+   */
+  template <typename T, int n>
+  inline
+  SmallMatrix<Vector<T,n>,4,4> PSurf<T,n>::evaluateParentSmall( T u, T v, int d1, int d2 ) const {
+
+    return _evalSmall( u, v, d1, d2, this->_matrix.template toType<T>() );
+  }
+
+
+
+  /*! SmallMatrix<Vector<T,n>,4,4> PSurf<T,n>::evaluateGlobalSmall( T u, T v, int d1, int d2 ) const
+   *  Evaluator for the surface, returning by value.
+   *  Computing values in global (scene) coordinate system.
+   *
+   *  \param[in] u   The u-parameter value to compute at
+   *  \param[in] v   The v-parameter value to compute at
+   *  \param[in] d1  The number of derivatives in u-direction (max 3)
+   *  \param[in] d2  The number of derivatives in v-direction (max 3)
+   *  \return        Position and partial derivatives in global coordinates
+   */
+  template <typename T, int n>
+  inline
+  SmallMatrix<Vector<T,n>,4,4> PSurf<T,n>::evaluateGlobalSmall( T u, T v, int d1, int d2 ) const {
+
+    return _evalSmall( u, v, d1, d2, this->_present.template toType<T>() );
+  }
+
+
+
 
   //******************************************************
   //      public closest point functions                **
@@ -378,6 +475,99 @@ namespace GMlib {
   }
 
 
+  /*! void PSurf<T,n>::computeCurvatures( const DMatrix<DMatrix<Vector<T,n>>>& p, DMatrix<T>* gauss, DMatrix<T>* mean, DMatrix<T>* kmax, DMatrix<T>* kmin )
+   *  \brief Curvature fields from a sample grid, without evaluating the surface again
+   *
+   *  Computes the Gaussian, mean and principal curvatures at every sample of a
+   *  grid made by resample()/replot() with at least 2 derivatives in both directions,
+   *  i.e. the same values as getCurvatureGauss() etc. at the sample parameters.
+   *  The fundamental forms are computed once per sample, and the rows are shared
+   *  among the worker threads (see parallelFor()). Fields given as nullptr are skipped.
+   *  The fields are set to 0 where the grid has less than 2 derivatives or the
+   *  surface is singular (du and dv parallel).
+   *
+   *  \param[in]  p      The sample grid, as given to PSurfVisualizer::replot()
+   *  \param[out] gauss  Gaussian curvature
+   *  \param[out] mean   Mean curvature
+   *  \param[out] kmax   Maximum principal curvature
+   *  \param[out] kmin   Minimum principal curvature
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::computeCurvatures( const DMatrix<DMatrix<Vector<T,n>>>& p, DMatrix<T>* gauss, DMatrix<T>* mean,
+                                      DMatrix<T>* kmax, DMatrix<T>* kmin ) {
+
+    const int m1 = p.getDim1();
+    const int m2 = p.getDim2();
+    if( gauss ) gauss->setDim( m1, m2 );
+    if( mean )  mean->setDim( m1, m2 );
+    if( kmax )  kmax->setDim( m1, m2 );
+    if( kmin )  kmin->setDim( m1, m2 );
+
+    const bool second_der = m1 > 0 && m2 > 0 && p(0)(0).getDim1() > 2 && p(0)(0).getDim2() > 2;
+
+    auto rows = [&]( int begin, int end ) {
+      for( int i = begin; i < end; i++ ) {
+        for( int j = 0; j < m2; j++ ) {
+
+          T K = T(0), H = T(0);
+          if( second_der ) {
+            const DMatrix<Vector<T,n>>& s = p(i)(j);
+            const Vector<T,n>& du  = s(1)(0);
+            const Vector<T,n>& dv  = s(0)(1);
+
+            // The normal is not normalized, |du^dv|^2 = EG - F^2
+            const Vector<T,n>  N   = du ^ dv;
+            const T E  = du * du;
+            const T F  = du * dv;
+            const T G  = dv * dv;
+            const T W2 = E*G - F*F;
+            if( W2 > T(0) ) {
+              const T e = N * s(2)(0);
+              const T f = N * s(1)(1);
+              const T g = N * s(0)(2);
+              K = (e*g - f*f) / (W2*W2);
+              H = T(0.5) * (e*G - 2 * (f*F) + g*E) / (W2 * std::sqrt(W2));
+            }
+          }
+
+          if( gauss ) (*gauss)[i][j] = K;
+          if( mean )  (*mean)[i][j]  = H;
+          if( kmax || kmin ) {
+            const T D = std::sqrt( std::max( H*H - K, T(0) ) );
+            if( kmax ) (*kmax)[i][j] = H + D;
+            if( kmin ) (*kmin)[i][j] = H - D;
+          }
+        }
+      }
+    };
+
+    // About 4096 samples per thread pays for starting it
+    parallelFor( 0, m1, rows, 1 + 4096 / std::max( m2, 1 ) );
+  }
+
+
+  /*! void PSurf<T,n>::getCurvatures( DMatrix<T>* gauss, DMatrix<T>* mean, DMatrix<T>* kmax, DMatrix<T>* kmin ) const
+   *  \brief Curvature fields at the current sample grid
+   *
+   *  Uses the samples from the last replot if they have 2nd derivatives,
+   *  else the surface is resampled with 2 derivatives (the kept samples are not changed).
+   *  See computeCurvatures().
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::getCurvatures( DMatrix<T>* gauss, DMatrix<T>* mean, DMatrix<T>* kmax, DMatrix<T>* kmin ) const {
+
+    if( !_staged && _no_der_u > 1 && _no_der_v > 1 &&
+        _sample_p.getDim1() == _no_sam_u && _sample_p.getDim2() == _no_sam_v ) {
+      computeCurvatures( _sample_p, gauss, mean, kmax, kmin );
+      return;
+    }
+
+    DMatrix<DMatrix<Vector<T,n>>> p;
+    resample( p, _no_sam_u, _no_sam_v, 2, 2, getStartPU(), getStartPV(), getEndPU(), getEndPV() );
+    computeCurvatures( p, gauss, mean, kmax, kmin );
+  }
+
+
 
   //***********************************************************
   //   To see the number of derivatives in pre-evaluation
@@ -621,6 +811,13 @@ namespace GMlib {
   template <typename T, int n>
   void PSurf<T,n>::replot( int m1, int m2, int d1, int d2 ) {
 
+    assert( this->isOnRenderingThread() );
+    _cancelReplotAsync();
+    _ray_bvh_valid = false;
+
+    // Going back to a level of detail already sampled
+    if( _lod_switch && _lodReplotCached( m1, m2 ) ) return;
+
     if( m1 != _no_sam_u && m1 > 1) {
         _no_sam_u = m1;
         preSample(1, m1);
@@ -639,20 +836,28 @@ namespace GMlib {
     if( d2 < 1 )    d2 = _no_der_v;
     else            _no_der_v = d2;
 
+    // A new sampling (not from setLodLevel()) makes new levels of detail
+    _lodReset( m1, m2 );
+
+    if( _staged ) {
+      _lodStore( _replotStaged( m1, m2, d1, d2 ) );
+      return;
+    }
+
     // Sample Positions and related Derivatives
-    DMatrix< DMatrix< Vector<T,n> > > p;
-    resample( p, m1, m2, d1, d2, getStartPU(), getStartPV(), getEndPU(), getEndPV() );
+    resample( _sample_p, m1, m2, d1, d2, getStartPU(), getStartPV(), getEndPU(), getEndPV() );
 
     // Compute normals at the sample points
-    DMatrix< Vector<float,n> > normals;
-    resampleNormals( p, normals );
+    resampleNormals( _sample_p, _sample_normals );
 
     // Set The Surrounding Sphere
-    setSurroundingSphere( p );
+    setSurroundingSphere( _sample_p );
+    _lodStore( true );
+    _updateSampleBufferPeak();
 
     // Replot Visaulizers
     for( int i = 0; i < this->_psurf_visualizers.getSize(); i++ )
-      this->_psurf_visualizers[i]->replot( p, normals, m1, m2, d1, d2, isClosedU(), isClosedV() );
+      this->_psurf_visualizers[i]->replot( _sample_p, _sample_normals, m1, m2, d1, d2, isClosedU(), isClosedV() );
   }
 
 
@@ -660,20 +865,645 @@ namespace GMlib {
   template <typename T, int n>
   void PSurf<T,n>::replot() const {
 
+      assert( this->isOnRenderingThread() );
+      _cancelReplotAsync();
+
+      // The shape has changed, the samples kept for the other levels of detail are outdated
+      _lodInvalidate();
+      _ray_bvh_valid = false;
+
+      if( _staged ) {
+        _lodStore( _replotStaged( _no_sam_u, _no_sam_v, _no_der_u, _no_der_v ) );
+        return;
+      }
+
       // Sample Positions and related Derivatives
-      DMatrix<DMatrix<Vector<T,n>>> p;
-      resample( p, _no_sam_u, _no_sam_v, _no_der_u, _no_der_v, getStartPU(), getStartPV(), getEndPU(), getEndPV() );
+      resample( _sample_p, _no_sam_u, _no_sam_v, _no_der_u, _no_der_v, getStartPU(), getStartPV(), getEndPU(), getEndPV() );
 
       // Compute normals at the sample points
-      DMatrix< Vector<float,n> > normals;
-      resampleNormals( p, normals );
+      resampleNormals( _sample_p, _sample_normals );
 
       // Set The Surrounding Sphere
-      setSurroundingSphere( p );
+      setSurroundingSphere( _sample_p );
+      _lodStore( true );
+      _updateSampleBufferPeak();
 
       // Replot Visaulizers
       for( int i = 0; i < this->_psurf_visualizers.getSize(); i++ )
-        this->_psurf_visualizers[i]->replot( p, normals, _no_sam_u, _no_sam_v, _no_der_u, _no_der_v, isClosedU(), isClosedV() );
+        this->_psurf_visualizers[i]->replot( _sample_p, _sample_normals, _no_sam_u, _no_sam_v, _no_der_u, _no_der_v, isClosedU(), isClosedV() );
+  }
+
+
+
+  /*! void PSurf<T,n>::replotAsync( int m1, int m2, int d1, int d2 )
+   *  Replot without blocking the calling thread. The samples, normals and
+   *  surrounding sphere are made by a task on the background TaskPool into a back buffer,
+   *  and taken in by syncReplot() on the rendering thread, which also replots
+   *  the visualizers. Until then the previous replot is rendered.
+   *
+   *  A new request supersedes the one being sampled, which is dropped at the
+   *  next row. A synchronous replot() cancels it.
+   *
+   *  The task samples a copy of the surface, by makeCopy(), made at the
+   *  request, so the surface itself can be used, changed and deleted in the
+   *  meantime. The copy takes only the shape: no samples, levels of detail or
+   *  visualizers, and of the children only those it can be made of, see
+   *  SceneObject::_setCopyShapeOnly(). Surfaces that can not be copied, and
+   *  surfaces with their own replot(), plotting in segments, replot at once.
+   *
+   *  \param[in]  m1  Number of samples in u-direction, as replot()
+   *  \param[in]  m2  Number of samples in v-direction
+   *  \param[in]  d1  Number of derivatives in u-direction
+   *  \param[in]  d2  Number of derivatives in v-direction
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::replotAsync( int m1, int m2, int d1, int d2 ) {
+
+    if( m1 < 2 ) m1 = _no_sam_u;
+    if( m2 < 2 ) m2 = _no_sam_v;
+    if( d1 < 1 ) d1 = _no_der_u;
+    if( d2 < 1 ) d2 = _no_der_v;
+    if( m1 < 2 || m2 < 2 ) return;
+
+    const bool shape_only = this->_setCopyShapeOnly( true );
+    PSurf<T,n>* copy = dynamic_cast<PSurf<T,n>*>( this->makeCopy() );
+    this->_setCopyShapeOnly( shape_only );
+    if( !copy ) {
+      replot( m1, m2, d1, d2 );
+      return;
+    }
+
+    if( !_async ) {
+      _async.reset( new AsyncReplot );
+      _async->running = false;
+      _async->request = 0;
+      _async->done    = 0;
+      _async->copy    = 0x0;
+      _async->taken   = 0x0;
+      _async->ready   = false;
+    }
+
+    _deleteUsedCopies();
+
+    AsyncReplot& a = *_async;
+    {
+      std::lock_guard<std::mutex> lock( a.mutex );
+      if( a.copy ) a.used.push_back( a.copy );
+      a.copy = copy;
+      a.m1 = m1;
+      a.m2 = m2;
+      a.d1 = d1;
+      a.d2 = d2;
+      a.ready = false;
+      a.request++;
+      if( a.running ) return;
+      a.running = true;
+    }
+
+    TaskPool::getBackground().push( [&a]() { PSurf<T,n>::_replotAsyncWork( a ); } );
+  }
+
+
+
+  /*! void PSurf<T,n>::cancelReplotAsync()
+   *  Drops the asynchronous replot, and waits for the task to stop.
+   *  The previous replot is kept.
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::cancelReplotAsync() {
+
+    _cancelReplotAsync();
+  }
+
+
+
+  /*! bool PSurf<T,n>::isReplotAsyncPending() const
+   *  True while an asynchronous replot is sampled or waiting for syncReplot().
+   */
+  template <typename T, int n>
+  bool PSurf<T,n>::isReplotAsyncPending() const {
+
+    if( !_async ) return false;
+
+    std::lock_guard<std::mutex> lock( _async->mutex );
+    return _async->running || _async->ready;
+  }
+
+
+
+  /*! bool PSurf<T,n>::syncReplot()
+   *  Takes in the back buffer of a finished asynchronous replot, and replots
+   *  the visualizers. To be called on the rendering thread, see Scene::syncReplots().
+   *
+   *  \return true if there was a finished replot
+   */
+  template <typename T, int n>
+  bool PSurf<T,n>::syncReplot() {
+
+    assert( this->isOnRenderingThread() );
+    if( !_async ) return false;
+
+    AsyncReplot& a = *_async;
+    Sphere<T,n> s;
+    int m1, m2, d1, d2;
+    {
+      std::lock_guard<std::mutex> lock( a.mutex );
+      if( !a.ready ) return false;
+      a.ready = false;
+
+      // The old samples are the back buffer of the next request
+      _sample_p.swap( a.p );
+      _sample_normals.swap( a.normals );
+      s  = a.s;
+      m1 = a.r_m1;
+      m2 = a.r_m2;
+      d1 = a.r_d1;
+      d2 = a.r_d2;
+    }
+
+    _deleteUsedCopies();
+
+    // The pre-evaluation of the copy was made for the new sampling
+    if( m1 != _no_sam_u ) preSample( 1, m1 );
+    if( m2 != _no_sam_v ) preSample( 2, m2 );
+
+    _no_sam_u = m1;
+    _no_sam_v = m2;
+    _no_der_u = d1;
+    _no_der_v = d2;
+    _ray_bvh_valid = false;
+
+    Parametrics<T,2,n>::setSurroundingSphere( s );
+
+    _lodReset( m1, m2 );
+    _lodStore( true );
+    _updateSampleBufferPeak();
+
+    for( int i = 0; i < this->_psurf_visualizers.getSize(); i++ )
+      this->_psurf_visualizers[i]->replot( _sample_p, _sample_normals, m1, m2, d1, d2, isClosedU(), isClosedV() );
+
+    return true;
+  }
+
+
+
+  /*! void PSurf<T,n>::_replotAsyncWork( AsyncReplot& a )
+   *  The pool task of replotAsync(), samples the copy of the newest request until
+   *  there is no new one. A request superseded during the sampling is dropped.
+   *  The back buffer is only written while no result is ready. The surface
+   *  itself is not used.
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::_replotAsyncWork( AsyncReplot& a ) {
+
+    while( true ) {
+
+      unsigned int k;
+      int m1, m2, d1, d2;
+      PSurf<T,n>* s;
+      {
+        std::lock_guard<std::mutex> lock( a.mutex );
+        k = a.request;
+        if( a.done == k ) {
+          if( a.taken ) a.used.push_back( a.taken );
+          a.taken   = 0x0;
+          a.running = false;
+          a.idle.notify_all();
+          return;
+        }
+        if( a.copy ) {
+          if( a.taken ) a.used.push_back( a.taken );
+          a.taken = a.copy;
+          a.copy  = 0x0;
+        }
+        s  = a.taken;
+        m1 = a.m1;
+        m2 = a.m2;
+        d1 = a.d1;
+        d2 = a.d2;
+      }
+
+      Sphere<T,n> sphere;
+      bool sampled = false;
+      if( m1 > 1 && s ) {
+
+        s->_resample_request = &a.request;
+        s->_resample_k       = k;
+        s->preSample( 1, m1 );
+        s->preSample( 2, m2 );
+
+        if( a.request == k )
+          s->resample( a.p, m1, m2, d1, d2, s->getStartPU(), s->getStartPV(), s->getEndPU(), s->getEndPV() );
+
+        if( a.request == k ) {
+          s->resampleNormals( a.p, a.normals );
+          s->uppdateSurroundingSphere( sphere, a.p );
+          sampled = true;
+        }
+      }
+
+      std::lock_guard<std::mutex> lock( a.mutex );
+      a.done = k;
+      if( sampled && a.request == k ) {
+        a.s     = sphere;
+        a.r_m1  = m1;
+        a.r_m2  = m2;
+        a.r_d1  = d1;
+        a.r_d2  = d2;
+        a.ready = true;
+      }
+    }
+  }
+
+
+
+  /*! void PSurf<T,n>::_cancelReplotAsync() const
+   *  Drops the asynchronous replot, waits for the task, and deletes the copies.
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::_cancelReplotAsync() const {
+
+    if( !_async ) return;
+
+    AsyncReplot& a = *_async;
+    {
+      std::lock_guard<std::mutex> lock( a.mutex );
+      a.m1    = 0;
+      a.ready = false;
+      a.request++;
+    }
+    // The task stops at the next row, it does not touch a after it has left
+    {
+      std::unique_lock<std::mutex> lock( a.mutex );
+      while( a.running )
+        a.idle.wait_for( lock, std::chrono::milliseconds(10) );
+      a.done = a.request;
+      if( a.copy )  a.used.push_back( a.copy );
+      if( a.taken ) a.used.push_back( a.taken );
+      a.copy  = 0x0;
+      a.taken = 0x0;
+    }
+    _deleteUsedCopies();
+  }
+
+
+
+  /*! bool PSurf<T,n>::_resampleCancelled() const
+   *  True if this is the copy of a request of replotAsync() that is superseded
+   *  or cancelled. Checked by resample() once per row.
+   */
+  template <typename T, int n>
+  inline
+  bool PSurf<T,n>::_resampleCancelled() const {
+
+    return _resample_request && _resample_request->load() != _resample_k;
+  }
+
+
+
+  /*! void PSurf<T,n>::_deleteUsedCopies() const
+   *  Deletes the copies the task is done with, on the owning thread, as they
+   *  are scene objects.
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::_deleteUsedCopies() const {
+
+    if( !_async ) return;
+
+    std::vector<PSurf<T,n>*> used;
+    {
+      std::lock_guard<std::mutex> lock( _async->mutex );
+      used.swap( _async->used );
+    }
+    for( PSurf<T,n>* s : used ) delete s;
+  }
+
+
+
+  /*! std::size_t PSurf<T,n>::getSampleBufferSize() const
+   *  The size in bytes of the sample data of the present sampling:
+   *  positions and derivatives, normals and the staging buffer,
+   *  including the samples kept for each level of detail.
+   *
+   *  This is the size of the sample matrices, not the memory held. The matrices keep their
+   *  allocation when a replot has fewer samples than the last one, see
+   *  DVector::setDim(), until shrinkSampleBuffers(). The staging buffers
+   *  count with all they hold, see PSurfStaging::getMemorySize().
+   */
+  template <typename T, int n>
+  std::size_t PSurf<T,n>::getSampleBufferSize() const {
+
+    std::size_t size = _staging.getMemorySize() + _sampleSize( _sample_p, _sample_normals );
+
+    for( unsigned int i = 0; i < _lod.size(); i++ )
+      size += _lod[i].stage.getMemorySize() + _sampleSize( _lod[i].p, _lod[i].normals );
+
+    return size;
+  }
+
+
+
+  /*! std::size_t PSurf<T,n>::getSampleBufferPeakSize() const
+   *  The largest getSampleBufferSize() (in bytes) seen by a replot
+   *  since construction or the last shrinkSampleBuffers(). As that,
+   *  it is a peak of the sizes in use, not of the memory held.
+   */
+  template <typename T, int n>
+  inline
+  std::size_t PSurf<T,n>::getSampleBufferPeakSize() const {
+
+    return _sample_peak;
+  }
+
+
+
+  /*! void PSurf<T,n>::shrinkSampleBuffers()
+   *  Free the sample buffers kept between replots, and reset the peak size.
+   *  The buffers are made again by the next replot.
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::shrinkSampleBuffers() {
+
+    for( int i = 0; i < _sample_p.getDim1(); i++ )
+      _sample_p[i].resetDim(0);
+    _sample_p.resetDim(0,0);
+
+    for( int i = 0; i < _sample_normals.getDim1(); i++ )
+      _sample_normals[i].resetDim(0);
+    _sample_normals.resetDim(0,0);
+
+    _staging.release();
+
+    for( unsigned int i = 0; i < _lod.size(); i++ ) {
+      LodLevel& l = _lod[i];
+      for( int j = 0; j < l.p.getDim1(); j++ )
+        l.p[j].resetDim(0);
+      l.p.resetDim(0,0);
+      for( int j = 0; j < l.normals.getDim1(); j++ )
+        l.normals[j].resetDim(0);
+      l.normals.resetDim(0,0);
+      l.stage.release();
+      l.cached = false;
+      l.in_use = false;
+    }
+
+    _sample_peak = 0;
+  }
+
+
+
+  /*! void PSurf<T,n>::enableLod( int levels )
+   *  Turn on level of detail, for use with a LodController.
+   *  Level 0 is the present sampling, each following level has about half the
+   *  number of samples in each direction, down to 3 samples. There are 2 to 4 levels.
+   *  The samples of each level are kept, so going back to a level
+   *  that has been visited does not sample the surface again.
+   *  A new replot(m1,m2,...) makes the levels from its sampling,
+   *  and replot() after editing drops the samples kept.
+   *
+   *  \param[in] levels  The number of levels of detail
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::enableLod( int levels ) {
+
+    _lod_no_levels = std::min( std::max( levels, 2 ), 4 );
+    _lodReset( _no_sam_u, _no_sam_v );
+  }
+
+
+
+  /*! void PSurf<T,n>::disableLod()
+   *  Turn off level of detail, and go back to the finest level.
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::disableLod() {
+
+    if( _lod.empty() ) return;
+
+    const int m1 = _lod[0].m1;
+    const int m2 = _lod[0].m2;
+    const bool coarse = this->_lod_level != 0;
+
+    _lod_no_levels = 0;
+    _lod.clear();
+    this->_lod_level = 0;
+
+    if( coarse ) replot( m1, m2, _no_der_u, _no_der_v );
+  }
+
+
+
+  template <typename T, int n>
+  inline
+  bool PSurf<T,n>::isLodEnabled() const {
+
+    return _lod_no_levels > 0;
+  }
+
+
+
+  template <typename T, int n>
+  inline
+  int PSurf<T,n>::getLodLevels() const {
+
+    return int(_lod.size());
+  }
+
+
+
+  /*! int PSurf<T,n>::getLodSamples( int level ) const
+   *  The number of samples in the densest direction at a level of detail.
+   *
+   *  \param[in] level  The level of detail, 0 is the finest
+   *  \return The number of samples, 0 if there is no such level
+   */
+  template <typename T, int n>
+  int PSurf<T,n>::getLodSamples( int level ) const {
+
+    if( level < 0 || level >= int(_lod.size()) ) return 0;
+
+    return std::max( _lod[level].m1, _lod[level].m2 );
+  }
+
+
+
+  /*! void PSurf<T,n>::setLodLevel( int level )
+   *  Replot the surface at a level of detail, using the samples kept
+   *  for that level if there are any.
+   *
+   *  \param[in] level  The level of detail, 0 is the finest
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::setLodLevel( int level ) {
+
+    if( _lod.empty() ) return;
+
+    level = std::min( std::max( level, 0 ), int(_lod.size()) - 1 );
+    if( level == this->_lod_level ) return;
+
+    this->_lod_level = level;
+
+    _lod_switch = true;
+    replot( _lod[level].m1, _lod[level].m2, _no_der_u, _no_der_v );
+    _lod_switch = false;
+  }
+
+
+
+  /*! bool PSurf<T,n>::intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit ) const
+   *  The nearest hit of the ray o + t*d, t >= 0, with position and unit normal
+   *  (in global coordinates) and the (u,v) parameter values of the hit.
+   *  See intersectRay( o, d, t, u, v ) and Scene::intersectRay().
+   *
+   *  \param[in]  o    The ray origin, in global coordinates
+   *  \param[in]  d    The ray direction
+   *  \param[out] hit  The hit, hit.obj is not set
+   *  \return true if the surface is hit
+   */
+  template <typename T, int n>
+  bool PSurf<T,n>::intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit ) const {
+
+    T t = T(0), u = T(0), v = T(0);
+    if( !intersectRay( o.template toType<T>(), Vector<T,3>( d.template toType<T>() ), t, u, v ) )
+      return false;
+
+    const SmallMatrix<Vector<T,n>,4,4> s = evaluateSmall( u, v, 1, 1 );
+    Point<T,3>  p  = s(0)(0);
+    Vector<T,3> du = s(1)(0);
+    Vector<T,3> dv = s(0)(1);
+    if( this->_scale.isActive() ) {
+      const Point<float,3> sc = this->_scale.getScale();
+      for( int k = 0; k < 3; k++ ) {
+        p[k]  *= T(sc(k));
+        du[k] *= T(sc(k));
+        dv[k] *= T(sc(k));
+      }
+    }
+
+    const HqMatrix<T,3> mat = this->_present.template toType<T>();
+    Vector<T,3> nor = (mat * du) ^ (mat * dv);
+    nor.normalize();
+
+    hit.t      = float(t);
+    hit.uv     = Point<float,2>( float(u), float(v) );
+    hit.pos    = (mat * p).template toType<float>();
+    hit.normal = nor.template toType<float>();
+    return true;
+  }
+
+
+
+  /*! bool PSurf<T,n>::intersectRay( const Point<T,3>& o, const Vector<T,3>& d, T& t, T& u, T& v ) const
+   *  The nearest hit of the ray o + t*d, t >= 0.
+   *
+   *  The ray is taken to local coordinates and traced through a hierarchy over the
+   *  triangles of the samples from the last replot (see PSurfTriangleBvh, made again
+   *  after each replot). A surface not plotted yet is evaluated at
+   *  getSamplesU() x getSamplesV() points. The triangles hit give start values for
+   *  Newton iteration in (u,v,t) on the surface itself, and the nearest solution is
+   *  returned. A ray grazing the surface between the samples may thus be missed.
+   *
+   *  \param[in]  o  The ray origin, in global coordinates
+   *  \param[in]  d  The ray direction
+   *  \param[out] t  Ray parameter of the hit
+   *  \param[out] u  Parameter value of the hit in u-direction
+   *  \param[out] v  Parameter value of the hit in v-direction
+   *  \return true if the surface is hit
+   */
+  template <typename T, int n>
+  bool PSurf<T,n>::intersectRay( const Point<T,3>& o, const Vector<T,3>& d, T& t, T& u, T& v ) const {
+
+    _updateRayBvh();
+    if( _ray_bvh.isEmpty() ) return false;
+
+    // The ray in local coordinates, with the same ray parameter
+    HqMatrix<T,3> invmat = this->_present.template toType<T>();
+    invmat.invertOrthoNormal();
+    Point<T,3>  lo = invmat * o;
+    Vector<T,3> ld = invmat * d;
+    if( this->_scale.isActive() ) {
+      const Point<float,3> sc = this->_scale.getScale();
+      for( int k = 0; k < 3; k++ ) {
+        lo[k] /= T(sc(k));
+        ld[k] /= T(sc(k));
+      }
+    }
+
+    std::vector<typename PSurfTriangleBvh<T>::Hit> seeds;
+    if( _ray_bvh.intersectAll( lo, ld, seeds ) == 0 ) return false;
+
+    // Seeds more than a cell behind the nearest hit can not give a nearer one
+    const T slack = _ray_bvh.getCellSize() / std::sqrt( ld * ld );
+
+    bool found = false;
+    for( unsigned int k = 0; k < seeds.size(); k++ ) {
+
+      if( found && seeds[k].t > t + slack ) break;
+
+      T tk = seeds[k].t;
+      T uk = seeds[k].uv(0);
+      T vk = seeds[k].uv(1);
+      if( _refineRayHit( lo, ld, tk, uk, vk ) && ( !found || tk < t ) ) {
+        t = tk;
+        u = uk;
+        v = vk;
+        found = true;
+      }
+    }
+
+    return found;
+  }
+
+
+
+  /*! const PSurfTriangleBvh<T>& PSurf<T,n>::getRayBvh() const
+   *  The hierarchy used by intersectRay(), in local coordinates.
+   *  It is made from the present samples if it is outdated.
+   */
+  template <typename T, int n>
+  inline
+  const PSurfTriangleBvh<T>& PSurf<T,n>::getRayBvh() const {
+
+    _updateRayBvh();
+    return _ray_bvh;
+  }
+
+
+
+  /*! void PSurf<T,n>::setStagedReplot( bool staged, bool second_der )
+   *  Turn the staged replot on or off.
+   *  When staged, replot() samples positions, texture coordinates and normals
+   *  straight into an interleaved staging buffer (see PSurfStaging) that the
+   *  visualizers upload in one shot. Visualizers that do not support the
+   *  staging buffer are replotted from an ordinary sample matrix.
+   *
+   *  \param[in] staged      Replot through the staging buffer or not
+   *  \param[in] second_der  Keep the second derivative plane in the staging buffer
+   */
+  template <typename T, int n>
+  inline
+  void PSurf<T,n>::setStagedReplot( bool staged, bool second_der ) {
+
+    _staged            = staged;
+    _staged_second_der = second_der;
+  }
+
+
+
+  template <typename T, int n>
+  inline
+  bool PSurf<T,n>::isStagedReplot() const {
+
+    return _staged;
+  }
+
+
+
+  template <typename T, int n>
+  inline
+  const PSurfStaging& PSurf<T,n>::getStaging() const {
+
+    return _staging;
   }
 
 
@@ -763,6 +1593,10 @@ namespace GMlib {
     p.setDim(m1, m2);
 
     for(int i=0; i<m1-1; i++) {
+      if( _resampleCancelled() ) {
+        _resample = false;
+        return;
+      }
       _ind[0]=i;
       T u = s_u + i*du;
       for(int j=0;j<m2-1;j++) {
@@ -800,6 +1634,62 @@ namespace GMlib {
   }
 
 
+  /*! void PSurf<T,n>::resampleStaging( PSurfStaging& stage, int m1, int m2, bool second_der, Sphere<T,n>* s ) const
+   *  Sample the surface and pack each sample straight into a staging buffer,
+   *  without building a sample matrix. The samples, texture coordinates and
+   *  normals are the same as from resample() and resampleNormals().
+   *  No GL context is needed.
+   *
+   *  \param[out] stage       The staging buffer to fill
+   *  \param[in]  m1          Number of samples in u-direction
+   *  \param[in]  m2          Number of samples in v-direction
+   *  \param[in]  second_der  Fill the second derivative plane
+   *  \param[out] s           If not null, the surrounding sphere is added to it (as setSurroundingSphere())
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::resampleStaging( PSurfStaging& stage, int m1, int m2, bool second_der, Sphere<T,n>* s ) const {
+
+    const int d = second_der ? 2 : 1;
+
+    // Derivatives by divided differences needs the whole sample matrix
+    if( this->_dm == GM_DERIVATION_DD ) {
+      DMatrix< DMatrix< Vector<T,n> > > p;
+      resample( p, m1, m2, d, d, getStartPU(), getStartPV(), getEndPU(), getEndPV() );
+      stage.fill( p, second_der );
+      if( s ) uppdateSurroundingSphere( *s, p );
+      return;
+    }
+
+    _resample = true;
+    stage.setDim( m1, m2, second_der );
+
+    const T s_u = getStartPU();
+    const T s_v = getStartPV();
+    const T e_u = getEndPU();
+    const T e_v = getEndPV();
+    const T du  = (e_u-s_u)/(m1-1);
+    const T dv  = (e_v-s_v)/(m2-1);
+
+    for( int i = 0; i < m1; i++ ) {
+      _ind[0] = i;
+      const bool lu = i < m1-1;
+      const T    u  = lu ? s_u + i*du : e_u;
+      for( int j = 0; j < m2; j++ ) {
+        _ind[1] = j;
+        const bool lv = j < m2-1;
+        eval( u, lv ? s_v + j*dv : e_v, d, d, lu, lv );
+        stage.set( i, j, _p );
+
+        // The same nine points as uppdateSurroundingSphere()
+        if( s && (i == 0 || i == m1/2 || i == m1-1) && (j == 0 || j == m2/2 || j == m2-1) )
+          *s += _p[0][0].toPoint();
+      }
+    }
+
+    _resample = false;
+  }
+
+
   template <typename T, int n>
   inline
   void PSurf<T,n>::resample( DMatrix<DMatrix <DMatrix <Vector<T,n> > > >& a,
@@ -945,6 +1835,341 @@ namespace GMlib {
 
 
 
+  template <typename T, int n>
+  inline
+  SmallMatrix<Vector<T,n>,4,4>
+  PSurf<T,n>::_evalSmall( T u, T v, int d1, int d2, const HqMatrix<T,3>& mat ) const {
+
+    SmallMatrix<Vector<T,n>,4,4> p(d1+1, d2+1);
+    _eval( u, v, p.getDim1()-1, p.getDim2()-1 );
+
+    p[0][0] = mat * _p[0][0].toPoint();
+    for( int j = 1; j < p.getDim2(); j++ )
+      p[0][j] = mat * _p[0][j];
+    for( int i = 1; i < p.getDim1(); i++ )
+      for( int j = 0; j < p.getDim2(); j++ )
+        p[i][j] = mat * _p[i][j];
+
+    return p;
+  }
+
+
+
+  template <typename T, int n>
+  bool PSurf<T,n>::_replotStaged( int m1, int m2, int d1, int d2 ) const {
+
+    // Sample straight into the staging buffer
+    Sphere<T,n> s;
+    resampleStaging( _staging, m1, m2, _staged_second_der, &s );
+    Parametrics<T,2,n>::setSurroundingSphere(s);
+
+    // Visualizers not supporting the staging buffer get the ordinary sample matrix
+    bool sampled = false;
+
+    for( int i = 0; i < this->_psurf_visualizers.getSize(); i++ ) {
+      PSurfVisualizer<T,n>* vis = this->_psurf_visualizers[i];
+      if( vis->replot( _staging, d1, d2, isClosedU(), isClosedV() ) ) continue;
+
+      if( !sampled ) {
+        resample( _sample_p, m1, m2, d1, d2, getStartPU(), getStartPV(), getEndPU(), getEndPV() );
+        resampleNormals( _sample_p, _sample_normals );
+        sampled = true;
+      }
+      vis->replot( _sample_p, _sample_normals, m1, m2, d1, d2, isClosedU(), isClosedV() );
+    }
+
+    _updateSampleBufferPeak();
+    return sampled;
+  }
+
+
+
+  /*! void PSurf<T,n>::_lodReset( int m1, int m2 ) const
+   *  Make the levels of detail from a sampling of m1 x m2 samples, dropping
+   *  the samples kept. Does nothing if the replot comes from setLodLevel().
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::_lodReset( int m1, int m2 ) const {
+
+    if( _lod_switch || _lod_no_levels < 1 ) return;
+
+    _lod.resize( 1 );
+    _lod[0].m1 = m1;
+    _lod[0].m2 = m2;
+
+    for( int k = 1; k < _lod_no_levels; k++ ) {
+
+      int k1 = ( ( _lod[k-1].m1 - 1 ) >> 1 ) + 1;
+      int k2 = ( ( _lod[k-1].m2 - 1 ) >> 1 ) + 1;
+      if( k1 < 3 ) k1 = _lod[k-1].m1;
+      if( k2 < 3 ) k2 = _lod[k-1].m2;
+      if( k1 == _lod[k-1].m1 && k2 == _lod[k-1].m2 ) break;
+
+      _lod.resize( k+1 );
+      _lod[k].m1 = k1;
+      _lod[k].m2 = k2;
+    }
+
+    _lodInvalidate();
+    this->_lod_level = 0;
+  }
+
+
+
+  template <typename T, int n>
+  inline
+  void PSurf<T,n>::_lodInvalidate() const {
+
+    for( unsigned int i = 0; i < _lod.size(); i++ ) {
+      _lod[i].cached = false;
+      _lod[i].in_use = false;
+    }
+  }
+
+
+
+  /*! void PSurf<T,n>::_lodPark() const
+   *  Give the samples of the present level of detail back to the level, by swapping
+   *  them with the sample buffers. The sample buffers are then free for another sampling.
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::_lodPark() const {
+
+    for( unsigned int i = 0; i < _lod.size(); i++ ) {
+      LodLevel& l = _lod[i];
+      if( !l.in_use ) continue;
+
+      l.p.swap( _sample_p );
+      l.normals.swap( _sample_normals );
+      l.stage.swap( _staging );
+      l.in_use = false;
+    }
+  }
+
+
+
+  /*! void PSurf<T,n>::_lodStore( bool sampled ) const
+   *  Keep the samples just made for the level of detail having this sampling,
+   *  with the surrounding sphere, which must be set first. The samples stay
+   *  in the sample buffers, and are not copied, until the level is left, see
+   *  _lodPark(). The sample matrices are only kept if they were made (sampled),
+   *  otherwise the staging buffer. A level whose samples were in the sample
+   *  buffers is dropped, as they are overwritten.
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::_lodStore( bool sampled ) const {
+
+    int k = this->_lod_level;
+    if( k < 0 || k >= int(_lod.size()) || _lod[k].m1 != _no_sam_u || _lod[k].m2 != _no_sam_v ) {
+      for( k = 0; k < int(_lod.size()); k++ )
+        if( _lod[k].m1 == _no_sam_u && _lod[k].m2 == _no_sam_v ) break;
+    }
+
+    for( int i = 0; i < int(_lod.size()); i++ ) {
+      if( !_lod[i].in_use ) continue;
+      _lod[i].cached = false;
+      _lod[i].in_use = false;
+    }
+    if( k == int(_lod.size()) ) return;
+
+    LodLevel& l = _lod[k];
+    l.sphere  = this->_sphere;
+    l.sampled = sampled;
+    l.cached  = true;
+    l.in_use  = true;
+    this->_lod_level = k;
+  }
+
+
+
+  /*! bool PSurf<T,n>::_lodReplotCached( int m1, int m2 )
+   *  Replot the visualizers from the samples kept for the level of detail
+   *  with m1 x m2 samples. The sampling, pre-evaluation, sample buffers and
+   *  surrounding sphere are set as if the level was sampled again, the samples
+   *  of the level left are swapped back to it. A visualizer not taking a kept
+   *  staging buffer gets the level sampled, as in _replotStaged(), so once a
+   *  level is found all visualizers are replotted from it.
+   *  \return false if no samples are kept for this sampling, then only the
+   *          samples of the present level are given back to it
+   */
+  template <typename T, int n>
+  bool PSurf<T,n>::_lodReplotCached( int m1, int m2 ) {
+
+    int k = 0;
+    while( k < int(_lod.size()) && !( _lod[k].cached && _lod[k].m1 == m1 && _lod[k].m2 == m2 ) ) k++;
+
+    if( k == int(_lod.size()) || !_lod[k].in_use ) _lodPark();
+    if( k == int(_lod.size()) ) return false;
+
+    if( m1 != _no_sam_u ) {
+      _no_sam_u = m1;
+      preSample( 1, m1 );
+    }
+    if( m2 != _no_sam_v ) {
+      _no_sam_v = m2;
+      preSample( 2, m2 );
+    }
+
+    LodLevel& l = _lod[k];
+    if( !l.in_use ) {
+      l.p.swap( _sample_p );
+      l.normals.swap( _sample_normals );
+      l.stage.swap( _staging );
+      l.in_use = true;
+    }
+    SceneObject::setSurroundingSphere( l.sphere );
+
+    for( int i = 0; i < this->_psurf_visualizers.getSize(); i++ ) {
+      PSurfVisualizer<T,n>* vis = this->_psurf_visualizers[i];
+      if( _staged && vis->replot( _staging, _no_der_u, _no_der_v, isClosedU(), isClosedV() ) ) continue;
+
+      if( !l.sampled ) {
+        resample( _sample_p, m1, m2, _no_der_u, _no_der_v, getStartPU(), getStartPV(), getEndPU(), getEndPV() );
+        resampleNormals( _sample_p, _sample_normals );
+        l.sampled = true;
+      }
+      vis->replot( _sample_p, _sample_normals, m1, m2, _no_der_u, _no_der_v, isClosedU(), isClosedV() );
+    }
+    _updateSampleBufferPeak();
+
+    this->_lod_level = k;
+    return true;
+  }
+
+
+
+  /*! void PSurf<T,n>::_updateRayBvh() const
+   *  Make the hierarchy for intersectRay() from the samples of the last replot,
+   *  from the staging buffer if the replot is staged.
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::_updateRayBvh() const {
+
+    if( _ray_bvh_valid ) return;
+
+    DMatrix<Point<T,3>> p;
+
+    if( _staged && _staging.getDim1() > 1 && _staging.getDim2() > 1 ) {
+      const int m1 = _staging.getDim1();
+      const int m2 = _staging.getDim2();
+      const GL::GLVertexTex2D* vp = _staging.getVertexPtr();
+      p.setDim( m1, m2 );
+      for( int i = 0; i < m1; i++ )
+        for( int j = 0; j < m2; j++ ) {
+          const GL::GLVertexTex2D& q = vp[i*m2 + j];
+          p[i][j] = Point<T,3>( T(q.x), T(q.y), T(q.z) );
+        }
+    }
+    else if( !_staged && _sample_p.getDim1() > 1 && _sample_p.getDim2() > 1 ) {
+      p.setDim( _sample_p.getDim1(), _sample_p.getDim2() );
+      for( int i = 0; i < p.getDim1(); i++ )
+        for( int j = 0; j < p.getDim2(); j++ )
+          p[i][j] = _sample_p(i)(j)(0)(0);
+    }
+    else {
+      // Not plotted yet
+      const int m1 = std::max( _no_sam_u, 2 );
+      const int m2 = std::max( _no_sam_v, 2 );
+      p.setDim( m1, m2 );
+      for( int i = 0; i < m1; i++ ) {
+        const T u = i < m1-1 ? getParStartU() + i * getParDeltaU() / (m1-1) : getParEndU();
+        for( int j = 0; j < m2; j++ ) {
+          const T v = j < m2-1 ? getParStartV() + j * getParDeltaV() / (m2-1) : getParEndV();
+          p[i][j] = evaluateSmall( u, v, 0, 0 )(0)(0);
+        }
+      }
+    }
+
+    _ray_bvh.build( p, getParStartU(), getParEndU(), getParStartV(), getParEndV() );
+    _ray_bvh_valid = true;
+  }
+
+
+
+  /*! void PSurf<T,n>::_copyRayQueryData( const SceneObject& original )
+   *  Takes the hierarchy for intersectRay() from the surface this is a copy of,
+   *  made there first if needed. See Scene::intersectRays().
+   */
+  template <typename T, int n>
+  void PSurf<T,n>::_copyRayQueryData( const SceneObject& original ) {
+
+    Parametrics<T,2,n>::_copyRayQueryData( original );
+
+    const PSurf<T,n>* surf = dynamic_cast<const PSurf<T,n>*>( &original );
+    if( !surf ) return;
+
+    surf->_updateRayBvh();
+    _ray_bvh       = surf->_ray_bvh;
+    _ray_bvh_valid = true;
+  }
+
+
+
+  /*! bool PSurf<T,n>::_refineRayHit( const Point<T,3>& o, const Vector<T,3>& d, T& t, T& u, T& v ) const
+   *  Newton iteration for S(u,v) = o + t*d (local coordinates) from the values given.
+   *  The parameters are wrapped in closed directions and clamped in open ones.
+   *  \return true if converged with t >= 0
+   */
+  template <typename T, int n>
+  bool PSurf<T,n>::_refineRayHit( const Point<T,3>& o, const Vector<T,3>& d, T& t, T& u, T& v ) const {
+
+    const T su = getParStartU(), du = getParDeltaU();
+    const T sv = getParStartV(), dv = getParDeltaV();
+    const T eps = T(1e-5) * _ray_bvh.getBox().getPointDelta().getLength();
+    const Vector<T,3> c = T(-1) * d;
+
+    for( int i = 0; i < 16; i++ ) {
+
+      const SmallMatrix<Vector<T,n>,4,4> s = evaluateSmall( u, v, 1, 1 );
+      const Vector<T,3> f = s(0)(0) - (o + t * d);
+      if( f.getLength() <= eps ) return t >= T(0);
+
+      // The Jacobian is [Su Sv -d], Cramer's rule
+      const Vector<T,3>& a = s(1)(0);
+      const Vector<T,3>& b = s(0)(1);
+      const T det = a * (b ^ c);
+      if( std::abs(det) <= std::numeric_limits<T>::min() ) return false;
+
+      u -= (f * (b ^ c)) / det;
+      v -= (a * (f ^ c)) / det;
+      t -= (a * (b ^ f)) / det;
+
+      if( isClosedU() ) u = su + (u - su) - du * std::floor( (u - su) / du );
+      else              u = std::min( std::max( u, su ), su + du );
+      if( isClosedV() ) v = sv + (v - sv) - dv * std::floor( (v - sv) / dv );
+      else              v = std::min( std::max( v, sv ), sv + dv );
+    }
+
+    return false;
+  }
+
+
+
+  template <typename T, int n>
+  std::size_t PSurf<T,n>::_sampleSize( const DMatrix<DMatrix<Vector<T,n>>>& p, const DMatrix<Vector<float,3>>& normals ) const {
+
+    std::size_t size = 0;
+
+    if( p.getDim1() > 0 && p.getDim2() > 0 )
+      size += std::size_t(p.getDim1()) * p.getDim2() * p(0)(0).getDim1() * p(0)(0).getDim2() * sizeof(Vector<T,n>);
+
+    if( normals.getDim1() > 0 )
+      size += std::size_t(normals.getDim1()) * normals.getDim2() * sizeof(Vector<float,3>);
+
+    return size;
+  }
+
+
+
+  template <typename T, int n>
+  inline
+  void PSurf<T,n>::_updateSampleBufferPeak() const {
+
+    _sample_peak = std::max( _sample_peak, getSampleBufferSize() );
+  }
+
+
+
   template <typename T, int n>
   inline
   void PSurf<T,n>::_computeEFGefg( T u, T v, T& E, T& F, T& G, T& e, T& f, T& g ) const {
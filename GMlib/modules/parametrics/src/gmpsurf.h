@@ -33,9 +33,21 @@
 #include <core/containers/gmarray.h>
 #include <core/containers/gmdvector.h>
 #include <core/containers/gmdmatrix.h>
+#include <core/containers/gmsmallmatrix.h>
+#include <core/utils/gmparallel.h>
+
+#include "visualizers/gmpsurfstaging.h"
+#include "intersection/gmpsurftrianglebvh.h"
+#include <core/utils/gmtaskgraph.h>
 
 // stl
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 
 namespace GMlib {
@@ -79,6 +91,10 @@ namespace GMlib {
     DMatrix<Vector<T,n> >&        evaluate( int i, int j ) const;
     DMatrix<Vector<T,n> >&        evaluateParent( int i, int j  ) const;
 
+    SmallMatrix<Vector<T,n>,4,4>  evaluateSmall( T u, T v, int d1, int d2 ) const;
+    SmallMatrix<Vector<T,n>,4,4>  evaluateParentSmall( T u, T v, int d1, int d2 ) const;
+    SmallMatrix<Vector<T,n>,4,4>  evaluateGlobalSmall( T u, T v, int d1, int d2 ) const;
+
     //****  Closest point functons  ****
     virtual void                  estimateClpPar( const Point<T,n>& p, T& u, T& v, int m=20 ) const;
     virtual bool                  getClosestPoint( const Point<T,n>& q, T& u, T& v,
@@ -92,6 +108,13 @@ namespace GMlib {
     virtual T                     getCurvaturePrincipalMax( T u, T v ) const;
     virtual T                     getCurvaturePrincipalMin( T u, T v ) const;
 
+    //****  Curvature fields over a whole sample grid  ****
+    static void                   computeCurvatures( const DMatrix<DMatrix<Vector<T,n>>>& p,
+                                                     DMatrix<T>* gauss, DMatrix<T>* mean,
+                                                     DMatrix<T>* kmax = nullptr, DMatrix<T>* kmin = nullptr );
+    void                          getCurvatures( DMatrix<T>* gauss, DMatrix<T>* mean,
+                                                 DMatrix<T>* kmax = nullptr, DMatrix<T>* kmin = nullptr ) const;
+
     int                           getDerivativesU() const;
     int                           getDerivativesV() const;
 
@@ -131,6 +154,39 @@ namespace GMlib {
     // virtual from SceneObject, must be implemented in the specific surface if it is editable/ changing shape
     void                          replot() const override;
 
+    // Asynchronous replot: sample on the background TaskPool, taken in by syncReplot()
+    virtual void                  replotAsync( int m1, int m2, int d1 = 0, int d2 = 0 );
+    void                          cancelReplotAsync();
+    bool                          isReplotAsyncPending() const;
+    // Virtual from SceneObject
+    bool                          syncReplot() override;
+
+    // Staged replot: sample straight into a GPU-ready staging buffer (see PSurfStaging)
+    void                          setStagedReplot( bool staged, bool second_der = false );
+    bool                          isStagedReplot() const;
+    const PSurfStaging&           getStaging() const;
+    void                          resampleStaging( PSurfStaging& stage, int m1, int m2, bool second_der = false,
+                                                   Sphere<T,n>* s = nullptr ) const;
+
+    //****  Sample buffers, kept and reused between replots  ****
+    std::size_t                   getSampleBufferSize() const;
+    std::size_t                   getSampleBufferPeakSize() const;
+    void                          shrinkSampleBuffers();
+
+    //****  Level of detail, see LodController  ****
+    void                          enableLod( int levels = 3 );
+    void                          disableLod();
+    bool                          isLodEnabled() const;
+    // Virtual from SceneObject
+    int                           getLodLevels() const override;
+    int                           getLodSamples( int level ) const override;
+    void                          setLodLevel( int level ) override;
+
+    //****  Ray intersection, see also Scene::intersectRay()  ****
+    bool                          intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit ) const override;
+    bool                          intersectRay( const Point<T,3>& o, const Vector<T,3>& d, T& t, T& u, T& v ) const;
+    const PSurfTriangleBvh<T>&    getRayBvh() const;
+
     // To set the actual domain. All mappings (both parametric and scaling of derivatives) will then automatical be done.
     void                          setDomainU( T start, T end );
     void                          setDomainUScale( T sc );
@@ -177,6 +233,10 @@ namespace GMlib {
     // Can be used by resample -- index in pre-eval
     mutable int                   _ind[2];
     mutable bool                  _resample;
+
+    // Cancel of a resample() of replotAsync(), checked once per row
+    const std::atomic<unsigned int>* _resample_request;  // The newest request, 0x0 if not cancelled this way
+    unsigned int                     _resample_k;        // The request being sampled
     mutable int                   _pre_eval_kode;
 
     // The result of the previous evaluation
@@ -200,6 +260,56 @@ namespace GMlib {
     mutable HqMatrix<T,3>                 _mat; // This is to convert float to T in _present
     mutable DMatrix< Vector<T,n>>          p;   // Position and derivatives in parent or global coordinates
 
+    // Sample buffers, reused by each replot (reallocated if the sampling grows from the last replot)
+    mutable DMatrix< DMatrix< Vector<T,n> > > _sample_p;       // Positions and derivatives at the samples
+    mutable DMatrix< Vector<float,3> >         _sample_normals; // Normals at the samples
+    mutable std::size_t                        _sample_peak;    // Largest getSampleBufferSize() (bytes)
+
+    // Staged replot
+    bool                          _staged;            // Replot through the staging buffer
+    bool                          _staged_second_der; // Keep the second derivative plane in the staging buffer
+    mutable PSurfStaging          _staging;           // The staging buffer, reused for each replot
+
+    // Level of detail, the samples of each level are kept. The samples of the present
+    // level are in the sample buffers, they are swapped with the level when leaving it
+    struct LodLevel {
+      int                               m1, m2;       // Number of samples in u and v
+      bool                              cached;       // The samples are up to date
+      bool                              sampled;      // The sample matrices are made, not only the staging buffer
+      bool                              in_use;       // The samples are in the sample buffers of the surface
+      DMatrix< DMatrix< Vector<T,n> > > p;            // Positions and derivatives
+      DMatrix< Vector<float,3> >        normals;      // Normals
+      PSurfStaging                      stage;        // Staging buffer (staged replot)
+      Sphere<float,3>                   sphere;       // Surrounding sphere
+    };
+    int                           _lod_no_levels;     // Number of levels asked for, 0 if no level of detail
+    bool                          _lod_switch;        // Replot from setLodLevel()
+    mutable std::vector<LodLevel> _lod;               // The levels, 0 is the finest
+
+    // Ray intersection, a hierarchy over the sample triangles (local coordinates)
+    mutable PSurfTriangleBvh<T>   _ray_bvh;
+    mutable bool                  _ray_bvh_valid;     // Made from the present samples
+
+    // Asynchronous replot, the request is sampled by a pool task into the back buffer,
+    // from a copy of the surface
+    struct AsyncReplot {
+      std::mutex                        mutex;
+      std::condition_variable           idle;         // Notified when the task has left
+      bool                              running;      // A task is queued or working
+      std::atomic<unsigned int>         request;      // Number of the newest request
+      unsigned int                      done;         // The last request handled by the task
+      int                               m1, m2, d1, d2; // The newest request, m1 = 0 if cancelled
+      PSurf<T,n>*                       copy;         // The copy of the newest request, not taken yet
+      PSurf<T,n>*                       taken;        // The copy the task has taken
+      std::vector<PSurf<T,n>*>          used;         // Copies to be deleted, by the owning thread
+      bool                              ready;        // The back buffer holds the newest request
+      int                               r_m1, r_m2, r_d1, r_d2;
+      DMatrix< DMatrix< Vector<T,n> > > p;            // Back buffer, positions and derivatives
+      DMatrix< Vector<float,3> >        normals;      // Back buffer, normals
+      Sphere<T,n>                       s;            // Back buffer, surrounding sphere
+    };
+    mutable std::unique_ptr<AsyncReplot> _async;
+
     // Visualizers
     Array< PSurfVisualizer<T,n>*> _psurf_visualizers;
     PSurfVisualizer<T,n>*         _default_visualizer;
@@ -262,8 +372,20 @@ namespace GMlib {
                                                                 T s_u = T(0), T s_v = T(0), T e_u = T(0), T e_v = T(0)) const;
 
     virtual void      resampleNormals( const DMatrix<DMatrix<Vector<T,n>>> &sample, DMatrix<Vector<float,3>> &normals ) const;
+    bool              _resampleCancelled() const;
 
     void              uppdateSurroundingSphere( Sphere<T,n>& s, const DMatrix<DMatrix<Vector<T,n>>>& p ) const;
+    void              _updateSampleBufferPeak() const;
+
+    void              _lodReset( int m1, int m2 ) const;
+    void              _lodInvalidate() const;
+    void              _lodPark() const;
+    void              _lodStore( bool sampled ) const;
+    bool              _lodReplotCached( int m1, int m2 );
+
+    void              _updateRayBvh() const;
+    void              _copyRayQueryData( const SceneObject& original ) override;
+    bool              _refineRayHit( const Point<T,3>& o, const Vector<T,3>& d, T& t, T& u, T& v ) const;
 
     T                 shiftU(T u) const;
     T                 shiftV(T v) const;
@@ -271,7 +393,14 @@ namespace GMlib {
   private:
 
     void              _eval( T u, T v, int d1, int d2 ) const;
+    bool              _replotStaged( int m1, int m2, int d1, int d2 ) const;
+    static void       _replotAsyncWork( AsyncReplot& a );
+    void              _cancelReplotAsync() const;
+    void              _deleteUsedCopies() const;
+    SmallMatrix<Vector<T,n>,4,4>
+                      _evalSmall( T u, T v, int d1, int d2, const HqMatrix<T,3>& mat ) const;
     void              _computeEFGefg( T u, T v, T& E, T& F, T& G, T& e, T& f, T& g ) const;
+    std::size_t       _sampleSize( const DMatrix<DMatrix<Vector<T,n>>>& p, const DMatrix<Vector<float,3>>& normals ) const;
 
   }; // END class PSurf
 
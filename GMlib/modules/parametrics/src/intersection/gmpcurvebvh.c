@@ -0,0 +1,298 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 - 2017 University of Tromsø - The Arctic University of Norway
+** Contact: GMlib Online Portal at https://source.uit.no/gmlib/gmlib/wikis/home
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+
+#include "../gmpcurve.h"
+
+// stl
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace GMlib {
+
+
+  template <typename T>
+  inline
+  PCurveBvh<T>::PCurveBvh()
+    : _source(EVALUATED), _s(0), _e(1), _closed(false), _size(0) {}
+
+
+  template <typename T>
+  inline
+  PCurveBvh<T>::PCurveBvh( const PCurve<T,3>& c, int m )
+    : PCurveBvh<T>() {
+
+    build( c, m );
+  }
+
+
+  /*! void PCurveBvh<T>::build( const PCurve<T,3>& c, int m )
+   *  \brief Makes the segments and the hierarchy
+   *
+   *  \param[in] c  The curve
+   *  \param[in] m  The resolution, the number of samples if the curve has to be
+   *                evaluated, and the Bezier segments are subdivided until they
+   *                are flat within 1/m of the size of the curve
+   */
+  template <typename T>
+  void PCurveBvh<T>::build( const PCurve<T,3>& c, int m ) {
+
+    m       = std::max( m, 1 );
+    _s      = c.getParStart();
+    _e      = c.getParEnd();
+    _closed = c.isClosed();
+    _seg.clear();
+
+    std::vector<DVector<Vector<T,3>>> p;
+    std::vector<T>                    t;
+
+    if( c.getBezierSegments( p, t ) && !p.empty() ) {
+
+      _source = BEZIER;
+      Box<T,3> all( p[0][0] );
+      for( const DVector<Vector<T,3>>& b : p )
+        for( int i = 0; i < b.getDim(); i++ ) all.insert( b(i) );
+
+      const T tol = all.getPointDelta().getLength() / T(m);
+      for( std::size_t i = 0; i < p.size(); i++ )
+        _subdivide( p[i], t[i], t[i+1], tol, 0 );
+    }
+    else if( c.getGlobalSamples( t, p ) ) {
+
+      _source = SAMPLES;
+      _fromSamples( t, p );
+    }
+    else {
+
+      _source = EVALUATED;
+      t.resize( m+1 );
+      p.resize( m+1 );
+      for( int i = 0; i <= m; i++ ) {
+        t[i] = i < m ? _s + i * (_e - _s) / m : _e;
+        const SmallVector<Vector<T,3>,4> e = c.evaluateGlobalSmall( t[i], 1 );
+        p[i].setDim(2);
+        p[i][0] = e(0);
+        p[i][1] = e(1);
+      }
+      _fromSamples( t, p );
+    }
+
+    _nodes.clear();
+    _nodes.reserve( 2 * _seg.size() );
+    if( !_seg.empty() ) _build( 0, int(_seg.size()) );
+    _size = _nodes.empty() ? T(0) : _nodes[0].box.getPointDelta().getLength();
+  }
+
+
+  template <typename T>
+  inline
+  int PCurveBvh<T>::getNoNodes() const {
+
+    return int(_nodes.size());
+  }
+
+
+  template <typename T>
+  inline
+  const typename PCurveBvh<T>::Node& PCurveBvh<T>::getNode( int k ) const {
+
+    return _nodes[k];
+  }
+
+
+  template <typename T>
+  inline
+  int PCurveBvh<T>::getNoSegments() const {
+
+    return int(_seg.size());
+  }
+
+
+  template <typename T>
+  inline
+  const typename PCurveBvh<T>::Segment& PCurveBvh<T>::getSegment( int k ) const {
+
+    return _seg[k];
+  }
+
+
+  /*! int PCurveBvh<T>::getSegmentIndex( T t ) const
+   *  \brief The segment holding the parameter t, clamped to the domain
+   */
+  template <typename T>
+  int PCurveBvh<T>::getSegmentIndex( T t ) const {
+
+    const auto it = std::upper_bound( _seg.begin(), _seg.end(), t,
+                                      []( T a, const Segment& s ) { return a < s.t1; } );
+    return std::min( int(it - _seg.begin()), int(_seg.size()) - 1 );
+  }
+
+
+  template <typename T>
+  inline
+  typename PCurveBvh<T>::Source PCurveBvh<T>::getSource() const {
+
+    return _source;
+  }
+
+
+  /*! T PCurveBvh<T>::getSize() const
+   *  \brief The diagonal of the box around the curve
+   */
+  template <typename T>
+  inline
+  T PCurveBvh<T>::getSize() const {
+
+    return _size;
+  }
+
+
+  template <typename T>
+  inline
+  T PCurveBvh<T>::getParStart() const {
+
+    return _s;
+  }
+
+
+  template <typename T>
+  inline
+  T PCurveBvh<T>::getParEnd() const {
+
+    return _e;
+  }
+
+
+  template <typename T>
+  inline
+  bool PCurveBvh<T>::isClosed() const {
+
+    return _closed;
+  }
+
+
+  // Splits the Bezier segment in halves by de Casteljau's algorithm until the
+  // inner control points are within tol from the chord
+  template <typename T>
+  void PCurveBvh<T>::_subdivide( const DVector<Vector<T,3>>& c, T t0, T t1, T tol, int depth ) {
+
+    const int         d = c.getDim() - 1;
+    const Vector<T,3> a = c(0);
+    const Vector<T,3> s = c(d) - a;
+    const T           l = s * s;
+
+    T h = T(0);
+    for( int i = 1; i < d; i++ ) {
+      const T w = l > T(0) ? std::min( std::max( ((c(i) - a) * s) / l, T(0) ), T(1) ) : T(0);
+      h = std::max( h, (c(i) - a - s * w).getLength() );
+    }
+
+    if( h <= tol || depth >= 16 ) {
+      Segment sg;
+      sg.t0 = t0;
+      sg.t1 = t1;
+      Box<T,3> box( c(0) );
+      for( int i = 1; i <= d; i++ ) box.insert( c(i) );
+      const T e = T(1e-4) * box.getPointDelta().getLength() + std::numeric_limits<T>::epsilon();
+      sg.box = Box<T,3>( box.getPointMin() - Vector<T,3>(e), box.getPointMax() + Vector<T,3>(e) );
+      _seg.push_back( sg );
+      return;
+    }
+
+    // The left half is the first points of the triangle, the right half the last ones
+    DVector<Vector<T,3>> q = c, left(d+1), right(d+1);
+    left[0]  = q(0);
+    right[d] = q(d);
+    for( int r = 1; r <= d; r++ ) {
+      for( int i = 0; i <= d - r; i++ ) q[i] = ( q(i) + q(i+1) ) * T(0.5);
+      left[r]    = q(0);
+      right[d-r] = q(d-r);
+    }
+
+    const T tm = ( t0 + t1 ) / 2;
+    _subdivide( left,  t0, tm, tol, depth + 1 );
+    _subdivide( right, tm, t1, tol, depth + 1 );
+  }
+
+
+  template <typename T>
+  void PCurveBvh<T>::_fromSamples( const std::vector<T>& t, const std::vector<DVector<Vector<T,3>>>& p ) {
+
+    for( std::size_t i = 0; i + 1 < t.size(); i++ ) {
+
+      const Vector<T,3>& a = p[i](0);
+      const Vector<T,3>& b = p[i+1](0);
+      const T            h = t[i+1] - t[i];
+
+      // The curve is close to the cubic Hermite interpolant, else only the chord is known
+      Box<T,3> box( a, b );
+      T        e;
+      if( p[i].getDim() > 1 && p[i+1].getDim() > 1 ) {
+        box.insert( a + p[i](1)   * (h / 3) );
+        box.insert( b - p[i+1](1) * (h / 3) );
+        e = T(0.05) * (b - a).getLength();
+      }
+      else
+        e = T(0.25) * (b - a).getLength();
+
+      e += T(1e-4) * box.getPointDelta().getLength() + std::numeric_limits<T>::epsilon();
+
+      Segment sg;
+      sg.t0  = t[i];
+      sg.t1  = t[i+1];
+      sg.box = Box<T,3>( box.getPointMin() - Vector<T,3>(e), box.getPointMax() + Vector<T,3>(e) );
+      _seg.push_back( sg );
+    }
+  }
+
+
+  template <typename T>
+  int PCurveBvh<T>::_build( int s0, int s1 ) {
+
+    const int k = int(_nodes.size());
+    _nodes.push_back( Node() );
+    Node nd;
+    nd.s0 = s0;
+    nd.s1 = s1;
+
+    if( s1 - s0 == 1 ) {
+      nd.left = nd.right = -1;
+      nd.box  = _seg[s0].box;
+    }
+    else {
+      const int sm = (s0 + s1) / 2;
+      nd.left  = _build( s0, sm );
+      nd.right = _build( sm, s1 );
+      nd.box = _nodes[nd.left].box;
+      nd.box.insert( _nodes[nd.right].box );
+    }
+
+    _nodes[k] = nd;
+    return k;
+  }
+
+
+} // END namespace GMlib
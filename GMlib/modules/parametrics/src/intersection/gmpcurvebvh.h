@@ -0,0 +1,123 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 - 2017 University of Tromsø - The Arctic University of Norway
+** Contact: GMlib Online Portal at https://source.uit.no/gmlib/gmlib/wikis/home
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_PARAMETRICS_INTERSECTION_PCURVEBVH_H
+#define GM_PARAMETRICS_INTERSECTION_PCURVEBVH_H
+
+
+// gmlib
+#include <core/types/gmpoint.h>
+#include <core/containers/gmdvector.h>
+
+// stl
+#include <vector>
+
+
+namespace GMlib {
+
+  template <typename T, int n>
+  class PCurve;
+
+
+
+  /*! \class PCurveBvh gmpcurvebvh.h <gmPCurveBvh>
+   *  \brief Bounding volume hierarchy over parameter intervals (segments) of a curve
+   *
+   *  The segments and their boxes are made from the best data the curve has:
+   *  - Bezier segments (see PCurve::getBezierSegments()), which are subdivided
+   *    by de Casteljau's algorithm until the control polygons are flat.
+   *    The boxes hold the control polygons, and then the curve.
+   *  - The samples made for plotting (see PCurve::getGlobalSamples()), no
+   *    evaluation is done. With first derivatives in the samples the box of a
+   *    segment is around the cubic Hermite control polygon, else it is around
+   *    the chord, enlarged by a quarter of the chord length.
+   *  - Else m+1 samples with first derivatives are evaluated.
+   *
+   *  The tree is made by halving the (parameter ordered) segment ranges,
+   *  the node 0 is the root and the leaves hold a single segment.
+   *  All positions are global (scene) coordinates, the hierarchy is a snapshot
+   *  that has to be built again when the curve is changed or moved.
+   */
+  template <typename T>
+  class PCurveBvh {
+  public:
+    enum Source {
+      BEZIER,           //!< Made from Bezier segments
+      SAMPLES,          //!< Made from the plotting samples of the curve
+      EVALUATED         //!< Made from new samples
+    };
+
+    struct Segment {
+      T           t0, t1;         //!< Parameter interval
+      Box<T,3>    box;
+    };
+
+    struct Node {
+      Box<T,3>    box;
+      int         left, right;    //!< Child nodes, -1 in the leaves
+      int         s0, s1;         //!< Segments [s0,s1) below the node
+
+      bool        isLeaf() const { return left < 0; }
+    };
+
+    PCurveBvh();
+    PCurveBvh( const PCurve<T,3>& c, int m = 64 );
+
+    void                build( const PCurve<T,3>& c, int m = 64 );
+
+    int                 getNoNodes() const;
+    const Node&         getNode( int k ) const;
+    int                 getNoSegments() const;
+    const Segment&      getSegment( int k ) const;
+    int                 getSegmentIndex( T t ) const;
+    Source              getSource() const;
+    T                   getSize() const;
+
+    T                   getParStart() const;
+    T                   getParEnd() const;
+    bool                isClosed() const;
+
+  private:
+    std::vector<Node>     _nodes;
+    std::vector<Segment>  _seg;
+
+    Source              _source;
+    T                   _s, _e;     // The parameter domain
+    bool                _closed;
+    T                   _size;      // Diagonal of the root box
+
+    void                _subdivide( const DVector<Vector<T,3>>& c, T t0, T t1, T tol, int depth );
+    void                _fromSamples( const std::vector<T>& t, const std::vector<DVector<Vector<T,3>>>& p );
+    int                 _build( int s0, int s1 );
+
+  }; // END class PCurveBvh
+
+
+} // END namespace GMlib
+
+// Include PCurveBvh class function implementations
+#include "gmpcurvebvh.c"
+
+
+#endif // GM_PARAMETRICS_INTERSECTION_PCURVEBVH_H
@@ -0,0 +1,454 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 - 2017 University of Tromsø - The Arctic University of Norway
+** Contact: GMlib Online Portal at https://source.uit.no/gmlib/gmlib/wikis/home
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+
+#include "../gmpcurve.h"
+#include "../gmpsurf.h"
+
+// gmlib
+#include <core/utils/gmparallel.h>
+
+// stl
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace GMlib {
+
+
+  /*! PCurveIntersection<T>::PCurveIntersection( int m )
+   *  \brief Sets up the queries
+   *
+   *  \param[in] m  The resolution of the curve hierarchies, see PCurveBvh
+   */
+  template <typename T>
+  inline
+  PCurveIntersection<T>::PCurveIntersection( int m )
+    : _m(m), _m1(32), _m2(32), _eps(0), _no_candidates(0) {}
+
+
+  /*! std::vector<typename PCurveIntersection<T>::CurveHit> PCurveIntersection<T>::intersect( const PCurve<T,3>& c1, const PCurve<T,3>& c2 )
+   *  \brief The intersection points of two curves, ordered by the parameter on c1
+   */
+  template <typename T>
+  std::vector<typename PCurveIntersection<T>::CurveHit>
+  PCurveIntersection<T>::intersect( const PCurve<T,3>& c1, const PCurve<T,3>& c2 ) {
+
+    const PCurveBvh<T> b1( c1, _m );
+    const PCurveBvh<T> b2( c2, _m );
+
+    std::vector<std::pair<int,int>> cand;
+    if( b1.getNoNodes() > 0 && b2.getNoNodes() > 0 )
+      _collect( b1, 0, b2, 0, cand );
+    _no_candidates = int(cand.size());
+
+    std::vector<CurveHit> hits;
+    _solveCurves( c1, b1, c2, b2, cand, hits );
+    return hits;
+  }
+
+
+  /*! std::vector<typename PCurveIntersection<T>::SurfHit> PCurveIntersection<T>::intersect( const PCurve<T,3>& c, const PSurf<T,3>& s )
+   *  \brief The intersection points of a curve and a surface, ordered by the parameter on c
+   */
+  template <typename T>
+  std::vector<typename PCurveIntersection<T>::SurfHit>
+  PCurveIntersection<T>::intersect( const PCurve<T,3>& c, const PSurf<T,3>& s ) {
+
+    const PCurveBvh<T>     bc( c, _m );
+    const PSurfPatchBvh<T> bs( s, _m1, _m2 );
+
+    std::vector<std::pair<int,int>> cand;
+    if( bc.getNoNodes() > 0 )
+      _collect( bc, 0, bs, 0, cand );
+    _no_candidates = int(cand.size());
+
+    std::vector<SurfHit> hits;
+    _solveSurf( c, bc, s, bs, cand, hits );
+    return hits;
+  }
+
+
+  /*! std::vector<typename PCurveIntersection<T>::PairHits> PCurveIntersection<T>::intersectAll( const std::vector<const PCurve<T,3>*>& c )
+   *  \brief The intersection points of all pairs of the curves
+   *
+   *  The hierarchies are made once for each curve, and the curve pairs are
+   *  traversed in parallel.
+   *
+   *  \return The pairs having intersection points, ordered by (i,j)
+   */
+  template <typename T>
+  std::vector<typename PCurveIntersection<T>::PairHits>
+  PCurveIntersection<T>::intersectAll( const std::vector<const PCurve<T,3>*>& c ) {
+
+    const int n = int(c.size());
+    std::vector<PCurveBvh<T>> bvh( n );
+    for( int i = 0; i < n; i++ )
+      bvh[i].build( *c[i], _m );
+
+    std::vector<std::pair<int,int>> pairs;
+    for( int i = 0; i < n; i++ )
+      for( int j = i+1; j < n; j++ )
+        if( bvh[i].getNoNodes() > 0 && bvh[j].getNoNodes() > 0 &&
+            bvh[i].getNode(0).box.isIntersecting( bvh[j].getNode(0).box ) )
+          pairs.push_back( std::make_pair( i, j ) );
+
+    std::vector<std::vector<std::pair<int,int>>> cand( pairs.size() );
+    parallelFor( 0, int(pairs.size()), [&]( int begin, int end ) {
+      for( int k = begin; k < end; k++ )
+        _collect( bvh[pairs[k].first], 0, bvh[pairs[k].second], 0, cand[k] );
+    } );
+
+    _no_candidates = 0;
+    std::vector<PairHits> result;
+    for( std::size_t k = 0; k < pairs.size(); k++ ) {
+      _no_candidates += int(cand[k].size());
+      if( cand[k].empty() ) continue;
+
+      PairHits ph;
+      ph.i = pairs[k].first;
+      ph.j = pairs[k].second;
+      _solveCurves( *c[ph.i], bvh[ph.i], *c[ph.j], bvh[ph.j], cand[k], ph.hits );
+      if( !ph.hits.empty() ) result.push_back( ph );
+    }
+    return result;
+  }
+
+
+  /*! std::vector<std::vector<typename PCurveIntersection<T>::SurfHit>> PCurveIntersection<T>::intersectAll( const std::vector<const PCurve<T,3>*>& c, const PSurf<T,3>& s )
+   *  \brief The intersection points of each of the curves with the surface
+   *
+   *  The surface hierarchy is made once, and the curves are traversed in parallel.
+   *
+   *  \return The intersection points, one vector for each curve
+   */
+  template <typename T>
+  std::vector<std::vector<typename PCurveIntersection<T>::SurfHit>>
+  PCurveIntersection<T>::intersectAll( const std::vector<const PCurve<T,3>*>& c, const PSurf<T,3>& s ) {
+
+    const int n = int(c.size());
+    const PSurfPatchBvh<T> bs( s, _m1, _m2 );
+    std::vector<PCurveBvh<T>> bvh( n );
+    for( int i = 0; i < n; i++ )
+      bvh[i].build( *c[i], _m );
+
+    std::vector<std::vector<std::pair<int,int>>> cand( n );
+    parallelFor( 0, n, [&]( int begin, int end ) {
+      for( int i = begin; i < end; i++ )
+        if( bvh[i].getNoNodes() > 0 )
+          _collect( bvh[i], 0, bs, 0, cand[i] );
+    } );
+
+    _no_candidates = 0;
+    std::vector<std::vector<SurfHit>> result( n );
+    for( int i = 0; i < n; i++ ) {
+      _no_candidates += int(cand[i].size());
+      _solveSurf( *c[i], bvh[i], s, bs, cand[i], result[i] );
+    }
+    return result;
+  }
+
+
+  /*! int PCurveIntersection<T>::getNoCandidates() const
+   *  \brief The number of leaf pairs left after the culling in the last query
+   */
+  template <typename T>
+  inline
+  int PCurveIntersection<T>::getNoCandidates() const {
+
+    return _no_candidates;
+  }
+
+
+  /*! void PCurveIntersection<T>::setSamples( int m, int m1, int m2 )
+   *  \brief The resolution of the hierarchies
+   *
+   *  \param[in] m   The curve resolution, see PCurveBvh::build()
+   *  \param[in] m1  The number of surface patches in u-direction
+   *  \param[in] m2  The number of surface patches in v-direction
+   */
+  template <typename T>
+  inline
+  void PCurveIntersection<T>::setSamples( int m, int m1, int m2 ) {
+
+    _m  = m;
+    _m1 = m1;
+    _m2 = m2;
+  }
+
+
+  /*! void PCurveIntersection<T>::setTolerance( T eps )
+   *  \brief The largest distance between the objects at an intersection point
+   *
+   *  The default (0) is relative to the size of the objects.
+   */
+  template <typename T>
+  inline
+  void PCurveIntersection<T>::setTolerance( T eps ) {
+
+    _eps = eps;
+  }
+
+
+  template <typename T>
+  inline
+  T PCurveIntersection<T>::getTolerance() const {
+
+    return _eps;
+  }
+
+
+  // All the leaf pairs with overlapping boxes, splitting the largest box first
+  template <typename T>
+  template <typename A, typename B>
+  void PCurveIntersection<T>::_collect( const A& a, int na, const B& b, int nb, std::vector<std::pair<int,int>>& out ) {
+
+    const typename A::Node& x = a.getNode( na );
+    const typename B::Node& y = b.getNode( nb );
+    if( !x.box.isIntersecting( y.box ) ) return;
+
+    if( x.isLeaf() && y.isLeaf() ) {
+      out.push_back( std::make_pair( na, nb ) );
+      return;
+    }
+
+    if( !x.isLeaf() && ( y.isLeaf() || x.box.getPointDelta().getLength() >= y.box.getPointDelta().getLength() ) ) {
+      _collect( a, x.left,  b, nb, out );
+      _collect( a, x.right, b, nb, out );
+    }
+    else {
+      _collect( a, na, b, y.left,  out );
+      _collect( a, na, b, y.right, out );
+    }
+  }
+
+
+  template <typename T>
+  inline
+  T PCurveIntersection<T>::_tolerance( T size ) const {
+
+    return _eps > T(0) ? _eps : size * std::max( T(1e-9), 100 * std::numeric_limits<T>::epsilon() );
+  }
+
+
+  // Gauss-Newton on |c1(t1) - c2(t2)|^2 from the middle of each segment pair
+  template <typename T>
+  void PCurveIntersection<T>::_solveCurves( const PCurve<T,3>& c1, const PCurveBvh<T>& b1,
+                                            const PCurve<T,3>& c2, const PCurveBvh<T>& b2,
+                                            const std::vector<std::pair<int,int>>& cand,
+                                            std::vector<CurveHit>& hits ) const {
+
+    const T eps = _tolerance( std::max( b1.getSize(), b2.getSize() ) );
+    const T s1 = b1.getParStart(), e1 = b1.getParEnd();
+    const T s2 = b2.getParStart(), e2 = b2.getParEnd();
+
+    const auto same = []( T a, T b, T s, T e, bool closed ) {
+      T d = std::abs( a - b );
+      if( closed ) d = std::min( d, (e - s) - d );
+      return d <= T(1e-4) * (e - s);
+    };
+
+    for( const std::pair<int,int>& c : cand ) {
+
+      const typename PCurveBvh<T>::Segment& g1 = b1.getSegment( b1.getNode( c.first ).s0 );
+      const typename PCurveBvh<T>::Segment& g2 = b2.getSegment( b2.getNode( c.second ).s0 );
+
+      // Already found in this pair of segments
+      bool found = false;
+      for( const CurveHit& h : hits )
+        if( h.t1 >= g1.t0 && h.t1 <= g1.t1 && h.t2 >= g2.t0 && h.t2 <= g2.t1 ) found = true;
+      if( found ) continue;
+
+      T t1 = (g1.t0 + g1.t1) / 2;
+      T t2 = (g2.t0 + g2.t1) / 2;
+      for( int it = 0; it < 30; it++ ) {
+
+        const SmallVector<Vector<T,3>,4> p1 = c1.evaluateGlobalSmall( t1, 1 );
+        const SmallVector<Vector<T,3>,4> p2 = c2.evaluateGlobalSmall( t2, 1 );
+        const Vector<T,3> f = p1(0) - p2(0);
+
+        if( f.getLength() <= eps ) {
+          bool dup = false;
+          for( const CurveHit& h : hits )
+            if( same( h.t1, t1, s1, e1, b1.isClosed() ) && same( h.t2, t2, s2, e2, b2.isClosed() ) ) dup = true;
+          if( !dup ) {
+            CurveHit h;
+            h.t1 = t1;
+            h.t2 = t2;
+            h.p  = p1(0);
+            hits.push_back( h );
+          }
+          break;
+        }
+
+        // The normal equations, [c1' -c2'] dx = -f
+        const Vector<T,3>& a = p1(1);
+        const Vector<T,3>  b = -p2(1);
+        T m[4] = { a*a, a*b, a*b, b*b };
+        T r[2] = { -(a*f), -(b*f) };
+        if( !_solve( m, r, 2 ) ) break;
+
+        const T n1 = _fit( t1 + r[0], s1, e1, b1.isClosed() );
+        const T n2 = _fit( t2 + r[1], s2, e2, b2.isClosed() );
+        if( std::abs( n1 - t1 ) + std::abs( n2 - t2 ) <= std::numeric_limits<T>::epsilon() * ( std::abs(t1) + std::abs(t2) + 1 ) )
+          break;    // Stuck, at a closest point which is not an intersection
+        t1 = n1;
+        t2 = n2;
+      }
+    }
+
+    std::sort( hits.begin(), hits.end(), []( const CurveHit& a, const CurveHit& b ) { return a.t1 < b.t1; } );
+  }
+
+
+  // Gauss-Newton on |c(t) - S(u,v)|^2 from the middle of each segment and patch
+  template <typename T>
+  void PCurveIntersection<T>::_solveSurf( const PCurve<T,3>& c, const PCurveBvh<T>& bc,
+                                          const PSurf<T,3>& s, const PSurfPatchBvh<T>& bs,
+                                          const std::vector<std::pair<int,int>>& cand,
+                                          std::vector<SurfHit>& hits ) const {
+
+    const T eps = _tolerance( std::max( bc.getSize(), bs.getNode(0).box.getPointDelta().getLength() ) );
+    const T st = bc.getParStart(),  et = bc.getParEnd();
+    const T su = s.getParStartU(),  eu = s.getParEndU();
+    const T sv = s.getParStartV(),  ev = s.getParEndV();
+    const T du = bs.getParDeltaU(), dv = bs.getParDeltaV();
+
+    const auto same = []( T a, T b, T s, T e, bool closed ) {
+      T d = std::abs( a - b );
+      if( closed ) d = std::min( d, (e - s) - d );
+      return d <= T(1e-4) * (e - s);
+    };
+
+    for( const std::pair<int,int>& k : cand ) {
+
+      const typename PCurveBvh<T>::Segment&   g = bc.getSegment( bc.getNode( k.first ).s0 );
+      const typename PSurfPatchBvh<T>::Node&  q = bs.getNode( k.second );
+
+      // Already found in this segment and patch
+      const T u0 = su + q.i0 * du, v0 = sv + q.j0 * dv;
+      bool found = false;
+      for( const SurfHit& h : hits )
+        if( h.t >= g.t0 && h.t <= g.t1 && h.uv(0) >= u0 && h.uv(0) <= u0 + du && h.uv(1) >= v0 && h.uv(1) <= v0 + dv )
+          found = true;
+      if( found ) continue;
+
+      const Point<T,2> uv = bs.getPatchCenter( q.i0, q.j0 );
+      T x[3] = { (g.t0 + g.t1) / 2, uv(0), uv(1) };
+      for( int it = 0; it < 30; it++ ) {
+
+        const SmallVector<Vector<T,3>,4>    pc = c.evaluateGlobalSmall( x[0], 1 );
+        const SmallMatrix<Vector<T,3>,4,4>  ps = s.evaluateGlobalSmall( x[1], x[2], 1, 1 );
+        const Vector<T,3> f = pc(0) - ps(0)(0);
+
+        if( f.getLength() <= eps ) {
+          bool dup = false;
+          for( const SurfHit& h : hits )
+            if( same( h.t, x[0], st, et, bc.isClosed() ) && same( h.uv(0), x[1], su, eu, s.isClosedU() ) &&
+                same( h.uv(1), x[2], sv, ev, s.isClosedV() ) ) dup = true;
+          if( !dup ) {
+            SurfHit h;
+            h.t  = x[0];
+            h.uv = Point<T,2>( x[1], x[2] );
+            h.p  = pc(0);
+            hits.push_back( h );
+          }
+          break;
+        }
+
+        // The normal equations, [c' -Su -Sv] dx = -f
+        const Vector<T,3> j[3] = { pc(1), -ps(1)(0), -ps(0)(1) };
+        T m[9], r[3];
+        for( int a = 0; a < 3; a++ ) {
+          for( int b = 0; b < 3; b++ ) m[a*3+b] = j[a] * j[b];
+          r[a] = -(j[a] * f);
+        }
+        if( !_solve( m, r, 3 ) ) break;
+
+        const T n[3] = { _fit( x[0] + r[0], st, et, bc.isClosed() ),
+                         _fit( x[1] + r[1], su, eu, s.isClosedU() ),
+                         _fit( x[2] + r[2], sv, ev, s.isClosedV() ) };
+        T step = T(0), size = T(1);
+        for( int a = 0; a < 3; a++ ) {
+          step += std::abs( n[a] - x[a] );
+          size += std::abs( x[a] );
+          x[a]  = n[a];
+        }
+        if( step <= std::numeric_limits<T>::epsilon() * size )
+          break;    // Stuck, at a closest point which is not an intersection
+      }
+    }
+
+    std::sort( hits.begin(), hits.end(), []( const SurfHit& a, const SurfHit& b ) { return a.t < b.t; } );
+  }
+
+
+  // Into the domain [s,e], around if closed
+  template <typename T>
+  inline
+  T PCurveIntersection<T>::_fit( T t, T s, T e, bool closed ) {
+
+    if( closed ) {
+      t = s + std::fmod( t - s, e - s );
+      return t < s ? t + (e - s) : t;
+    }
+    return std::min( std::max( t, s ), e );
+  }
+
+
+  // Solves the symmetric positive (semi)definite n x n system a x = b by Cholesky
+  // factorization, x in b. A tiny diagonal is added, since the system is singular
+  // where the objects are tangential.
+  template <typename T>
+  bool PCurveIntersection<T>::_solve( T* a, T* b, int n ) {
+
+    T trace = T(0);
+    for( int k = 0; k < n; k++ ) trace += a[k*n+k];
+    if( !(trace > T(0)) ) return false;
+    for( int k = 0; k < n; k++ ) a[k*n+k] += trace * std::numeric_limits<T>::epsilon();
+
+    for( int c = 0; c < n; c++ ) {
+      for( int k = 0; k < c; k++ ) a[c*n+c] -= a[c*n+k] * a[c*n+k];
+      if( !(a[c*n+c] > T(0)) ) return false;
+      a[c*n+c] = std::sqrt( a[c*n+c] );
+      for( int r = c+1; r < n; r++ ) {
+        for( int k = 0; k < c; k++ ) a[r*n+c] -= a[r*n+k] * a[c*n+k];
+        a[r*n+c] /= a[c*n+c];
+      }
+    }
+
+    for( int r = 0; r < n; r++ ) {
+      for( int k = 0; k < r; k++ ) b[r] -= a[r*n+k] * b[k];
+      b[r] /= a[r*n+r];
+    }
+    for( int r = n-1; r >= 0; r-- ) {
+      for( int k = r+1; k < n; k++ ) b[r] -= a[k*n+r] * b[k];
+      b[r] /= a[r*n+r];
+    }
+    return true;
+  }
+
+
+} // END namespace GMlib
@@ -0,0 +1,133 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 - 2017 University of Tromsø - The Arctic University of Norway
+** Contact: GMlib Online Portal at https://source.uit.no/gmlib/gmlib/wikis/home
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_PARAMETRICS_INTERSECTION_PCURVEINTERSECTION_H
+#define GM_PARAMETRICS_INTERSECTION_PCURVEINTERSECTION_H
+
+
+#include "gmpcurvebvh.h"
+#include "gmpsurfpatchbvh.h"
+
+// gmlib
+#include <core/types/gmpoint.h>
+
+// stl
+#include <utility>
+#include <vector>
+
+
+namespace GMlib {
+
+  template <typename T, int n>
+  class PCurve;
+
+  template <typename T, int n>
+  class PSurf;
+
+
+
+  /*! \class PCurveIntersection gmpcurveintersection.h <gmPCurveIntersection>
+   *  \brief Intersection points of curves with curves and with surfaces
+   *
+   *  The curves get a PCurveBvh, and the surfaces a PSurfPatchBvh. The pairs of
+   *  segments (and patches) with overlapping boxes are found by traversing the
+   *  two hierarchies together, and each pair is a start for Newton iteration on
+   *  c1(t1) - c2(t2) = 0, or c(t) - S(u,v) = 0 (least squares, so tangential
+   *  intersections are found as well). Pairs around an intersection point
+   *  already found are skipped, and the same point found twice is kept once.
+   *
+   *  The batched queries, intersectAll(), make the hierarchies first, then the
+   *  traversals of all the curve pairs (or curves against the surface) are done
+   *  in parallel. The Newton iterations evaluate the curves and surfaces, which
+   *  are not thread safe, and are done from the calling thread.
+   *
+   *  All points are in global (scene) coordinates.
+   */
+  template <typename T>
+  class PCurveIntersection {
+  public:
+    struct CurveHit {
+      T             t1, t2;     //!< Parameter values on the two curves
+      Point<T,3>    p;
+    };
+
+    struct SurfHit {
+      T             t;          //!< Parameter value on the curve
+      Point<T,2>    uv;         //!< Parameter values on the surface
+      Point<T,3>    p;
+    };
+
+    struct PairHits {
+      int                     i, j;   //!< The curves, i < j
+      std::vector<CurveHit>   hits;
+    };
+
+    PCurveIntersection( int m = 64 );
+
+    std::vector<CurveHit>   intersect( const PCurve<T,3>& c1, const PCurve<T,3>& c2 );
+    std::vector<SurfHit>    intersect( const PCurve<T,3>& c, const PSurf<T,3>& s );
+
+    std::vector<PairHits>   intersectAll( const std::vector<const PCurve<T,3>*>& c );
+    std::vector<std::vector<SurfHit>>
+                            intersectAll( const std::vector<const PCurve<T,3>*>& c, const PSurf<T,3>& s );
+
+    int                     getNoCandidates() const;
+
+    void                    setSamples( int m, int m1 = 32, int m2 = 32 );
+    void                    setTolerance( T eps );
+    T                       getTolerance() const;
+
+  protected:
+    int                     _m;         // Curve resolution, see PCurveBvh
+    int                     _m1, _m2;   // Surface patches
+    T                       _eps;       // Distance tolerance, 0 means relative to the size
+    int                     _no_candidates;
+
+    template <typename A, typename B>
+    static void             _collect( const A& a, int na, const B& b, int nb, std::vector<std::pair<int,int>>& out );
+
+    T                       _tolerance( T size ) const;
+
+    void                    _solveCurves( const PCurve<T,3>& c1, const PCurveBvh<T>& b1,
+                                          const PCurve<T,3>& c2, const PCurveBvh<T>& b2,
+                                          const std::vector<std::pair<int,int>>& cand,
+                                          std::vector<CurveHit>& hits ) const;
+    void                    _solveSurf( const PCurve<T,3>& c, const PCurveBvh<T>& bc,
+                                        const PSurf<T,3>& s, const PSurfPatchBvh<T>& bs,
+                                        const std::vector<std::pair<int,int>>& cand,
+                                        std::vector<SurfHit>& hits ) const;
+
+    static T                _fit( T t, T s, T e, bool closed );
+    static bool             _solve( T* a, T* b, int n );
+
+  }; // END class PCurveIntersection
+
+
+} // END namespace GMlib
+
+// Include PCurveIntersection class function implementations
+#include "gmpcurveintersection.c"
+
+
+#endif // GM_PARAMETRICS_INTERSECTION_PCURVEINTERSECTION_H
@@ -0,0 +1,712 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 - 2017 University of Tromsø - The Arctic University of Norway
+** Contact: GMlib Online Portal at https://source.uit.no/gmlib/gmlib/wikis/home
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+
+
+#include "../gmpsurf.h"
+#include "../curves/gmpsurfcurve.h"
+
+// gmlib
+#include <core/utils/gmparallel.h>
+
+// stl
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace GMlib {
+
+
+  template <typename T>
+  PSurfIntersection<T>::PSurfIntersection( PSurf<T,3>* s1, PSurf<T,3>* s2, int m1, int m2 )
+    : _m1(m1), _m2(m2), _eps(0), _step_length(0), _eps_used(0), _h_max(0) {
+
+    _s[0] = s1;
+    _s[1] = s2;
+  }
+
+
+  /*! int PSurfIntersection<T>::compute()
+   *  \brief Finds the intersection curves
+   *
+   *  Previous results are dropped, and the hierarchies are built again.
+   *  \return The number of curves
+   */
+  template <typename T>
+  int PSurfIntersection<T>::compute() {
+
+    _curves.clear();
+    _marks.clear();
+    _candidates.clear();
+
+    _bvh[0].build( *_s[0], _m1, _m2 );
+    _bvh[1].build( *_s[1], _m1, _m2 );
+
+    // Tolerances relative to the size of the surfaces, unless set
+    const T size = std::max( _bvh[0].getNode(0).box.getPointDelta().getLength(),
+                             _bvh[1].getNode(0).box.getPointDelta().getLength() );
+    _eps_used = _eps > T(0) ? _eps : size * std::max( T(1e-9), 100 * std::numeric_limits<T>::epsilon() );
+    _h_max    = _step_length > T(0) ? _step_length : T(0.5) * std::min( _bvh[0].getPatchSize(), _bvh[1].getPatchSize() );
+    if( _h_max <= T(0) ) _h_max = T(0.01) * size;
+
+    _prune();
+
+    for( const std::pair<int,int>& c : _candidates ) {
+
+      const typename PSurfPatchBvh<T>::Node& a = _bvh[0].getNode( c.first );
+      const typename PSurfPatchBvh<T>::Node& b = _bvh[1].getNode( c.second );
+      if( _isTraced( _bvh[0].getPatchIndex( a.i0, a.j0 ), _bvh[1].getPatchIndex( b.i0, b.j0 ) ) )
+        continue;
+
+      // A point on both surfaces, from the patch centers
+      const Point<T,2> c1 = _bvh[0].getPatchCenter( a.i0, a.j0 );
+      const Point<T,2> c2 = _bvh[1].getPatchCenter( b.i0, b.j0 );
+      Vector<T,4> x;
+      x[0] = c1(0);  x[1] = c1(1);
+      x[2] = c2(0);  x[3] = c2(1);
+      if( !_seed( x ) ) continue;
+
+      Point<T,3>  p[2];
+      Vector<T,3> d[2][2];
+      _evaluate( x, p, d );
+      if( _isTraced( x, p[0] ) ) continue;
+
+      _trace( x );
+    }
+
+    return getNoCurves();
+  }
+
+
+  template <typename T>
+  inline
+  int PSurfIntersection<T>::getNoCurves() const {
+
+    return int(_curves.size());
+  }
+
+
+  template <typename T>
+  inline
+  const typename PSurfIntersection<T>::Curve& PSurfIntersection<T>::getCurve( int i ) const {
+
+    return _curves[i];
+  }
+
+
+  /*! int PSurfIntersection<T>::getNoCandidates() const
+   *  \brief The number of patch pairs left after the culling in the last compute()
+   */
+  template <typename T>
+  inline
+  int PSurfIntersection<T>::getNoCandidates() const {
+
+    return int(_candidates.size());
+  }
+
+
+  template <typename T>
+  inline
+  const PSurfPatchBvh<T>& PSurfIntersection<T>::getBvh( int surf ) const {
+
+    return _bvh[surf];
+  }
+
+
+  /*! std::vector<PSurfCurve<T>*> PSurfIntersection<T>::makePSurfCurves( int i, int surf ) const
+   *  \brief Makes the curve i on one of the surfaces as a chain of PSurfCurve's
+   *
+   *  Where the curve crosses the seam of a closed surface, the segment goes
+   *  past the end of the parameter domain. The caller owns the curves.
+   *
+   *  \param[in] i     The curve
+   *  \param[in] surf  The surface, 0 or 1
+   */
+  template <typename T>
+  std::vector<PSurfCurve<T>*> PSurfIntersection<T>::makePSurfCurves( int i, int surf ) const {
+
+    const std::vector<Point<T,2>>& uv = surf == 0 ? _curves[i].uv1 : _curves[i].uv2;
+
+    std::vector<PSurfCurve<T>*> curves;
+    for( std::size_t k = 0; k+1 < uv.size(); k++ ) {
+
+      Point<T,2> b = uv[k+1];
+      for( int l = 0; l < 2; l++ ) {
+        if( !_closed( 2*surf + l ) ) continue;
+        const T period = _end( 2*surf + l ) - _start( 2*surf + l );
+        if( b(l) - uv[k](l) >  period / 2 ) b[l] -= period;
+        if( b(l) - uv[k](l) < -period / 2 ) b[l] += period;
+      }
+      curves.push_back( new PSurfCurve<T>( _s[surf], uv[k], b ) );
+    }
+    return curves;
+  }
+
+
+  template <typename T>
+  inline
+  void PSurfIntersection<T>::setSamples( int m1, int m2 ) {
+
+    _m1 = m1;
+    _m2 = m2;
+  }
+
+
+  /*! void PSurfIntersection<T>::setTolerance( T eps )
+   *  \brief The largest distance between the surfaces at the curve points, 0 (default) is relative to the size
+   */
+  template <typename T>
+  inline
+  void PSurfIntersection<T>::setTolerance( T eps ) {
+
+    _eps = eps;
+  }
+
+
+  template <typename T>
+  inline
+  T PSurfIntersection<T>::getTolerance() const {
+
+    return _eps;
+  }
+
+
+  /*! void PSurfIntersection<T>::setStepLength( T step )
+   *  \brief The largest distance between curve points, 0 (default) is half the patch size
+   */
+  template <typename T>
+  inline
+  void PSurfIntersection<T>::setStepLength( T step ) {
+
+    _step_length = step;
+  }
+
+
+  template <typename T>
+  inline
+  T PSurfIntersection<T>::getStepLength() const {
+
+    return _step_length;
+  }
+
+
+
+  //*********************************
+  //   Culling of the patch pairs  **
+  //*********************************
+
+
+  template <typename T>
+  void PSurfIntersection<T>::_prune() {
+
+    if( !_bvh[0].getNode(0).box.isIntersecting( _bvh[1].getNode(0).box ) ) return;
+
+    // Split the upper levels breadth first, to get work for all the threads
+    std::vector<std::pair<int,int>> front( 1, std::make_pair( 0, 0 ) ), next;
+    const std::size_t wanted = std::size_t( 8 * getNoThreads() );
+    while( front.size() < wanted ) {
+      next.clear();
+      bool split = false;
+      for( const std::pair<int,int>& f : front )
+        split = _split( f.first, f.second, next ) || split;
+      front.swap( next );
+      if( !split ) break;
+    }
+
+    std::vector<std::vector<std::pair<int,int>>> out( front.size() );
+    parallelFor( 0, int(front.size()), [&]( int begin, int end ) {
+      for( int k = begin; k < end; k++ )
+        _collect( front[k].first, front[k].second, out[k] );
+    } );
+
+    for( const std::vector<std::pair<int,int>>& o : out )
+      _candidates.insert( _candidates.end(), o.begin(), o.end() );
+  }
+
+
+  // Pushes the overlapping child pairs of (a,b), splitting the larger node,
+  // or (a,b) itself if both are leaves. Returns true if a node was split.
+  template <typename T>
+  bool PSurfIntersection<T>::_split( int a, int b, std::vector<std::pair<int,int>>& out ) const {
+
+    const typename PSurfPatchBvh<T>::Node& na = _bvh[0].getNode(a);
+    const typename PSurfPatchBvh<T>::Node& nb = _bvh[1].getNode(b);
+
+    if( na.isLeaf() && nb.isLeaf() ) {
+      out.push_back( std::make_pair( a, b ) );
+      return false;
+    }
+
+    const bool split_a = !na.isLeaf() &&
+        ( nb.isLeaf() || na.box.getPointDelta().getLength() >= nb.box.getPointDelta().getLength() );
+
+    if( split_a ) {
+      if( _bvh[0].getNode( na.left ).box.isIntersecting( nb.box ) )  out.push_back( std::make_pair( na.left, b ) );
+      if( _bvh[0].getNode( na.right ).box.isIntersecting( nb.box ) ) out.push_back( std::make_pair( na.right, b ) );
+    }
+    else {
+      if( na.box.isIntersecting( _bvh[1].getNode( nb.left ).box ) )  out.push_back( std::make_pair( a, nb.left ) );
+      if( na.box.isIntersecting( _bvh[1].getNode( nb.right ).box ) ) out.push_back( std::make_pair( a, nb.right ) );
+    }
+    return true;
+  }
+
+
+  template <typename T>
+  void PSurfIntersection<T>::_collect( int a, int b, std::vector<std::pair<int,int>>& out ) const {
+
+    std::vector<std::pair<int,int>> pairs;
+    if( !_split( a, b, pairs ) ) {
+      out.push_back( std::make_pair( a, b ) );
+      return;
+    }
+    for( const std::pair<int,int>& p : pairs )
+      _collect( p.first, p.second, out );
+  }
+
+
+
+  //*************************************
+  //   Start points, and traced curves **
+  //*************************************
+
+
+  // Newton iteration onto the intersection, the smallest parameter step
+  // solving the linearized S1(u1,v1) = S2(u2,v2)
+  template <typename T>
+  bool PSurfIntersection<T>::_seed( Vector<T,4>& x ) const {
+
+    Point<T,3>  p[2];
+    Vector<T,3> d[2][2];
+
+    for( int it = 0; it < 30; it++ ) {
+
+      _evaluate( x, p, d );
+      const Vector<T,3> f = p[0] - p[1];
+      if( f.getLength() < _eps_used ) return true;
+
+      // dx = J^T (J J^T)^-1 (-f), J = [ S1u S1v -S2u -S2v ]
+      const Vector<T,3> jc[4] = { d[0][0], d[0][1], -d[1][0], -d[1][1] };
+      T a[9], b[3];
+      for( int r = 0; r < 3; r++ ) {
+        b[r] = -f(r);
+        for( int c = 0; c < 3; c++ ) {
+          a[r*3+c] = T(0);
+          for( int k = 0; k < 4; k++ ) a[r*3+c] += jc[k](r) * jc[k](c);
+        }
+      }
+      if( !_solve( a, b, 3 ) ) return false;
+
+      for( int k = 0; k < 4; k++ )
+        x[k] += jc[k](0) * b[0] + jc[k](1) * b[1] + jc[k](2) * b[2];
+      if( !_wrap( x, std::numeric_limits<T>::infinity() ) ) return false;
+    }
+    return false;
+  }
+
+
+  template <typename T>
+  bool PSurfIntersection<T>::_isTraced( int patch1, int patch2 ) const {
+
+    const auto it = _marks.find( patch1 );
+    if( it == _marks.end() ) return false;
+
+    for( const Mark& m : it->second )
+      if( m.patch2 == patch2 ) return true;
+    return false;
+  }
+
+
+  // Is there a curve point closer than a step, in the neighbour patches on the first surface?
+  template <typename T>
+  bool PSurfIntersection<T>::_isTraced( const Vector<T,4>& x, const Point<T,3>& p ) const {
+
+    const PSurfPatchBvh<T>& bvh = _bvh[0];
+    int i, j;
+    bvh.getPatch( x(0), x(1), i, j );
+
+    for( int di = -1; di <= 1; di++ )
+      for( int dj = -1; dj <= 1; dj++ ) {
+
+        int k = i + di, l = j + dj;
+        if( bvh.isClosedU() ) k = (k + bvh.getNoPatchesU()) % bvh.getNoPatchesU();
+        if( bvh.isClosedV() ) l = (l + bvh.getNoPatchesV()) % bvh.getNoPatchesV();
+        if( k < 0 || l < 0 || k >= bvh.getNoPatchesU() || l >= bvh.getNoPatchesV() ) continue;
+
+        const auto it = _marks.find( bvh.getPatchIndex( k, l ) );
+        if( it == _marks.end() ) continue;
+        for( const Mark& m : it->second )
+          if( (m.p - p).getLength() < _h_max ) return true;
+      }
+    return false;
+  }
+
+
+  template <typename T>
+  void PSurfIntersection<T>::_mark( const Curve& c ) {
+
+    for( std::size_t k = 0; k < c.p.size(); k++ ) {
+      int i1, j1, i2, j2;
+      _bvh[0].getPatch( c.uv1[k](0), c.uv1[k](1), i1, j1 );
+      _bvh[1].getPatch( c.uv2[k](0), c.uv2[k](1), i2, j2 );
+
+      Mark m;
+      m.patch2 = _bvh[1].getPatchIndex( i2, j2 );
+      m.p      = c.p[k];
+      _marks[ _bvh[0].getPatchIndex( i1, j1 ) ].push_back( m );
+    }
+  }
+
+
+
+  //**********************
+  //   Curve marching   **
+  //**********************
+
+
+  template <typename T>
+  void PSurfIntersection<T>::_trace( const Vector<T,4>& x0 ) {
+
+    Vector<T,3> t;
+    if( !_tangent( x0, t ) ) return;  // The surfaces are tangential
+
+    Point<T,3>  p[2];
+    Vector<T,3> d[2][2];
+    _evaluate( x0, p, d );
+
+    Curve fw;
+    fw.closed = false;
+    _push( fw, x0, p[0] );
+
+    bool closed;
+    _march( x0, t, fw, closed );
+
+    if( closed ) {
+      fw.uv1.push_back( fw.uv1.front() );
+      fw.uv2.push_back( fw.uv2.front() );
+      fw.p.push_back( fw.p.front() );
+      fw.closed = true;
+    }
+    else {
+      Curve bw;
+      _push( bw, x0, p[0] );
+      _march( x0, -t, bw, closed );
+
+      // The backward half reversed, then the forward half
+      Curve c;
+      c.closed = false;
+      for( std::size_t k = bw.p.size()-1; k > 0; k-- ) {
+        c.uv1.push_back( bw.uv1[k] );
+        c.uv2.push_back( bw.uv2[k] );
+        c.p.push_back( bw.p[k] );
+      }
+      c.uv1.insert( c.uv1.end(), fw.uv1.begin(), fw.uv1.end() );
+      c.uv2.insert( c.uv2.end(), fw.uv2.begin(), fw.uv2.end() );
+      c.p.insert( c.p.end(), fw.p.begin(), fw.p.end() );
+      fw = c;
+    }
+
+    if( fw.p.size() < 2 ) return;  // A single touching point
+
+    _mark( fw );
+    _curves.push_back( fw );
+  }
+
+
+  template <typename T>
+  void PSurfIntersection<T>::_march( Vector<T,4> x, Vector<T,3> t, Curve& c, bool& closed ) const {
+
+    closed = false;
+
+    const Point<T,3> p0    = c.p.front();
+    Point<T,3>       q     = p0;
+    T                h     = _h_max;
+    const T          h_min = _h_max * T(1e-3);
+
+    // Largest turn per step, about 11 degrees, and the turn where the step is made longer
+    const T cos_max  = std::cos( T(0.2) );
+    const T cos_grow = std::cos( T(0.05) );
+
+    Point<T,3>  p[2];
+    Vector<T,3> d[2][2];
+
+    for( int steps = 0; steps < 100000; steps++ ) {
+
+      Vector<T,4> xn;
+      Vector<T,3> tn;
+      bool        boundary;
+      if( !_step( x, t, h, xn, boundary ) || !_tangent( xn, tn ) ) {
+        if( (h /= 2) < h_min ) return;
+        continue;
+      }
+      if( tn * t < T(0) ) tn = -tn;
+      if( tn * t < cos_max && h > h_min ) {
+        h /= 2;
+        continue;
+      }
+
+      _evaluate( xn, p, d );
+      const Point<T,3> pn = p[0];
+      if( (pn - q).getLength() < _eps_used ) return;  // No progress, e.g. at the boundary
+
+      // Back at the start point
+      if( c.p.size() > 3 && (p0 - q) * t > T(0) ) {
+        const Vector<T,3> s  = pn - q;
+        const T           w  = std::min( std::max( ((p0 - q) * s) / (s * s), T(0) ), T(1) );
+        if( (q + s * w - p0).getLength() < T(0.25) * h ) {
+          closed = true;
+          return;
+        }
+      }
+
+      _push( c, xn, pn );
+      if( boundary ) return;
+
+      if( tn * t > cos_grow ) h = std::min( T(1.5) * h, _h_max );
+      x = xn;
+      t = tn;
+      q = pn;
+    }
+  }
+
+
+  // One step of length h along t, then back onto both surfaces.
+  // Stops at the boundary of a domain which is not closed.
+  template <typename T>
+  bool PSurfIntersection<T>::_step( const Vector<T,4>& x, const Vector<T,3>& t, T h,
+                                    Vector<T,4>& xn, bool& boundary ) const {
+
+    Point<T,3>  p[2];
+    Vector<T,3> d[2][2];
+    _evaluate( x, p, d );
+
+    // The parameter steps giving h*t on each surface (least squares)
+    Vector<T,4> dx;
+    for( int s = 0; s < 2; s++ ) {
+      const T E = d[s][0] * d[s][0];
+      const T F = d[s][0] * d[s][1];
+      const T G = d[s][1] * d[s][1];
+      const T a = h * (d[s][0] * t);
+      const T b = h * (d[s][1] * t);
+      const T det = E*G - F*F;
+      if( det <= T(0) ) return false;
+      dx[2*s]   = (G*a - F*b) / det;
+      dx[2*s+1] = (E*b - F*a) / det;
+    }
+
+    T   frac  = T(1);
+    int fixed = -1;
+    T   fixed_value = T(0);
+    for( int k = 0; k < 4; k++ ) {
+      if( _closed(k) ) continue;
+      const T y = x(k) + dx(k);
+      if( y < _start(k) && dx(k) < T(0) && (_start(k) - x(k)) / dx(k) < frac ) {
+        frac  = std::max( (_start(k) - x(k)) / dx(k), T(0) );
+        fixed = k;
+        fixed_value = _start(k);
+      }
+      if( y > _end(k) && dx(k) > T(0) && (_end(k) - x(k)) / dx(k) < frac ) {
+        frac  = std::max( (_end(k) - x(k)) / dx(k), T(0) );
+        fixed = k;
+        fixed_value = _end(k);
+      }
+    }
+
+    boundary = fixed >= 0;
+    xn = x + dx * frac;
+    if( !_wrap( xn, T(0) ) ) return false;
+    return _correct( xn, p[0], t, h * frac, fixed, fixed_value );
+  }
+
+
+  // Newton iteration onto both surfaces, in the plane at distance h along t from q,
+  // or with the parameter "fixed" set to fixed_value (at the boundary)
+  template <typename T>
+  bool PSurfIntersection<T>::_correct( Vector<T,4>& x, const Point<T,3>& q, const Vector<T,3>& t, T h,
+                                       int fixed, T fixed_value ) const {
+
+    Point<T,3>  p[2];
+    Vector<T,3> d[2][2];
+
+    for( int it = 0; it < 12; it++ ) {
+
+      _evaluate( x, p, d );
+      const Vector<T,3> f = p[0] - p[1];
+
+      T a[16], b[4];
+      for( int r = 0; r < 3; r++ ) {
+        a[r*4+0] =  d[0][0](r);
+        a[r*4+1] =  d[0][1](r);
+        a[r*4+2] = -d[1][0](r);
+        a[r*4+3] = -d[1][1](r);
+        b[r]     = -f(r);
+      }
+      if( fixed >= 0 ) {
+        for( int k = 0; k < 4; k++ ) a[12+k] = k == fixed ? T(1) : T(0);
+        b[3] = fixed_value - x(fixed);
+      }
+      else {
+        a[12] = t * d[0][0];
+        a[13] = t * d[0][1];
+        a[14] = a[15] = T(0);
+        b[3]  = h - t * (p[0] - q);
+      }
+
+      if( f.getLength() < _eps_used && std::abs( b[3] ) < _eps_used ) return true;
+
+      if( !_solve( a, b, 4 ) ) return false;
+      for( int k = 0; k < 4; k++ ) x[k] += b[k];
+      if( !_wrap( x, T(0.01) ) ) return false;
+    }
+    return false;
+  }
+
+
+  template <typename T>
+  bool PSurfIntersection<T>::_tangent( const Vector<T,4>& x, Vector<T,3>& t ) const {
+
+    Point<T,3>  p[2];
+    Vector<T,3> d[2][2];
+    _evaluate( x, p, d );
+
+    const Vector<T,3> n1 = d[0][0] ^ d[0][1];
+    const Vector<T,3> n2 = d[1][0] ^ d[1][1];
+    t = n1 ^ n2;
+
+    const T l = t.getLength();
+    if( l <= T(1e-6) * n1.getLength() * n2.getLength() ) return false;
+    t = t * (T(1) / l);
+    return true;
+  }
+
+
+  template <typename T>
+  inline
+  void PSurfIntersection<T>::_evaluate( const Vector<T,4>& x, Point<T,3> p[2], Vector<T,3> d[2][2] ) const {
+
+    for( int s = 0; s < 2; s++ ) {
+      const SmallMatrix<Vector<T,3>,4,4> e = _s[s]->evaluateGlobalSmall( x(2*s), x(2*s+1), 1, 1 );
+      p[s]    = e(0)(0);
+      d[s][0] = e(1)(0);
+      d[s][1] = e(0)(1);
+    }
+  }
+
+
+  template <typename T>
+  inline
+  void PSurfIntersection<T>::_push( Curve& c, const Vector<T,4>& x, const Point<T,3>& p ) const {
+
+    c.uv1.push_back( Point<T,2>( x(0), x(1) ) );
+    c.uv2.push_back( Point<T,2>( x(2), x(3) ) );
+    c.p.push_back( p );
+  }
+
+
+  // The parameters are (u1,v1,u2,v2)
+  template <typename T>
+  inline
+  T PSurfIntersection<T>::_start( int k ) const {
+
+    return k % 2 == 0 ? _s[k/2]->getParStartU() : _s[k/2]->getParStartV();
+  }
+
+
+  template <typename T>
+  inline
+  T PSurfIntersection<T>::_end( int k ) const {
+
+    return k % 2 == 0 ? _s[k/2]->getParEndU() : _s[k/2]->getParEndV();
+  }
+
+
+  template <typename T>
+  inline
+  bool PSurfIntersection<T>::_closed( int k ) const {
+
+    return k % 2 == 0 ? _s[k/2]->isClosedU() : _s[k/2]->isClosedV();
+  }
+
+
+  // Periodic parameters are moved into the domain, the others are clamped,
+  // fails if they are more than slack times the domain outside
+  template <typename T>
+  bool PSurfIntersection<T>::_wrap( Vector<T,4>& x, T slack ) const {
+
+    for( int k = 0; k < 4; k++ ) {
+
+      if( !std::isfinite( x(k) ) ) return false;
+
+      const T s = _start(k);
+      const T e = _end(k);
+      if( _closed(k) ) {
+        x[k] = s + std::fmod( x(k) - s, e - s );
+        if( x(k) < s ) x[k] += e - s;
+      }
+      else {
+        if( x(k) < s - slack * (e - s) || x(k) > e + slack * (e - s) ) return false;
+        x[k] = std::min( std::max( x(k), s ), e );
+      }
+    }
+    return true;
+  }
+
+
+  // Gaussian elimination with partial pivoting, the solution is returned in b
+  template <typename T>
+  bool PSurfIntersection<T>::_solve( T* a, T* b, int n ) {
+
+    T scale = T(0);
+    for( int k = 0; k < n*n; k++ ) scale = std::max( scale, std::abs( a[k] ) );
+    const T tiny = scale * std::numeric_limits<T>::epsilon();
+
+    for( int c = 0; c < n; c++ ) {
+
+      int piv = c;
+      for( int r = c+1; r < n; r++ )
+        if( std::abs( a[r*n+c] ) > std::abs( a[piv*n+c] ) ) piv = r;
+      if( !(std::abs( a[piv*n+c] ) > tiny) ) return false;
+
+      if( piv != c ) {
+        for( int k = 0; k < n; k++ ) std::swap( a[c*n+k], a[piv*n+k] );
+        std::swap( b[c], b[piv] );
+      }
+
+      for( int r = c+1; r < n; r++ ) {
+        const T f = a[r*n+c] / a[c*n+c];
+        for( int k = c; k < n; k++ ) a[r*n+k] -= f * a[c*n+k];
+        b[r] -= f * b[c];
+      }
+    }
+
+    for( int r = n-1; r >= 0; r-- ) {
+      for( int k = r+1; k < n; k++ ) b[r] -= a[r*n+k] * b[k];
+      b[r] /= a[r*n+r];
+    }
+    return true;
+  }
+
+
+} // END namespace GMlib
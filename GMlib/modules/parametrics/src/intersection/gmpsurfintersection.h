@@ -0,0 +1,150 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 - 2017 University of Tromsø - The Arctic University of Norway
+** Contact: GMlib Online Portal at https://source.uit.no/gmlib/gmlib/wikis/home
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_PARAMETRICS_INTERSECTION_PSURFINTERSECTION_H
+#define GM_PARAMETRICS_INTERSECTION_PSURFINTERSECTION_H
+
+
+#include "gmpsurfpatchbvh.h"
+
+// gmlib
+#include <core/types/gmpoint.h>
+
+// stl
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace GMlib {
+
+  template <typename T, int n>
+  class PSurf;
+
+  template <typename T>
+  class PSurfCurve;
+
+
+
+  /*! \class PSurfIntersection gmpsurfintersection.h <gmPSurfIntersection>
+   *  \brief Intersection curves of two surfaces
+   *
+   *  Both surfaces get a PSurfPatchBvh, and the pairs of patches with overlapping
+   *  boxes are found by traversing the two hierarchies together; the upper levels
+   *  are split in pairs of subtrees which are traversed in parallel. From each
+   *  remaining patch pair not already passed by a curve, a point on both surfaces
+   *  is found by Newton iteration, and the curve through it is traced in both
+   *  directions by stepping along the tangent N1 x N2 and correcting back onto
+   *  both surfaces by Newton iteration, until it leaves a parameter domain, comes
+   *  back to its start (closed curve), or the surfaces are tangential.
+   *
+   *  The curves are given as parameter polylines on each of the surfaces, a
+   *  segment between two following parameter points is what a PSurfCurve draws,
+   *  see makePSurfCurves(). All positions are global (scene) coordinates.
+   *
+   *  The surfaces are evaluated from one thread only, they are not thread safe.
+   */
+  template <typename T>
+  class PSurfIntersection {
+  public:
+    struct Curve {
+      std::vector<Point<T,2>>   uv1;      //!< Parameter polyline on the first surface
+      std::vector<Point<T,2>>   uv2;      //!< Parameter polyline on the second surface
+      std::vector<Point<T,3>>   p;        //!< The points, in global coordinates
+      bool                      closed;   //!< The last point is a copy of the first
+    };
+
+    PSurfIntersection( PSurf<T,3>* s1, PSurf<T,3>* s2, int m1 = 32, int m2 = 32 );
+
+    int                         compute();
+
+    int                         getNoCurves() const;
+    const Curve&                getCurve( int i ) const;
+    int                         getNoCandidates() const;
+    const PSurfPatchBvh<T>&     getBvh( int surf ) const;
+
+    std::vector<PSurfCurve<T>*> makePSurfCurves( int i, int surf ) const;
+
+    void                        setSamples( int m1, int m2 );
+    void                        setTolerance( T eps );
+    T                           getTolerance() const;
+    void                        setStepLength( T step );
+    T                           getStepLength() const;
+
+  protected:
+    PSurf<T,3>*                 _s[2];
+    PSurfPatchBvh<T>            _bvh[2];
+    int                         _m1, _m2;
+
+    T                           _eps;           // Distance tolerance, 0 means relative to the size
+    T                           _step_length;   // Largest step, 0 means relative to the patch size
+    T                           _eps_used;
+    T                           _h_max;
+
+    std::vector<Curve>          _curves;
+    std::vector<std::pair<int,int>>  _candidates;
+
+    // Points of the curves by the patch on the first surface, for finding curves already traced
+    struct Mark {
+      int           patch2;
+      Point<T,3>    p;
+    };
+    std::unordered_map<int, std::vector<Mark>>  _marks;
+
+    void                        _prune();
+    void                        _collect( int a, int b, std::vector<std::pair<int,int>>& out ) const;
+    bool                        _split( int a, int b, std::vector<std::pair<int,int>>& out ) const;
+
+    bool                        _seed( Vector<T,4>& x ) const;
+    bool                        _isTraced( const Vector<T,4>& x, const Point<T,3>& p ) const;
+    bool                        _isTraced( int patch1, int patch2 ) const;
+    void                        _mark( const Curve& c );
+
+    void                        _trace( const Vector<T,4>& x0 );
+    void                        _march( Vector<T,4> x, Vector<T,3> t, Curve& c, bool& closed ) const;
+    bool                        _step( const Vector<T,4>& x, const Vector<T,3>& t, T h,
+                                       Vector<T,4>& xn, bool& boundary ) const;
+    bool                        _correct( Vector<T,4>& x, const Point<T,3>& q, const Vector<T,3>& t, T h,
+                                          int fixed, T fixed_value ) const;
+    bool                        _tangent( const Vector<T,4>& x, Vector<T,3>& t ) const;
+    void                        _evaluate( const Vector<T,4>& x, Point<T,3> p[2], Vector<T,3> d[2][2] ) const;
+    void                        _push( Curve& c, const Vector<T,4>& x, const Point<T,3>& p ) const;
+
+    T                           _start( int k ) const;
+    T                           _end( int k ) const;
+    bool                        _closed( int k ) const;
+    bool                        _wrap( Vector<T,4>& x, T slack ) const;
+
+    static bool                 _solve( T* a, T* b, int n );
+
+  }; // END class PSurfIntersection
+
+
+} // END namespace GMlib
+
+// Include PSurfIntersection class function implementations
+#include "gmpsurfintersection.c"
+
+
+#endif // GM_PARAMETRICS_INTERSECTION_PSURFINTERSECTION_H
@@ -0,0 +1,279 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 - 2017 University of Tromsø - The Arctic University of Norway
+** Contact: GMlib Online Portal at https://source.uit.no/gmlib/gmlib/wikis/home
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+
+
+#include "../gmpsurf.h"
+
+// stl
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace GMlib {
+
+
+  template <typename T>
+  inline
+  PSurfPatchBvh<T>::PSurfPatchBvh()
+    : _m1(0), _m2(0), _su(0), _sv(0), _du(1), _dv(1), _cu(false), _cv(false), _size(0) {}
+
+
+  template <typename T>
+  inline
+  PSurfPatchBvh<T>::PSurfPatchBvh( const PSurf<T,3>& s, int m1, int m2 )
+    : PSurfPatchBvh<T>() {
+
+    build( s, m1, m2 );
+  }
+
+
+  /*! void PSurfPatchBvh<T>::build( const PSurf<T,3>& s, int m1, int m2 )
+   *  \brief Samples the surface and makes the hierarchy
+   *
+   *  \param[in] s   The surface
+   *  \param[in] m1  Number of patches in u-direction
+   *  \param[in] m2  Number of patches in v-direction
+   */
+  template <typename T>
+  void PSurfPatchBvh<T>::build( const PSurf<T,3>& s, int m1, int m2 ) {
+
+    _m1 = std::max( m1, 1 );
+    _m2 = std::max( m2, 1 );
+    _su = s.getParStartU();
+    _sv = s.getParStartV();
+    _du = s.getParDeltaU() / _m1;
+    _dv = s.getParDeltaV() / _m2;
+    _cu = s.isClosedU();
+    _cv = s.isClosedV();
+
+    // The surface is evaluated at half the patch size
+    _p.setDim( 2*_m1+1, 2*_m2+1 );
+    for( int i = 0; i <= 2*_m1; i++ ) {
+      const T u = i < 2*_m1 ? _su + i * _du / 2 : s.getParEndU();
+      for( int j = 0; j <= 2*_m2; j++ ) {
+        const T v = j < 2*_m2 ? _sv + j * _dv / 2 : s.getParEndV();
+        _p[i][j] = s.evaluateGlobalSmall( u, v, 0, 0 )(0)(0);
+      }
+    }
+
+    _nodes.clear();
+    _nodes.reserve( 2 * _m1 * _m2 );
+    _size = T(0);
+    _build( 0, _m1, 0, _m2 );
+    _size /= T(_m1 * _m2);
+  }
+
+
+  template <typename T>
+  inline
+  int PSurfPatchBvh<T>::getNoNodes() const {
+
+    return int(_nodes.size());
+  }
+
+
+  template <typename T>
+  inline
+  const typename PSurfPatchBvh<T>::Node& PSurfPatchBvh<T>::getNode( int k ) const {
+
+    return _nodes[k];
+  }
+
+
+  template <typename T>
+  inline
+  int PSurfPatchBvh<T>::getNoPatchesU() const {
+
+    return _m1;
+  }
+
+
+  template <typename T>
+  inline
+  int PSurfPatchBvh<T>::getNoPatchesV() const {
+
+    return _m2;
+  }
+
+
+  template <typename T>
+  inline
+  int PSurfPatchBvh<T>::getPatchIndex( int i, int j ) const {
+
+    return i * _m2 + j;
+  }
+
+
+  /*! void PSurfPatchBvh<T>::getPatch( T u, T v, int& i, int& j ) const
+   *  \brief The patch holding the parameter (u,v), clamped to the domain
+   */
+  template <typename T>
+  inline
+  void PSurfPatchBvh<T>::getPatch( T u, T v, int& i, int& j ) const {
+
+    i = std::min( std::max( int( std::floor( (u - _su) / _du ) ), 0 ), _m1-1 );
+    j = std::min( std::max( int( std::floor( (v - _sv) / _dv ) ), 0 ), _m2-1 );
+  }
+
+
+  template <typename T>
+  inline
+  Point<T,2> PSurfPatchBvh<T>::getPatchCenter( int i, int j ) const {
+
+    return Point<T,2>( _su + (i + T(0.5)) * _du, _sv + (j + T(0.5)) * _dv );
+  }
+
+
+  /*! const Point<T,3>& PSurfPatchBvh<T>::getCorner( int i, int j ) const
+   *  \brief The sample at the patch corner (i,j), 0 <= i <= m1, 0 <= j <= m2
+   */
+  template <typename T>
+  inline
+  const Point<T,3>& PSurfPatchBvh<T>::getCorner( int i, int j ) const {
+
+    return _p(2*i)(2*j);
+  }
+
+
+  /*! T PSurfPatchBvh<T>::getPatchSize() const
+   *  \brief The mean diagonal of the patch boxes
+   */
+  template <typename T>
+  inline
+  T PSurfPatchBvh<T>::getPatchSize() const {
+
+    return _size;
+  }
+
+
+  template <typename T>
+  inline
+  T PSurfPatchBvh<T>::getParStartU() const {
+
+    return _su;
+  }
+
+
+  template <typename T>
+  inline
+  T PSurfPatchBvh<T>::getParStartV() const {
+
+    return _sv;
+  }
+
+
+  template <typename T>
+  inline
+  T PSurfPatchBvh<T>::getParDeltaU() const {
+
+    return _du;
+  }
+
+
+  template <typename T>
+  inline
+  T PSurfPatchBvh<T>::getParDeltaV() const {
+
+    return _dv;
+  }
+
+
+  template <typename T>
+  inline
+  bool PSurfPatchBvh<T>::isClosedU() const {
+
+    return _cu;
+  }
+
+
+  template <typename T>
+  inline
+  bool PSurfPatchBvh<T>::isClosedV() const {
+
+    return _cv;
+  }
+
+
+  template <typename T>
+  int PSurfPatchBvh<T>::_build( int i0, int i1, int j0, int j1 ) {
+
+    const int k = int(_nodes.size());
+    _nodes.push_back( Node() );
+    Node nd;
+    nd.i0 = i0;  nd.i1 = i1;
+    nd.j0 = j0;  nd.j1 = j1;
+
+    if( i1 - i0 == 1 && j1 - j0 == 1 ) {
+      nd.left = nd.right = -1;
+      nd.box  = _leafBox( i0, j0 );
+      _size  += nd.box.getPointDelta().getLength();
+    }
+    else {
+      // Halve the longest index range
+      if( i1 - i0 >= j1 - j0 ) {
+        const int im = (i0 + i1) / 2;
+        nd.left  = _build( i0, im, j0, j1 );
+        nd.right = _build( im, i1, j0, j1 );
+      }
+      else {
+        const int jm = (j0 + j1) / 2;
+        nd.left  = _build( i0, i1, j0, jm );
+        nd.right = _build( i0, i1, jm, j1 );
+      }
+      nd.box = _nodes[nd.left].box;
+      nd.box.insert( _nodes[nd.right].box );
+    }
+
+    _nodes[k] = nd;
+    return k;
+  }
+
+
+  template <typename T>
+  Box<T,3> PSurfPatchBvh<T>::_leafBox( int i, int j ) const {
+
+    const int a = 2*i, b = 2*j;
+
+    Box<T,3> box( _p(a)(b) );
+    for( int k = 0; k < 3; k++ )
+      for( int l = 0; l < 3; l++ )
+        box.insert( _p(a+k)(b+l) );
+
+    // Chord height, the midpoints distance to the chords
+    T h = T(0);
+    for( int k = 0; k < 3; k++ ) {
+      h = std::max( h, ( _p(a+1)(b+k) - (_p(a)(b+k) + _p(a+2)(b+k)) * T(0.5) ).getLength() );
+      h = std::max( h, ( _p(a+k)(b+1) - (_p(a+k)(b) + _p(a+k)(b+2)) * T(0.5) ).getLength() );
+    }
+
+    // The surface may bulge out of the samples by about the chord height,
+    // and some slack is added for flat patches
+    const T e = h + T(1e-4) * box.getPointDelta().getLength() + std::numeric_limits<T>::epsilon();
+    return Box<T,3>( box.getPointMin() - Vector<T,3>(e), box.getPointMax() + Vector<T,3>(e) );
+  }
+
+
+} // END namespace GMlib
@@ -0,0 +1,113 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 - 2017 University of Tromsø - The Arctic University of Norway
+** Contact: GMlib Online Portal at https://source.uit.no/gmlib/gmlib/wikis/home
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_PARAMETRICS_INTERSECTION_PSURFPATCHBVH_H
+#define GM_PARAMETRICS_INTERSECTION_PSURFPATCHBVH_H
+
+
+// gmlib
+#include <core/types/gmpoint.h>
+#include <core/containers/gmdmatrix.h>
+
+// stl
+#include <vector>
+
+
+namespace GMlib {
+
+  template <typename T, int n>
+  class PSurf;
+
+
+
+  /*! \class PSurfPatchBvh gmpsurfpatchbvh.h <gmPSurfPatchBvh>
+   *  \brief Bounding volume hierarchy over the (u,v) sample patches of a surface
+   *
+   *  The parameter domain is split in m1 x m2 equal patches. Each patch is sampled
+   *  at its corners, edge midpoints and center (in global coordinates, see
+   *  PSurf::evaluateGlobalSmall()), and gets a box around the samples, enlarged by
+   *  the estimated chord height. The tree is made by halving the index ranges,
+   *  the node 0 is the root and the leaves hold a single patch.
+   *
+   *  The hierarchy is a snapshot, it has to be built again when the surface
+   *  (or its position in the scene) is changed.
+   */
+  template <typename T>
+  class PSurfPatchBvh {
+  public:
+    struct Node {
+      Box<T,3>    box;
+      int         left, right;    //!< Child nodes, -1 in the leaves
+      int         i0, i1;         //!< Patches [i0,i1) in u-direction below the node
+      int         j0, j1;         //!< Patches [j0,j1) in v-direction below the node
+
+      bool        isLeaf() const { return left < 0; }
+    };
+
+    PSurfPatchBvh();
+    PSurfPatchBvh( const PSurf<T,3>& s, int m1, int m2 );
+
+    void                build( const PSurf<T,3>& s, int m1, int m2 );
+
+    int                 getNoNodes() const;
+    const Node&         getNode( int k ) const;
+
+    int                 getNoPatchesU() const;
+    int                 getNoPatchesV() const;
+    int                 getPatchIndex( int i, int j ) const;
+    void                getPatch( T u, T v, int& i, int& j ) const;
+    Point<T,2>          getPatchCenter( int i, int j ) const;
+    const Point<T,3>&   getCorner( int i, int j ) const;
+    T                   getPatchSize() const;
+
+    T                   getParStartU() const;
+    T                   getParStartV() const;
+    T                   getParDeltaU() const;
+    T                   getParDeltaV() const;
+    bool                isClosedU() const;
+    bool                isClosedV() const;
+
+  private:
+    std::vector<Node>   _nodes;
+    DMatrix<Point<T,3>> _p;         // Samples at half the patch size, (2m1+1) x (2m2+1)
+
+    int                 _m1, _m2;
+    T                   _su, _sv;   // Start of the parameter domain
+    T                   _du, _dv;   // Parameter size of the patches
+    bool                _cu, _cv;   // Closed in u/v-direction
+    T                   _size;      // Mean diagonal of the leaf boxes
+
+    int                 _build( int i0, int i1, int j0, int j1 );
+    Box<T,3>            _leafBox( int i, int j ) const;
+
+  }; // END class PSurfPatchBvh
+
+
+} // END namespace GMlib
+
+// Include PSurfPatchBvh class function implementations
+#include "gmpsurfpatchbvh.c"
+
+
+#endif // GM_PARAMETRICS_INTERSECTION_PSURFPATCHBVH_H
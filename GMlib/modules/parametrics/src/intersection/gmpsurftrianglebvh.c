@@ -0,0 +1,378 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 - 2017 University of Tromsø - The Arctic University of Norway
+** Contact: GMlib Online Portal at https://source.uit.no/gmlib/gmlib/wikis/home
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+// stl
+#include <algorithm>
+#include <cmath>
+
+
+namespace GMlib {
+
+
+  template <typename T>
+  inline
+  PSurfTriangleBvh<T>::PSurfTriangleBvh()
+    : _m1(0), _m2(0), _su(0), _sv(0), _du(1), _dv(1), _size(0) {}
+
+
+  template <typename T>
+  inline
+  PSurfTriangleBvh<T>::PSurfTriangleBvh( const DMatrix<Point<T,3>>& p, T su, T eu, T sv, T ev )
+    : PSurfTriangleBvh<T>() {
+
+    build( p, su, eu, sv, ev );
+  }
+
+
+  /*! void PSurfTriangleBvh<T>::build( const DMatrix<Point<T,3>>& p, T su, T eu, T sv, T ev )
+   *  \brief Makes the hierarchy over a sample grid
+   *
+   *  \param[in] p   The sample positions, at least 2 x 2
+   *  \param[in] su  Parameter value of the first row (u-direction)
+   *  \param[in] eu  Parameter value of the last row
+   *  \param[in] sv  Parameter value of the first column (v-direction)
+   *  \param[in] ev  Parameter value of the last column
+   */
+  template <typename T>
+  void PSurfTriangleBvh<T>::build( const DMatrix<Point<T,3>>& p, T su, T eu, T sv, T ev ) {
+
+    clear();
+    if( p.getDim1() < 2 || p.getDim2() < 2 ) return;
+
+    _p  = p;
+    _m1 = p.getDim1() - 1;
+    _m2 = p.getDim2() - 1;
+    _su = su;
+    _sv = sv;
+    _du = (eu - su) / _m1;
+    _dv = (ev - sv) / _m2;
+
+    _nodes.reserve( 2 * _m1 * _m2 );
+    _build( 0, _m1, 0, _m2 );
+  }
+
+
+  template <typename T>
+  void PSurfTriangleBvh<T>::clear() {
+
+    _nodes.clear();
+    _p.resetDim( 0, 0 );
+    _m1 = _m2 = 0;
+    _size = T(0);
+  }
+
+
+  template <typename T>
+  inline
+  bool PSurfTriangleBvh<T>::isEmpty() const {
+
+    return _nodes.empty();
+  }
+
+
+  /*! bool PSurfTriangleBvh<T>::intersect( const Point<T,3>& o, const Vector<T,3>& d, Hit& hit, T t_max ) const
+   *  \brief The nearest triangle hit by the ray o + t*d, 0 <= t <= t_max
+   *
+   *  The nearest child node is visited first, and nodes further away
+   *  than the nearest hit found so far are skipped.
+   *
+   *  \return true if a triangle is hit
+   */
+  template <typename T>
+  bool PSurfTriangleBvh<T>::intersect( const Point<T,3>& o, const Vector<T,3>& d, Hit& hit, T t_max ) const {
+
+    if( _nodes.empty() ) return false;
+
+    Vector<T,3> inv_d;
+    for( int k = 0; k < 3; k++ ) inv_d[k] = T(1) / d(k);
+
+    bool found = false;
+    T    t0, t1;
+    Hit  cell_hits[2];
+
+    std::vector<int> stack;
+    stack.reserve( 64 );
+    stack.push_back( 0 );
+
+    while( !stack.empty() ) {
+
+      const Node& nd = _nodes[stack.back()];
+      stack.pop_back();
+      if( !_hitBox( nd.box, o, inv_d, t_max, t0 ) ) continue;
+
+      if( nd.isLeaf() ) {
+        const int no = _hitCell( nd.i0, nd.j0, o, d, t_max, cell_hits );
+        for( int k = 0; k < no; k++ )
+          if( cell_hits[k].t <= t_max ) {
+            hit   = cell_hits[k];
+            t_max = hit.t;
+            found = true;
+          }
+        continue;
+      }
+
+      // The nearest child on top of the stack
+      const bool l = _hitBox( _nodes[nd.left].box,  o, inv_d, t_max, t0 );
+      const bool r = _hitBox( _nodes[nd.right].box, o, inv_d, t_max, t1 );
+      if( l && r ) {
+        stack.push_back( t0 <= t1 ? nd.right : nd.left );
+        stack.push_back( t0 <= t1 ? nd.left  : nd.right );
+      }
+      else if( l ) stack.push_back( nd.left );
+      else if( r ) stack.push_back( nd.right );
+    }
+
+    return found;
+  }
+
+
+  /*! int PSurfTriangleBvh<T>::intersectAll( const Point<T,3>& o, const Vector<T,3>& d, std::vector<Hit>& hits, T t_max ) const
+   *  \brief All triangles hit by the ray o + t*d, 0 <= t <= t_max
+   *
+   *  \param[out] hits  The hits, sorted by the ray parameter
+   *  \return The number of hits
+   */
+  template <typename T>
+  int PSurfTriangleBvh<T>::intersectAll( const Point<T,3>& o, const Vector<T,3>& d, std::vector<Hit>& hits, T t_max ) const {
+
+    hits.clear();
+    if( _nodes.empty() ) return 0;
+
+    Vector<T,3> inv_d;
+    for( int k = 0; k < 3; k++ ) inv_d[k] = T(1) / d(k);
+
+    T    t0;
+    Hit  cell_hits[2];
+
+    std::vector<int> stack;
+    stack.reserve( 64 );
+    stack.push_back( 0 );
+
+    while( !stack.empty() ) {
+
+      const Node& nd = _nodes[stack.back()];
+      stack.pop_back();
+      if( !_hitBox( nd.box, o, inv_d, t_max, t0 ) ) continue;
+
+      if( nd.isLeaf() ) {
+        const int no = _hitCell( nd.i0, nd.j0, o, d, t_max, cell_hits );
+        hits.insert( hits.end(), cell_hits, cell_hits + no );
+      }
+      else {
+        stack.push_back( nd.right );
+        stack.push_back( nd.left );
+      }
+    }
+
+    std::sort( hits.begin(), hits.end(), []( const Hit& a, const Hit& b ) { return a.t < b.t; } );
+    return int(hits.size());
+  }
+
+
+  template <typename T>
+  inline
+  int PSurfTriangleBvh<T>::getNoNodes() const {
+
+    return int(_nodes.size());
+  }
+
+
+  template <typename T>
+  inline
+  const typename PSurfTriangleBvh<T>::Node& PSurfTriangleBvh<T>::getNode( int k ) const {
+
+    return _nodes[k];
+  }
+
+
+  /*! const Box<T,3>& PSurfTriangleBvh<T>::getBox() const
+   *  \brief The box around all the samples (the root node), the hierarchy must not be empty
+   */
+  template <typename T>
+  inline
+  const Box<T,3>& PSurfTriangleBvh<T>::getBox() const {
+
+    return _nodes[0].box;
+  }
+
+
+  template <typename T>
+  inline
+  int PSurfTriangleBvh<T>::getNoCellsU() const {
+
+    return _m1;
+  }
+
+
+  template <typename T>
+  inline
+  int PSurfTriangleBvh<T>::getNoCellsV() const {
+
+    return _m2;
+  }
+
+
+  /*! const Point<T,3>& PSurfTriangleBvh<T>::getSample( int i, int j ) const
+   *  \brief The sample (i,j), 0 <= i <= getNoCellsU(), 0 <= j <= getNoCellsV()
+   */
+  template <typename T>
+  inline
+  const Point<T,3>& PSurfTriangleBvh<T>::getSample( int i, int j ) const {
+
+    return _p(i)(j);
+  }
+
+
+  /*! T PSurfTriangleBvh<T>::getCellSize() const
+   *  \brief The largest diagonal of the cell boxes
+   */
+  template <typename T>
+  inline
+  T PSurfTriangleBvh<T>::getCellSize() const {
+
+    return _size;
+  }
+
+
+  template <typename T>
+  int PSurfTriangleBvh<T>::_build( int i0, int i1, int j0, int j1 ) {
+
+    const int k = int(_nodes.size());
+    _nodes.push_back( Node() );
+    Node nd;
+    nd.i0 = i0;  nd.i1 = i1;
+    nd.j0 = j0;  nd.j1 = j1;
+
+    if( i1 - i0 == 1 && j1 - j0 == 1 ) {
+      nd.left = nd.right = -1;
+      nd.box  = _leafBox( i0, j0 );
+      _size   = std::max( _size, nd.box.getPointDelta().getLength() );
+    }
+    else {
+      // Halve the longest index range
+      if( i1 - i0 >= j1 - j0 ) {
+        const int im = (i0 + i1) / 2;
+        nd.left  = _build( i0, im, j0, j1 );
+        nd.right = _build( im, i1, j0, j1 );
+      }
+      else {
+        const int jm = (j0 + j1) / 2;
+        nd.left  = _build( i0, i1, j0, jm );
+        nd.right = _build( i0, i1, jm, j1 );
+      }
+      nd.box = _nodes[nd.left].box;
+      nd.box.insert( _nodes[nd.right].box );
+    }
+
+    _nodes[k] = nd;
+    return k;
+  }
+
+
+  template <typename T>
+  Box<T,3> PSurfTriangleBvh<T>::_leafBox( int i, int j ) const {
+
+    Box<T,3> box( _p(i)(j) );
+    box.insert( _p(i+1)(j) );
+    box.insert( _p(i)(j+1) );
+    box.insert( _p(i+1)(j+1) );
+
+    // A little thickness, so flat cells (e.g. in a plane) do not get lost in the slab test
+    const T eps = T(1e-4) * box.getPointDelta().getLength() + std::numeric_limits<T>::min();
+    const Vector<T,3> pad( eps, eps, eps );
+    return Box<T,3>( box.getPointMin() - pad, box.getPointMax() + pad );
+  }
+
+
+  /*! The slab test, t_enter is where the ray enters the box (clamped to 0) */
+  template <typename T>
+  inline
+  bool PSurfTriangleBvh<T>::_hitBox( const Box<T,3>& box, const Point<T,3>& o, const Vector<T,3>& inv_d,
+                                     T t_max, T& t_enter ) const {
+
+    const Point<T,3> p0 = box.getPointMin();
+    const Point<T,3> p1 = box.getPointMax();
+
+    T t0 = T(0), t1 = t_max;
+    for( int k = 0; k < 3; k++ ) {
+      T a = (p0(k) - o(k)) * inv_d(k);
+      T b = (p1(k) - o(k)) * inv_d(k);
+      if( a > b ) std::swap( a, b );
+      // NaN (zero direction on the slab border) does not cut the interval
+      if( a > t0 ) t0 = a;
+      if( b < t1 ) t1 = b;
+      if( t0 > t1 ) return false;
+    }
+    t_enter = t0;
+    return true;
+  }
+
+
+  /*! The two triangles of the cell (i,j), Möller-Trumbore */
+  template <typename T>
+  int PSurfTriangleBvh<T>::_hitCell( int i, int j, const Point<T,3>& o, const Vector<T,3>& d,
+                                     T t_max, Hit* hits ) const {
+
+    const Point<T,3>& p00 = _p(i)(j);
+    const Point<T,3>& p10 = _p(i+1)(j);
+    const Point<T,3>& p01 = _p(i)(j+1);
+    const Point<T,3>& p11 = _p(i+1)(j+1);
+
+    // The triangles (p00,p10,p11) and (p00,p11,p01), as p00 + a*e1 + b*e2
+    const Vector<T,3> e[2][2] = { { p10 - p00, p11 - p00 }, { p11 - p00, p01 - p00 } };
+    const Vector<T,3> s = o - p00;
+
+    int no = 0;
+    for( int k = 0; k < 2; k++ ) {
+
+      const Vector<T,3> q   = d ^ e[k][1];
+      const T           det = e[k][0] * q;
+      if( std::abs(det) <= std::numeric_limits<T>::min() ) continue;
+
+      const T f = T(1) / det;
+      const T a = f * (s * q);
+      if( a < T(0) || a > T(1) ) continue;
+
+      const Vector<T,3> r = s ^ e[k][0];
+      const T b = f * (d * r);
+      if( b < T(0) || a + b > T(1) ) continue;
+
+      const T t = f * (e[k][1] * r);
+      if( t < T(0) || t > t_max ) continue;
+
+      // Barycentric to cell coordinates
+      const T cu = k == 0 ? a + b : a;
+      const T cv = k == 0 ? b     : a + b;
+
+      Hit& h = hits[no++];
+      h.t  = t;
+      h.uv = Point<T,2>( _su + (i + cu) * _du, _sv + (j + cv) * _dv );
+      h.i  = i;
+      h.j  = j;
+    }
+    return no;
+  }
+
+
+} // END namespace GMlib
@@ -0,0 +1,120 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 - 2017 University of Tromsø - The Arctic University of Norway
+** Contact: GMlib Online Portal at https://source.uit.no/gmlib/gmlib/wikis/home
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_PARAMETRICS_INTERSECTION_PSURFTRIANGLEBVH_H
+#define GM_PARAMETRICS_INTERSECTION_PSURFTRIANGLEBVH_H
+
+
+// gmlib
+#include <core/types/gmpoint.h>
+#include <core/containers/gmdmatrix.h>
+
+// stl
+#include <limits>
+#include <vector>
+
+
+namespace GMlib {
+
+
+
+  /*! \class PSurfTriangleBvh gmpsurftrianglebvh.h <gmPSurfTriangleBvh>
+   *  \brief Bounding volume hierarchy over the triangles of a surface sample grid
+   *
+   *  Made from a m1 x m2 grid of sample positions (e.g. the samples of the last
+   *  replot, see PSurf::intersectRay()), with uniform parameter values over the
+   *  domain [su,eu] x [sv,ev]. Each grid cell is split in two triangles along
+   *  the diagonal (i,j)-(i+1,j+1). The tree is made by halving the index ranges,
+   *  the node 0 is the root and the leaves hold a single cell.
+   *
+   *  Ray hits are given with the ray parameter and the (u,v) parameter values
+   *  interpolated over the triangle, i.e. a start value for Newton iteration on
+   *  the true surface. The hierarchy is not changed by the queries, so several
+   *  threads can query it at the same time.
+   */
+  template <typename T>
+  class PSurfTriangleBvh {
+  public:
+    struct Node {
+      Box<T,3>    box;
+      int         left, right;    //!< Child nodes, -1 in the leaves
+      int         i0, i1;         //!< Cells [i0,i1) in u-direction below the node
+      int         j0, j1;         //!< Cells [j0,j1) in v-direction below the node
+
+      bool        isLeaf() const { return left < 0; }
+    };
+
+    struct Hit {
+      T           t;              //!< Ray parameter, the hit is at o + t*d
+      Point<T,2>  uv;             //!< Interpolated parameter values
+      int         i, j;           //!< The cell
+    };
+
+    PSurfTriangleBvh();
+    PSurfTriangleBvh( const DMatrix<Point<T,3>>& p, T su, T eu, T sv, T ev );
+
+    void                build( const DMatrix<Point<T,3>>& p, T su, T eu, T sv, T ev );
+    void                clear();
+    bool                isEmpty() const;
+
+    bool                intersect( const Point<T,3>& o, const Vector<T,3>& d, Hit& hit,
+                                   T t_max = std::numeric_limits<T>::max() ) const;
+    int                 intersectAll( const Point<T,3>& o, const Vector<T,3>& d, std::vector<Hit>& hits,
+                                      T t_max = std::numeric_limits<T>::max() ) const;
+
+    int                 getNoNodes() const;
+    const Node&         getNode( int k ) const;
+    const Box<T,3>&     getBox() const;
+
+    int                 getNoCellsU() const;
+    int                 getNoCellsV() const;
+    const Point<T,3>&   getSample( int i, int j ) const;
+    T                   getCellSize() const;
+
+  private:
+    std::vector<Node>   _nodes;
+    DMatrix<Point<T,3>> _p;         // The sample positions
+
+    int                 _m1, _m2;   // Number of cells
+    T                   _su, _sv;   // Start of the parameter domain
+    T                   _du, _dv;   // Parameter size of the cells
+    T                   _size;      // Largest diagonal of the leaf boxes
+
+    int                 _build( int i0, int i1, int j0, int j1 );
+    Box<T,3>            _leafBox( int i, int j ) const;
+    bool                _hitBox( const Box<T,3>& box, const Point<T,3>& o, const Vector<T,3>& inv_d,
+                                 T t_max, T& t_enter ) const;
+    int                 _hitCell( int i, int j, const Point<T,3>& o, const Vector<T,3>& d,
+                                  T t_max, Hit* hits ) const;
+
+  }; // END class PSurfTriangleBvh
+
+
+} // END namespace GMlib
+
+// Include PSurfTriangleBvh class function implementations
+#include "gmpsurftrianglebvh.c"
+
+
+#endif // GM_PARAMETRICS_INTERSECTION_PSURFTRIANGLEBVH_H
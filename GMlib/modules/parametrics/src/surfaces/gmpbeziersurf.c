@@ -375,11 +375,13 @@ namespace GMlib {
       this->_p.setDim(d1+1,d2+1);
       p.setDim(m1, m2);
 
-      for(int i=0; i<m1; i++)
+      for(int i=0; i<m1; i++) {
+          if( this->_resampleCancelled() ) return;
           for(int j=0; j<m2; j++) {
               multEval( _ru[i], _rv[j], d1, d2);
               p[i][j] = this->_p;
           }
+      }
   }
 
 
@@ -253,11 +253,13 @@ namespace GMlib {
   template <typename T>
   void PBSplineSurf<T>::replot( ) const{
 
+          this->_lodInvalidate();
+
           int d1 = this->_no_der_u;
           int d2 = this->_no_der_v;
 
-          DMatrix< DMatrix< Vector<T,3> > >   p;
-          DMatrix< Vector<float,3> >          normals;
+          DMatrix< DMatrix< Vector<T,3> > >&  p       = this->_sample_p;
+          DMatrix< Vector<float,3> >&         normals = this->_sample_normals;
           Sphere<T,3>                         s;
 
           for(int i=0; i<_vpu.getDim(); i++)
@@ -275,6 +277,7 @@ namespace GMlib {
                   for( int k = 0; k < _visu[i][j].vis.getSize(); k++ )
                       _visu[i][j].vis[k]->replot( p, normals, _vpu[i].m, _vpv[j].m, d1, d2, false, false );
               }
+          this->_updateSampleBufferPeak();
           Parametrics<T,2,3>::setSurroundingSphere(s);
   }
 
@@ -304,8 +307,10 @@ namespace GMlib {
           if( d2 < 1 )    d2 = this->_no_der_v;
           else            this->_no_der_v = d2;
 
-          DMatrix< DMatrix< Vector<T,3> > >   p;
-          DMatrix< Vector<float,3> >          normals;
+          this->_lodReset( this->_no_sam_u, this->_no_sam_v );
+
+          DMatrix< DMatrix< Vector<T,3> > >&  p       = this->_sample_p;
+          DMatrix< Vector<float,3> >&         normals = this->_sample_normals;
           Sphere<T,3>                         s;
 
           for(int i=0; i<_vpu.getDim(); i++)
@@ -323,12 +328,28 @@ namespace GMlib {
                   for( int k = 0; k < _visu[i][j].vis.getSize(); k++ )
                       _visu[i][j].vis[k]->replot( p, normals, _vpu[i].m, _vpv[j].m, d1, d2, false, false );
               }
+          this->_updateSampleBufferPeak();
           Parametrics<T,2,3>::setSurroundingSphere(s);
       } else
           PSurf<T,3>::replot( m1, m2, d1, d2 );
   }
 
 
+  /*! void PBSplineSurf<T>::replotAsync( int m1, int m2, int d1, int d2 )
+   *  The partitioned visualization is replotted at once, the default one in the background.
+   */
+  template <typename T>
+  void PBSplineSurf<T>::replotAsync( int m1, int m2, int d1, int d2 ) {
+
+      if(_part_viz) {
+          this->cancelReplotAsync();
+          replot( m1, m2, d1, d2 );
+      }
+      else
+          PSurf<T,3>::replotAsync( m1, m2, d1, d2 );
+  }
+
+
   template <typename T>
   bool PBSplineSurf<T>::isClosedU() const {
       return _cu;
@@ -525,9 +546,11 @@ namespace GMlib {
 
       p.setDim(m1, m2);
 
-      for(int i=0; i<m1; i++)
+      for(int i=0; i<m1; i++) {
+          if( this->_resampleCancelled() ) return;
           for(int j=0; j<m2; j++)
-              multEval( p[i][j], _ru[0][i].m, _rv[0][j].m, _ru[0][i].ind, _rv[0][j].ind, d1, d2 );
+              multEval( p[i][j], _ru[0][i], _rv[0][j], _ru[0][i].ind, _rv[0][j].ind, d1, d2 );
+      }
   }
 
 
@@ -539,7 +562,7 @@ namespace GMlib {
 
       for(int i=0; i<m1; i++)
           for(int j=0; j<m2; j++)
-              multEval( p[i][j], bu(i).m, bv(j).m, bu(i).ind, bv(j).ind, d1, d2);
+              multEval( p[i][j], bu(i), bv(j), bu(i).ind, bv(j).ind, d1, d2);
   }
 
 
@@ -638,10 +661,10 @@ namespace GMlib {
 
       // Compute the Bernstein-Hermite matrix
       for( int j = 0; j < m-1; j++ ) {
-          int i = EvaluatorStatic<T>::evaluateBSp( p[j].m, start+j*dt, t, d, false );// - d;
+          int i = EvaluatorStatic<T>::evaluateBSp( p[j], start+j*dt, t, d, false );// - d;
           p[j].ind.init( i, d+1, n);
       }
-      int i = EvaluatorStatic<T>::evaluateBSp( p[m-1].m, end, t, d, true );// - d;
+      int i = EvaluatorStatic<T>::evaluateBSp( p[m-1], end, t, d, true );// - d;
       p[m-1].ind.init( i, d+1, n);
   }
 
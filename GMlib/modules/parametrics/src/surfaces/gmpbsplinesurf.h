@@ -100,6 +100,7 @@ namespace GMlib {
 
       // from PSurf
       void                       replot( int m1, int m2, int d1 = 0, int d2 = 0 ) override;
+      void                       replotAsync( int m1, int m2, int d1 = 0, int d2 = 0 ) override;
       bool                       isClosedU() const override;
       bool                       isClosedV() const override;
       void                       showSelectors( T rad = T(1), bool grid = false,
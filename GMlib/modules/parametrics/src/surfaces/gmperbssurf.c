@@ -537,50 +537,52 @@ namespace GMlib {
   void PERBSSurf<T>::eval( T u, T v, int d1, int d2, bool lu, bool lv ) const {
 
 
+      // Find Knot Indices u_k and v_k and the ERBS-basis, pre-evaluated
+      // when resampling, else computed at (u,v)
+      int uk, vk;
+      DVector<T> bu, bv;
       if(this->_resample) {
-          int i = this->_ind[0];
-          int j = this->_ind[1];
-
-
-          // Find Knot Indices u_k and v_k
-          int uk = _ru(i).ind;
-          int vk = _rv(j).ind;
-
-          // Get result of inner loop for first patch in v
-          DMatrix< Vector<T,3> > s0 = getC( u, v, uk, vk, d1, d2 );
-
-          // If placed on a knot, return only first patch result
-          if( std::abs(v - _v(vk)) < 1e-5 ) {
-              this->_p = s0;
-              //      std::cout << "_p[0][0]: " << this->_p[0][0] << "  (knot)" << std::endl;
-              return;
-          }
-          else {    // Blend Patches
+          uk = _ru(this->_ind[0]).ind;
+          vk = _rv(this->_ind[1]).ind;
+          bu = _ru(this->_ind[0]).m;
+          bv = _rv(this->_ind[1]).m;
+      }
+      else {
+          uk = findKnot( _u, u );
+          vk = findKnot( _v, v );
+          getB( bu, _u, uk, u, 2 );
+          getB( bv, _v, vk, v, 2 );
+      }
 
-              // Get result of inner loop for second patch in v
-              DMatrix< Vector<T,3> > s1 = getC( u, v, uk, vk+1, d1, d2 );
+      // Get result of inner loop for first patch in v
+      DMatrix< Vector<T,3> > s0 = getC( u, v, uk, vk, d1, d2, bu );
 
-              // Evaluate ERBS-basis in v direction
-              const DVector<T>& B = _rv(j).m;
+      // If placed on a knot, return only first patch result
+      if( std::abs(v - _v(vk)) < 1e-5 ) {
+          this->_p = s0;
+          return;
+      }
+      else {    // Blend Patches
 
-              // Compute "Pascals triangle"-numbers and correct patch matrix
-              DVector<T> a( B.getDim() );
-              s0 -= s1;
-              s0.transpose(); s1.transpose();
-              for( int i = 0; i <= d2; i++ ) {
+          // Get result of inner loop for second patch in v
+          DMatrix< Vector<T,3> > s1 = getC( u, v, uk, vk+1, d1, d2, bu );
 
-                  a[i] = 1;
-                  for( int j = i-1; j > 0; j-- )
-                      a[j] += a(j-1);                           // Compute "Pascals triangle"-numbers
+          // Compute "Pascals triangle"-numbers and correct patch matrix
+          DVector<T> a( bv.getDim() );
+          s0 -= s1;
+          s0.transpose(); s1.transpose();
+          for( int i = 0; i <= d2; i++ ) {
 
-                  for( int j = 0; j <= i; j++ )
-                      s1[i] += (a(j)*B(j)) * s0(i-j);       // "column += scalar x column"
-              }
-              s1.transpose();
+              a[i] = 1;
+              for( int j = i-1; j > 0; j-- )
+                  a[j] += a(j-1);                           // Compute "Pascals triangle"-numbers
 
-              this->_p = s1;
-              //      std::cout << "_p[0][0]: " << this->_p[0][0] << std::endl;
+              for( int j = 0; j <= i; j++ )
+                  s1[i] += (a(j)*bv(j)) * s0(i-j);       // "column += scalar x column"
           }
+          s1.transpose();
+
+          this->_p = s1;
       }
 
 
@@ -664,14 +666,11 @@ namespace GMlib {
     p.setDim(m);
 
     // Compute the Bernstein-Hermite Polynomiale, for the B-spline Surface
-    for( int j = 0, i=1; j < m; j++ ) {
+    for( int j = 0; j < m; j++ ) {
         T s = start+dt*j;
 
-        for(; i < t.getDim()-2; ++i ) if( s < t(i+1) ) break;
-        if( i== t.getDim()-2) while( std::abs( t(i) - t(i-1) ) < 1e-5 ) --i;
-
-        p[j].ind = i;
-        getB( p[j].m, t, i, start+dt*j, 2 );
+        p[j].ind = findKnot( t, s );
+        getB( p[j].m, t, p[j].ind, s, 2 );
     }
   }
 
@@ -848,7 +847,7 @@ namespace GMlib {
 
   template <typename T>
   inline
-  void PERBSSurf<T>::getB( DVector<T>& B, const DVector<T>& kv, int tk, T t, int d ) {
+  void PERBSSurf<T>::getB( DVector<T>& B, const DVector<T>& kv, int tk, T t, int d ) const {
 
     B.setDim(d+1);
 
@@ -860,45 +859,48 @@ namespace GMlib {
 
   template <typename T>
   inline
-  DMatrix< Vector<T,3> > PERBSSurf<T>::getC( T u, T v, int uk, int vk, T du, T dv ) const {
-
-      if(this->_resample) {
-          // Init Indexes and get local u/v values
-          const int cu = uk-1;
-          const int cv = vk-1;
+  DMatrix< Vector<T,3> > PERBSSurf<T>::getC( T u, T v, int uk, int vk, T du, T dv, const DVector<T>& B ) const {
 
-          // Evaluate First local patch
-          DMatrix< Vector<T,3> > c0 = _c(cu)(cv)->evaluateParent( mapToLocal(u,v,uk,vk), Point<T,2>( du, dv ) );
+      // Init Indexes and get local u/v values
+      const int cu = uk-1;
+      const int cv = vk-1;
 
-          // If on a interpolation point return only first patch evaluation
-          if( std::abs(u - _u(uk)) < 1e-5 )
-              return c0;
+      // Evaluate First local patch
+      DMatrix< Vector<T,3> > c0 = _c(cu)(cv)->evaluateParent( mapToLocal(u,v,uk,vk), Point<T,2>( du, dv ) );
 
-          // Select next local patch in u direction
+      // If on a interpolation point return only first patch evaluation
+      if( std::abs(u - _u(uk)) < 1e-5 )
+          return c0;
 
-          // Evaluate Second local patch
-          DMatrix< Vector<T,3> > c1 = _c(cu+1)(cv)->evaluateParent( mapToLocal(u,v,uk+1,vk), Point<T,2>( du, dv) );
+      // Select next local patch in u direction
 
-          DVector<T> a(du+1);
+      // Evaluate Second local patch
+      DMatrix< Vector<T,3> > c1 = _c(cu+1)(cv)->evaluateParent( mapToLocal(u,v,uk+1,vk), Point<T,2>( du, dv) );
 
-          // Evaluate ERBS-basis in u direction
-          const DVector<T>& B = _ru(uk).m;
+      DVector<T> a(du+1);
 
-          // Compute "Pascals triangle"-numbers and correct patch matrix
-          c0 -= c1;
-          for( int i = 0; i < B.getDim(); i++ ) {
+      // Compute "Pascals triangle"-numbers and correct patch matrix, using the ERBS-basis in u direction
+      c0 -= c1;
+      for( int i = 0; i <= du; i++ ) {
 
-              a[i] = 1;
-              for( int j = i-1; j > 0; j-- )
-                  a[j] += a[j-1];
+          a[i] = 1;
+          for( int j = i-1; j > 0; j-- )
+              a[j] += a[j-1];
 
-              for( int j = 0; j <= i; j++ )
-                  c1[i] += (a(j) * B(j)) * c0(i-j);
-          }
-          return c1 ;
+          for( int j = 0; j <= i; j++ )
+              c1[i] += (a(j) * B(j)) * c0(i-j);
       }
-      else
-      return DMatrix< Vector<T,3> >();
+      return c1 ;
+  }
+
+  template <typename T>
+  inline
+  int PERBSSurf<T>::findKnot( const DVector<T>& t, T s ) const {
+
+    int i = 1;
+    for( ; i < t.getDim()-2; ++i ) if( s < t(i+1) ) break;
+    if( i == t.getDim()-2 ) while( std::abs( t(i) - t(i-1) ) < 1e-5 ) --i;
+    return i;
   }
 
   template <typename T>
@@ -1333,6 +1335,7 @@ namespace GMlib {
     else
       _no_der_v = d2;
 
+    this->_lodReset( m1, m2 );
 
 
     // pre-sampel / pre evaluate data for a given parametric surface, if wanted/needed
@@ -1497,6 +1500,15 @@ namespace GMlib {
     //      this->_psurf_visualizers[i]->replot( p, normals, m1, m2, d1, d2, isClosedU(), isClosedV() );
   }
 
+  /*! void PERBSSurf<T>::replotAsync(int m1, int m2, int d1, int d2)
+   *  The surface is replotted in segments with their own visualizers, this is done at once.
+   */
+  template <typename T>
+  void PERBSSurf<T>::replotAsync(int m1, int m2, int d1, int d2) {
+
+    replot( m1, m2, d1, d2 );
+  }
+
   template <typename T>
   void PERBSSurf<T>::splitKnot(int uk, int vk)  {
 
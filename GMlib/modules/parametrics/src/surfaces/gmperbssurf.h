@@ -114,6 +114,7 @@ namespace GMlib {
     bool                                isClosedV() const override;
 //    void                                preSample( int m1, int m2, int d1, int d2, T s_u, T s_v, T e_u, T e_v ) override;
     void                                replot(int m1 = 0, int m2 = 0, int d1 = 0, int d2 = 0) override;
+    void                                replotAsync(int m1, int m2, int d1 = 0, int d2 = 0) override;
 
   protected:
     bool                                _closed_u;
@@ -141,8 +142,9 @@ namespace GMlib {
     void                                evalPre( T u, T v, int d1 = 0, int d2 = 0, bool lu = false, bool lv = false );
     void                                findIndex( T u, T v, int& iu, int& iv );
     void                                generateKnotVector( DVector<T>& kv, const T s, const T d, int kvd, bool closed );
-    void                                getB( DVector<T>& B, const DVector<T>& kv, int tk, T t, int d );
-    DMatrix< Vector<T,3> >              getC( T u, T v, int uk, int vk, T du, T dv ) const;
+    int                                 findKnot( const DVector<T>& t, T s ) const;
+    void                                getB( DVector<T>& B, const DVector<T>& kv, int tk, T t, int d ) const;
+    DMatrix< Vector<T,3> >              getC( T u, T v, int uk, int vk, T du, T dv, const DVector<T>& B ) const;
     DMatrix< Vector<T,3> >              getCPre( T u, T v, int uk, int vk, T du, T dv, int iu, int iv );
     T                                   getStartPU() const override;
     T                                   getEndPU()   const override;
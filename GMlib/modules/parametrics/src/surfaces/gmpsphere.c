@@ -90,6 +90,8 @@ namespace GMlib {
           DMatrix< Vector<T,3> >              normals;
           Sphere<T,3>                         s(Point<T,3>(T(0)), _radius);
 
+          this->_lodReset( m1, m1 );
+
           // Sample Positions
           resample(p, m1);
 
@@ -106,6 +108,19 @@ namespace GMlib {
   }
 
 
+  /*! void PSphere<T>::replotAsync( int m1, int m2, int d1, int d2 )
+   *  The replot with a normal map is done at once, the others in the background.
+   */
+  template <typename T>
+  void PSphere<T>::replotAsync( int m1, int m2, int d1, int d2 ) {
+
+      if(d1==0 && m1>3 && m1<31)
+          replot( m1, m2, d1, d2 );
+      else
+          PSurf<T,3>::replotAsync( m1, m2, d1, d2 );
+  }
+
+
 
   template <typename T>
   bool PSphere<T>::isClosedU() const {
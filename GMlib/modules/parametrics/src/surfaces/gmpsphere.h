@@ -50,6 +50,7 @@ namespace GMlib {
 
     // from PSurf
     void          replot( int m1 = 0, int m2 = 0, int d1 = 0, int d2 = 0 ) override;
+    void          replotAsync( int m1, int m2, int d1 = 0, int d2 = 0 ) override;
     bool          isClosedU() const override;
     bool          isClosedV() const override;
 
@@ -28,379 +28,361 @@
  */
 
 
-namespace GMlib {
+#include "../gmpsurf.h"
+
+// gmlib
+#include <core/utils/gmparallel.h>
+#include <opengl/gmopengl.h>
+#include <opengl/gmopenglmanager.h>
+#include <opengl/shaders/gmvertexshader.h>
+#include <opengl/shaders/gmfragmentshader.h>
+#include <scene/camera/gmcamera.h>
+#include <scene/render/gmdefaultrenderer.h>
 
 
-  template <typename T>
-  PSurfContoursVisualizer<T>::PSurfContoursVisualizer() {
+namespace GMlib {
 
-    this->setRenderProgram( GL::GLProgram("psurf_contours") );
 
-    _mapping = GM_PSURF_CONTOURSVISUALIZER_X;
+  template <typename T, int n>
+  PSurfContoursVisualizer<T,n>::PSurfContoursVisualizer()
+    : _no_strips(0), _no_strip_indices(0), _strip_size(0),
+      _mapping(GM_PSURF_CONTOURSVISUALIZER_X),
+      _method(GM_PSURF_CONTOURSVISUALIZER_LINEAR) {
 
     // Set default colors
-    _colors += GMcolor::red();
-    _colors += GMcolor::blue();
-
-    // Set default interpolation method
-    _method = GM_PSURF_CONTOURSVISUALIZER_LINEAR;
+    _colors.push_back( GMcolor::red() );
+    _colors.push_back( GMcolor::blue() );
 
-    glGenBuffers( 1, &_ibo );
-    glGenBuffers( 1, &_vbo );
+    _init();
   }
 
-  template <typename T>
-  PSurfContoursVisualizer<T>::~PSurfContoursVisualizer() {
 
-    glDeleteBuffers( 1, &_ibo );
-    glDeleteBuffers( 1, &_vbo );
-  }
-
-  template <typename T>
-  inline
-  void PSurfContoursVisualizer<T>::display() {
+  template <typename T, int n>
+  PSurfContoursVisualizer<T,n>::PSurfContoursVisualizer( const PSurfContoursVisualizer<T,n>& copy )
+    : PSurfVisualizer<T,n>(copy), _no_strips(0), _no_strip_indices(0), _strip_size(0),
+      _colors(copy._colors), _mapping(copy._mapping), _method(copy._method) {
 
-    const GL::GLProgram &prog = this->getRenderProgram();
-    prog.setUniform( "u_selected", false );
+    _init();
+  }
 
-    GLuint vert_loc = prog.getAttributeLocation( "in_vertex" );
-    GLuint color_loc = prog.getAttributeLocation( "in_color" );
 
-    GLsizei stride = sizeof( Vertex );
-    glBindBuffer( GL_ARRAY_BUFFER, _vbo );
+  template <typename T, int n>
+  void PSurfContoursVisualizer<T,n>::render( const SceneObject* obj, const DefaultRenderer* renderer ) const {
 
-    glVertexAttribPointer( vert_loc, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)0x0 );
-    glEnableVertexAttribArray( vert_loc );
+    this->glSetDisplayMode();
 
-    glVertexAttribPointer( color_loc, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)(3*sizeof(GLfloat)) );
-    glEnableVertexAttribArray( color_loc );
+    _prog.bind(); {
 
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _ibo );
-    for( int i = 0; i < _tri_strips; i++ )
-      glDrawElements( GL_TRIANGLE_STRIP, _indices_per_tri_strip, GL_UNSIGNED_SHORT, (const GLvoid*)( i*_tri_strip_offset ) );
-    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0x0 );
+      _prog.uniform( "u_mvpmat", obj->getModelViewProjectionMatrix(renderer->getCamera()) );
 
-    glDisableVertexAttribArray( color_loc );
-    glDisableVertexAttribArray( vert_loc );
+      GL::AttributeLocation vert_loc  = _prog.getAttributeLocation( "in_vertex" );
+      GL::AttributeLocation color_loc = _prog.getAttributeLocation( "in_color" );
 
-    glBindBuffer( GL_ARRAY_BUFFER, 0x0 );
+      _vbo.bind();
+        _vbo.enable( vert_loc,  3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<const GLvoid *>(0x0) );
+        _vbo.enable( color_loc, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<const GLvoid *>(3*sizeof(GLfloat)) );
+          draw();
+        _vbo.disable( vert_loc );
+        _vbo.disable( color_loc );
+      _vbo.unbind();
 
+    } _prog.unbind();
   }
 
-  template <typename T>
-  inline
-  Color PSurfContoursVisualizer<T>::getColor( T d ) {
 
-    // Find Index
-    int idx;
-    idx = d * ( _colors.getSize()-1 );
-    if( idx == _colors.getSize()-1 ) idx--;
-    if( (idx < 0) || (idx > _colors.getSize()-1) ) idx = 0;
+  template <typename T, int n>
+  void PSurfContoursVisualizer<T,n>::renderGeometry( const SceneObject* obj, const Renderer* renderer, const Color& color ) const {
 
-    return _colors[idx];
-  }
+    _color_prog.bind(); {
 
-  template <typename T>
-  inline
-  Color PSurfContoursVisualizer<T>::getColorInterpolated( T d ) {
+      _color_prog.uniform( "u_color", color );
+      _color_prog.uniform( "u_mvpmat", obj->getModelViewProjectionMatrix(renderer->getCamera()) );
+      GL::AttributeLocation vert_loc = _color_prog.getAttributeLocation( "in_vertex" );
 
-    // Find Index
-    int idx;
-    idx = d * ( _colors.getSize()-1 );
-    if( idx == _colors.getSize()-1 ) idx--;
-    if( (idx < 0) || (idx > _colors.getSize()-1) ) idx = 0;
+      _vbo.bind();
+        _vbo.enable( vert_loc, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<const GLvoid *>(0x0) );
+          draw();
+        _vbo.disable( vert_loc );
+      _vbo.unbind();
 
-
-    double local_d = (double( _colors.getSize()-1 ) * d) - idx;
-    Color ret = _colors[idx].getInterpolatedHSV( local_d, _colors[idx+1] );
-
-    return ret;
+    } _color_prog.unbind();
   }
 
-  template <typename T>
-  const Array<Color>& PSurfContoursVisualizer<T>::getColors() const {
 
-    return _colors;
-  }
+  template <typename T, int n>
+  void PSurfContoursVisualizer<T,n>::replot( const DMatrix< DMatrix< Vector<T, n> > >& p,
+                                             const DMatrix< Vector<float, 3> >& /*normals*/,
+                                             int /*m1*/, int /*m2*/, int /*d1*/, int /*d2*/,
+                                             bool /*closed_u*/, bool /*closed_v*/ ) {
 
-  template <typename T>
-  inline
-  T PSurfContoursVisualizer<T>::getCurvatureGauss( DMatrix< Vector<T,3> >& p ) {
-
-    UnitVector<T,3>   N   = p[1][0]^p[0][1];
-    Vector<T,3>		  du  = p[1][0];
-    Vector<T,3>		  dv  = p[0][1];
-    Vector<T,3>		  duu = p[2][0];
-    Vector<T,3>		  duv = p[1][1];
-    Vector<T,3>		  dvv = p[0][2];
-
-    T E = du  * du;
-    T F = du  * dv;
-    T G = dv  * dv;
-    T e = N   * duu;
-    T f = N   * duv;
-    T g = N   * dvv;
-
-    return (e*g - f*f) / (E*G - F*F);
-  }
+    const int m1 = p.getDim1();
+    const int m2 = p.getDim2();
+    if( m1 < 2 || m2 < 2 ) return;
 
-  template <typename T>
-  inline
-  T PSurfContoursVisualizer<T>::getCurvatureMean( DMatrix< Vector<T,3> >& p ) {
-
-    UnitVector<T,3>   N   = p[1][0]^p[0][1];
-    Vector<T,3>		  du  = p[1][0];
-    Vector<T,3>		  dv  = p[0][1];
-    Vector<T,3>		  duu = p[2][0];
-    Vector<T,3>		  duv = p[1][1];
-    Vector<T,3>		  dvv = p[0][2];
-
-    T E = du  * du;
-    T F = du  * dv;
-    T G = dv  * dv;
-    T e = N   * duu;
-    T f = N   * duv;
-    T g = N   * dvv;
-
-    return 0.5 * (e*G - 2 * (f*F) + g*E) / (E*G - F*F);
-  }
+    PSurfVisualizer<T,n>::fillTriangleStripIBO( _ibo, m1, m2, _no_strips, _no_strip_indices, _strip_size );
 
-  template <typename T>
-  inline
-  T PSurfContoursVisualizer<T>::getCurvaturePrincipalMax( DMatrix< Vector<T,3> >& p ) {
+    // The field to map, and its range
+    computeValues( p );
 
-    T K = getCurvatureGauss( p );
-    T H = getCurvatureMean( p );
+    T min = _values(0)(0), max = min;
+    for( int i = 0; i < m1; i++ )
+      for( int j = 0; j < m2; j++ ) {
+        const T v = _values(i)(j);
+        if( v < min ) min = v;
+        if( v > max ) max = v;
+      }
+    const T scale = (max-min) < T(1e-5) ? T(0) : T(1) / (max-min);
+
+    // Vertex positions and colors
+    _vbo.bufferData( m1 * m2 * sizeof(Vertex), 0x0, GL_STATIC_DRAW );
+    Vertex *ptr = _vbo.mapBuffer<Vertex>();
+
+    auto rows = [&]( int begin, int end ) {
+      for( int i = begin; i < end; i++ )
+        for( int j = 0; j < m2; j++ ) {
+
+          Vertex& v = ptr[i*m2 + j];
+          const Vector<T,n>& q = p(i)(j)(0)(0);
+          v.x = GLfloat(q(0));
+          v.y = GLfloat(q(1));
+          v.z = GLfloat(q(2));
+
+          const T d = (_values(i)(j) - min) * scale;
+          const Color c = _method == GM_PSURF_CONTOURSVISUALIZER_NO_INTERPOLATION ? getColor(d) : getColorInterpolated(d);
+          v.r = GLfloat(c.getRedC());
+          v.g = GLfloat(c.getGreenC());
+          v.b = GLfloat(c.getBlueC());
+          v.a = GLfloat(c.getAlphaC());
+        }
+    };
+    parallelFor( 0, m1, rows, 1 + 4096 / m2 );
 
-    return H + sqrt( H*H - K );
+    _vbo.unmapBuffer();
   }
 
-  template <typename T>
-  inline
-  T PSurfContoursVisualizer<T>::getCurvaturePrincipalMin( DMatrix< Vector<T,3> >& p ) {
 
-    T K = getCurvatureGauss( p );
-    T H = getCurvatureMean( p );
+  template <typename T, int n>
+  void PSurfContoursVisualizer<T,n>::computeValues( const DMatrix< DMatrix< Vector<T, n> > >& p ) {
 
-    return H - sqrt( H*H - K );
-  }
+    const int m1 = p.getDim1();
+    const int m2 = p.getDim2();
 
-  template <typename T>
-  GM_PSURF_CONTOURSVISUALIZER_INTERPOLATION_METHOD PSurfContoursVisualizer<T>::getInterpolationMethod() const {
+    switch( _mapping ) {
+    case GM_PSURF_CONTOURSVISUALIZER_CURVATURE_GAUSS:
+      PSurf<T,n>::computeCurvatures( p, &_values, nullptr );
+      return;
+    case GM_PSURF_CONTOURSVISUALIZER_CURVATURE_MEAN:
+      PSurf<T,n>::computeCurvatures( p, nullptr, &_values );
+      return;
+    case GM_PSURF_CONTOURSVISUALIZER_CURVATURE_PRINCIPAL_MAX:
+      PSurf<T,n>::computeCurvatures( p, nullptr, nullptr, &_values );
+      return;
+    case GM_PSURF_CONTOURSVISUALIZER_CURVATURE_PRINCIPAL_MIN:
+      PSurf<T,n>::computeCurvatures( p, nullptr, nullptr, nullptr, &_values );
+      return;
+    default: break;
+    }
 
-    return _method;
+    _values.setDim( m1, m2 );
+    const bool first_der = p(0)(0).getDim1() > 1 && p(0)(0).getDim2() > 1;
+
+    for( int i = 0; i < m1; i++ )
+      for( int j = 0; j < m2; j++ ) {
+
+        const DMatrix< Vector<T,n> >& s = p(i)(j);
+        T& v = _values[i][j];
+        switch( _mapping ) {
+        case GM_PSURF_CONTOURSVISUALIZER_X:        v = s(0)(0)(0);                          break;
+        case GM_PSURF_CONTOURSVISUALIZER_Y:        v = s(0)(0)(1);                          break;
+        case GM_PSURF_CONTOURSVISUALIZER_Z:        v = s(0)(0)(2);                          break;
+        case GM_PSURF_CONTOURSVISUALIZER_U:        v = T(i) / T(m1-1);                      break;
+        case GM_PSURF_CONTOURSVISUALIZER_V:        v = T(j) / T(m2-1);                      break;
+        case GM_PSURF_CONTOURSVISUALIZER_SPEED_U:  v = first_der ? s(1)(0).getLength() : T(0);  break;
+        case GM_PSURF_CONTOURSVISUALIZER_SPEED_V:  v = first_der ? s(0)(1).getLength() : T(0);  break;
+        default:                                   v = T(0);                                break;
+        }
+      }
   }
 
-  template <typename T>
-  GM_PSURF_CONTOURSVISUALIZER_MAP PSurfContoursVisualizer<T>::getMapping() const {
-
-    return _mapping;
-  }
 
-  template <typename T>
+  template <typename T, int n>
   inline
-  void PSurfContoursVisualizer<T>::replot(
-    DMatrix< DMatrix< Vector<T, 3> > >& p,
-    DMatrix< Vector<T, 3> >& normals,
-    int m1, int m2, int d1, int d2,
-    bool /*closed_u*/, bool /*closed_v*/
-  ) {
+  Color PSurfContoursVisualizer<T,n>::getColor( T d ) const {
 
-    _tri_strips = PSurfVisualizer<T>::getNoTriangleStrips( p.getDim1(), p.getDim2() );
-    _indices_per_tri_strip = PSurfVisualizer<T>::getNoIndicesPerTriangleStrip( p.getDim1(), p.getDim2() );
-    _tri_strip_offset =  sizeof(GLushort) * _indices_per_tri_strip;
+    const int no_colors = int(_colors.size());
+    if( no_colors < 2 ) return no_colors ? _colors[0] : GMcolor::black();
 
-    PSurfVisualizer<T>::fillTriangleStripIBO( _ibo, p.getDim1(), p.getDim2() );
+    // Find Index
+    int idx = int( d * ( no_colors-1 ) );
+    if( idx == no_colors-1 ) idx--;
+    if( (idx < 0) || (idx > no_colors-1) ) idx = 0;
 
+    return _colors[idx];
+  }
 
-    // Color/Material Countours
-    DMatrix<double> cmap;
 
-    T min, max;
-    T C;
-    cmap.setDim( p.getDim1(), p.getDim2() );
-    switch( _mapping ) {
-
-    case GM_PSURF_CONTOURSVISUALIZER_U:
-      {
-        for( int i = 0; i < p.getDim1(); i++ )
-          for( int j = 0; j < p.getDim2(); j++ )
-            cmap[i][j] = double(i) / double(p.getDim1()-1);
-      }
-      break;
-    case GM_PSURF_CONTOURSVISUALIZER_V:
-      {
-        for( int i = 0; i < p.getDim1(); i++ )
-          for( int j = 0; j < p.getDim2(); j++ )
-            cmap[i][j] = double(j) / double(p.getDim2()-1);
-      }
-      break;
-
-    default:
-      {
-        // Init min/max
-        min = max = getValue(p, 0, 0);
-
-        // Extract all Gaussian Curvature data
-        for( int i = 0; i < p.getDim1(); i++ ) {
-          for( int j = 0; j < p.getDim2(); j++ ) {
-
-            const T curvature = getValue(p, i, j);
-            if( curvature < min )
-              min = curvature;
-            if( curvature > max )
-              max = curvature;
-          }
-        }
-
-        // Correct interval
-        if( (max-min) < 1e-5 ) {
+  template <typename T, int n>
+  inline
+  Color PSurfContoursVisualizer<T,n>::getColorInterpolated( T d ) const {
 
-          for( int i = 0; i < p.getDim1(); i++ )
-            for( int j = 0; j < p.getDim2(); j++ )
-              cmap[i][j] = 0.0;
-        }
-        else {
-          C = 1.0f / (max-min);
-          min /= (max-min);
-
-          // Compute interpolated map values
-          for( int i = 0; i < p.getDim1(); i++ ) {
-            for( int j = 0; j < p.getDim2(); j++ ) {
-
-              const T curvature = getValue(p, i, j);
-              cmap[i][j] = ( C * curvature ) - min;
-            }
-          }
-        }
-      }
-      break;
-    }
+    const int no_colors = int(_colors.size());
+    if( no_colors < 2 ) return no_colors ? _colors[0] : GMcolor::black();
 
+    // Find Index
+    int idx = int( d * ( no_colors-1 ) );
+    if( idx == no_colors-1 ) idx--;
+    if( (idx < 0) || (idx > no_colors-1) ) idx = 0;
 
-    glBindBuffer( GL_ARRAY_BUFFER, _vbo );
-    Vertex data[p.getDim1()*p.getDim2()];
+    double local_d = (double( no_colors-1 ) * d) - idx;
+    return _colors[idx].getInterpolatedHSV( local_d, _colors[idx+1] );
+  }
 
-    // Fill vertex point data.
-    for( int i = 0; i < p.getDim1(); i++ ) {
-      for( int j = 0; j < p.getDim2(); j++ ) {
 
-        const int idx = i * p.getDim2() + j;
-        data[idx].x = p[i][j][0][0][0];
-        data[idx].y = p[i][j][0][0][1];
-        data[idx].z = p[i][j][0][0][2];
-      }
-    }
+  template <typename T, int n>
+  inline
+  const std::vector<Color>& PSurfContoursVisualizer<T,n>::getColors() const {
 
+    return _colors;
+  }
 
-    // Fill vertex color data
-    switch( _method ) {
-    case GM_PSURF_CONTOURSVISUALIZER_NO_INTERPOLATION:
-      for( int i = 0; i < p.getDim1(); i++ ) {
-        for( int j = 0; j < p.getDim2(); j++ ) {
 
-          const int idx = i * p.getDim2() + j;
-          const Color c = getColor( cmap[i][j] );
-          data[idx].r = c.getRedC();
-          data[idx].g = c.getGreenC();
-          data[idx].b = c.getBlueC();
-          data[idx].a = c.getAlphaC();
-        }
-      }
-      break;
-
-    case GM_PSURF_CONTOURSVISUALIZER_LINEAR:
-    default:
-      for( int i = 0; i < p.getDim1(); i++ ) {
-        for( int j = 0; j < p.getDim2(); j++ ) {
-
-          const int idx = i * p.getDim2() + j;
-          const Color c = getColorInterpolated( cmap[i][j] );
-          data[idx].r = c.getRedC();
-          data[idx].g = c.getGreenC();
-          data[idx].b = c.getBlueC();
-          data[idx].a = c.getAlphaC();
-        }
-      }
-      break;
-    }
+  template <typename T, int n>
+  inline
+  void PSurfContoursVisualizer<T,n>::setColors( const std::vector<Color>& c ) {
 
-    glBindBuffer( GL_ARRAY_BUFFER, _vbo );
-    glBufferData( GL_ARRAY_BUFFER, p.getDim1() * p.getDim2() * sizeof(Vertex), data, GL_STATIC_DRAW );
-    glBindBuffer( GL_ARRAY_BUFFER, 0x0 );
+    _colors = c;
   }
 
-  template <typename T>
+
+  template <typename T, int n>
   inline
-  T PSurfContoursVisualizer<T>::getValue( DMatrix< DMatrix< Vector<T, 3> > >& p, int i, int j ) {
+  GM_PSURF_CONTOURSVISUALIZER_INTERPOLATION_METHOD PSurfContoursVisualizer<T,n>::getInterpolationMethod() const {
 
-    switch( _mapping ) {
-    case GM_PSURF_CONTOURSVISUALIZER_X:
-      return p[i][j][0][0][0];
-    case GM_PSURF_CONTOURSVISUALIZER_Y:
-      return p[i][j][0][0][1];
-    case GM_PSURF_CONTOURSVISUALIZER_Z:
-      return p[i][j][0][0][2];
+    return _method;
+  }
 
-    default: break;
-    }
 
+  template <typename T, int n>
+  inline
+  void PSurfContoursVisualizer<T,n>::setInterpolationMethod( GM_PSURF_CONTOURSVISUALIZER_INTERPOLATION_METHOD method ) {
 
-    // Values requireing 1st derivatives
-    if( p[i][j].getDim1() < 2 || p[i][j].getDim2() < 2 )
-      return T(0);
+    _method = method;
+  }
 
-    switch( _mapping ) {
-    case GM_PSURF_CONTOURSVISUALIZER_U:
-      return p[i][j][1][0].getLength();
-    case GM_PSURF_CONTOURSVISUALIZER_V:
-      return p[i][j][0][1].getLength();
 
-    default: break;
-    }
+  template <typename T, int n>
+  inline
+  GM_PSURF_CONTOURSVISUALIZER_MAP PSurfContoursVisualizer<T,n>::getMapping() const {
 
+    return _mapping;
+  }
 
-    // Values requireing 2nd derivatives
-    if( p[i][j].getDim1() < 3 || p[i][j].getDim2() < 3 )
-      return T(0);
 
-    switch( _mapping ) {
-    case GM_PSURF_CONTOURSVISUALIZER_CURVATURE_GAUSS:
-      return getCurvatureGauss(p[i][j]);
-
-    case GM_PSURF_CONTOURSVISUALIZER_CURVATURE_MEAN:
-      return getCurvatureMean(p[i][j]);
+  template <typename T, int n>
+  inline
+  void PSurfContoursVisualizer<T,n>::setMapping( GM_PSURF_CONTOURSVISUALIZER_MAP mapping ) {
 
-    case GM_PSURF_CONTOURSVISUALIZER_CURVATURE_PRINCIPAL_MAX:
-      return getCurvaturePrincipalMax( p[i][j] );
+    _mapping = mapping;
+  }
 
-    case GM_PSURF_CONTOURSVISUALIZER_CURVATURE_PRINCIPAL_MIN:
-      return getCurvaturePrincipalMin( p[i][j] );
 
-    default: break;
-    }
+  template <typename T, int n>
+  inline
+  void PSurfContoursVisualizer<T,n>::draw() const {
 
-    return T(0);
+    _ibo.bind();
+    for( unsigned int i = 0; i < _no_strips; ++i )
+      _ibo.drawElements( GL_TRIANGLE_STRIP, _no_strip_indices, GL_UNSIGNED_INT, reinterpret_cast<const GLvoid *>(i * _strip_size) );
+    _ibo.unbind();
   }
 
-  template <typename T>
-  void PSurfContoursVisualizer<T>::setColors( const Array<Color>& c ) {
 
-    _colors = c;
+  template <typename T, int n>
+  void PSurfContoursVisualizer<T,n>::initShaderProgram() {
+
+    const std::string prog_name    = "psurf_contours_prog";
+    if( _prog.acquire(prog_name) ) return;
+
+
+    std::string vs_src =
+        GL::OpenGLManager::glslDefHeaderVersionSource() +
+
+        "uniform mat4 u_mvpmat;\n"
+        "\n"
+        "in vec4 in_vertex;\n"
+        "in vec4 in_color;\n"
+        "\n"
+        "out vec4 gl_Position;\n"
+        "\n"
+        "smooth out vec4 ex_color;\n"
+        "\n"
+        "void main() {\n"
+        "\n"
+        "  ex_color = in_color;\n"
+        "  gl_Position = u_mvpmat * in_vertex;\n"
+        "}\n"
+        ;
+
+    std::string fs_src =
+        GL::OpenGLManager::glslDefHeaderVersionSource() +
+
+        "smooth in vec4 ex_color;\n"
+        "\n"
+        "out vec4 gl_FragColor;\n"
+        "\n"
+        "void main() {\n"
+        "\n"
+        "  gl_FragColor = ex_color;\n"
+        "}\n"
+        ;
+
+    bool compile_ok, link_ok;
+
+    GL::VertexShader vshader;
+    vshader.create("psurf_contours_vs");
+    vshader.setPersistent(true);
+    vshader.setSource(vs_src);
+    compile_ok = vshader.compile();
+    if( !compile_ok ) {
+      std::cout << "Src:" << std::endl << vshader.getSource() << std::endl << std::endl;
+      std::cout << "Error: " << vshader.getCompilerLog() << std::endl;
+    }
+    assert(compile_ok);
+
+    GL::FragmentShader fshader;
+    fshader.create("psurf_contours_fs");
+    fshader.setPersistent(true);
+    fshader.setSource(fs_src);
+    compile_ok = fshader.compile();
+    if( !compile_ok ) {
+      std::cout << "Src:" << std::endl << fshader.getSource() << std::endl << std::endl;
+      std::cout << "Error: " << fshader.getCompilerLog() << std::endl;
+    }
+    assert(compile_ok);
+
+    _prog.create(prog_name);
+    _prog.setPersistent(true);
+    _prog.attachShader(vshader);
+    _prog.attachShader(fshader);
+    link_ok = _prog.link();
+    if( !link_ok ) {
+      std::cout << "Error: " << _prog.getLinkerLog() << std::endl;
+    }
+    assert(link_ok);
   }
 
-  template <typename T>
-  void PSurfContoursVisualizer<T>::setInterpolationMethod( GM_PSURF_CONTOURSVISUALIZER_INTERPOLATION_METHOD method ) {
 
-    _method = method;
-  }
-
-  template <typename T>
-  void PSurfContoursVisualizer<T>::setMapping( GM_PSURF_CONTOURSVISUALIZER_MAP mapping ) {
+  template <typename T, int n>
+  inline
+  void PSurfContoursVisualizer<T,n>::_init() {
 
-    _mapping = mapping;
-  }
+    initShaderProgram();
 
+    _color_prog.acquire("color");
+    assert(_color_prog.isValid());
 
+    _vbo.create();
+    _ibo.create();
+  }
 
 } // END namespace GMlib
@@ -28,18 +28,22 @@
  */
 
 
-#ifndef __GMPSURFCONTOURSVISUALIZER_H__
-#define __GMPSURFCONTOURSVISUALIZER_H__
+#ifndef GM_PARAMETRICS_VISUALIZERS_PSURFCONTOURSVISUALIZER_H
+#define GM_PARAMETRICS_VISUALIZERS_PSURFCONTOURSVISUALIZER_H
 
 
 #include "gmpsurfvisualizer.h"
 
-
 // gmlib
 #include <core/types/gmpoint.h>
-#include <core/containers/gmdvector.h>
 #include <core/containers/gmdmatrix.h>
 #include <core/utils/gmcolor.h>
+#include <opengl/gmprogram.h>
+#include <opengl/bufferobjects/gmvertexbufferobject.h>
+#include <opengl/bufferobjects/gmindexbufferobject.h>
+
+// stl
+#include <vector>
 
 
 namespace GMlib {
@@ -65,55 +69,66 @@ namespace GMlib {
   };
 
 
-  template <typename T>
-  class PSurfContoursVisualizer : public PSurfVisualizer<T> {
+  /*! \class PSurfContoursVisualizer gmpsurfcontoursvisualizer.h <gmPSurfContoursVisualizer>
+   *  \brief Colors the surface by a scalar field over the samples
+   *
+   *  The speed mappings need the surface to be replotted with at least 1 derivative,
+   *  the curvature mappings with at least 2 (e.g. replot(m1,m2,2,2)). The curvatures
+   *  are computed from the samples, see PSurf::computeCurvatures().
+   */
+  template <typename T, int n>
+  class PSurfContoursVisualizer : public PSurfVisualizer<T,n> {
+    GM_VISUALIZER(PSurfContoursVisualizer)
   public:
     struct Vertex {
       GLfloat   x, y, z;
       GLfloat   r, g, b, a;
-      GLfloat   padding;
-    }; // Size 8 * sizeof( GLfloat )
+    };
 
     PSurfContoursVisualizer();
-    virtual ~PSurfContoursVisualizer();
+    PSurfContoursVisualizer( const PSurfContoursVisualizer<T,n>& copy );
+
+    void                              render( const SceneObject* obj, const DefaultRenderer* renderer ) const override;
+    void                              renderGeometry( const SceneObject* obj, const Renderer* renderer, const Color& color ) const override;
 
-    void                              display();
-    const Array<Color>&               getColors() const;
+    void                              replot( const DMatrix< DMatrix< Vector<T, n> > >& p,
+                                              const DMatrix< Vector<float, 3> >& normals,
+                                              int m1, int m2, int d1, int d2,
+                                              bool closed_u, bool closed_v ) override;
+
+    const std::vector<Color>&         getColors() const;
+    void                              setColors( const std::vector<Color>& c );
     GM_PSURF_CONTOURSVISUALIZER_INTERPOLATION_METHOD   getInterpolationMethod() const;
-    GM_PSURF_CONTOURSVISUALIZER_MAP   getMapping() const;
-    void                              replot(
-      DMatrix< DMatrix< Vector<T, 3> > >& p,
-      DMatrix< Vector<T, 3> >& normals,
-      int m1, int m2, int d1, int d2,
-      bool closed_u, bool closed_v
-    );
-    void                              setColors( const Array<Color>& c );
     void                              setInterpolationMethod( GM_PSURF_CONTOURSVISUALIZER_INTERPOLATION_METHOD method );
+    GM_PSURF_CONTOURSVISUALIZER_MAP   getMapping() const;
     void                              setMapping( GM_PSURF_CONTOURSVISUALIZER_MAP mapping );
 
   protected:
-    Array<Color>                      _colors;
-    GM_PSURF_CONTOURSVISUALIZER_MAP   _mapping;
-    GM_PSURF_CONTOURSVISUALIZER_INTERPOLATION_METHOD   _method;
+    GL::Program                       _prog;
+    GL::Program                       _color_prog;
+
+    GL::VertexBufferObject            _vbo;
+    GL::IndexBufferObject             _ibo;
 
-    GLuint                            _ibo;
-    GLuint                            _vbo;
+    GLuint                            _no_strips;
+    GLuint                            _no_strip_indices;
+    GLsizei                           _strip_size;
 
-    int                               _tri_strips;
-    GLsizei                           _tri_strip_offset;
-    int                               _indices_per_tri_strip;
+    std::vector<Color>                _colors;    //!< Array<Color> can not be used, Color has no operator<
+    GM_PSURF_CONTOURSVISUALIZER_MAP   _mapping;
+    GM_PSURF_CONTOURSVISUALIZER_INTERPOLATION_METHOD   _method;
 
+    DMatrix<T>                        _values;    //!< The mapped field, kept to reuse its memory
 
+    void                              computeValues( const DMatrix< DMatrix< Vector<T, n> > >& p );
+    Color                             getColor( T d ) const;
+    Color                             getColorInterpolated( T d ) const;
 
-    Color                             getColor( T d );
-    Color                             getColorInterpolated( T d );
-    T                                 getCurvatureGauss( DMatrix< Vector<T,3> >& p );
-    T                                 getCurvatureMean( DMatrix< Vector<T,3> >& p );
-    T                                 getCurvaturePrincipalMax( DMatrix< Vector<T,3> >& p );
-    T                                 getCurvaturePrincipalMin( DMatrix< Vector<T,3> >& p );
-    T                                 getValue( DMatrix< DMatrix< Vector<T, 3> > >& p, int i, int j );
+    void                              draw() const;
+    void                              initShaderProgram();
+    void                              _init();
 
-  };
+  }; // END class PSurfContoursVisualizer
 
 } // END namespace GMlib
 
@@ -121,4 +136,4 @@ namespace GMlib {
 #include "gmpsurfcontoursvisualizer.c"
 
 
-#endif // __GMPSURFCONTOURSVISUALIZER_H__
+#endif // GM_PARAMETRICS_VISUALIZERS_PSURFCONTOURSVISUALIZER_H
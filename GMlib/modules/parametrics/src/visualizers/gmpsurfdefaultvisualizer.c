@@ -149,6 +149,18 @@ namespace GMlib {
 
 
 
+  template <typename T, int n>
+  inline
+  bool PSurfDefaultVisualizer<T,n>::replot( const PSurfStaging& stage, int /*d1*/, int /*d2*/, bool closed_u, bool closed_v ) {
+
+    PSurfVisualizer<T,n>::fillStandardVBO( _vbo, stage );
+    PSurfVisualizer<T,n>::fillTriangleStripIBO( _ibo, stage.getDim1(), stage.getDim2(), _no_strips, _no_strip_indices, _strip_size );
+    PSurfVisualizer<T,n>::fillNMap( _nmap, stage, closed_u, closed_v );
+    return true;
+  }
+
+
+
   template <typename T, int n>
   inline
   void PSurfDefaultVisualizer<T,n>::draw() const {
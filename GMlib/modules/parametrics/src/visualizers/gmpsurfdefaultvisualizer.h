@@ -54,6 +54,7 @@ namespace GMlib {
 
     void    replot( const DMatrix< DMatrix< Vector<T, n> > >& p, const DMatrix< Vector<float, 3> >& normals,
                                             int m1, int m2, int d1, int d2, bool closed_u, bool closed_v ) override;
+    bool    replot( const PSurfStaging& stage, int d1, int d2, bool closed_u, bool closed_v ) override;
 
   protected:
     GL::Program                 _prog;
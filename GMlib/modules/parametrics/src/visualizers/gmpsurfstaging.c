@@ -0,0 +1,218 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+
+#include "gmpsurfstaging.h"
+
+
+namespace GMlib {
+
+
+  inline
+  PSurfStaging::PSurfStaging() : _m1(0), _m2(0), _second_der(false) {}
+
+
+  /*! void PSurfStaging::setDim( int m1, int m2, bool second_der )
+   *  Set the size of the sample grid.
+   *  Memory is only reallocated if the grid grows beyond
+   *  the largest grid this buffer has held.
+   *
+   *  \param[in] m1          Number of samples in u-direction
+   *  \param[in] m2          Number of samples in v-direction
+   *  \param[in] second_der  Whether to keep the second derivative plane
+   */
+  inline
+  void PSurfStaging::setDim( int m1, int m2, bool second_der ) {
+
+    _m1 = m1;
+    _m2 = m2;
+    _second_der = second_der;
+
+    // The planes keep their size, they are only extended
+    const int k = m1*m2;
+    if( k > _vertices.getDim() ) {
+      _vertices.setDim( k );
+      _normals.setDim( k );
+    }
+    if( second_der && 3*k > _second.getDim() )
+      _second.setDim( 3*k );
+  }
+
+
+  inline
+  int PSurfStaging::getDim1() const {
+    return _m1;
+  }
+
+
+  inline
+  int PSurfStaging::getDim2() const {
+    return _m2;
+  }
+
+
+  inline
+  bool PSurfStaging::hasSecondDerivatives() const {
+    return _second_der;
+  }
+
+
+  inline
+  GL::GLVertexTex2D* PSurfStaging::getVertexPtr() {
+    return _vertices.getPtr();
+  }
+
+
+  inline
+  const GL::GLVertexTex2D* PSurfStaging::getVertexPtr() const {
+    return _vertices.getPtr();
+  }
+
+
+  inline
+  GL::GLNormal* PSurfStaging::getNormalPtr() {
+    return _normals.getPtr();
+  }
+
+
+  inline
+  const GL::GLNormal* PSurfStaging::getNormalPtr() const {
+    return _normals.getPtr();
+  }
+
+
+  /*! GL::GLVertex* PSurfStaging::getSecondDerivativePtr()
+   *  The second derivatives, three for each sample (uu,uv,vv), row major.
+   *  Only valid if hasSecondDerivatives() is true.
+   */
+  inline
+  GL::GLVertex* PSurfStaging::getSecondDerivativePtr() {
+    return _second.getPtr();
+  }
+
+
+  inline
+  const GL::GLVertex* PSurfStaging::getSecondDerivativePtr() const {
+    return _second.getPtr();
+  }
+
+
+  inline
+  GLsizeiptr PSurfStaging::getVertexBytes() const {
+    return GLsizeiptr(_m1) * _m2 * sizeof(GL::GLVertexTex2D);
+  }
+
+
+  /*! std::size_t PSurfStaging::getMemorySize() const
+   *  The number of bytes held by the planes, this is the size
+   *  of the largest grid the buffer has held since release().
+   */
+  inline
+  std::size_t PSurfStaging::getMemorySize() const {
+    return _vertices.getDim() * sizeof(GL::GLVertexTex2D)
+         + _normals.getDim()  * sizeof(GL::GLNormal)
+         + _second.getDim()   * sizeof(GL::GLVertex);
+  }
+
+
+  /*! void PSurfStaging::release()
+   *  Free the memory of the planes, the dimension is set to 0x0.
+   */
+  inline
+  void PSurfStaging::release() {
+
+    _m1 = _m2 = 0;
+    _second_der = false;
+    _vertices.resetDim(0);
+    _normals.resetDim(0);
+    _second.resetDim(0);
+  }
+
+
+  /*! void PSurfStaging::swap( PSurfStaging& s )
+   *  Exchange the planes with s, without copying them.
+   */
+  inline
+  void PSurfStaging::swap( PSurfStaging& s ) {
+
+    std::swap( _m1, s._m1 );
+    std::swap( _m2, s._m2 );
+    std::swap( _second_der, s._second_der );
+    _vertices.swap( s._vertices );
+    _normals.swap( s._normals );
+    _second.swap( s._second );
+  }
+
+
+  /*! void PSurfStaging::set( int i, int j, const DMatrix< Vector<T,n> >& p )
+   *  Pack one evaluated sample into the staging planes.
+   *  The normal is computed as in PSurf::resampleNormals().
+   *
+   *  \param[in] i  Sample index in u-direction
+   *  \param[in] j  Sample index in v-direction
+   *  \param[in] p  Position and partial derivatives, at least 1x1 (2x2 if second derivatives)
+   */
+  template <typename T, int n>
+  inline
+  void PSurfStaging::set( int i, int j, const DMatrix< Vector<T,n> >& p ) {
+
+    const int k = i*_m2 + j;
+
+    GL::GLVertexTex2D& v = _vertices[k];
+    v.x = float(p(0)(0)(0));
+    v.y = float(p(0)(0)(1));
+    v.z = float(p(0)(0)(2));
+    v.s = i/float(_m1-1);
+    v.t = j/float(_m2-1);
+
+    Vector<float,3> nor = p(1)(0) ^ p(0)(1);
+    nor.normalize();
+    _normals[k] = GL::GLNormal{ nor(0), nor(1), nor(2) };
+
+    if( _second_der ) {
+      const Vector<T,n>* d2[3] = { &p(2)(0), &p(1)(1), &p(0)(2) };
+      for( int l = 0; l < 3; l++ )
+        _second[3*k+l] = GL::GLVertex{ float((*d2[l])(0)), float((*d2[l])(1)), float((*d2[l])(2)) };
+    }
+  }
+
+
+  /*! void PSurfStaging::fill( const DMatrix< DMatrix< Vector<T,n> > >& p, bool second_der )
+   *  Pack a complete sample matrix, as made by PSurf::resample(), into the staging planes.
+   *
+   *  \param[in] p           The sample matrix
+   *  \param[in] second_der  Whether to fill the second derivative plane
+   */
+  template <typename T, int n>
+  inline
+  void PSurfStaging::fill( const DMatrix< DMatrix< Vector<T,n> > >& p, bool second_der ) {
+
+    setDim( p.getDim1(), p.getDim2(), second_der );
+    for( int i = 0; i < p.getDim1(); i++ )
+      for( int j = 0; j < p.getDim2(); j++ )
+        set( i, j, p(i)(j) );
+  }
+
+
+} // END namespace GMlib
@@ -0,0 +1,97 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+
+
+#ifndef GM_PARAMETRICS_VISUALIZERS_PSURFSTAGING_H
+#define GM_PARAMETRICS_VISUALIZERS_PSURFSTAGING_H
+
+
+// gmlib
+#include <core/types/gmpoint.h>
+#include <core/containers/gmdvector.h>
+#include <core/containers/gmdmatrix.h>
+#include <opengl/gmopengl.h>
+
+
+namespace GMlib {
+
+
+  /*! \class PSurfStaging gmpsurfstaging.h <gmPSurfStaging>
+   *  \brief CPU staging buffer for a sampled surface
+   *
+   *  Holds the sample grid of a surface in the layout the visualizers upload:
+   *  - an interleaved GLVertexTex2D plane, position and texture coordinates,
+   *    row major (index i*m2+j), the same as PSurfVisualizer::fillStandardVBO(),
+   *  - a GLNormal plane, row major, the same as the normal map texture,
+   *  - optionally a plane with the second derivatives (uu,uv,vv) for each sample.
+   *
+   *  No GL context is needed to fill it, the GL types are only used for the layout.
+   *  The planes only grow, so a staging buffer can be reused for each replot.
+   */
+  class PSurfStaging {
+  public:
+    PSurfStaging();
+
+    void                        setDim( int m1, int m2, bool second_der = false );
+    int                         getDim1() const;
+    int                         getDim2() const;
+    bool                        hasSecondDerivatives() const;
+
+    GL::GLVertexTex2D*          getVertexPtr();
+    const GL::GLVertexTex2D*    getVertexPtr() const;
+    GL::GLNormal*               getNormalPtr();
+    const GL::GLNormal*         getNormalPtr() const;
+    GL::GLVertex*               getSecondDerivativePtr();
+    const GL::GLVertex*         getSecondDerivativePtr() const;
+
+    GLsizeiptr                  getVertexBytes() const;
+    std::size_t                 getMemorySize() const;
+    void                        release();
+    void                        swap( PSurfStaging& s );
+
+    template <typename T, int n>
+    void                        set( int i, int j, const DMatrix< Vector<T,n> >& p );
+    template <typename T, int n>
+    void                        fill( const DMatrix< DMatrix< Vector<T,n> > >& p, bool second_der = false );
+
+  private:
+    int                         _m1;
+    int                         _m2;
+    bool                        _second_der;
+
+    DVector<GL::GLVertexTex2D>  _vertices;
+    DVector<GL::GLNormal>       _normals;
+    DVector<GL::GLVertex>       _second;
+
+  }; // END class PSurfStaging
+
+} // END namespace GMlib
+
+// Include PSurfStaging class function implementations
+#include "gmpsurfstaging.c"
+
+
+
+#endif // GM_PARAMETRICS_VISUALIZERS_PSURFSTAGING_H
@@ -116,6 +116,34 @@ void PSurfVisualizer<T,n>::fillNMap( GL::Texture& nmap, const DMatrix< Vector<fl
 }
 
 
+template <typename T, int n>
+inline
+void PSurfVisualizer<T,n>::fillNMap( GL::Texture& nmap, const PSurfStaging& stage, bool closed_u, bool closed_v) {
+
+  const int m1 = closed_u ? stage.getDim1()-1 : stage.getDim1();
+  const int m2 = closed_v ? stage.getDim2()-1 : stage.getDim2();
+
+  // The normal plane is row major with stride getDim2(), upload one row at the time if closed in v
+  if( m2 == stage.getDim2() )
+    nmap.texImage2D( 0, GL_RGB16F, m2, m1, 0, GL_RGB, GL_FLOAT, stage.getNormalPtr() );
+  else {
+    nmap.texImage2D( 0, GL_RGB16F, m2, m1, 0, GL_RGB, GL_FLOAT, 0x0 );
+    for( int i = 0; i < m1; ++i )
+      nmap.texSubImage2D( 0, 0, i, m2, 1, GL_RGB, GL_FLOAT, stage.getNormalPtr() + i*stage.getDim2() );
+  }
+
+  // set texture parameters for the nmap
+  nmap.texParameteri( GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+  nmap.texParameteri( GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+
+  if( closed_v )  nmap.texParameterf(GL_TEXTURE_WRAP_S, GL_REPEAT);
+  else            nmap.texParameterf(GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+
+  if( closed_u )  nmap.texParameterf(GL_TEXTURE_WRAP_T, GL_REPEAT);
+  else            nmap.texParameterf(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+
 template <typename T, int n>
 inline
 void PSurfVisualizer<T,n>::fillStandardIBO( GLuint ibo_id, int m1, int m2 ) {
@@ -189,6 +217,18 @@ void PSurfVisualizer<T,n>::fillStandardVBO(GL::VertexBufferObject &vbo,
 
 
 
+/*! void PSurfVisualizer<T,n>::fillStandardVBO( GL::VertexBufferObject& vbo, const PSurfStaging& stage )
+ *  The staging buffer has the same layout as the VBO, so it is uploaded in one shot.
+ */
+template <typename T, int n>
+inline
+void PSurfVisualizer<T,n>::fillStandardVBO(GL::VertexBufferObject &vbo, const PSurfStaging& stage) {
+
+  vbo.bufferData( stage.getVertexBytes(), stage.getVertexPtr(), GL_STATIC_DRAW );
+}
+
+
+
 template <typename T, int n>
 inline
 void PSurfVisualizer<T,n>::fillTriangleStripIBO(GL::IndexBufferObject& ibo, int m1, int m2,
@@ -359,6 +399,22 @@ void PSurfVisualizer<T,n>::replot(
 
 
 
+/*! bool PSurfVisualizer<T,n>::replot( const PSurfStaging& stage, int d1, int d2, bool closed_u, bool closed_v )
+ *  Replot from a staging buffer (see PSurf::setStagedReplot()).
+ *  A visualizer that can not work from the staging buffer returns false,
+ *  and is then replotted from the ordinary sample matrix.
+ */
+template <typename T, int n>
+bool PSurfVisualizer<T,n>::replot(
+  const PSurfStaging& /*stage*/,
+  int /*d1*/, int /*d2*/, bool /*closed_u*/, bool /*closed_v*/
+) {
+
+  return false;
+}
+
+
+
 } // END namespace GMlib
 
 
@@ -36,6 +36,8 @@
 #include <opengl/bufferobjects/gmindexbufferobject.h>
 #include <scene/gmvisualizer.h>
 
+#include "gmpsurfstaging.h"
+
 
 namespace GMlib {
 
@@ -53,12 +55,16 @@ namespace GMlib {
 
     virtual void  replot( const DVector<DVector<Vector<T, n> > >& p, const DMatrix< Vector<float,3> >& normals, int m, bool closed_u, bool closed_v );
 
+    virtual bool  replot( const PSurfStaging& stage, int d1, int d2, bool closed_u, bool closed_v );
+
 
     static void   fillStandardVBO(GL::VertexBufferObject &vbo, const DMatrix< DMatrix< Vector<T,n> > >& p );
     static void   fillStandardVBO(GL::VertexBufferObject &vbo, const DVector<DVector<Vector<T,n> > >& p );
+    static void   fillStandardVBO(GL::VertexBufferObject &vbo, const PSurfStaging& stage );
 
     static void   fillTriangleStripIBO(GL::IndexBufferObject& ibo, int m1, int m2, GLuint& no_strips, GLuint& no_strip_indices, GLsizei& strip_size );
     static void   fillNMap( GL::Texture& nmap, const DMatrix< Vector<float, 3> >& normals, bool closed_u, bool closed_v);
+    static void   fillNMap( GL::Texture& nmap, const PSurfStaging& stage, bool closed_u, bool closed_v);
     static void   compTriangleStripProperties( int m1, int m2, GLuint& no_strips, GLuint& no_strip_indices, GLsizei& strip_size );
 
     static void   fillMap( GL::Texture& map, const DMatrix< DMatrix< Vector<T,n> > >& p, int d1, int d2, bool closed_u, bool closed_v );
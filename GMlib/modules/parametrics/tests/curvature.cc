@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <gmParametricsModule>
+using namespace GMlib;
+
+#include "testsurfaces.h"
+
+
+namespace {
+
+
+  TEST(PSurfCurvature, Fields_match_the_pointwise_curvatures) {
+
+    PTorus<double> torus( 3.0, 1.0, 1.0 );
+    torus.replot( 23, 17, 2, 2 );
+
+    DMatrix<double> gauss, mean, kmax, kmin;
+    torus.getCurvatures( &gauss, &mean, &kmax, &kmin );
+    ASSERT_EQ( gauss.getDim1(), 23 );
+    ASSERT_EQ( gauss.getDim2(), 17 );
+
+    for( int i = 0; i < 23; i++ )
+      for( int j = 0; j < 17; j++ ) {
+        const double u = sampleValue( torus.getParStartU(), torus.getParEndU(), i, 23 );
+        const double v = sampleValue( torus.getParStartV(), torus.getParEndV(), j, 17 );
+        EXPECT_NEAR( gauss[i][j], torus.getCurvatureGauss( u, v ), 1e-9 );
+        EXPECT_NEAR( mean[i][j],  torus.getCurvatureMean( u, v ), 1e-9 );
+        EXPECT_NEAR( kmax[i][j],  torus.getCurvaturePrincipalMax( u, v ), 1e-9 );
+        EXPECT_NEAR( kmin[i][j],  torus.getCurvaturePrincipalMin( u, v ), 1e-9 );
+      }
+  }
+
+
+  TEST(PSurfCurvature, Sphere_has_constant_curvature) {
+
+    PSphere<float> sphere( 2.0f );
+    DMatrix<DMatrix<Vector<float,3>>> p;
+    sphere.replot( 20, 20, 2, 2 );
+
+    // The poles are singular (du = 0), leave them out
+    DMatrix<float> gauss, kmin;
+    sphere.getCurvatures( &gauss, nullptr, nullptr, &kmin );
+    for( int i = 0; i < 20; i++ )
+      for( int j = 1; j < 19; j++ ) {
+        EXPECT_NEAR( gauss[i][j], 0.25f, 1e-4 );
+        EXPECT_NEAR( std::fabs(kmin[i][j]), 0.5f, 1e-3 );
+      }
+  }
+
+
+  TEST(PSurfCurvature, Resamples_when_the_samples_lack_second_derivatives) {
+
+    PTorus<double> torus( 3.0, 1.0, 1.0 );
+    torus.replot( 12, 12, 1, 1 );
+
+    DMatrix<double> gauss;
+    torus.getCurvatures( &gauss, nullptr );
+    ASSERT_EQ( gauss.getDim1(), 12 );
+    EXPECT_NEAR( gauss[0][0], torus.getCurvatureGauss( torus.getParStartU(), torus.getParStartV() ), 1e-9 );
+
+    // Straight from a grid without 2nd derivatives, the fields are 0
+    DMatrix<DMatrix<Vector<double,3>>> p;
+    p.setDim( 2, 2 );
+    for( int i = 0; i < 2; i++ )
+      for( int j = 0; j < 2; j++ ) p[i][j].setDim( 2, 2 );
+    PSurf<double,3>::computeCurvatures( p, &gauss, nullptr );
+    EXPECT_EQ( gauss[1][1], 0.0 );
+  }
+
+
+  TEST(PSurfCurvature, Serial_and_parallel_fields_are_equal) {
+
+    PTorus<float> torus( 3.0f, 1.0f, 1.0f );
+    torus.replot( 200, 150, 2, 2 );
+
+    const int no_threads = getNoThreads();
+    DMatrix<float> par, ser;
+    torus.getCurvatures( nullptr, &par );
+    setNoThreads( 1 );
+    torus.getCurvatures( nullptr, &ser );
+    setNoThreads( no_threads );
+
+    for( int i = 0; i < 200; i++ )
+      for( int j = 0; j < 150; j++ )
+        EXPECT_EQ( par[i][j], ser[i][j] );
+  }
+
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <gmParametricsModule>
+using namespace GMlib;
+
+#include <cmath>
+#include <vector>
+
+
+namespace {
+
+
+  DVector<Vector<float,3>> points( const std::vector<Vector<float,3>>& p ) {
+
+    DVector<Vector<float,3>> c( int(p.size()) );
+    for( int i = 0; i < c.getDim(); i++ ) c[i] = p[i];
+    return c;
+  }
+
+
+  TEST(PCurveIntersection, Bspline_bezier_segments_follow_the_curve) {
+
+    PBSplineCurve<float> spline( points( { Vector<float,3>( 0.0f, 0.0f, 0.0f ), Vector<float,3>( 1.0f, 2.0f, 0.0f ),
+                                           Vector<float,3>( 2.0f, -1.0f, 1.0f ), Vector<float,3>( 3.0f, 1.0f, 0.0f ),
+                                           Vector<float,3>( 4.0f, 0.0f, -1.0f ), Vector<float,3>( 5.0f, 2.0f, 0.0f ) } ), 3, false );
+
+    std::vector<DVector<Vector<float,3>>> c;
+    std::vector<float>                    t;
+    ASSERT_TRUE( spline.getBezierSegments( c, t ) );
+    ASSERT_EQ( c.size(), std::size_t(3) );
+    ASSERT_EQ( t.size(), c.size() + 1 );
+    EXPECT_FLOAT_EQ( t.front(), spline.getParStart() );
+    EXPECT_FLOAT_EQ( t.back(),  spline.getParEnd() );
+
+    // The Bezier segments evaluated by de Casteljau's algorithm
+    for( std::size_t i = 0; i < c.size(); i++ )
+      for( int k = 0; k <= 4; k++ ) {
+        const float w = k / 4.0f;
+        DVector<Vector<float,3>> q = c[i];
+        for( int r = 1; r < q.getDim(); r++ )
+          for( int j = 0; j < q.getDim() - r; j++ ) q[j] = q(j) * (1 - w) + q(j+1) * w;
+
+        const Vector<float,3> p = spline.evaluateGlobalSmall( t[i] + w * (t[i+1] - t[i]), 0 )(0);
+        EXPECT_NEAR( (q(0) - p).getLength(), 0.0f, 1e-4 );
+      }
+  }
+
+
+  TEST(PCurveIntersection, Line_and_circle) {
+
+    PCircle<float> circle( 2.0f );
+    PLine<float>   line( Point<float,3>( -3.0f, 0.0f, 0.0f ), Point<float,3>( 3.0f, 0.0f, 0.0f ) );
+
+    PCurveIntersection<float> isect;
+    const std::vector<PCurveIntersection<float>::CurveHit> hits = isect.intersect( line, circle );
+    ASSERT_EQ( hits.size(), std::size_t(2) );
+    EXPECT_NEAR( hits[0].p(0), -2.0f, 1e-4 );
+    EXPECT_NEAR( hits[1].p(0),  2.0f, 1e-4 );
+    for( const PCurveIntersection<float>::CurveHit& h : hits ) {
+      EXPECT_NEAR( (line.evaluateGlobalSmall( h.t1, 0 )(0) - circle.evaluateGlobalSmall( h.t2, 0 )(0)).getLength(), 0.0f, 1e-4 );
+      EXPECT_NEAR( h.p(1), 0.0f, 1e-4 );
+    }
+
+    // The same from the plotting samples of the circle, which is then not evaluated to build
+    circle.sample( 50, 1 );
+    EXPECT_EQ( PCurveBvh<float>( circle ).getSource(), PCurveBvh<float>::SAMPLES );
+    EXPECT_EQ( isect.intersect( circle, line ).size(), std::size_t(2) );
+  }
+
+
+  TEST(PCurveIntersection, Bezier_curves) {
+
+    // y = 4t(1-t) against y = 0.5, at t = (1 -+ sqrt(0.5))/2
+    PBezierCurve<float> arc(  points( { Vector<float,3>( 0.0f, 0.0f, 0.0f ), Vector<float,3>( 1.0f, 2.0f, 0.0f ), Vector<float,3>( 2.0f, 0.0f, 0.0f ) } ) );
+    PBezierCurve<float> flat( points( { Vector<float,3>( 0.0f, 0.5f, 0.0f ), Vector<float,3>( 1.0f, 0.5f, 0.0f ), Vector<float,3>( 2.0f, 0.5f, 0.0f ) } ) );
+    EXPECT_EQ( PCurveBvh<float>( arc ).getSource(), PCurveBvh<float>::BEZIER );
+
+    PCurveIntersection<float> isect;
+    const std::vector<PCurveIntersection<float>::CurveHit> hits = isect.intersect( arc, flat );
+    ASSERT_EQ( hits.size(), std::size_t(2) );
+    EXPECT_NEAR( hits[0].t1, (1.0f - std::sqrt(0.5f)) / 2, 1e-4 );
+    EXPECT_NEAR( hits[1].t1, (1.0f + std::sqrt(0.5f)) / 2, 1e-4 );
+    EXPECT_NEAR( hits[0].t2, hits[0].t1, 1e-4 );
+
+    // Moved away, the boxes do not meet
+    PBezierCurve<float> above( points( { Vector<float,3>( 0.0f, 3.0f, 0.0f ), Vector<float,3>( 2.0f, 3.0f, 0.0f ) } ) );
+    EXPECT_TRUE( isect.intersect( arc, above ).empty() );
+    EXPECT_EQ( isect.getNoCandidates(), 0 );
+  }
+
+
+  TEST(PCurveIntersection, Line_and_torus) {
+
+    PTorus<float> torus( 3.0f, 1.0f, 1.0f );
+    PLine<float>  line( Point<float,3>( -5.0f, 0.0f, 0.0f ), Point<float,3>( 5.0f, 0.0f, 0.0f ) );
+
+    PCurveIntersection<float> isect;
+    const std::vector<PCurveIntersection<float>::SurfHit> hits = isect.intersect( line, torus );
+    ASSERT_EQ( hits.size(), std::size_t(4) );
+    const float x[4] = { -4.0f, -2.0f, 2.0f, 4.0f };
+    for( int i = 0; i < 4; i++ ) {
+      EXPECT_NEAR( hits[i].p(0), x[i], 1e-3 );
+      const Point<float,3> q = torus.evaluateGlobalSmall( hits[i].uv(0), hits[i].uv(1), 0, 0 )(0)(0);
+      EXPECT_NEAR( (q - hits[i].p).getLength(), 0.0f, 1e-3 );
+    }
+  }
+
+
+  TEST(PCurveIntersection, Batched_queries_match_single_ones) {
+
+    PCircle<float> circle( 2.0f );
+    std::vector<PLine<float>*> lines;
+    for( int i = 0; i < 6; i++ )
+      lines.push_back( new PLine<float>( Point<float,3>( -3.0f, i * 0.5f - 1.0f, 0.0f ), Point<float,3>( 3.0f, i * 0.5f - 1.2f, 0.0f ) ) );
+
+    std::vector<const PCurve<float,3>*> curves( 1, &circle );
+    curves.insert( curves.end(), lines.begin(), lines.end() );
+
+    PCurveIntersection<float> isect;
+    const std::vector<PCurveIntersection<float>::PairHits> all = isect.intersectAll( curves );
+
+    // The lines do not cross each other inside their domain
+    int n = 0;
+    for( const PCurveIntersection<float>::PairHits& ph : all ) {
+      EXPECT_EQ( ph.i, 0 );
+      const std::vector<PCurveIntersection<float>::CurveHit> single = isect.intersect( circle, *curves[ph.j] );
+      ASSERT_EQ( ph.hits.size(), single.size() );
+      for( std::size_t k = 0; k < single.size(); k++ )
+        EXPECT_NEAR( ph.hits[k].t1, single[k].t1, 1e-5 );
+      n += int(ph.hits.size());
+    }
+    EXPECT_EQ( n, 12 );
+
+    // Against a plane
+    PPlane<float> plane( Point<float,3>( 0.5f, -5.0f, -5.0f ), Vector<float,3>( 0.0f, 10.0f, 0.0f ), Vector<float,3>( 0.0f, 0.0f, 10.0f ) );
+    const std::vector<std::vector<PCurveIntersection<float>::SurfHit>> sh = isect.intersectAll( curves, plane );
+    ASSERT_EQ( sh.size(), curves.size() );
+    EXPECT_EQ( sh[0].size(), std::size_t(2) );
+    for( std::size_t i = 1; i < sh.size(); i++ ) {
+      ASSERT_EQ( sh[i].size(), std::size_t(1) );
+      EXPECT_NEAR( sh[i][0].p(0), 0.5f, 1e-4 );
+    }
+
+    for( PLine<float>* l : lines ) delete l;
+  }
+
+}
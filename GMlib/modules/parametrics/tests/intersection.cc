@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <gmParametricsModule>
+using namespace GMlib;
+
+#include <cmath>
+#include <memory>
+
+
+namespace {
+
+
+  // The largest distance between the two surfaces at the curve points
+  template <typename T>
+  T maxResidual( const PSurfIntersection<T>& isect, PSurf<T,3>& s1, PSurf<T,3>& s2 ) {
+
+    T r = T(0);
+    for( int i = 0; i < isect.getNoCurves(); i++ ) {
+      const typename PSurfIntersection<T>::Curve& c = isect.getCurve(i);
+      for( std::size_t k = 0; k < c.p.size(); k++ ) {
+        const Vector<T,3> p1 = s1.evaluateGlobalSmall( c.uv1[k](0), c.uv1[k](1), 0, 0 )(0)(0);
+        const Vector<T,3> p2 = s2.evaluateGlobalSmall( c.uv2[k](0), c.uv2[k](1), 0, 0 )(0)(0);
+        r = std::max( r, (p1 - p2).getLength() );
+        r = std::max( r, (p1 - c.p[k]).getLength() );
+      }
+    }
+    return r;
+  }
+
+
+  TEST(PSurfIntersection, Torus_and_plane_make_two_circles) {
+
+    PTorus<float> torus( 3.0f, 1.0f, 1.0f );
+    PPlane<float> plane( Point<float,3>( -5.0f, -5.0f, 0.0f ), Vector<float,3>( 10.0f, 0.0f, 0.0f ), Vector<float,3>( 0.0f, 10.0f, 0.0f ) );
+
+    PSurfIntersection<float> isect( &torus, &plane );
+    ASSERT_EQ( isect.compute(), 2 );
+    EXPECT_LT( maxResidual( isect, torus, plane ), 1e-3 );
+
+    float radii[2];
+    for( int i = 0; i < 2; i++ ) {
+      const PSurfIntersection<float>::Curve& c = isect.getCurve(i);
+      EXPECT_TRUE( c.closed );
+      EXPECT_GT( c.p.size(), std::size_t(30) );
+      radii[i] = std::sqrt( c.p[0](0)*c.p[0](0) + c.p[0](1)*c.p[0](1) );
+      for( const Point<float,3>& p : c.p ) {
+        EXPECT_NEAR( std::sqrt( p(0)*p(0) + p(1)*p(1) ), radii[i], 1e-4 );
+        EXPECT_NEAR( p(2), 0.0, 1e-4 );
+      }
+    }
+    EXPECT_NEAR( std::min( radii[0], radii[1] ), 2.0, 1e-4 );
+    EXPECT_NEAR( std::max( radii[0], radii[1] ), 4.0, 1e-4 );
+
+    // The culling leaves the patches along the circles only
+    EXPECT_LT( isect.getNoCandidates(), 32*32*32*32 / 50 );
+  }
+
+
+  TEST(PSurfIntersection, Torus_and_cylinder) {
+
+    PTorus<float>    torus( 3.0f, 1.0f, 1.0f );
+    PCylinder<float> cylinder( 3.5f, 3.5f, 4.0f );
+
+    PSurfIntersection<float> isect( &torus, &cylinder );
+    ASSERT_EQ( isect.compute(), 2 );
+    EXPECT_LT( maxResidual( isect, torus, cylinder ), 1e-3 );
+
+    // (3.5 - 3)^2 + z^2 = 1
+    const float z = std::sqrt( 0.75f );
+    for( int i = 0; i < 2; i++ ) {
+      const PSurfIntersection<float>::Curve& c = isect.getCurve(i);
+      EXPECT_TRUE( c.closed );
+      for( const Point<float,3>& p : c.p )
+        EXPECT_NEAR( std::fabs( p(2) ), z, 1e-4 );
+    }
+  }
+
+
+  TEST(PSurfIntersection, Planes_give_a_segment_ending_at_the_boundary) {
+
+    PPlane<float> p1( Point<float,3>( 0.0f, 0.0f, 0.0f ), Vector<float,3>( 2.0f, 0.0f, 0.0f ), Vector<float,3>( 0.0f, 2.0f, 0.0f ) );
+    PPlane<float> p2( Point<float,3>( 1.0f, -1.0f, -1.0f ), Vector<float,3>( 0.0f, 4.0f, 0.0f ), Vector<float,3>( 0.0f, 0.0f, 2.0f ) );
+
+    PSurfIntersection<float> isect( &p1, &p2, 8, 8 );
+    ASSERT_EQ( isect.compute(), 1 );
+
+    const PSurfIntersection<float>::Curve& c = isect.getCurve(0);
+    EXPECT_FALSE( c.closed );
+
+    // The line x = 1 across the first plane, y from 0 to 2
+    const Point<float,3>& a = c.p.front();
+    const Point<float,3>& b = c.p.back();
+    EXPECT_NEAR( a(0), 1.0, 1e-4 );
+    EXPECT_NEAR( b(0), 1.0, 1e-4 );
+    EXPECT_NEAR( std::min( a(1), b(1) ), 0.0, 1e-4 );
+    EXPECT_NEAR( std::max( a(1), b(1) ), 2.0, 1e-4 );
+
+    std::vector<PSurfCurve<float>*> curves = isect.makePSurfCurves( 0, 0 );
+    EXPECT_EQ( curves.size(), c.p.size() - 1 );
+    for( PSurfCurve<float>* pc : curves ) delete pc;
+  }
+
+
+  TEST(PSurfIntersection, Erbs_and_bspline_surfaces_against_a_plane) {
+
+    PTorus<float> torus( 3.0f, 1.0f, 1.0f );
+    std::unique_ptr<PERBSSurf<float>> erbs( new PERBSSurf<float>( &torus, 6, 6, 2, 2 ) );
+    PPlane<float> plane( Point<float,3>( -5.0f, -5.0f, 0.3f ), Vector<float,3>( 10.0f, 0.0f, 0.0f ), Vector<float,3>( 0.0f, 10.0f, 0.0f ) );
+
+    PSurfIntersection<float> isect( erbs.get(), &plane );
+    EXPECT_EQ( isect.compute(), 2 );
+    EXPECT_LT( maxResidual( isect, *erbs, plane ), 1e-3 );
+    for( int i = 0; i < isect.getNoCurves(); i++ )
+      EXPECT_TRUE( isect.getCurve(i).closed );
+
+    // A wavy open B-spline surface through z = 0
+    DMatrix<Vector<float,3>> c( 5, 5 );
+    for( int i = 0; i < 5; i++ )
+      for( int j = 0; j < 5; j++ )
+        c[i][j] = Vector<float,3>( i, j, (i+j) % 2 ? 1.0f : -1.0f );
+    DVector<float> u( 8 ), v( 8 );
+    const float kn[8] = { 0, 0, 0, 1, 2, 3, 3, 3 };
+    for( int k = 0; k < 8; k++ ) u[k] = v[k] = kn[k];
+    PBSplineSurf<float> bspline( c, u, v );
+    PPlane<float> plane0( Point<float,3>( -1.0f, -1.0f, 0.0f ), Vector<float,3>( 6.0f, 0.0f, 0.0f ), Vector<float,3>( 0.0f, 6.0f, 0.0f ) );
+
+    PSurfIntersection<float> isect2( &bspline, &plane0 );
+    EXPECT_GT( isect2.compute(), 0 );
+    EXPECT_LT( maxResidual( isect2, bspline, plane0 ), 1e-3 );
+  }
+
+
+  TEST(PSurfIntersection, Apart_surfaces_have_no_candidates) {
+
+    PSphere<float> s1( 1.0f );
+    PPlane<float>  p( Point<float,3>( -2.0f, -2.0f, 3.0f ), Vector<float,3>( 4.0f, 0.0f, 0.0f ), Vector<float,3>( 0.0f, 4.0f, 0.0f ) );
+
+    PSurfIntersection<float> isect( &s1, &p );
+    EXPECT_EQ( isect.compute(), 0 );
+    EXPECT_EQ( isect.getNoCandidates(), 0 );
+  }
+
+}
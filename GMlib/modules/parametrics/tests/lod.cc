@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <gmParametricsModule>
+#include <gmSceneModule>
+using namespace GMlib;
+
+#include "testsurfaces.h"
+#include "../../scene/tests/testcamera.h"
+
+
+namespace {
+
+
+  // Camera on the x-axis looking at origo
+  void placeCamera( Camera& cam, float dist ) {
+    ::placeCamera( cam, Point<float,3>( dist, 0.0f, 0.0f ), Vector<float,3>( 0.0f, 0.0f, 1.0f ), 10000.0f );
+  }
+
+
+  // The prepare pass of the DefaultRenderer, without drawing
+  int prepare( Scene& scene, Camera& cam, LodController& lod ) {
+    scene.prepare();
+    Array<const SceneObject*> objs;
+    scene.getRenderList( objs, &cam );
+    return lod.update( objs, cam );
+  }
+
+
+  TEST(LodController, Projected_radius_and_samples_decrease_with_distance) {
+
+    Camera cam;
+    LodController lod( 0.5f );
+    const Sphere<float,3> s( Point<float,3>( 0.0f, 0.0f, 0.0f ), 4.0f );
+
+    placeCamera( cam, 20.0f );
+    const float r_near = lod.computeProjectedRadius( s, cam );
+    placeCamera( cam, 200.0f );
+    const float r_far  = lod.computeProjectedRadius( s, cam );
+
+    EXPECT_GT( r_near, r_far );
+    EXPECT_GT( lod.computeRequiredSamples( r_near ), lod.computeRequiredSamples( r_far ) );
+    EXPECT_EQ( lod.computeRequiredSamples( 0.0f ), 2 );
+  }
+
+
+  TEST(LodController, Surface_levels_follow_distance_with_hysteresis) {
+
+    Scene scene;
+    Camera cam;
+    CountingTorus torus;
+    scene.insert( &torus );
+
+    torus.replot( 65, 65, 1, 1 );
+    torus.enableLod( 3 );
+    ASSERT_EQ( torus.getLodLevels(), 3 );
+    EXPECT_EQ( torus.getLodSamples(0), 65 );
+    EXPECT_EQ( torus.getLodSamples(1), 33 );
+    EXPECT_EQ( torus.getLodSamples(2), 17 );
+
+    LodController lod( 0.5f, 0.25f );
+
+    placeCamera( cam, 10.0f );
+    prepare( scene, cam, lod );
+    EXPECT_EQ( torus.getLodLevel(), 0 );
+
+    placeCamera( cam, 2000.0f );
+    EXPECT_EQ( prepare( scene, cam, lod ), 1 );
+    EXPECT_EQ( torus.getLodLevel(), 2 );
+    EXPECT_EQ( torus.getSamplesU(), 17 );
+
+    // Find the distance where level 1 is needed, just inside it the level
+    // goes finer at once, and must go well beyond it to get coarse again
+    float dist = 2000.0f;
+    while( lod.computeLevel( torus, ( placeCamera( cam, dist ), cam ) ) == 2 ) dist *= 0.99f;
+    prepare( scene, cam, lod );
+    EXPECT_EQ( torus.getLodLevel(), 1 );
+
+    placeCamera( cam, dist / 0.98f );
+    EXPECT_EQ( prepare( scene, cam, lod ), 0 );
+    EXPECT_EQ( torus.getLodLevel(), 1 );
+
+    placeCamera( cam, 2000.0f );
+    prepare( scene, cam, lod );
+    EXPECT_EQ( torus.getLodLevel(), 2 );
+
+    scene.remove( &torus );
+  }
+
+
+  TEST(LodController, Surface_levels_are_kept_until_edited) {
+
+    CountingTorus torus;
+    torus.replot( 33, 33, 1, 1 );
+    torus.enableLod( 2 );
+
+    torus.setLodLevel( 1 );
+    torus.setLodLevel( 0 );
+    const int evals = torus.evals;
+
+    // Both levels are sampled, going back and forth does not evaluate
+    torus.setLodLevel( 1 );
+    torus.setLodLevel( 0 );
+    EXPECT_EQ( torus.evals.load(), evals );
+    EXPECT_EQ( torus.getLodLevel(), 0 );
+
+    // Editing drops the kept samples
+    torus.replot();
+    const int edited = torus.evals;
+    torus.setLodLevel( 1 );
+    EXPECT_GT( torus.evals.load(), edited );
+
+    torus.disableLod();
+    EXPECT_EQ( torus.getLodLevels(), 0 );
+    EXPECT_EQ( torus.getSamplesU(), 33 );
+  }
+
+
+  TEST(LodController, Surface_cached_levels_set_the_sampling) {
+
+    CountingTorus torus, coarse;
+    torus.replot( 33, 33, 1, 1 );
+    coarse.replot( 17, 17, 1, 1 );
+    torus.enableLod( 2 );
+
+    torus.setLodLevel( 1 );
+    torus.setLodLevel( 0 );
+    const int evals = torus.evals;
+
+    // From the kept samples, as if sampled again
+    torus.setLodLevel( 1 );
+    EXPECT_EQ( torus.evals.load(), evals );
+    EXPECT_EQ( torus.getSamplesU(), 17 );
+    EXPECT_EQ( torus.getSamplesV(), 17 );
+    EXPECT_FLOAT_EQ( torus.getSurroundingSphere().getRadius(), coarse.getSurroundingSphere().getRadius() );
+
+    // An edit replots at the level it is on
+    torus.evals = 0;
+    torus.replot();
+    EXPECT_EQ( torus.evals.load(), 17 * 17 );
+    EXPECT_EQ( torus.getLodLevel(), 1 );
+    EXPECT_EQ( torus.getSamplesU(), 17 );
+  }
+
+
+  TEST(LodController, Surface_levels_hold_their_samples_once) {
+
+    PTorus<float> fine, coarse;
+    fine.replot( 33, 33, 1, 1 );
+    coarse.replot( 17, 17, 1, 1 );
+
+    PTorus<float> torus;
+    torus.replot( 33, 33, 1, 1 );
+    torus.enableLod( 2 );
+    EXPECT_EQ( torus.getSampleBufferSize(), fine.getSampleBufferSize() );
+
+    // The present level is in the sample buffers, not copied to the level
+    torus.setLodLevel( 1 );
+    torus.setLodLevel( 0 );
+    torus.setLodLevel( 1 );
+    const std::size_t both = fine.getSampleBufferSize() + coarse.getSampleBufferSize();
+    EXPECT_EQ( torus.getSampleBufferSize(), both );
+    EXPECT_EQ( torus.getSampleBufferPeakSize(), both );
+
+    // A copy gets the levels, not their samples
+    PTorus<float> copy( torus );
+    EXPECT_EQ( copy.getLodLevels(), 2 );
+    EXPECT_EQ( copy.getLodSamples(1), 17 );
+    EXPECT_EQ( copy.getSampleBufferSize(), std::size_t(0) );
+  }
+
+
+  TEST(LodController, Curve_levels) {
+
+    PCircle<float> circle( 2.0f );
+    circle.sample( 100, 0 );
+    circle.enableLod( 4 );
+    ASSERT_EQ( circle.getLodLevels(), 4 );
+    EXPECT_EQ( circle.getLodSamples(3), 13 );
+
+    circle.setLodLevel( 3 );
+    EXPECT_EQ( circle.getNumSamples(), 13 );
+    EXPECT_EQ( int(circle.getSampleValues().size()), 13 );
+
+    circle.setLodLevel( 0 );
+    EXPECT_EQ( circle.getNumSamples(), 100 );
+    EXPECT_EQ( int(circle.getSampleValues().size()), 100 );
+
+    // A new sampling makes new levels
+    circle.sample( 40, 0 );
+    EXPECT_EQ( circle.getLodLevel(), 0 );
+    EXPECT_EQ( circle.getLodSamples(1), 20 );
+  }
+
+}
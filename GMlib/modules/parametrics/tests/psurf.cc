@@ -0,0 +1,270 @@
+#include <gtest/gtest.h>
+
+#include <gmParametricsModule>
+#include <gmSceneModule>
+using namespace GMlib;
+
+#include "testsurfaces.h"
+
+#include <chrono>
+#include <thread>
+
+
+namespace {
+
+
+  // Calls syncReplot() until it takes in a replot, false after 10 s
+  bool waitForSync( PSurf<float,3>& surf ) {
+    for( int i = 0; i < 10000; i++ ) {
+      if( surf.syncReplot() ) return true;
+      std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+    }
+    return false;
+  }
+
+
+  TEST(PSurf, SampleBuffers_peakSize_and_shrink) {
+
+    PTorus<float> torus;
+    EXPECT_EQ( torus.getSampleBufferSize(), std::size_t(0) );
+    EXPECT_EQ( torus.getSampleBufferPeakSize(), std::size_t(0) );
+
+    torus.replot( 20, 20, 1, 1 );
+    const std::size_t size20 = torus.getSampleBufferSize();
+    EXPECT_GT( size20, std::size_t(0) );
+    EXPECT_EQ( torus.getSampleBufferPeakSize(), size20 );
+
+    torus.replot( 30, 30, 1, 1 );
+    const std::size_t size30 = torus.getSampleBufferSize();
+    EXPECT_GT( size30, size20 );
+
+    // Sampling less do not lower the peak size
+    torus.replot( 10, 10, 1, 1 );
+    EXPECT_LT( torus.getSampleBufferSize(), size30 );
+    EXPECT_EQ( torus.getSampleBufferPeakSize(), size30 );
+
+    torus.shrinkSampleBuffers();
+    EXPECT_EQ( torus.getSampleBufferSize(), std::size_t(0) );
+    EXPECT_EQ( torus.getSampleBufferPeakSize(), std::size_t(0) );
+
+    // And the buffers are made again
+    torus.replot();
+    EXPECT_GT( torus.getSampleBufferSize(), std::size_t(0) );
+  }
+
+
+  TEST(PSurf, SampleBuffers_staged_replot_reuses_staging) {
+
+    PTorus<float> torus;
+    torus.setStagedReplot( true );
+    torus.replot( 20, 20, 1, 1 );
+
+    const GL::GLVertexTex2D* ptr = torus.getStaging().getVertexPtr();
+    EXPECT_EQ( torus.getStaging().getDim1(), 20 );
+
+    torus.replot( 15, 15, 1, 1 );
+    torus.replot( 20, 20, 1, 1 );
+    EXPECT_EQ( torus.getStaging().getVertexPtr(), ptr );
+  }
+
+
+  TEST(PSurf, Async_replot_is_kept_until_synced) {
+
+    CountingTorus torus, reference;
+    torus.replot( 10, 10, 1, 1 );
+    reference.replot( 40, 30, 1, 1 );
+    EXPECT_FALSE( torus.syncReplot() );
+
+    torus.replotAsync( 40, 30, 1, 1 );
+    EXPECT_EQ( torus.getSamplesU(), 10 );
+    ASSERT_TRUE( waitForSync( torus ) );
+    EXPECT_FALSE( torus.isReplotAsyncPending() );
+    EXPECT_FALSE( torus.syncReplot() );
+
+    EXPECT_EQ( torus.getSamplesU(), 40 );
+    EXPECT_EQ( torus.getSamplesV(), 30 );
+    EXPECT_EQ( torus.getSampleBufferSize(), reference.getSampleBufferSize() );
+    const Sphere<float,3>& s = torus.getSurroundingSphere();
+    const Sphere<float,3>& r = reference.getSurroundingSphere();
+    EXPECT_FLOAT_EQ( s.getRadius(), r.getRadius() );
+    EXPECT_NEAR( ( s.getPos() - r.getPos() ).getLength(), 0.0f, 1e-5f );
+
+    // A replot() afterwards uses the new sampling
+    torus.evals = 0;
+    torus.replot();
+    EXPECT_EQ( torus.evals.load(), 40 * 30 );
+  }
+
+
+  TEST(PSurf, Async_replot_newest_request_wins) {
+
+    CountingTorus torus;
+    torus.replot( 10, 10, 1, 1 );
+
+    torus.replotAsync( 200, 200, 1, 1 );
+    torus.replotAsync( 50, 50, 1, 1 );
+    torus.replotAsync( 20, 25, 1, 1 );
+    ASSERT_TRUE( waitForSync( torus ) );
+    EXPECT_EQ( torus.getSamplesU(), 20 );
+    EXPECT_EQ( torus.getSamplesV(), 25 );
+    EXPECT_FALSE( torus.isReplotAsyncPending() );
+
+    // Cancelled, the previous sampling is kept
+    torus.replotAsync( 300, 300, 1, 1 );
+    torus.cancelReplotAsync();
+    EXPECT_FALSE( torus.isReplotAsyncPending() );
+    EXPECT_FALSE( torus.syncReplot() );
+    EXPECT_EQ( torus.getSamplesU(), 20 );
+
+    // A synchronous replot supersedes it
+    torus.replotAsync( 300, 300, 1, 1 );
+    torus.replot( 15, 15, 1, 1 );
+    EXPECT_FALSE( torus.syncReplot() );
+    EXPECT_EQ( torus.getSamplesU(), 15 );
+  }
+
+
+  TEST(PSurf, Async_replot_deleted_while_sampling) {
+
+    // The thread samples a copy, the surface can go at any time
+    for( int i = 0; i < 20; i++ ) {
+      PTorus<float>* torus = new PTorus<float>( 3.0f, 1.0f, 1.0f );
+      torus->replot( 10, 10, 1, 1 );
+      torus->replotAsync( 400, 400, 1, 1 );
+      if( i % 2 ) std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+      delete torus;
+    }
+
+    // and be changed meanwhile
+    PTorus<float> torus( 3.0f, 1.0f, 1.0f );
+    torus.replot( 10, 10, 1, 1 );
+    torus.replotAsync( 40, 40, 1, 1 );
+    torus.replot( 12, 12, 1, 1 );
+    torus.replotAsync( 30, 30, 1, 1 );
+    EXPECT_EQ( torus.getSamplesU(), 12 );
+    ASSERT_TRUE( waitForSync( torus ) );
+    EXPECT_EQ( torus.getSamplesU(), 30 );
+  }
+
+
+  // Evaluates slowly, and so do its copies
+  class SlowTorus : public PTorus<float> {
+    GM_SCENEOBJECT(SlowTorus)
+  public:
+    SlowTorus() : PTorus<float>( 3.0f, 1.0f, 1.0f ) {}
+    SlowTorus( const SlowTorus& copy ) : PTorus<float>( copy ) {}
+  protected:
+    void eval( float u, float v, int d1, int d2, bool lu, bool lv ) const override {
+      std::this_thread::sleep_for( std::chrono::microseconds(20) );
+      PTorus<float>::eval( u, v, d1, d2, lu, lv );
+    }
+  };
+
+
+  // Counts its copies
+  class CopyCounter : public SceneObject {
+    GM_SCENEOBJECT(CopyCounter)
+  public:
+    CopyCounter() {}
+    CopyCounter( const CopyCounter& copy ) : SceneObject( copy ) { copies++; }
+    static std::atomic<int> copies;
+  };
+  std::atomic<int> CopyCounter::copies( 0 );
+
+
+  TEST(PSurf, Async_replot_cancelled_within_a_row) {
+
+    SlowTorus torus;
+    torus.replot( 5, 5, 1, 1 );
+
+    // Seconds of sampling, on the background pool
+    torus.replotAsync( 300, 300, 1, 1 );
+    std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+    EXPECT_FALSE( TaskPool::getShared().runOne() );
+
+    const auto start = std::chrono::steady_clock::now();
+    torus.replot( 6, 6, 1, 1 );
+    EXPECT_LT( std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500) );
+    EXPECT_FALSE( torus.isReplotAsyncPending() );
+    EXPECT_EQ( torus.getSamplesU(), 6 );
+  }
+
+
+  TEST(PSurf, Async_replot_copies_only_the_shape) {
+
+    PTorus<float> torus( 3.0f, 1.0f, 1.0f );
+    torus.replot( 10, 10, 1, 1 );
+    CopyCounter* child = new CopyCounter;
+    torus.insert( child );
+
+    SceneObject* copy = torus.makeCopy();
+    EXPECT_EQ( CopyCounter::copies.load(), 1 );
+    delete copy;
+
+    torus.replotAsync( 20, 20, 1, 1 );
+    ASSERT_TRUE( waitForSync( torus ) );
+    EXPECT_EQ( CopyCounter::copies.load(), 1 );
+    EXPECT_EQ( torus.getSamplesU(), 20 );
+  }
+
+
+  TEST(PSurf, Async_replot_synced_by_the_scene) {
+
+    Scene scene;
+    CountingTorus a, b;
+    a.replot( 10, 10, 1, 1 );
+    b.replot( 10, 10, 1, 1 );
+    scene.insert( &a );
+    scene.insert( &b );
+
+    a.replotAsync( 30, 30, 1, 1 );
+    int n = 0;
+    for( int i = 0; i < 10000 && n == 0; i++ ) {
+      n = scene.syncReplots();
+      if( n == 0 ) std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+    }
+    EXPECT_EQ( n, 1 );
+    EXPECT_EQ( a.getSamplesU(), 30 );
+    EXPECT_EQ( b.getSamplesU(), 10 );
+
+    scene.remove( &a );
+    scene.remove( &b );
+  }
+
+
+  TEST(PSurf, EvaluateSmall_as_evaluate_up_to_the_capacity) {
+
+    PTorus<float> torus( 3.0f, 1.0f, 1.0f );
+    const float u = 0.3f, v = 1.1f;
+
+    SmallMatrix<Vector<float,3>,4,4> s = torus.evaluateSmall( u, v, 2, 1 );
+    ASSERT_EQ( s.getDim1(), 3 );
+    ASSERT_EQ( s.getDim2(), 2 );
+    DMatrix<Vector<float,3>> p = torus.evaluate( u, v, 2, 1 );
+    for( int i = 0; i < 3; i++ )
+      for( int j = 0; j < 2; j++ )
+        EXPECT_EQ( s(i)(j), p(i)(j) );
+
+    // More derivatives than the inline capacity are not computed
+    for( int k = 0; k < 3; k++ ) {
+      s = k == 0 ? torus.evaluateSmall( u, v, 5, 7 )
+        : k == 1 ? torus.evaluateParentSmall( u, v, 5, 7 )
+        :          torus.evaluateGlobalSmall( u, v, 4, 3 );
+      ASSERT_EQ( s.getDim1(), 4 );
+      ASSERT_EQ( s.getDim2(), 4 );
+      p = torus.evaluate( u, v, 3, 3 );
+      for( int i = 0; i < 4; i++ )
+        for( int j = 0; j < 4; j++ )
+          EXPECT_NEAR( ( s(i)(j) - p(i)(j) ).getLength(), 0.0f, 1e-5f );
+    }
+
+    PCircle<float> circle( 2.0f );
+    SmallVector<Vector<float,3>,4> c = circle.evaluateSmall( 0.4f, 6 );
+    ASSERT_EQ( c.getDim(), 4 );
+    DVector<Vector<float,3>> q = circle.evaluate( 0.4f, 3 );
+    for( int i = 0; i < 4; i++ )
+      EXPECT_EQ( c(i), q(i) );
+    EXPECT_EQ( circle.evaluateGlobalSmall( 0.4f, 9 ).getDim(), 4 );
+  }
+
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <gmParametricsModule>
+using namespace GMlib;
+
+#include "testsurfaces.h"
+
+#include <cmath>
+
+
+namespace {
+
+
+  TEST(PSurfStaging, Layout_matches_GLVertexTex2D_and_GLNormal) {
+
+    EXPECT_EQ( sizeof(GL::GLVertexTex2D), 5 * sizeof(GLfloat) );
+    EXPECT_EQ( sizeof(GL::GLNormal),      3 * sizeof(GLfloat) );
+
+    PSurfStaging stage;
+    stage.setDim( 4, 3 );
+    EXPECT_EQ( stage.getVertexBytes(), GLsizeiptr(12 * sizeof(GL::GLVertexTex2D)) );
+  }
+
+
+  TEST(PSurfStaging, Plane_positions_texcoords_and_normals) {
+
+    PPlane<float> plane( Point<float,3>(0.0f, 0.0f, 0.0f),
+                         Vector<float,3>(2.0f, 0.0f, 0.0f),
+                         Vector<float,3>(0.0f, 3.0f, 0.0f) );
+
+    const int m1 = 5, m2 = 4;
+    PSurfStaging stage;
+    plane.resampleStaging( stage, m1, m2 );
+
+    ASSERT_EQ( stage.getDim1(), m1 );
+    ASSERT_EQ( stage.getDim2(), m2 );
+    EXPECT_FALSE( stage.hasSecondDerivatives() );
+
+    for( int i = 0; i < m1; i++ )
+      for( int j = 0; j < m2; j++ ) {
+        const GL::GLVertexTex2D& v = stage.getVertexPtr()[i*m2 + j];
+        const GL::GLNormal&      nv = stage.getNormalPtr()[i*m2 + j];
+        EXPECT_FLOAT_EQ( v.x, 2.0f * i/(m1-1) );
+        EXPECT_FLOAT_EQ( v.y, 3.0f * j/(m2-1) );
+        EXPECT_FLOAT_EQ( v.z, 0.0f );
+        EXPECT_FLOAT_EQ( v.s, i/float(m1-1) );
+        EXPECT_FLOAT_EQ( v.t, j/float(m2-1) );
+        EXPECT_FLOAT_EQ( nv.nx, 0.0f );
+        EXPECT_FLOAT_EQ( nv.ny, 0.0f );
+        EXPECT_FLOAT_EQ( std::fabs(nv.nz), 1.0f );
+      }
+  }
+
+
+  TEST(PSurfStaging, Torus_matches_evaluate_including_second_derivatives) {
+
+    PTorus<float> torus( 3.0f, 1.0f, 1.0f );
+
+    const int m1 = 7, m2 = 6;
+    PSurfStaging stage;
+    Sphere<float,3> s;
+    torus.resampleStaging( stage, m1, m2, true, &s );
+
+    ASSERT_TRUE( stage.hasSecondDerivatives() );
+    EXPECT_TRUE( s.isValid() );
+
+    for( int i = 0; i < m1; i++ )
+      for( int j = 0; j < m2; j++ ) {
+        const float u = sampleValue( torus.getParStartU(), torus.getParEndU(), i, m1 );
+        const float v = sampleValue( torus.getParStartV(), torus.getParEndV(), j, m2 );
+        const DMatrix<Vector<float,3>>& p = torus.evaluate( u, v, 2, 2 );
+
+        const int k = i*m2 + j;
+        const GL::GLVertexTex2D& q = stage.getVertexPtr()[k];
+        EXPECT_NEAR( q.x, p(0)(0)(0), 1e-5 );
+        EXPECT_NEAR( q.y, p(0)(0)(1), 1e-5 );
+        EXPECT_NEAR( q.z, p(0)(0)(2), 1e-5 );
+
+        UnitVector<float,3> nor = p(1)(0) ^ p(0)(1);
+        const GL::GLNormal& nq = stage.getNormalPtr()[k];
+        EXPECT_NEAR( nq.nx, nor(0), 1e-5 );
+        EXPECT_NEAR( nq.ny, nor(1), 1e-5 );
+        EXPECT_NEAR( nq.nz, nor(2), 1e-5 );
+
+        const GL::GLVertex* d2 = stage.getSecondDerivativePtr() + 3*k;
+        EXPECT_NEAR( d2[0].x, p(2)(0)(0), 1e-4 );
+        EXPECT_NEAR( d2[1].y, p(1)(1)(1), 1e-4 );
+        EXPECT_NEAR( d2[2].z, p(0)(2)(2), 1e-4 );
+      }
+  }
+
+
+  TEST(PSurfStaging, Buffer_is_reused_when_shrinking) {
+
+    PSurfStaging stage;
+    stage.setDim( 20, 20 );
+    const GL::GLVertexTex2D* ptr = stage.getVertexPtr();
+
+    stage.setDim( 10, 10 );
+    EXPECT_EQ( stage.getVertexPtr(), ptr );
+    stage.setDim( 20, 20 );
+    EXPECT_EQ( stage.getVertexPtr(), ptr );
+  }
+
+}
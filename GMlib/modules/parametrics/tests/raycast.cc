@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <gmParametricsModule>
+#include <gmSceneModule>
+using namespace GMlib;
+
+#include <cmath>
+#include <vector>
+
+
+namespace {
+
+
+  // Distance from the torus (3,1) around the z-axis
+  float torusDistance( const Point<float,3>& p ) {
+
+    const float r = std::sqrt( p(0)*p(0) + p(1)*p(1) ) - 3.0f;
+    return std::abs( std::sqrt( r*r + p(2)*p(2) ) - 1.0f );
+  }
+
+
+  TEST(PSurfRay, Plane_hit_parameters_and_normal) {
+
+    PPlane<float> plane( Point<float,3>( 0.0f, 0.0f, 0.0f ), Vector<float,3>( 4.0f, 0.0f, 0.0f ), Vector<float,3>( 0.0f, 2.0f, 0.0f ) );
+    plane.replot( 5, 5, 1, 1 );
+
+    RayHit hit;
+    ASSERT_TRUE( plane.intersectRay( Point<float,3>( 1.0f, 0.5f, 3.0f ), Vector<float,3>( 0.0f, 0.0f, -2.0f ), hit ) );
+    EXPECT_NEAR( hit.t, 1.5f, 1e-5 );
+    EXPECT_NEAR( hit.uv(0), 0.25f, 1e-5 );
+    EXPECT_NEAR( hit.uv(1), 0.25f, 1e-5 );
+    EXPECT_NEAR( hit.pos(2), 0.0f, 1e-5 );
+    EXPECT_NEAR( std::abs( hit.normal(2) ), 1.0f, 1e-5 );
+
+    // Going away, and passing beside
+    EXPECT_FALSE( plane.intersectRay( Point<float,3>( 1.0f, 0.5f, 3.0f ), Vector<float,3>( 0.0f, 0.0f, 1.0f ), hit ) );
+    EXPECT_FALSE( plane.intersectRay( Point<float,3>( 5.0f, 0.5f, 3.0f ), Vector<float,3>( 0.0f, 0.0f, -1.0f ), hit ) );
+  }
+
+
+  TEST(PSurfRay, Torus_hits_are_on_the_true_surface) {
+
+    // A coarse sampling, the hits are refined on the surface
+    PTorus<float> torus( 3.0f, 1.0f, 1.0f );
+    torus.replot( 9, 7, 1, 1 );
+
+    RayHit hit;
+    ASSERT_TRUE( torus.intersectRay( Point<float,3>( 10.0f, 0.0f, 0.0f ), Vector<float,3>( -1.0f, 0.0f, 0.0f ), hit ) );
+    EXPECT_NEAR( hit.t, 6.0f, 1e-4 );
+    EXPECT_NEAR( hit.pos(0), 4.0f, 1e-4 );
+    EXPECT_NEAR( std::abs( hit.normal(0) ), 1.0f, 1e-4 );
+
+    // Through the hole
+    EXPECT_FALSE( torus.intersectRay( Point<float,3>( 0.0f, 0.0f, 5.0f ), Vector<float,3>( 0.0f, 0.0f, -1.0f ), hit ) );
+
+    // Rays from a point above, the nearest hit is found
+    for( int k = 0; k < 32; k++ ) {
+      const float a = 0.2f * k;
+      const Point<float,3>  o( 0.5f, 0.5f, 6.0f );
+      const Vector<float,3> d( 3.0f * std::cos(a) - o(0), 3.0f * std::sin(a) - o(1), 0.8f - o(2) );
+      ASSERT_TRUE( torus.intersectRay( o, d, hit ) );
+      EXPECT_LT( torusDistance( hit.pos ), 1e-4 );
+      EXPECT_NEAR( (hit.pos - (o + hit.t * d)).getLength(), 0.0f, 1e-4 );
+      EXPECT_GT( hit.pos(2), 0.0f );
+
+      const Vector<float,3> p = torus.evaluateGlobalSmall( hit.uv(0), hit.uv(1), 0, 0 )(0)(0);
+      EXPECT_NEAR( (p - hit.pos).getLength(), 0.0f, 1e-4 );
+    }
+  }
+
+
+  TEST(PSurfRay, Hierarchy_follows_replot) {
+
+    PTorus<float> torus( 3.0f, 1.0f, 1.0f );
+
+    // Not plotted, sampled for the ray queries
+    EXPECT_EQ( torus.getRayBvh().getNoCellsU() + 1, torus.getSamplesU() );
+
+    torus.replot( 12, 10, 1, 1 );
+    EXPECT_EQ( torus.getRayBvh().getNoCellsU(), 11 );
+    EXPECT_EQ( torus.getRayBvh().getNoCellsV(), 9 );
+    EXPECT_EQ( torus.getRayBvh().getNoNodes(), 2 * 11 * 9 - 1 );
+
+    torus.setStagedReplot( true );
+    torus.replot( 6, 5, 1, 1 );
+    EXPECT_EQ( torus.getRayBvh().getNoCellsU(), 5 );
+
+    RayHit hit;
+    EXPECT_TRUE( torus.intersectRay( Point<float,3>( 10.0f, 0.0f, 0.0f ), Vector<float,3>( -1.0f, 0.0f, 0.0f ), hit ) );
+    EXPECT_NEAR( hit.pos(0), 4.0f, 1e-4 );
+  }
+
+
+  TEST(SceneRay, Nearest_object_in_global_coordinates) {
+
+    Scene scene;
+    PTorus<float>* t1 = new PTorus<float>( 3.0f, 1.0f, 1.0f );
+    PTorus<float>* t2 = new PTorus<float>( 3.0f, 1.0f, 1.0f );
+    t1->replot( 16, 16, 1, 1 );
+    t2->replot( 16, 16, 1, 1 );
+    t2->translateGlobal( Vector<float,3>( 0.0f, 0.0f, 5.0f ) );
+    t2->rotateGlobal( Angle(90), Vector<float,3>( 0.0f, 1.0f, 0.0f ) );
+    scene.insert( t1 );
+    scene.insert( t2 );
+    scene.prepare();
+
+    RayHit hit;
+    ASSERT_TRUE( scene.intersectRay( Point<float,3>( 0.0f, 0.0f, 20.0f ), Vector<float,3>( 0.0f, 0.0f, -1.0f ), hit ) );
+    EXPECT_EQ( hit.obj, t2 );
+    EXPECT_NEAR( hit.pos(2), 9.0f, 1e-4 );
+    EXPECT_NEAR( hit.t, 11.0f, 1e-4 );
+    EXPECT_NEAR( std::abs( hit.normal(2) ), 1.0f, 1e-4 );
+
+    ASSERT_TRUE( scene.intersectRay( Point<float,3>( 0.0f, 3.0f, -10.0f ), Vector<float,3>( 0.0f, 0.0f, 1.0f ), hit ) );
+    EXPECT_EQ( hit.obj, t1 );
+    EXPECT_NEAR( hit.pos(2), -1.0f, 1e-4 );
+
+    // The second torus is in the yz-plane
+    t1->setVisible( false );
+    ASSERT_TRUE( scene.intersectRay( Point<float,3>( 0.0f, 3.0f, -10.0f ), Vector<float,3>( 0.0f, 0.0f, 1.0f ), hit ) );
+    EXPECT_EQ( hit.obj, t2 );
+    EXPECT_NEAR( hit.pos(2), 5.0f - std::sqrt(7.0f), 1e-4 );
+    EXPECT_FALSE( scene.intersectRay( Point<float,3>( 30.0f, 0.0f, -10.0f ), Vector<float,3>( 0.0f, 0.0f, 1.0f ), hit ) );
+    EXPECT_EQ( hit.obj, nullptr );
+  }
+
+
+  TEST(SceneRay, Batch_matches_single_rays_for_any_number_of_threads) {
+
+    Scene scene;
+    for( int i = 0; i < 5; i++ ) {
+      PTorus<float>* t = new PTorus<float>( 3.0f, 1.0f, 1.0f );
+      t->replot( 12, 12, 1, 1 );
+      t->translateGlobal( Vector<float,3>( 2.5f * i, 0.0f, 0.5f * i ) );
+      scene.insert( t );
+    }
+    scene.prepare();
+
+    std::vector<Point<float,3>>  o;
+    std::vector<Vector<float,3>> d;
+    for( int i = 0; i < 40; i++ )
+      for( int j = 0; j < 20; j++ ) {
+        o.push_back( Point<float,3>( 5.0f, -20.0f, 2.0f ) );
+        d.push_back( Vector<float,3>( -8.0f + 0.6f * i, 20.0f, -4.0f + 0.4f * j ) );
+      }
+
+    std::vector<RayHit> single( o.size() );
+    int no_hits = 0;
+    for( std::size_t k = 0; k < o.size(); k++ )
+      no_hits += scene.intersectRay( o[k], d[k], single[k] ) ? 1 : 0;
+    EXPECT_GT( no_hits, 100 );
+
+    const int no_threads = getNoThreads();
+    for( int th : { 1, 3 } ) {
+      setNoThreads( th );
+      std::vector<RayHit> batch;
+      scene.intersectRays( o, d, batch );
+      ASSERT_EQ( batch.size(), o.size() );
+      for( std::size_t k = 0; k < o.size(); k++ ) {
+        EXPECT_EQ( batch[k].obj, single[k].obj );
+        EXPECT_EQ( batch[k].t, single[k].t );
+      }
+    }
+    setNoThreads( no_threads );
+  }
+
+
+  TEST(SceneRay, Batch_on_one_surface_with_a_child_is_split_over_the_rays) {
+
+    // One top level surface, the hits of the copies traced by the other threads
+    // are given by the surface and its child
+    Scene scene;
+    PTorus<float>* t = new PTorus<float>( 3.0f, 1.0f, 1.0f );
+    t->replot( 12, 12, 1, 1 );
+    PTorus<float>* c = new PTorus<float>( 1.0f, 0.3f, 0.3f );
+    c->replot( 8, 8, 1, 1 );
+    c->translateGlobal( Vector<float,3>( 0.0f, 0.0f, 2.0f ) );
+    t->insert( c );
+    scene.insert( t );
+    scene.prepare();
+
+    std::vector<Point<float,3>>  o;
+    std::vector<Vector<float,3>> d;
+    for( int i = 0; i < 80; i++ )
+      for( int j = 0; j < 80; j++ ) {
+        o.push_back( Point<float,3>( -5.0f + 0.125f * i, -5.0f + 0.125f * j, 10.0f ) );
+        d.push_back( Vector<float,3>( 0.0f, 0.0f, -1.0f ) );
+      }
+
+    std::vector<RayHit> single( o.size() );
+    int no_hits[2] = { 0, 0 };
+    for( std::size_t k = 0; k < o.size(); k++ )
+      if( scene.intersectRay( o[k], d[k], single[k] ) )
+        no_hits[ single[k].obj == c ? 1 : 0 ]++;
+    EXPECT_GT( no_hits[0], 1000 );
+    EXPECT_GT( no_hits[1], 100 );
+
+    const int no_threads = getNoThreads();
+    for( int th : { 1, 4 } ) {
+      setNoThreads( th );
+      std::vector<RayHit> batch;
+      scene.intersectRays( o, d, batch );
+      ASSERT_EQ( batch.size(), o.size() );
+      for( std::size_t k = 0; k < o.size(); k++ ) {
+        EXPECT_EQ( batch[k].obj, single[k].obj );
+        EXPECT_EQ( batch[k].t, single[k].t );
+        EXPECT_EQ( batch[k].uv, single[k].uv );
+      }
+    }
+    setNoThreads( no_threads );
+  }
+
+}
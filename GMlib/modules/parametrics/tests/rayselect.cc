@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <gmParametricsModule>
+#include <gmSceneModule>
+using namespace GMlib;
+
+#include "../../scene/tests/testcamera.h"
+
+#include <cmath>
+
+
+namespace {
+
+
+  // The pixel where the point p is seen by a camera at (0,0,40) looking at origo
+  Point<int,2> project( const Camera& cam, const Point<float,3>& p ) {
+    const float dz = 40.0f - p(2);
+    const float nx = p(0) / ( dz * cam.getAspectRatio() * cam.getAngleTan() );
+    const float ny = p(1) / ( dz * cam.getAngleTan() );
+    return Point<int,2>( int( std::floor( 0.5f*(nx+1.0f)*800 ) ), int( std::floor( 0.5f*(ny+1.0f)*600 ) ) );
+  }
+
+
+  TEST(RaySelect, Camera_rays_go_through_the_pixels) {
+
+    Camera cam;
+    placeCamera( cam, Point<float,3>( 0.0f, 0.0f, 40.0f ), Vector<float,3>( 0.0f, 1.0f, 0.0f ), 1000.0f );
+
+    const Point<float,3> p( -5.0f, 3.0f, 2.0f );
+    const Point<int,2>   px = project( cam, p );
+
+    Point<float,3>  o;
+    Vector<float,3> d;
+    cam.getRay( float(px(0)), float(px(1)), o, d );
+    EXPECT_NEAR( o(2), 40.0f, 1e-5 );
+    EXPECT_NEAR( d(2), -1.0f, 1e-5 );
+
+    // Within a pixel from the point
+    const Point<float,3> q = o + 38.0f * d;
+    const float pixel = 2.0f * 38.0f * cam.getAngleTan() / 600;
+    EXPECT_NEAR( q(0), p(0), pixel );
+    EXPECT_NEAR( q(1), p(1), pixel );
+  }
+
+
+  TEST(RaySelect, Picks_the_nearest_object_and_rectangles) {
+
+    Scene scene;
+    Camera cam( scene );
+    scene.insert( &cam );
+    placeCamera( cam, Point<float,3>( 0.0f, 0.0f, 40.0f ), Vector<float,3>( 0.0f, 1.0f, 0.0f ), 1000.0f );
+
+    PTorus<float> left( 3.0f, 1.0f, 1.0f ), behind( 3.0f, 1.0f, 1.0f ), right( 3.0f, 1.0f, 1.0f );
+    left.translate( Vector<float,3>( -8.0f, 0.0f, 0.0f ) );
+    behind.translate( Vector<float,3>( -8.0f, 0.0f, -10.0f ) );
+    right.translate( Vector<float,3>( 8.0f, 0.0f, 0.0f ) );
+    for( PTorus<float>* t : { &left, &behind, &right } ) {
+      t->replot( 24, 12, 1, 1 );
+      scene.insert( t );
+    }
+    scene.prepare();
+
+    RaySelectRenderer sel;
+    sel.setCamera( &cam );
+    sel.reshape( Vector<int,2>( 800, 600 ) );
+    sel.prepare();
+    sel.select( 0 );
+
+    // On the tube of the left torus, hiding the one behind
+    const Point<int,2> a = project( cam, Point<float,3>( -11.0f, 0.0f, 1.0f ) );
+    RayHit hit;
+    ASSERT_TRUE( sel.findHit( a(0), a(1), hit ) );
+    EXPECT_EQ( hit.obj, &left );
+    EXPECT_NEAR( hit.pos(2), 1.0f, 0.05f );
+    EXPECT_EQ( sel.findObject( a(0), a(1) ), &left );
+
+    // Through the holes, on the background and on the right torus
+    const Point<int,2> h = project( cam, Point<float,3>( -8.0f, 0.0f, -10.0f ) );
+    EXPECT_EQ( sel.findObject( h(0), h(1) ), nullptr );
+    EXPECT_EQ( sel.findObject( 400, 20 ), nullptr );
+    const Point<int,2> b = project( cam, Point<float,3>( 11.0f, 0.0f, 1.0f ) );
+    EXPECT_EQ( sel.findObject( b(0), b(1) ), &right );
+
+    // Type filter
+    sel.select( GM_SO_TYPE_SELECTOR );
+    EXPECT_EQ( sel.findObject( a(0), a(1) ), nullptr );
+    sel.select( -GM_SO_TYPE_SELECTOR );
+    EXPECT_EQ( sel.findObject( a(0), a(1) ), &left );
+
+    // The left half of the view has both left tori, and not those selected
+    Array<SceneObject*> objs = sel.findObjects( 0, 0, 399, 599 );
+    EXPECT_EQ( objs.getSize(), 2 );
+    EXPECT_TRUE( objs.exist( &left ) );
+    EXPECT_TRUE( objs.exist( &behind ) );
+
+    objs = sel.findObjects( 500, 200, 799, 400 );
+    ASSERT_EQ( objs.getSize(), 1 );
+    EXPECT_EQ( objs(0), &right );
+
+    left.setSelected( true );
+    objs = sel.findObjects( 0, 0, 399, 599 );
+    ASSERT_EQ( objs.getSize(), 1 );
+    EXPECT_EQ( objs(0), &behind );
+    left.setSelected( false );
+
+    for( PTorus<float>* t : { &left, &behind, &right } ) scene.remove( t );
+    scene.remove( &cam );
+  }
+
+}
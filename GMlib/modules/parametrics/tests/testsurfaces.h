@@ -0,0 +1,32 @@
+#ifndef GM_PARAMETRICS_TESTS_TESTSURFACES_H
+#define GM_PARAMETRICS_TESTS_TESTSURFACES_H
+
+#include <gmParametricsModule>
+
+#include <atomic>
+
+
+/*!
+ * A torus counting the evaluations, from any thread, to see when the
+ * samples are reused.
+ */
+class CountingTorus : public GMlib::PTorus<float> {
+public:
+  CountingTorus() : GMlib::PTorus<float>( 3.0f, 1.0f, 1.0f ), evals(0) {}
+  mutable std::atomic<int> evals;
+protected:
+  void eval( float u, float v, int d1, int d2, bool lu, bool lv ) const override {
+    evals++;
+    GMlib::PTorus<float>::eval( u, v, d1, d2, lu, lv );
+  }
+};
+
+
+// Parameter value of sample i out of m
+template <typename T>
+T sampleValue( T s, T e, int i, int m ) {
+  return i < m-1 ? s + i * (e-s)/(m-1) : e;
+}
+
+
+#endif // GM_PARAMETRICS_TESTS_TESTSURFACES_H
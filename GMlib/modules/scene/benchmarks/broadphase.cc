@@ -0,0 +1,216 @@
+#include <benchmark/benchmark.h>
+
+#include <gmCoreModule>
+#include <event/gmbroadphase.h>
+#include <event/gmeventcontroller.h>
+#include <event/gmeventmanager.h>
+using namespace GMlib;
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+/*!
+ * Equal spheres bouncing off each other in a box, with the collisions as
+ * events. The time of impact tests are run on all pairs, or on the pairs
+ * of a BroadPhase.
+ */
+class BouncingController : public EventController {
+public:
+  BouncingController(int n, int method) : _method(method), _bp(BroadPhase::Method(std::max(method, 0)))
+  {
+    // About 30 spheres each 10x10x10
+    _size = 0.5f * std::cbrt(float(n) * 1000.0f / 30.0f);
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> pos(-_size, _size), vel(-3.0f, 3.0f);
+    for (int i = 0; i < n; ++i) {
+      Ball b;
+      b.p     = Point<float, 3>(pos(rng), pos(rng), pos(rng));
+      b.v     = Vector<float, 3>(vel(rng), vel(rng), vel(rng));
+      b.x     = 0.0;
+      b.stamp = 0;
+      _balls.push_back(b);
+      _ids.push_back(_bp.insert(Sphere<float, 3>(b.p, 0.5f)));
+    }
+  }
+
+  int collisions = 0;
+  int pairs      = 0;
+
+private:
+  struct Ball {
+    Point<float, 3>  p;       //!< Position at x
+    Vector<float, 3> v;
+    double           x;
+    int              stamp;   //!< Changed at each collision, to invalidate events
+  };
+
+  struct Collision {
+    double x;
+    int    a, b;
+    int    sa, sb;
+    bool   operator<(const Collision& o) const { return x > o.x; }
+  };
+
+  int                    _method;   //!< -1 for all pairs, else the BroadPhase::Method
+  BroadPhase             _bp;
+  float                  _size;
+  double                 _dt = 0.0;
+  std::vector<Ball>      _balls;
+  std::vector<int>       _ids;
+  mutable std::vector<Collision> _events;   //!< Last is first
+  std::vector<int>       _cand;
+
+  void clear() override { _events.clear(); }
+
+  bool detect(double dt) override
+  {
+    _dt = dt;
+    if (_method < 0) {
+      // Chunks of spheres, run in parallel with parallel detection
+      const int                           n = int(_balls.size());
+      std::vector<std::vector<Collision>> chunks(size_t((n + 63) / 64));
+      detectInChunks(n, 64, [this, n, &chunks](int k, int begin, int end) {
+        for (int a = begin; a < end; ++a)
+          for (int b = a + 1; b < n; ++b) test(a, b, 0.0, &chunks[size_t(k)]);
+      });
+      for (const auto& c : chunks) _events.insert(_events.end(), c.begin(), c.end());
+    }
+    else {
+      for (size_t i = 0; i < _balls.size(); ++i)
+        _bp.update(_ids[i], Sphere<float, 3>(_balls[i].p, 0.5f), float(dt) * _balls[i].v);
+      const auto& p = _bp.findPairs();
+      pairs         = int(p.size());
+      for (const auto& ab : p) test(ab.first, ab.second, 0.0);
+    }
+    std::stable_sort(_events.begin(), _events.end());
+    return !_events.empty();
+  }
+
+  void handleFirst() override
+  {
+    const Collision c = _events.back();
+    _events.pop_back();
+
+    // Move both to x and exchange the velocities along the normal
+    Ball& a = moveTo(c.a, c.x);
+    Ball& b = moveTo(c.b, c.x);
+    Vector<float, 3> n = a.p - b.p;
+    n /= n.getLength();
+    const float s = (a.v - b.v) * n;
+    a.v -= s * n;
+    b.v += s * n;
+    a.stamp++;
+    b.stamp++;
+    collisions++;
+
+    for (int k : {c.a, c.b}) {
+      if (_method < 0) {
+        for (int o = 0; o < int(_balls.size()); ++o)
+          if (o != k) test(k, o, c.x);
+      }
+      else {
+        _bp.update(_ids[size_t(k)], Sphere<float, 3>(_balls[size_t(k)].p, 0.5f),
+                   float(_dt * (1.0 - c.x)) * _balls[size_t(k)].v);
+        _bp.findCandidates(_ids[size_t(k)], _cand);
+        for (int o : _cand) test(k, o, c.x);
+      }
+    }
+
+    // Drop the events of spheres that have collided since
+    while (!_events.empty() && (_events.back().sa != _balls[size_t(_events.back().a)].stamp ||
+                                _events.back().sb != _balls[size_t(_events.back().b)].stamp))
+      _events.pop_back();
+  }
+
+  void doFinalize() override
+  {
+    for (size_t i = 0; i < _balls.size(); ++i) {
+      Ball& b = moveTo(int(i), 1.0);
+      b.x     = 0.0;
+      for (int k = 0; k < 3; ++k)
+        if ((b.p[k] < -_size && b.v[k] < 0.0f) || (b.p[k] > _size && b.v[k] > 0.0f)) b.v[k] = -b.v[k];
+    }
+  }
+
+  double getFirstX() const override { return _events.empty() ? 0.0 : _events.back().x; }
+
+  Ball& moveTo(int i, double x)
+  {
+    Ball& b = _balls[size_t(i)];
+    b.p += float((x - b.x) * _dt) * b.v;
+    b.x = x;
+    return b;
+  }
+
+  // Time of impact of a and b after x, queued if within the step, or put in found
+  void test(int ia, int ib, double x, std::vector<Collision>* found = 0x0) const
+  {
+    const Ball&            a = _balls[size_t(ia)];
+    const Ball&            b = _balls[size_t(ib)];
+    const Vector<float, 3> d = (a.p + float((x - a.x) * _dt) * a.v) - (b.p + float((x - b.x) * _dt) * b.v);
+    const Vector<float, 3> w = float(_dt) * (a.v - b.v);
+    const double           qa = w * w, qb = 2.0 * (d * w), qc = d * d - 1.0;
+    const double           disc = qb * qb - 4.0 * qa * qc;
+    if (qb >= 0.0 || disc < 0.0 || qc < 0.0) return;
+
+    const double s = (-qb - std::sqrt(disc)) / (2.0 * qa);
+    if (s > 0.0 && x + s <= 1.0) {
+      const Collision c = {x + s, ia, ib, a.stamp, b.stamp};
+      if (found)
+        found->push_back(c);
+      else
+        _events.insert(std::upper_bound(_events.begin(), _events.end(), c), c);
+    }
+  }
+};
+
+
+/*!
+ * \brief BM_Bouncing
+ * One EventManager step of n bouncing spheres, with the time of impact
+ * tests on all pairs (-1), or on the pairs from sweep and prune (0) or
+ * the uniform grid (1)
+ */
+static void BM_Bouncing(benchmark::State& state)
+{
+  BouncingController ctl(int(state.range(0)), int(state.range(1)));
+  EventManager       mgr;
+  mgr.registerController(&ctl);
+
+  for (auto _ : state) mgr.processEvents(0.016);
+  state.counters["collisions"] = benchmark::Counter(double(ctl.collisions), benchmark::Counter::kAvgIterations);
+  state.counters["pairs"]      = double(ctl.pairs);
+}
+BENCHMARK(BM_Bouncing)
+  ->Unit(benchmark::kMillisecond)
+  ->ArgsProduct({{1000, 10000}, {-1, 0, 1}});
+
+
+/*!
+ * \brief BM_Bouncing_Detect
+ * Eight controllers of 2000 spheres testing all pairs, with serial (0) or
+ * parallel (1) detection, see EventManager::enableParallelDetect()
+ */
+static void BM_Bouncing_Detect(benchmark::State& state)
+{
+  std::vector<std::unique_ptr<BouncingController>> ctls;
+  EventManager                                     mgr;
+  for (int i = 0; i < 8; ++i) {
+    ctls.emplace_back(new BouncingController(2000, -1));
+    ctls.back()->setThreadSafe(true);
+    mgr.registerController(ctls.back().get());
+  }
+  if (state.range(0)) mgr.enableParallelDetect();
+
+  for (auto _ : state) mgr.processEvents(0.016);
+  state.counters["threads"] = double(state.range(0) ? getNoThreads() : 1);
+}
+BENCHMARK(BM_Bouncing_Detect)->Unit(benchmark::kMillisecond)->Arg(0)->Arg(1);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <gmCoreModule>
+#include <event/gmeventcontroller.h>
+#include <event/gmeventmanager.h>
+using namespace GMlib;
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+
+/*!
+ * A controller with a fixed set of collision like events each step,
+ * handling an event detects a follow-up event later in the step
+ */
+class DenseController : public EventController {
+public:
+  DenseController(unsigned int seed, int n) : _rng(seed), _n(n) {}
+
+  void    clear() override { _events.clear(); }
+  bool    detect(double) override
+  {
+    std::uniform_real_distribution<double> x(0.001, 1.0);
+    for (int i = 0; i < _n; ++i) _events.push_back(x(_rng));
+    std::sort(_events.begin(), _events.end(), std::greater<double>());
+    return true;
+  }
+  void    handleFirst() override
+  {
+    const double x = _events.back();
+    _events.pop_back();
+    const double y = x + 0.5 * (1.0 - x);
+    if (y - x > 0.01)
+      _events.insert(std::upper_bound(_events.begin(), _events.end(), y, std::greater<double>()), y);
+  }
+  double  getFirstX() const override { return _events.empty() ? 0.0 : _events.back(); }
+
+private:
+  std::mt19937        _rng;
+  int                 _n;
+  std::vector<double> _events;
+};
+
+
+struct Controllers {
+  std::vector<std::unique_ptr<DenseController>> ctls;
+
+  Controllers(int n)
+  {
+    for (int i = 0; i < n; ++i) ctls.emplace_back(new DenseController(unsigned(i), 8));
+  }
+};
+
+
+/*!
+ * \brief BM_Events_LinearScan
+ * Finding the first event by asking every controller for each event,
+ * the way EventManager did before the queue
+ */
+static void BM_Events_LinearScan(benchmark::State& state)
+{
+  Controllers s(int(state.range(0)));
+  int         handled = 0;
+
+  for (auto _ : state) {
+    handled = 0;
+    for (auto& c : s.ctls) c->detectEvents(0.016);
+    for (;;) {
+      EventController* ctl = 0x0;
+      double           x   = 0.0;
+      for (auto& c : s.ctls) {
+        const double c_x = c->getFirstEventX();
+        if (c_x > 0.0 && (c_x < x || x == 0.0)) {
+          x   = c_x;
+          ctl = c.get();
+        }
+      }
+      if (!ctl) break;
+      ctl->handleFirstEvent();
+      handled++;
+    }
+    for (auto& c : s.ctls) c->finalize();
+  }
+  state.counters["events"] = double(handled);
+}
+BENCHMARK(BM_Events_LinearScan)->Unit(benchmark::kMillisecond)->Arg(100)->Arg(1000);
+
+
+/*!
+ * \brief BM_Events_Manager
+ * EventManager::processEvents() with the controllers in a min-heap
+ */
+static void BM_Events_Manager(benchmark::State& state)
+{
+  Controllers  s(int(state.range(0)));
+  EventManager mgr;
+  for (auto& c : s.ctls) mgr.registerController(c.get());
+
+  for (auto _ : state) mgr.processEvents(0.016);
+}
+BENCHMARK(BM_Events_Manager)->Unit(benchmark::kMillisecond)->Arg(100)->Arg(1000);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,120 @@
+#include <benchmark/benchmark.h>
+
+#include <gmCoreModule>
+#include <gmscene.h>
+#include <gmsceneobject.h>
+#include <camera/gmcamera.h>
+using namespace GMlib;
+
+#include "../tests/testball.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+
+/*!
+ * n sibling objects in a cube, the camera sees a few percent of them
+ */
+struct SceneSetup {
+  Scene                                   scene;
+  Camera                                  cam;
+  std::vector<std::unique_ptr<BallObject>> objs;
+
+  explicit SceneSetup(int n)
+  {
+    std::mt19937                          rng(3);
+    std::uniform_real_distribution<float> pos(-300.0f, 300.0f), rad(0.2f, 1.0f);
+    for (int i = 0; i < n; ++i) {
+      objs.emplace_back(new BallObject(Point<float, 3>(pos(rng), pos(rng), pos(rng)), rad(rng)));
+      scene.insert(objs.back().get());
+    }
+    cam.set(Point<float, 3>(0.0f, 0.0f, 300.0f), Vector<float, 3>(0.0f, 0.0f, -1.0f),
+            Vector<float, 3>(0.0f, 1.0f, 0.0f));
+    cam.setCuttingPlanes(1.0f, 400.0f);
+    cam.reshape(0, 0, 800, 600);
+    scene.prepare();
+  }
+
+  ~SceneSetup()
+  {
+    for (auto& obj : objs) scene.remove(obj.get());
+  }
+};
+
+
+/*!
+ * \brief BM_RenderList_Recursive
+ * Testing the surrounding sphere of every object in scene graph order,
+ * the way Scene::getRenderList() did before the BVH
+ */
+static void BM_RenderList_Recursive(benchmark::State& state)
+{
+  SceneSetup                s(int(state.range(0)));
+  Array<const SceneObject*> objs(int(state.range(0)));
+
+  for (auto _ : state) {
+    objs.resetSize();
+    s.cam.computeFrustumBounds();
+    for (int i = 0; i < s.scene.getSize(); ++i) s.scene[i]->getRenderList(objs, s.cam);
+    benchmark::DoNotOptimize(objs.getSize());
+  }
+  state.counters["visible"] = double(objs.getSize());
+}
+BENCHMARK(BM_RenderList_Recursive)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Arg(100000);
+
+
+/*!
+ * \brief BM_RenderList_Bvh
+ * Scene::getRenderList(), a hierarchical traversal of the scene BVH
+ */
+static void BM_RenderList_Bvh(benchmark::State& state)
+{
+  SceneSetup                s(int(state.range(0)));
+  Array<const SceneObject*> objs(int(state.range(0)));
+
+  for (auto _ : state) {
+    objs.resetSize();
+    s.scene.getRenderList(objs, &s.cam);
+    benchmark::DoNotOptimize(objs.getSize());
+  }
+  state.counters["visible"] = double(objs.getSize());
+}
+BENCHMARK(BM_RenderList_Bvh)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Arg(100000);
+
+
+/*!
+ * \brief BM_Prepare_Moving
+ * Scene::prepare() with a percentage of the objects moving each frame,
+ * including keeping the BVH updated
+ */
+static void BM_Prepare_Moving(benchmark::State& state)
+{
+  SceneSetup s(10000);
+  const int  no_moving = int(state.range(0)) * 100;
+  float      sign      = 1.0f;
+
+  for (auto _ : state) {
+    for (int i = 0; i < no_moving; ++i)
+      s.objs[size_t(i)]->translateGlobal(Vector<float, 3>(sign * 2.0f, 0.0f, 0.0f));
+    sign = -sign;
+    s.scene.prepare();
+  }
+}
+BENCHMARK(BM_Prepare_Moving)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(0)
+  ->Arg(1)
+  ->Arg(10)
+  ->Arg(100);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+
+#include <gmCoreModule>
+#include <gmscene.h>
+#include <gmsceneobject.h>
+#include <camera/gmcamera.h>
+using namespace GMlib;
+
+#include "../tests/testball.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+
+/*!
+ * n objects in a cube, as hierarchies of 8: a top object with three
+ * children, each with a child, and one with two more below that
+ */
+struct SceneSetup {
+  Scene                                    scene;
+  Camera                                   cam;
+  std::vector<BallObject*>                 tops;
+  std::vector<std::unique_ptr<BallObject>> objs;
+
+  SceneSetup(int n, bool flat)
+  {
+    std::mt19937                          rng(3);
+    std::uniform_real_distribution<float> pos(-300.0f, 300.0f), off(-3.0f, 3.0f), rad(0.2f, 1.0f);
+
+    auto make = [&](BallObject* parent, bool top) {
+      const Point<float, 3> p = top ? Point<float, 3>(pos(rng), pos(rng), pos(rng))
+                                    : Point<float, 3>(off(rng), off(rng), off(rng));
+      objs.emplace_back(new BallObject(p, rad(rng)));
+      if (parent) parent->insert(objs.back().get());
+      return objs.back().get();
+    };
+
+    for (int i = 0; i < n / 8; ++i) {
+      BallObject* top = make(nullptr, true);
+      for (int k = 0; k < 3; ++k) make(make(top, false), false);
+      make(make(objs.back().get(), false), false);
+      tops.push_back(top);
+      scene.insert(top);
+    }
+
+    cam.set(Point<float, 3>(0.0f, 0.0f, 300.0f), Vector<float, 3>(0.0f, 0.0f, -1.0f),
+            Vector<float, 3>(0.0f, 1.0f, 0.0f));
+    cam.setCuttingPlanes(1.0f, 400.0f);
+    cam.reshape(0, 0, 800, 600);
+    cam.computeFrustumBounds();
+
+    if (flat) scene.enableFlatView();
+    scene.prepare();
+  }
+
+  ~SceneSetup()
+  {
+    scene.disableFlatView();
+    for (BallObject* top : tops) scene.remove(top);
+    for (auto& obj : objs) obj->setParent(nullptr);
+    for (auto& obj : objs)
+      while (obj->getChildren().getSize()) obj->remove(obj->getChildren()(0));
+  }
+};
+
+
+/*!
+ * \brief BM_Prepare_Full
+ * Scene::prepare() of the whole scene, the recursive SceneObject::prepare()
+ * (0) against the linear sweeps of the flat view (1)
+ */
+static void BM_Prepare_Full(benchmark::State& state)
+{
+  SceneSetup s(int(state.range(0)), state.range(1) != 0);
+
+  for (auto _ : state) {
+    for (BallObject* top : s.tops) top->setDirty();
+    s.scene.prepare();
+  }
+}
+BENCHMARK(BM_Prepare_Full)
+  ->Unit(benchmark::kMicrosecond)
+  ->ArgsProduct({{1000, 10000, 100000}, {0, 1}});
+
+
+/*!
+ * \brief BM_Prepare_Moving_Tops
+ * Scene::prepare() with 10% of the hierarchies moving each frame
+ */
+static void BM_Prepare_Moving_Tops(benchmark::State& state)
+{
+  SceneSetup s(int(state.range(0)), state.range(1) != 0);
+  float      sign = 1.0f;
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < s.tops.size(); i += 10)
+      s.tops[i]->translateGlobal(Vector<float, 3>(sign * 2.0f, 0.0f, 0.0f));
+    sign = -sign;
+    s.scene.prepare();
+  }
+}
+BENCHMARK(BM_Prepare_Moving_Tops)
+  ->Unit(benchmark::kMicrosecond)
+  ->ArgsProduct({{10000, 100000}, {0, 1}});
+
+
+/*!
+ * \brief BM_RenderList_Hierarchy
+ * Culling by the recursive SceneObject::getRenderList() (0) against the
+ * forward sweep of the flat view (1)
+ */
+static void BM_RenderList_Hierarchy(benchmark::State& state)
+{
+  SceneSetup                s(int(state.range(0)), state.range(1) != 0);
+  Array<const SceneObject*> objs(int(state.range(0)));
+
+  for (auto _ : state) {
+    objs.resetSize();
+    if (state.range(1))
+      s.scene.getFlatView().getRenderList(objs, s.cam);
+    else
+      for (int i = 0; i < s.scene.getSize(); ++i) s.scene[i]->getRenderList(objs, s.cam);
+    benchmark::DoNotOptimize(objs.getSize());
+  }
+  state.counters["visible"] = double(objs.getSize());
+}
+BENCHMARK(BM_RenderList_Hierarchy)
+  ->Unit(benchmark::kMicrosecond)
+  ->ArgsProduct({{1000, 10000, 100000}, {0, 1}});
+
+
+BENCHMARK_MAIN();
@@ -215,6 +215,30 @@ namespace GMlib {
 
 
 
+  /*! void Camera::getRay(float x, float y, Point<float,3>& o, Vector<float,3>& d) const
+   *  \brief The ray through a pixel, in scene coordinates
+   *
+   *  The pixel (x,y) is relative to the viewport, with origo in the lower left
+   *  corner as in OpenGL, and the ray goes through the pixel center. The ray starts
+   *  in the eye and d has unit length along the view direction, so the near and far
+   *  planes are at the ray parameters getNearPlane() and getFarPlane().
+   *
+   *  \param[in]  x  Pixel column
+   *  \param[in]  y  Pixel row
+   *  \param[out] o  Ray origin
+   *  \param[out] d  Ray direction
+   */
+  void Camera::getRay(float x, float y, Point<float,3>& o, Vector<float,3>& d) const {
+
+    const float nx = 2.0f*(x+0.5f)/_w - 1.0f;
+    const float ny = 2.0f*(y+0.5f)/_h - 1.0f;
+
+    // The side vector points to the left
+    o = _matrix_scene*_pos;
+    d = _matrix_scene*( _dir + ny*_frustum_angle_tan*_up - nx*getAspectRatio()*_frustum_angle_tan*_side );
+  }
+
+
   /*! SceneObject* Camera::lockTargetAtPixel(int x, int y)
    *  \brief Pending Documentation
    *
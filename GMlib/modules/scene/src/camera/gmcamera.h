@@ -109,6 +109,7 @@ namespace GMlib {
     void                        getViewport(int& w1, int& w2, int& h1, int& h2) const;
     int                         getViewportW() const;
     int                         getViewportH() const;
+    virtual void                getRay(float x, float y, Point<float,3>& o, Vector<float,3>& d) const;
 
 //    virtual void                go(bool stereo=false);  // Running the Camera.
 
@@ -360,7 +361,7 @@ namespace GMlib {
                             const Vector<float,3>& z,
                             const Vector<float,3>& p ) {
 
-    static Vector<float,4> nx, ny, nz, nw(0.0f);
+    Vector<float,4> nx, ny, nz, nw(0.0f);
     nx = -x;
     ny =  y;
     nz = -z;
@@ -374,6 +375,8 @@ namespace GMlib {
     _matrix.setRow( ny, 1 );
     _matrix.setRow( nz, 2 );
     _matrix.setRow( nw, 3 );
+
+    setDirty();
   }
 
 
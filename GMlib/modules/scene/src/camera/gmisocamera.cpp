@@ -108,6 +108,22 @@ namespace GMlib {
 
 
 
+  /*! void IsoCamera::getRay(float x, float y, Point<float,3>& o, Vector<float,3>& d) const
+   *  \brief The ray through a pixel, in scene coordinates
+   *
+   *  As Camera::getRay(), but all rays are parallel to the view direction
+   *  and start in the plane through the eye.
+   */
+  void IsoCamera::getRay(float x, float y, Point<float,3>& o, Vector<float,3>& d) const {
+
+    const float nx = 2.0f*(x+0.5f)/_w - 1.0f;
+    const float ny = 2.0f*(y+0.5f)/_h - 1.0f;
+
+    o = _matrix_scene*( _pos + ny*_horizontal*_up - nx*getAspectRatio()*_horizontal*_side );
+    d = _matrix_scene*_dir;
+  }
+
+
   /*! void IsoCamera::resetC(float z)
    *  \brief Pending Documentation
    *
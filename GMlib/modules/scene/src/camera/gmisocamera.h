@@ -60,6 +60,7 @@ namespace GMlib {
     ~IsoCamera();
 
     double          deltaTranslate(SceneObject *) override;
+    void            getRay(float x, float y, Point<float,3>& o, Vector<float,3>& d) const override;
 
 //    void             go(bool stereo=false);
     void            lock(SceneObject* /*obj*/) override {}         //!< Disable locking
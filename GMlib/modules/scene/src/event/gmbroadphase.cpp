@@ -0,0 +1,442 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+#include "gmbroadphase.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace GMlib;
+
+
+namespace {
+
+  // Cell coordinates are kept in 21 bits each in the keys
+  const int CELL_RANGE = 1 << 20;
+
+  // Largest number of cells a sphere is put in
+  const int64_t MAX_CELLS = 64;
+
+  int getCellCoord( float x, float cell ) {
+
+    const float c = std::floor( x / cell );
+    if( c < float(-CELL_RANGE) )    return -CELL_RANGE;
+    if( c > float(CELL_RANGE - 1) ) return CELL_RANGE - 1;
+    return int(c);
+  }
+}
+
+
+BroadPhase::BroadPhase( Method method )
+  : _size(0), _method(method), _built(false),
+    _axis(0), _max_width(0.0f), _cell_size(0.0f), _cell(1.0f) {
+}
+
+/*!
+ * \brief BroadPhase::insert
+ * \param s - The sphere at the start of the step
+ * \param ds - The motion of the sphere over the step
+ * \return The id of the sphere, ids of removed spheres are used again
+ */
+int
+BroadPhase::insert( const Sphere<float,3>& s, const Vector<float,3>& ds ) {
+
+  int id;
+  if( _free.empty() ) {
+    id = int(_proxies.size());
+    _proxies.push_back( Proxy() );
+    _proxies.back().moved  = false;
+    _proxies.back().listed = false;
+    _proxies.back().large  = false;
+  }
+  else {
+    id = _free.back();
+    _free.pop_back();
+  }
+
+  _proxies[size_t(id)].used = true;
+  ++_size;
+  set( id, s, ds );
+  return id;
+}
+
+/*!
+ * \brief BroadPhase::update
+ * \param id - The id given by insert()
+ * \param s - The sphere at the start of the step
+ * \param ds - The motion of the sphere over the step
+ */
+void
+BroadPhase::update( int id, const Sphere<float,3>& s, const Vector<float,3>& ds ) {
+
+  set( id, s, ds );
+}
+
+void
+BroadPhase::remove( int id ) {
+
+  Proxy& p = _proxies[size_t(id)];
+  if( !p.used )
+    return;
+
+  p.used = false;
+  _free.push_back( id );
+  --_size;
+}
+
+void
+BroadPhase::clear() {
+
+  _proxies.clear();
+  _free.clear();
+  _moved.clear();
+  _order.clear();
+  _keys.clear();
+  _cells.clear();
+  _large.clear();
+  _pairs.clear();
+  _size  = 0;
+  _built = false;
+}
+
+/*!
+ * \brief BroadPhase::findPairs
+ * \return The pairs of ids (a < b) of intersecting swept spheres, in order
+ *
+ *  The structure of the method is brought up to date with the updated
+ *  spheres first.
+ */
+const std::vector<std::pair<int,int>>&
+BroadPhase::findPairs() {
+
+  build();
+  _pairs.clear();
+
+  if( _method == SweepAndPrune ) {
+
+    const size_t n = _order.size();
+    for( size_t i = 0; i < n; ++i ) {
+      const int   a  = _order[i];
+      const float hi = _proxies[size_t(a)].hi[_axis];
+      for( size_t j = i + 1; j < n && _keys[j] <= hi; ++j ) {
+        const int b = _order[j];
+        if( isOverlapping( a, b ) )
+          _pairs.emplace_back( std::min( a, b ), std::max( a, b ) );
+      }
+    }
+  }
+  else {
+
+    // A pair is in all cells covered by both, and is tested in the cell of
+    // the lower corner of the intersection of the boxes only
+    size_t s = 0;
+    while( s < _cells.size() ) {
+      size_t e = s + 1;
+      while( e < _cells.size() && _cells[e].first == _cells[s].first ) ++e;
+
+      for( size_t i = s; i < e; ++i ) {
+        const Proxy& p = _proxies[size_t(_cells[i].second)];
+        for( size_t j = i + 1; j < e; ++j ) {
+          const Proxy& q = _proxies[size_t(_cells[j].second)];
+          const uint64_t owner = getCellKey( getCellCoord( std::max( p.lo[0], q.lo[0] ), _cell ),
+                                             getCellCoord( std::max( p.lo[1], q.lo[1] ), _cell ),
+                                             getCellCoord( std::max( p.lo[2], q.lo[2] ), _cell ) );
+          const int a = _cells[i].second;
+          const int b = _cells[j].second;
+          if( owner == _cells[s].first && isOverlapping( a, b ) )
+            _pairs.emplace_back( std::min( a, b ), std::max( a, b ) );
+        }
+      }
+      s = e;
+    }
+
+    // The spheres out of the grid are tested against all others
+    for( size_t i = 0; i < _large.size(); ++i ) {
+      const int a = _large[i];
+      for( size_t b = 0; b < _proxies.size(); ++b ) {
+        const Proxy& q = _proxies[b];
+        if( q.used && int(b) != a && ( !q.large || int(b) > a ) && isOverlapping( a, int(b) ) )
+          _pairs.emplace_back( std::min( a, int(b) ), std::max( a, int(b) ) );
+      }
+    }
+  }
+
+  std::sort( _pairs.begin(), _pairs.end() );
+  return _pairs;
+}
+
+/*!
+ * \brief BroadPhase::findCandidates
+ * \param id - The id of a sphere
+ * \param ids - Returns the ids of the spheres whose swept sphere intersects the one of id, in order
+ *
+ *  Used after changing the motion of a sphere while handling an event. The
+ *  spheres updated since the last findPairs() are tested one by one, the
+ *  others are found through the structure of the method. The structure is
+ *  built again first when many spheres are updated.
+ */
+void
+BroadPhase::findCandidates( int id, std::vector<int>& ids ) {
+
+  ids.clear();
+  if( !_built || int(_moved.size()) > 64 + _size / 16 )
+    build();
+
+  const Proxy& p = _proxies[size_t(id)];
+
+  if( _method == SweepAndPrune ) {
+
+    size_t j = size_t( std::lower_bound( _keys.begin(), _keys.end(), p.lo[_axis] - _max_width ) - _keys.begin() );
+    for( ; j < _keys.size() && _keys[j] <= p.hi[_axis]; ++j ) {
+      const int b = _order[j];
+      const Proxy& q = _proxies[size_t(b)];
+      if( b != id && q.used && !q.moved && isOverlapping( id, b ) )
+        ids.push_back( b );
+    }
+  }
+  else if( isLarge( p ) ) {
+
+    for( size_t b = 0; b < _proxies.size(); ++b ) {
+      const Proxy& q = _proxies[b];
+      if( int(b) != id && q.used && !q.moved && isOverlapping( id, int(b) ) )
+        ids.push_back( int(b) );
+    }
+  }
+  else {
+
+    for( int b : _large ) {
+      const Proxy& q = _proxies[size_t(b)];
+      if( b != id && q.used && !q.moved && isOverlapping( id, b ) )
+        ids.push_back( b );
+    }
+
+    int lo[3], hi[3];
+    getCellRange( p, lo, hi );
+    for( int x = lo[0]; x <= hi[0]; ++x )
+      for( int y = lo[1]; y <= hi[1]; ++y )
+        for( int z = lo[2]; z <= hi[2]; ++z ) {
+          const std::pair<uint64_t,int> first( getCellKey( x, y, z ), -1 );
+          for( auto it = std::lower_bound( _cells.begin(), _cells.end(), first );
+               it != _cells.end() && it->first == first.first; ++it ) {
+            const int b = it->second;
+            const Proxy& q = _proxies[size_t(b)];
+            if( b != id && q.used && !q.moved && isOverlapping( id, b ) )
+              ids.push_back( b );
+          }
+        }
+  }
+
+  for( int b : _moved )
+    if( b != id && _proxies[size_t(b)].used && isOverlapping( id, b ) )
+      ids.push_back( b );
+
+  std::sort( ids.begin(), ids.end() );
+  ids.erase( std::unique( ids.begin(), ids.end() ), ids.end() );
+}
+
+/*!
+ * \brief BroadPhase::setCellSize
+ * \param size - The cell size of the grid, or 0 to use twice the average swept radius
+ */
+void
+BroadPhase::setCellSize( float size ) {
+
+  _cell_size = size;
+  _built     = false;
+}
+
+void
+BroadPhase::setMethod( Method method ) {
+
+  if( method == _method )
+    return;
+
+  _method = method;
+  _built  = false;
+}
+
+void
+BroadPhase::build() {
+
+  if( _method == SweepAndPrune ) buildSweep();
+  else                           buildGrid();
+
+  for( int id : _moved )
+    _proxies[size_t(id)].moved = false;
+  _moved.clear();
+  _built = true;
+}
+
+/*!
+ * \brief BroadPhase::buildSweep
+ *
+ *  Removed spheres are taken out of the order and new ones are put last.
+ *  The order is sorted by insertion when the axis is the same as before
+ *  and there are few new spheres, else sorted from scratch.
+ */
+void
+BroadPhase::buildSweep() {
+
+  size_t k = 0;
+  for( int id : _order ) {
+    if( _proxies[size_t(id)].used ) _order[k++] = id;
+    else                            _proxies[size_t(id)].listed = false;
+  }
+  _order.resize( k );
+
+  size_t added = 0;
+  for( int id : _moved ) {
+    Proxy& p = _proxies[size_t(id)];
+    if( p.used && !p.listed ) {
+      _order.push_back( id );
+      p.listed = true;
+      ++added;
+    }
+  }
+
+  // The axis of largest spread of the centers
+  double sum[3] = { 0.0, 0.0, 0.0 }, sum2[3] = { 0.0, 0.0, 0.0 };
+  for( int id : _order )
+    for( int i = 0; i < 3; ++i ) {
+      const double c = _proxies[size_t(id)].c[i];
+      sum[i]  += c;
+      sum2[i] += c * c;
+    }
+  int axis = 0;
+  for( int i = 1; i < 3; ++i )
+    if( sum2[i] - sum[i] * sum[i] / double( std::max( _order.size(), size_t(1) ) ) >
+        sum2[axis] - sum[axis] * sum[axis] / double( std::max( _order.size(), size_t(1) ) ) )
+      axis = i;
+
+  const auto less = [this,axis]( int a, int b ) {
+    const float la = _proxies[size_t(a)].lo[axis];
+    const float lb = _proxies[size_t(b)].lo[axis];
+    return la < lb || ( la == lb && a < b );
+  };
+
+  if( axis != _axis || added * 8 > _order.size() ) {
+    _axis = axis;
+    std::sort( _order.begin(), _order.end(), less );
+  }
+  else {
+    for( size_t i = 1; i < _order.size(); ++i ) {
+      const int id = _order[i];
+      size_t j = i;
+      for( ; j > 0 && less( id, _order[j-1] ); --j )
+        _order[j] = _order[j-1];
+      _order[j] = id;
+    }
+  }
+
+  _keys.resize( _order.size() );
+  _max_width = 0.0f;
+  for( size_t i = 0; i < _order.size(); ++i ) {
+    const Proxy& p = _proxies[size_t(_order[i])];
+    _keys[i]   = p.lo[_axis];
+    _max_width = std::max( _max_width, p.hi[_axis] - p.lo[_axis] );
+  }
+}
+
+void
+BroadPhase::buildGrid() {
+
+  if( _cell_size > 0.0f )
+    _cell = _cell_size;
+  else {
+    double sum = 0.0;
+    for( const Proxy& p : _proxies )
+      if( p.used ) sum += p.r;
+    _cell = _size > 0 && sum > 0.0 ? float( 2.0 * sum / _size ) : 1.0f;
+  }
+
+  _cells.clear();
+  _large.clear();
+  int lo[3], hi[3];
+  for( size_t id = 0; id < _proxies.size(); ++id ) {
+    Proxy& p = _proxies[id];
+    p.large = false;
+    if( !p.used )
+      continue;
+
+    if( isLarge( p ) ) {
+      p.large = true;
+      _large.push_back( int(id) );
+      continue;
+    }
+
+    getCellRange( p, lo, hi );
+    for( int x = lo[0]; x <= hi[0]; ++x )
+      for( int y = lo[1]; y <= hi[1]; ++y )
+        for( int z = lo[2]; z <= hi[2]; ++z )
+          _cells.emplace_back( getCellKey( x, y, z ), int(id) );
+  }
+  std::sort( _cells.begin(), _cells.end() );
+}
+
+void
+BroadPhase::getCellRange( const Proxy& p, int lo[3], int hi[3] ) const {
+
+  for( int k = 0; k < 3; ++k ) {
+    lo[k] = getCellCoord( p.lo[k], _cell );
+    hi[k] = getCellCoord( p.hi[k], _cell );
+  }
+}
+
+/*!
+ * \brief BroadPhase::isLarge
+ * \return True if the box of p covers more than MAX_CELLS cells of the grid
+ */
+bool
+BroadPhase::isLarge( const Proxy& p ) const {
+
+  int lo[3], hi[3];
+  getCellRange( p, lo, hi );
+  int64_t no_cells = 1;
+  for( int k = 0; k < 3; ++k )
+    no_cells *= int64_t( hi[k] - lo[k] + 1 );
+  return no_cells > MAX_CELLS;
+}
+
+void
+BroadPhase::set( int id, const Sphere<float,3>& s, const Vector<float,3>& ds ) {
+
+  Proxy& p = _proxies[size_t(id)];
+  p.c = s.getPos() + 0.5f * ds;
+  p.r = s.getRadius() + 0.5f * ds.getLength();
+  for( int k = 0; k < 3; ++k ) {
+    p.lo[k] = p.c[k] - p.r;
+    p.hi[k] = p.c[k] + p.r;
+  }
+
+  if( !p.moved ) {
+    p.moved = true;
+    _moved.push_back( id );
+  }
+}
+
+uint64_t
+BroadPhase::getCellKey( int x, int y, int z ) {
+
+  return ( uint64_t( x + CELL_RANGE ) << 42 ) |
+         ( uint64_t( y + CELL_RANGE ) << 21 ) |
+           uint64_t( z + CELL_RANGE );
+}
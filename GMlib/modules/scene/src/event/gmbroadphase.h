@@ -0,0 +1,166 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+#ifndef GM_SCENE_EVENT_GMBROADPHASE_H
+#define GM_SCENE_EVENT_GMBROADPHASE_H
+
+//- gmlib
+#include <core/types/gmpoint.h>
+
+//- stl
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace GMlib {
+
+  /*!
+   * \class BroadPhase gmbroadphase.h <gmBroadPhase>
+   * \brief Candidate pairs of moving spheres for collision controllers
+   *
+   *  An EventController testing moving spheres against each other can keep
+   *  them here, and run the exact time of impact tests on the candidates only,
+   *  instead of on all pairs. A sphere is given with its motion over the step,
+   *  and is bounded by a swept sphere around its start and end positions.
+   *  Two spheres are candidates when their swept spheres intersect, i.e. they
+   *  may collide within [0, dt].
+   *
+   *  In EventController::detect(dt) the controller updates the spheres and
+   *  asks for all candidate pairs with findPairs(). When handling an event
+   *  changes the motion of a sphere, it updates that sphere and asks for
+   *  its new candidates with findCandidates(), which only tests the spheres
+   *  updated since the last findPairs() one by one.
+   *
+   *  Two methods are available:
+   *    - SweepAndPrune sorts the spheres on the axis of largest spread. The
+   *      order is kept between the steps and sorted again by insertion, which
+   *      is nearly linear when the spheres move a little each step.
+   *    - UniformGrid puts the spheres in the cells of a grid, with the cell
+   *      size given or twice the average swept radius. Best when the spheres
+   *      are of about the same size and evenly spread. A sphere covering more
+   *      than 64 cells is kept out of the grid, and tested against all others.
+   *
+   *  The pairs are ordered, and the same for both methods.
+   */
+  class BroadPhase {
+  public:
+    enum Method {
+      SweepAndPrune,
+      UniformGrid
+    };
+
+    explicit BroadPhase( Method method = SweepAndPrune );
+
+    int     insert( const Sphere<float,3>& s, const Vector<float,3>& ds = Vector<float,3>(0.0f) );
+    void    update( int id, const Sphere<float,3>& s, const Vector<float,3>& ds = Vector<float,3>(0.0f) );
+    void    remove( int id );
+    void    clear();
+
+    const std::vector<std::pair<int,int>>&  findPairs();
+    void                                    findCandidates( int id, std::vector<int>& ids );
+
+    float   getCellSize() const;
+    Method  getMethod() const;
+    int     getSize() const;
+    void    setCellSize( float size );
+    void    setMethod( Method method );
+
+  private:
+    struct Proxy {
+      Point<float,3>  c;          //!< Center of the swept sphere
+      float           r;          //!< Radius of the swept sphere
+      float           lo[3];      //!< Box around the swept sphere
+      float           hi[3];
+      bool            used;
+      bool            moved;      //!< Updated since the last build
+      bool            listed;     //!< In the sweep and prune order
+      bool            large;      //!< Out of the grid at the last build
+    };
+
+    std::vector<Proxy>                _proxies;
+    std::vector<int>                  _free;
+    std::vector<int>                  _moved;         //!< Updated since the last build
+    int                               _size;
+    Method                            _method;
+    bool                              _built;
+
+    // Sweep and prune
+    std::vector<int>                  _order;         //!< Sorted on lo[_axis] at the last build
+    std::vector<float>                _keys;          //!< lo[_axis] at the last build
+    int                               _axis;
+    float                             _max_width;     //!< Largest hi - lo on the axis at the last build
+
+    // Uniform grid
+    std::vector<std::pair<uint64_t,int>> _cells;      //!< Sorted (cell, id)
+    std::vector<int>                  _large;         //!< Ids kept out of the grid, in order
+    float                             _cell_size;     //!< Given, or 0 to compute it
+    float                             _cell;          //!< Used at the last build
+
+    std::vector<std::pair<int,int>>   _pairs;
+
+    void              build();
+    void              buildSweep();
+    void              buildGrid();
+    void              getCellRange( const Proxy& p, int lo[3], int hi[3] ) const;
+    bool              isLarge( const Proxy& p ) const;
+    bool              isOverlapping( int a, int b ) const;
+    void              set( int id, const Sphere<float,3>& s, const Vector<float,3>& ds );
+
+    static uint64_t   getCellKey( int x, int y, int z );
+  };
+
+
+
+  inline
+  float BroadPhase::getCellSize() const {
+
+    return _cell_size;
+  }
+
+  inline
+  BroadPhase::Method BroadPhase::getMethod() const {
+
+    return _method;
+  }
+
+  inline
+  int BroadPhase::getSize() const {
+
+    return _size;
+  }
+
+  inline
+  bool BroadPhase::isOverlapping( int a, int b ) const {
+
+    const Proxy& p = _proxies[size_t(a)];
+    const Proxy& q = _proxies[size_t(b)];
+    for( int k = 0; k < 3; ++k )
+      if( p.lo[k] > q.hi[k] || q.lo[k] > p.hi[k] )
+        return false;
+    const Vector<float,3> d = p.c - q.c;
+    const float           r = p.r + q.r;
+    return d * d <= r * r;
+  }
+
+}
+
+#endif // GM_SCENE_EVENT_GMBROADPHASE_H
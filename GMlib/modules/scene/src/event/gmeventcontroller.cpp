@@ -1,9 +1,15 @@
 #include "gmeventcontroller.h"
 
+//- gmlib
+#include <core/utils/gmtaskgraph.h>
+
+//- stl
+#include <algorithm>
+
 using namespace GMlib;
 
 
-EventController::EventController() {}
+EventController::EventController() : _thread_safe(false), _parallel(false) {}
 EventController::~EventController() {}
 
 double EventController::getFirstEventX() const {
@@ -12,6 +18,27 @@ double EventController::getFirstEventX() const {
 }
 
 
+/*!
+ * \brief EventController::isThreadSafe
+ * \return Whether detect() can run concurrently with other controllers
+ */
+bool EventController::isThreadSafe() const {
+
+  return _thread_safe;
+}
+
+/*!
+ * \brief EventController::setThreadSafe
+ * \param thread_safe - detect() only reads the scene and writes to this controller
+ *
+ *  Controllers that are not thread safe are detected on the thread calling
+ *  EventManager::processEvents(). The default is not thread safe.
+ */
+void EventController::setThreadSafe(bool thread_safe) {
+
+  _thread_safe = thread_safe;
+}
+
 bool EventController::detectEvents(double dt) {
 
   clear();
@@ -23,6 +50,35 @@ void EventController::handleFirstEvent() {
   handleFirst();
 }
 
+/*!
+ * \brief EventController::detectInChunks
+ * \param n - The number of items to detect events for
+ * \param chunk_size - The number of items in a chunk
+ * \param f - Called as f(chunk, begin, end) for each chunk of items [begin, end)
+ * \return The number of chunks
+ *
+ *  For use in detect(). The chunks are run on the shared TaskPool when the
+ *  EventManager detects in parallel, else in order on this thread. Keeping
+ *  the events of each chunk apart, and merging them in chunk order, gives
+ *  the same events in both cases.
+ */
+int EventController::detectInChunks(int n, int chunk_size, const std::function<void(int,int,int)>& f) const {
+
+  const int no_chunks = chunk_size > 0 ? ( n + chunk_size - 1 ) / chunk_size : 0;
+
+  if( !_parallel || no_chunks < 2 ) {
+    for( int k = 0; k < no_chunks; ++k )
+      f( k, k * chunk_size, std::min( n, ( k + 1 ) * chunk_size ) );
+    return no_chunks;
+  }
+
+  TaskGraph graph;
+  for( int k = 0; k < no_chunks; ++k )
+    graph.insertTask( [&f,k,n,chunk_size]{ f( k, k * chunk_size, std::min( n, ( k + 1 ) * chunk_size ) ); } );
+  graph.run();
+  return no_chunks;
+}
+
 /*!
  * \brief EventController::finalize
  *
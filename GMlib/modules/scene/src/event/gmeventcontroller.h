@@ -26,6 +26,9 @@
 //- gmlib
 #include <core/containers/gmarray.h>
 
+//- stl
+#include <functional>
+
 namespace GMlib {
 
   class Event;
@@ -44,6 +47,12 @@ namespace GMlib {
    *       within that dt (second pass)
    *    NB! When storing events in Array, use insertAlways for performance reasons.
    *
+   *  With parallel detection in the EventManager, detect() of thread safe
+   *  controllers (setThreadSafe()) runs concurrently with the other
+   *  controllers, and detectInChunks() runs the chunks of a detection
+   *  concurrently. Detection must then only read the scene, and write to
+   *  data of its own controller or chunk.
+   *
    *  Optionally, inherited classes can store customized information
    *  and perform updates based on events.
    *
@@ -54,12 +63,23 @@ namespace GMlib {
     virtual ~EventController();
 
     double  getFirstEventX() const;
+    bool    isThreadSafe() const;
+    void    setThreadSafe( bool thread_safe );
 
     bool    detectEvents( double dt );
     void    handleFirstEvent();
     void    finalize();
 
+  protected:
+    int     detectInChunks( int n, int chunk_size, const std::function<void(int,int,int)>& f ) const;
+
   private:
+    friend class EventManager;
+
+    bool    _thread_safe;
+    bool    _parallel;      //!< Set by the EventManager for the detection
+
+
     /*!
      *  \brief void clear()
      *
@@ -1,13 +1,17 @@
 #include "gmeventmanager.h"
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
 
 #include "gmevent.h"
 #include "gmeventcontroller.h"
 
+#include <core/utils/gmtaskgraph.h>
+
 using namespace GMlib;
 
-EventManager::EventManager() {
+EventManager::EventManager() : _parallel_detect(false) {
 }
 
 EventManager::~EventManager() {
@@ -18,7 +22,8 @@ EventManager::~EventManager() {
  * \param dt - delta time
  *
  *  The algorithm works as follows:
- *    1. Asks controllers to detect new events with a <i>dt</i> simulation step
+ *    1. Asks controllers to detect new events with a <i>dt</i> simulation step,
+ *       and queues the controllers having events on the x of their first event
  *    2. Asks to handle the firt event for as long as there are valid events
  *    3. Call finalize to handle the "rest" of the simulation step in each controller
  */
@@ -26,8 +31,34 @@ void
 EventManager::processEvents(double dt) {
 
   // detect events
-  for( int i = 0; i < _event_controllers.size(); ++i )
-    _event_controllers[i]->detectEvents( dt );
+  if( _parallel_detect && _event_controllers.size() > 1 ) {
+
+    // The controllers that are not thread safe are detected on this thread
+    TaskGraph graph;
+    for( int i = 0; i < _event_controllers.size(); ++i ) {
+      EventController* ctl = _event_controllers[i];
+      ctl->_parallel = true;
+      graph.insertTask( [ctl,dt]{ ctl->detectEvents( dt ); }, !ctl->isThreadSafe() );
+    }
+    graph.run();
+  }
+  else {
+    for( int i = 0; i < _event_controllers.size(); ++i ) {
+      _event_controllers[i]->_parallel = _parallel_detect;
+      _event_controllers[i]->detectEvents( dt );
+    }
+  }
+
+  // Queued in controller order, the same order for serial and parallel detection
+  _queue.clear();
+  for( int i = 0; i < _event_controllers.size(); ++i ) {
+
+    // Controller returns x == 0.0 if there is no event. and event must be in (0.0, x]
+    const double x = _event_controllers[i]->getFirstEventX();
+    if( x > 0.0 )
+      _queue.emplace_back( x, i );
+  }
+  std::make_heap( _queue.begin(), _queue.end(), std::greater<std::pair<double,int>>() );
 
   // handle each event ...
   while( handleFirstEvent() );
@@ -37,6 +68,28 @@ EventManager::processEvents(double dt) {
     _event_controllers[i]->finalize();
 }
 
+/*!
+ * \brief EventManager::enableParallelDetect
+ *
+ *  Detects the events of the controllers in parallel on the shared TaskPool,
+ *  see EventController::setThreadSafe() and EventController::detectInChunks().
+ *  The events are handled in the same order as with serial detection.
+ */
+void
+EventManager::enableParallelDetect() {
+  _parallel_detect = true;
+}
+
+void
+EventManager::disableParallelDetect() {
+  _parallel_detect = false;
+}
+
+bool
+EventManager::isParallelDetect() const {
+  return _parallel_detect;
+}
+
 /*!
  * \brief EventManager::registerController
  * \param controller - EventController
@@ -54,34 +107,34 @@ EventManager::registerController(EventController *controller) {
  * \return Whether an event was handled
  *
  *  Handle the first event if an event exists in any controller.
+ *  Only the controller handling the event changes, so only its entry
+ *  in the queue is updated. Equal x are handled in controller order.
  */
 bool
 EventManager::handleFirstEvent() {
 
-  // 1) Find controller with lowest x event
-  EventController* ctl = 0x0;
-  double x = 0.0;
-  for( int i = 0; i < _event_controllers.size(); ++i ) {
+  if( _queue.empty() )
+    return false;
 
-    EventController* c_ctl = _event_controllers[i];
-
-    // Controller returns x == 0.0 if there is no event. and event must be in (0.0, x]
-    const double c_x = c_ctl->getFirstEventX();
-    if( c_x > 0.0 && ( c_x < x || x == 0.0 ) ) {  // Optimized: early termination
-      x = c_x;
-      ctl = c_ctl;
-    }
-  }
+  // 1) Take the controller with lowest x event
+  const std::greater<std::pair<double,int>> later;
+  std::pop_heap( _queue.begin(), _queue.end(), later );
+  const int i = _queue.back().second;
+  _queue.pop_back();
 
   // 2) Controller handle first event
   //  2.0) Controller detects new events
   //  2.1) Controller sorts events
   //  2.2) Controller invalidates events
-  if( ctl ) {
-
-    ctl->handleFirstEvent();
-    return true;
+  EventController* ctl = _event_controllers[i];
+  ctl->handleFirstEvent();
+
+  // 3) Queue the controller again on its next event
+  const double x = ctl->getFirstEventX();
+  if( x > 0.0 ) {
+    _queue.emplace_back( x, i );
+    std::push_heap( _queue.begin(), _queue.end(), later );
   }
 
-  return false;
+  return true;
 }
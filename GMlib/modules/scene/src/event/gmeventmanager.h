@@ -26,6 +26,10 @@
 //- gmlib
 #include <core/containers/gmarray.h>
 
+//- stl
+#include <utility>
+#include <vector>
+
 namespace GMlib {
 
   class Event;
@@ -37,6 +41,10 @@ namespace GMlib {
    *
    *  The central EventManager class that handles EventControllers.
    *
+   *  The controllers are kept in a min-heap on the x of their first
+   *  event, so picking the next event is O(log n) in the number of
+   *  controllers. A controller is expected to change its own events only,
+   *  as it does through the EventController interface.
    */
   class EventManager {
   public:
@@ -46,10 +54,16 @@ namespace GMlib {
     void    processEvents(double dt);
     bool    registerController(EventController* controller);
 
+    void    enableParallelDetect();
+    void    disableParallelDetect();
+    bool    isParallelDetect() const;
+
   private:
     bool    handleFirstEvent();
 
-    Array<EventController*> _event_controllers;
+    Array<EventController*>            _event_controllers;
+    std::vector<std::pair<double,int>> _queue;  //!< Min-heap of (first event x, controller index)
+    bool                               _parallel_detect;
   };
 
 }
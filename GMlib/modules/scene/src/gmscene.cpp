@@ -28,6 +28,8 @@
 
 // gmlib
 #include <core/utils/gmutils.h>
+#include <core/utils/gmparallel.h>
+#include <core/utils/gmtaskgraph.h>
 
 // local
 #include "gmsceneobject.h"
@@ -38,9 +40,70 @@
 #include "light/gmspotlight.h"
 #include "light/gmsun.h"
 
+// stl
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+
 
 namespace GMlib {
 
+  namespace {
+
+    // Does the ray o + t*d, 0 <= t <= t_max, go through the sphere
+    bool hitSphere( const Sphere<float,3>& s, const Point<float,3>& o, const Vector<float,3>& d, float t_max ) {
+
+      const Vector<float,3> c  = s.getPos() - o;
+      const float           r2 = s.getRadius() * s.getRadius();
+      const float           dd = d * d;
+      if( dd <= 0.0f ) return c * c <= r2;
+
+      const float           tc = (c * d) / dd;
+      const Vector<float,3> e  = c - tc * d;
+      const float           h  = r2 - e * e;
+      if( h < 0.0f ) return false;
+
+      const float dt = std::sqrt( h / dd );
+      return tc + dt >= 0.0f && tc - dt <= t_max;
+    }
+
+
+    // The nearest hit in the tree below obj, nearer than the hit given
+    void intersectTree( SceneObject* obj, const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit ) {
+
+      const Sphere<float,3>& s = obj->getSurroundingSphere();
+      if( !s.isValid() || !hitSphere( s, o, d, hit.t ) ) return;
+
+      RayHit h;
+      if( obj->isVisible() && obj->intersectRay( o, d, h ) && h.t < hit.t ) {
+        hit     = h;
+        hit.obj = obj;
+      }
+
+      Array<SceneObject*>& children = obj->getChildren();
+      for( int i = 0; i < children.getSize(); i++ )
+        intersectTree( children[i], o, d, hit );
+    }
+
+    // True if a shape only copy of obj keeps all that a ray can hit, the children
+    // left out (cameras, lights, selectors, see SceneObject::_setCopyShapeOnly())
+    // may have no children of their own
+    bool isCopiedWhole( SceneObject* obj ) {
+
+      Array<SceneObject*>& children = obj->getChildren();
+      for( int i = 0; i < children.getSize(); i++ ) {
+        if( children[i]->getTypeId() < GM_SO_TYPE_POINT && children[i]->getChildren().getSize() > 0 )
+          return false;
+        if( !isCopiedWhole( children[i] ) )
+          return false;
+      }
+      return true;
+    }
+
+  } // END anonymous namespace
+
+
 
 
   /*! Scene::Scene()
@@ -67,10 +130,10 @@ namespace GMlib {
     _matrix_stack(32),
     _event_manager(0) {
 
-    _scene += obj;
     _matrix_stack += HqMatrix<float,3>();
 
     init();
+    insert(obj);
   }
 
   Scene::Scene( const Scene&  s ) :
@@ -79,6 +142,13 @@ namespace GMlib {
     _event_manager(0) {
 
     init();
+
+    // The objects are shared, all of them are prepared for this scene
+    for( int i = 0; i < _scene.getSize(); ++i ) {
+      _scene[i]->_dirty = true;
+      _dirty_objs += _scene[i];
+      insertNames(_scene[i]);
+    }
   }
 
   Scene::~Scene() {
@@ -86,19 +156,38 @@ namespace GMlib {
     clear();
   }
 
+  /*! SceneObject* Scene::find(unsigned int name)
+   *  \brief The object in the scene with the given name, 0 if none
+   *
+   *  A lookup in the name index, kept up to date when objects are inserted
+   *  and removed, in the scene or as children of objects in the scene.
+   */
   SceneObject* Scene::find(unsigned int name) {
-    SceneObject* obj;
 
-    for(int i=0; i < _scene.getSize(); i++)
-      if( (obj = _scene[i]->find(name)) ) return obj;
-    return 0;
+    auto it = _names.find(name);
+    return it != _names.end() ? it->second : 0x0;
   }
 
   const SceneObject* Scene::find(unsigned int name) const {
 
-    for(int i=0; i < _scene.getSize(); i++)
-      if( const SceneObject* obj = _scene(i)->find(name) ) return obj;
-    return 0x0;
+    auto it = _names.find(name);
+    return it != _names.end() ? it->second : 0x0;
+  }
+
+  void Scene::insertNames(SceneObject* obj) {
+
+    _names[obj->getName()] = obj;
+    for( int i = 0; i < obj->getChildren().getSize(); i++ )
+      insertNames( obj->getChildren()[i] );
+  }
+
+  void Scene::removeNames(const SceneObject* obj) {
+
+    auto it = _names.find(obj->getName());
+    if( it != _names.end() && it->second == obj )
+      _names.erase(it);
+    for( int i = 0; i < obj->getChildren().getSize(); i++ )
+      removeNames( obj->getChildren()(i) );
   }
 
   void Scene::getRenderList( Array<const SceneObject*> &objs, const Camera *cam)  const {
@@ -109,8 +198,10 @@ namespace GMlib {
 
       const_cast<Camera*>(cam)->computeFrustumBounds();
 
-      for( int i = 0; i < _scene.getSize(); ++i )
-        _scene(i)->getRenderList( objs, *cam );
+      if( _flat_enabled && _flat.isBuilt() )
+        _flat.getRenderList( objs, *cam );
+      else
+        _bvh.getRenderList( objs, *cam );
     }
     else {
       for( int i = 0; i < _scene.getSize(); ++i )
@@ -130,6 +221,14 @@ namespace GMlib {
     // Remove/(delete) sun
     removeSun();
 
+    // The objects are no longer prepared by this scene
+    invalidateFlat();
+    for( int i = 0; i < _scene.getSize(); ++i ) {
+      _scene[i]->_scene        = 0x0;
+      _scene[i]->_dirty_listed = false;
+    }
+    _dirty_objs.clear();
+
     // Lights: if in scene remove, then delete
     for( int i = 0; i < _lights.getSize(); ++i ) {
       SceneObject *obj = dynamic_cast<SceneObject*>(_lights(i));
@@ -142,6 +241,8 @@ namespace GMlib {
     _cameras.clear();
 
     // Clear rest of scene (remove and delete)
+    _bvh.clear();
+    _names.clear();
     _scene.clear();
 
     if(running)
@@ -176,6 +277,110 @@ namespace GMlib {
     return sp;
   }
 
+  /*! bool Scene::intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit ) const
+   *  \brief The nearest visible object hit by the ray o + t*d, t >= 0
+   *
+   *  The object tree is pruned by the surrounding spheres (so the scene must have
+   *  been prepared), and each object on the ray is asked by SceneObject::intersectRay().
+   *
+   *  \param[in]  o    The ray origin, in global coordinates
+   *  \param[in]  d    The ray direction
+   *  \param[out] hit  The nearest hit, hit.obj is nullptr if nothing is hit
+   *  \return true if an object is hit
+   */
+  bool Scene::intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit ) const {
+
+    hit = RayHit();
+    for( int i = 0; i < _scene.getSize(); i++ )
+      intersectTree( _scene(i), o, d, hit );
+
+    return hit.obj != nullptr;
+  }
+
+
+  /*! void Scene::intersectRays( const std::vector<Point<float,3>>& o, const std::vector<Vector<float,3>>& d, std::vector<RayHit>& hits ) const
+   *  \brief Scene::intersectRay() for a batch of rays, run on the worker threads (see parallelFor())
+   *
+   *  The rays are split in chunks, one for each thread. A surface can not be
+   *  evaluated by two threads at the same time, so the first chunk traces the
+   *  objects themselves and each of the others a shape only copy of them, taking the
+   *  global matrices and ray hierarchies of the objects (see
+   *  SceneObject::_copyRayQueryData()). The hits are given by the objects copied.
+   *  An object a shape only copy would not keep whole is traced by one chunk
+   *  at a time. Each ray is traced as by intersectRay(), so the result is the
+   *  same whatever the number of threads.
+   *
+   *  \param[in]  o     The ray origins
+   *  \param[in]  d     The ray directions
+   *  \param[out] hits  The nearest hit of each ray
+   */
+  void Scene::intersectRays( const std::vector<Point<float,3>>& o, const std::vector<Vector<float,3>>& d,
+                             std::vector<RayHit>& hits ) const {
+
+    const int no_rays = int( std::min( o.size(), d.size() ) );
+    const int no_objs = _scene.getSize();
+
+    hits.assign( no_rays, RayHit() );
+    if( no_rays == 0 || no_objs == 0 ) return;
+
+    // A chunk must have rays enough to pay for the copies
+    const int min_chunk = 1024;
+    const int no_chunks = std::max( 1, std::min( getNoThreads(), no_rays / min_chunk ) );
+
+    // The objects traced by each chunk, the objects not copied are shared
+    std::vector<std::vector<SceneObject*>> objs( no_chunks, std::vector<SceneObject*>( no_objs ) );
+    std::vector<char> shared( no_objs, 0 );
+    std::vector<std::mutex> locks( no_objs );
+
+    const bool shape_only = SceneObject::_setCopyShapeOnly( true );
+    for( int i = 0; i < no_objs; i++ ) {
+
+      SceneObject* obj = _scene(i);
+      objs[0][i] = obj;
+      for( int c = 1; c < no_chunks; c++ ) {
+        SceneObject* copy = isCopiedWhole( obj ) ? obj->makeCopy() : nullptr;
+        if( !copy ) {
+          for( int k = 1; k < c; k++ ) delete objs[k][i];
+          for( int k = 1; k < no_chunks; k++ ) objs[k][i] = obj;
+          shared[i] = 1;
+          break;
+        }
+        copy->_copyRayQueryData( *obj );
+        objs[c][i] = copy;
+      }
+    }
+    SceneObject::_setCopyShapeOnly( shape_only );
+
+    parallelFor( 0, no_chunks, [&]( int b, int e ) {
+      for( int c = b; c < e; c++ ) {
+        const int r0 = c * no_rays / no_chunks;
+        const int r1 = (c+1) * no_rays / no_chunks;
+        for( int r = r0; r < r1; r++ ) {
+          RayHit& hit = hits[r];
+          for( int i = 0; i < no_objs; i++ ) {
+
+            if( shared[i] ) {
+              std::lock_guard<std::mutex> lock( locks[i] );
+              intersectTree( objs[c][i], o[r], d[r], hit );
+              continue;
+            }
+
+            const SceneObject* prev = hit.obj;
+            intersectTree( objs[c][i], o[r], d[r], hit );
+
+            // A copy hit is given by the object copied
+            if( c > 0 && hit.obj != prev )
+              hit.obj = const_cast<SceneObject*>( hit.obj->_copy_of );
+          }
+        }
+      }
+    } );
+
+    for( int c = 1; c < no_chunks; c++ )
+      for( int i = 0; i < no_objs; i++ )
+        if( !shared[i] ) delete objs[c][i];
+  }
+
   void Scene::updateSelection(SceneObject *obj) {
 
     if( obj->isSelected() )
@@ -189,8 +394,15 @@ namespace GMlib {
     if(!obj)
       return;
 
-    _scene.insert(obj);
+    if(!_scene.insert(obj))
+      return;
+
     obj->setParent(0);
+    obj->_scene = this;
+    obj->_dirty = true;
+    insertDirty(obj);
+    insertNames(obj);
+    invalidateFlat();
   }
 
   void Scene::insertCamera(Camera *cam, bool insert_in_scene) {
@@ -217,17 +429,112 @@ namespace GMlib {
     return false;
   }
 
+  /*! void Scene::prepare()
+   *  \brief Updates the scene matrices and spheres of the objects that have changed
+   *
+   *  Only the top level objects in the dirty list are visited, and of these
+   *  only the dirty parts (see SceneObject::prepare()). For a mostly static
+   *  scene the work is proportional to what has moved since the last call.
+   *  With the flat view enabled the work is done by SceneFlat::prepare().
+   */
   void Scene::prepare() {
 
+    if(_flat_enabled) {
+      if(!_flat.isBuilt())
+        _flat.build(this);
+      _flat.prepare();
+
+      for(int i=0; i < _dirty_objs.getSize(); i++)
+        _dirty_objs[i]->_dirty_listed = false;
+      _dirty_objs.resetSize();
+      return;
+    }
+
     int no_disp_obj = 0;
 
-    for(int i=0; i < _scene.getSize(); i++)
-      no_disp_obj += _scene[i]->prepare( _matrix_stack, this );
+    for(int i=0; i < _dirty_objs.getSize(); i++) {
+      _dirty_objs[i]->_dirty_listed = false;
+      no_disp_obj += _dirty_objs[i]->prepare( _matrix_stack, this );
+    }
+    _dirty_objs.resetSize();
   }
 
   void Scene::remove( SceneObject* obj ) {
 
-    if(obj) _scene.remove(obj);
+    if(obj) {
+      invalidateFlat();
+      if(_scene.remove(obj)) {
+        removeDirty(obj);
+        removeNames(obj);
+        obj->_scene = 0x0;
+      }
+      removeFromBvh(obj);
+    }
+  }
+
+  void Scene::insertDirty(SceneObject* obj) {
+
+    std::lock_guard<std::mutex> lock(_dirty_mutex);
+
+    if(obj->_dirty_listed)
+      return;
+
+    obj->_dirty_listed = true;
+    _dirty_objs += obj;
+  }
+
+  void Scene::removeDirty(SceneObject* obj) {
+
+    std::lock_guard<std::mutex> lock(_dirty_mutex);
+
+    if(!obj->_dirty_listed)
+      return;
+
+    obj->_dirty_listed = false;
+    _dirty_objs.remove(obj);
+  }
+
+  /*! void Scene::enableFlatView()
+   *  \brief Keeps a flattened view of the object hierarchy (see SceneFlat)
+   *
+   *  The view is built by the next prepare(), and rebuilt by the prepare() after
+   *  objects are inserted or removed. prepare() is then done by the view, and so
+   *  is the culling of getRenderList() while the view is built.
+   */
+  void Scene::enableFlatView() {
+
+    _flat_enabled = true;
+  }
+
+  void Scene::disableFlatView() {
+
+    _flat_enabled = false;
+    _flat.clear();
+  }
+
+  void Scene::updateFlat(const SceneObject* obj) {
+
+    _flat.update(obj->_flat_index);
+  }
+
+  void Scene::invalidateFlat() {
+
+    if(_flat.isBuilt())
+      _flat.clear();
+  }
+
+  void Scene::updateBvh(SceneObject* obj) {
+
+    _bvh.update(obj);
+  }
+
+  void Scene::removeFromBvh(SceneObject* obj) {
+
+    _bvh.remove(obj);
+
+    const Array<SceneObject*>& children = obj->getChildren();
+    for( int i = 0; i < children.getSize(); ++i )
+      removeFromBvh(children(i));
   }
 
   void Scene::insertLight(Light* light, bool insert_in_scene ) {
@@ -295,7 +602,18 @@ namespace GMlib {
     _timer_time_elapsed   = other._timer_time_elapsed;
     _timer_time_scale     = other._timer_time_scale;
 
+    _bvh.clear();
+    invalidateFlat();
+    for( int i = 0; i < _dirty_objs.getSize(); ++i )
+      _dirty_objs[i]->_dirty_listed = false;
+    _dirty_objs.clear();
     _scene                = other._scene;
+    _names.clear();
+    for( int i = 0; i < _scene.getSize(); ++i ) {
+      _scene[i]->_dirty = true;
+      _dirty_objs += _scene[i];
+      insertNames(_scene[i]);
+    }
     _event_manager        = other._event_manager;
 
     _lights               = other._lights;
@@ -350,6 +668,8 @@ namespace GMlib {
 
     if( !_timer_active ) return;
 
+    _render_thread = std::this_thread::get_id();
+
     if( GMutils::compValueF(_timer_time_elapsed,0.0) ) prepare();
 
     double dt, timer_dt;
@@ -361,7 +681,122 @@ namespace GMlib {
 
       _timer_time_elapsed  += dt;
       if ( _event_manager ) _event_manager->processEvents(dt);
-      for( int i=0; i< _scene.getSize(); i++ )
+      if( _parallel_simulate ) {
+        simulateParallel(dt);
+      }
+      else {
+        for( int i=0; i< _scene.getSize(); i++ )
+          _scene[i]->simulate(dt);
+      }
+    }
+  }
+
+  /*! void Scene::enableParallelSimulate()
+   *  \brief Simulates the thread safe objects on the shared TaskPool
+   *
+   *  A top level object, with its children, is simulated on a worker thread
+   *  when all of them are thread safe (see SceneObject::setThreadSafe()). The
+   *  other top level objects are simulated on the calling thread, in the order
+   *  of the scene when the dependencies allow it. An object is simulated
+   *  after the objects it depends on (see
+   *  SceneObject::insertSimulateDependency()), and after the object it is
+   *  locked to.
+   *
+   *  The objects replotted in localSimulate() only mark it by setEditDone(),
+   *  and replotEdited() does the replots on the rendering thread. A replot
+   *  on an other thread fails an assertion in debug builds, see
+   *  SceneObject::isOnRenderingThread().
+   */
+  void Scene::enableParallelSimulate() {
+
+    _parallel_simulate = true;
+  }
+
+  void Scene::disableParallelSimulate() {
+
+    _parallel_simulate = false;
+  }
+
+  namespace {
+
+    bool isThreadSafeTree( const SceneObject* obj ) {
+
+      if( !obj->isThreadSafe() ) return false;
+      for( int i = 0; i < obj->getChildren().getSize(); i++ )
+        if( !isThreadSafeTree( obj->getChildren()(i) ) ) return false;
+      return true;
+    }
+
+    void mapTree( const SceneObject* obj, int task, std::unordered_map<const SceneObject*,int>& task_of ) {
+
+      task_of[obj] = task;
+      for( int i = 0; i < obj->getChildren().getSize(); i++ )
+        mapTree( obj->getChildren()(i), task, task_of );
+    }
+
+    // The key of the task graph: an object with its lock object, thread safety
+    // and dependencies ended by 0x0, then its children, ended by 0x0
+    void appendKey( const SceneObject* obj, std::vector<const void*>& key ) {
+
+      key.push_back( obj );
+      key.push_back( obj->getLockObject() );
+      key.push_back( obj->isThreadSafe() ? obj : 0x0 );
+      const Array<SceneObject*>& deps = obj->getSimulateDependencies();
+      for( int i = 0; i < deps.getSize(); i++ )
+        key.push_back( deps(i) );
+      key.push_back( 0x0 );
+
+      for( int i = 0; i < obj->getChildren().getSize(); i++ )
+        appendKey( obj->getChildren()(i), key );
+      key.push_back( 0x0 );
+    }
+
+    void insertEdges( const SceneObject* obj, int task, const std::unordered_map<const SceneObject*,int>& task_of, TaskGraph& graph ) {
+
+      const Array<SceneObject*>& deps = obj->getSimulateDependencies();
+      for( int i = 0; i <= deps.getSize(); i++ ) {
+        const SceneObject* dep = i < deps.getSize() ? deps(i) : obj->getLockObject();
+        auto it = task_of.find( dep );
+        if( it != task_of.end() && it->second != task )
+          graph.insertEdge( it->second, task );
+      }
+      for( int i = 0; i < obj->getChildren().getSize(); i++ )
+        insertEdges( obj->getChildren()(i), task, task_of, graph );
+    }
+
+  } // END anonymous namespace
+
+  void Scene::simulateParallel( double dt ) {
+
+    // The graph is made again only when the objects, their locks, thread
+    // safety or dependencies have changed since the last frame
+    _sim_key_now.clear();
+    for( int i = 0; i < _scene.getSize(); i++ )
+      appendKey( _scene[i], _sim_key_now );
+
+    if( _sim_key_now != _sim_key ) {
+
+      // One task for each top level object, the ones that are not thread safe
+      // are run on this thread, in the order they get ready
+      _sim_graph.clear();
+      std::unordered_map<const SceneObject*,int> task_of;
+      for( int i = 0; i < _scene.getSize(); i++ ) {
+
+        const int task = _sim_graph.insertTask( [this,i]{ _scene[i]->simulate(_sim_dt); }, !isThreadSafeTree( _scene[i] ) );
+        mapTree( _scene[i], task, task_of );
+      }
+
+      for( int i = 0; i < _scene.getSize(); i++ )
+        insertEdges( _scene[i], task_of[_scene[i]], task_of, _sim_graph );
+
+      _sim_key.swap( _sim_key_now );
+      _sim_acyclic = _sim_graph.isAcyclic();
+    }
+
+    // Cyclic dependencies, ignore them
+    _sim_dt = dt;
+    if( !_sim_acyclic || !_sim_graph.run() ) {
+      for( int i = 0; i < _scene.getSize(); i++ )
         _scene[i]->simulate(dt);
     }
   }
@@ -373,6 +808,10 @@ namespace GMlib {
     _timer_time_elapsed  = 0;
     _timer_fixed_dt_enabled = false;
     _timer_fixed_dt = 0.25;
+    _parallel_simulate = false;
+    _sim_acyclic = false;
+    _sim_dt = 0.0;
+    _flat_enabled = false;
 
     _sun = 0x0;
   }
@@ -390,6 +829,53 @@ namespace GMlib {
           _scene(i)->getEditedObjects(e_obj);
   }
 
+  /*! int Scene::replotEdited()
+   *  \brief Replots the visible objects marked by setEditDone(), returns how many
+   *
+   *  The deferred OpenGL work of simulate(), to be called on the rendering
+   *  thread before the scene is rendered.
+   */
+  int Scene::replotEdited() {
+
+      Array<const SceneObject*> e_obj;
+      getEditedObjects(e_obj);
+
+      int n = 0;
+      for(int i=0; i< e_obj.getSize(); i++)
+          if(e_obj(i)->isVisible()) {
+              e_obj(i)->replot();
+              n++;
+          }
+      return n;
+  }
+
+  namespace {
+
+    int syncTree( SceneObject* obj ) {
+
+      int n = obj->syncReplot() ? 1 : 0;
+      for( int i = 0; i < obj->getChildren().getSize(); i++ )
+        n += syncTree( obj->getChildren()[i] );
+      return n;
+    }
+
+  } // END anonymous namespace
+
+  /*! int Scene::syncReplots()
+   *  \brief Takes in the finished background replots, returns how many
+   *
+   *  Calls SceneObject::syncReplot() of all objects. The sync point of the
+   *  asynchronous replots (see PSurf::replotAsync()), to be called on the
+   *  rendering thread before the scene is prepared.
+   */
+  int Scene::syncReplots() {
+
+      int n = 0;
+      for(int i=0; i< _scene.getSize(); i++)
+          n += syncTree(_scene[i]);
+      return n;
+  }
+
 
 
 } // END namespace GMlib
@@ -33,8 +33,20 @@
 #include <core/utils/gmtimer.h>
 #include <core/containers/gmarray.h>
 #include <core/utils/gmsortobject.h>
+#include <core/utils/gmtaskgraph.h>
 #include <opengl/bufferobjects/gmuniformbufferobject.h>
 
+// local
+#include "gmscenebvh.h"
+#include "gmsceneflat.h"
+
+// stl
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 
 namespace GMlib{
 
@@ -46,6 +58,25 @@ namespace GMlib{
 
 
 
+  /*! \struct RayHit gmscene.h <gmScene>
+   *  \brief The nearest hit of a ray o + t*d, see Scene::intersectRay()
+   *
+   *  Given in global (scene) coordinates. The ray parameter t is not
+   *  normalized, i.e. the distance to the hit is t times the length of d.
+   */
+  struct RayHit {
+    SceneObject*      obj;      //!< The object hit, set by the Scene (nullptr if no hit)
+    float             t;        //!< Ray parameter of the hit
+    Point<float,2>    uv;       //!< Parameter values of the hit, for parametric objects
+    Point<float,3>    pos;      //!< Position of the hit
+    Vector<float,3>   normal;   //!< Unit surface normal at the hit
+
+    RayHit() : obj(nullptr), t(std::numeric_limits<float>::max()), uv(0.0f, 0.0f),
+               pos(0.0f, 0.0f, 0.0f), normal(0.0f, 0.0f, 0.0f) {}
+  };
+
+
+
   /*! \class Scene gmscene.h <gmscene>
    *  \brief Pending Documentation cleanup, and general documentation
    *
@@ -82,6 +113,21 @@ namespace GMlib{
 
     void                        getRenderList(Array<const SceneObject*>& disp_objs, const Camera* cam) const;
 
+    const SceneBvh&             getBvh() const;
+    void                        updateBvh(SceneObject* obj);        //!< Used by SceneObject::prepare()
+    void                        removeFromBvh(SceneObject* obj);    //!< Removes obj and its children from the BVH
+    void                        insertDirty(SceneObject* obj);      //!< Used by SceneObject, obj is prepared by the next prepare()
+    void                        removeDirty(SceneObject* obj);
+    void                        insertNames(SceneObject* obj);      //!< Used by SceneObject, indexes obj and its children for find()
+    void                        removeNames(const SceneObject* obj);
+
+    const SceneFlat&            getFlatView() const;
+    void                        enableFlatView();
+    void                        disableFlatView();
+    bool                        isFlatView() const;
+    void                        updateFlat(const SceneObject* obj); //!< Used by SceneObject, copies the changes of obj
+    void                        invalidateFlat();                   //!< The hierarchy has changed, the view is rebuilt by prepare()
+
     Array<Light*>&              getLights();
     const Array<Light*>&        getLights() const;
     void                        insertLight(Light* light, bool insert_in_scene = false);
@@ -101,6 +147,10 @@ namespace GMlib{
 
     void                        prepare();
     void                        simulate();
+    void                        enableParallelSimulate();
+    void                        disableParallelSimulate();
+    bool                        isParallelSimulate() const;
+    bool                        isRenderingThread() const;
     bool                        isRunning() const;
     virtual bool                toggleRun();
     void                        enabledFixedDt();
@@ -117,6 +167,10 @@ namespace GMlib{
     Sphere<float,3>             getSphere() const;
     Sphere<float,3>             getSphereClean() const;
 
+    bool                        intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit ) const;
+    void                        intersectRays( const std::vector<Point<float,3>>& o, const std::vector<Vector<float,3>>& d,
+                                               std::vector<RayHit>& hits ) const;
+
     const Array<SceneObject*>&  getSelectedObjects() const;
     void                        updateSelection(SceneObject *obj );
     bool                        isSelected( SceneObject* obj ) const;
@@ -124,6 +178,8 @@ namespace GMlib{
     void                        clearSelection();
 
     void                        getEditedObjects(Array<const SceneObject*>& e_obj) const;
+    int                         replotEdited();
+    int                         syncReplots();
     void                        setEventManager( EventManager* mgr );
 
 
@@ -140,6 +196,13 @@ namespace GMlib{
 
     Array<SceneObject*>         _sel_objs;
 
+    SceneBvh                    _bvh;
+    Array<SceneObject*>         _dirty_objs;    //!< Top level objects to be prepared
+    std::mutex                  _dirty_mutex;   //!< Guards _dirty_objs during a parallel simulate
+    std::unordered_map<unsigned int,SceneObject*> _names; //!< All objects by name, see find()
+    SceneFlat                   _flat;
+    bool                        _flat_enabled;
+
     Array<HqMatrix<float,3> >   _matrix_stack;
 
     GMTimer                     _timer;
@@ -150,9 +213,19 @@ namespace GMlib{
     bool                        _timer_fixed_dt_enabled;
 
     EventManager*               _event_manager;
+    bool                        _parallel_simulate;
+    std::thread::id             _render_thread; //!< The thread calling simulate(), see isRenderingThread()
+
+    // The task graph of simulateParallel(), kept while the key is the same
+    TaskGraph                   _sim_graph;
+    std::vector<const void*>    _sim_key;       //!< The objects, locks, thread safety and dependencies of the graph
+    std::vector<const void*>    _sim_key_now;   //!< The key of this frame
+    bool                        _sim_acyclic;
+    double                      _sim_dt;        //!< The time step of the running graph
 
 
     void                        init();
+    void                        simulateParallel( double dt );
 
 
 
@@ -164,6 +237,52 @@ namespace GMlib{
 
 
 
+  /*! const SceneBvh& Scene::getBvh() const
+   *  \brief The bounding volume hierarchy over the objects of the scene
+   *
+   *  Updated by prepare().
+   */
+  inline
+  const SceneBvh& Scene::getBvh() const {
+
+    return _bvh;
+  }
+
+  /*! const SceneFlat& Scene::getFlatView() const
+   *  \brief The flattened view of the object hierarchy
+   *
+   *  Empty unless enabled by enableFlatView(). Built and updated by prepare().
+   */
+  inline
+  const SceneFlat& Scene::getFlatView() const {
+
+    return _flat;
+  }
+
+  inline
+  bool Scene::isFlatView() const {
+
+    return _flat_enabled;
+  }
+
+  inline
+  bool Scene::isParallelSimulate() const {
+
+    return _parallel_simulate;
+  }
+
+  /*! bool Scene::isRenderingThread() const
+   *  \brief True on the thread that simulates and renders the scene
+   *
+   *  That is the thread calling simulate(), the replots are left to it
+   *  (see replotEdited()). True on any thread before the first simulate().
+   */
+  inline
+  bool Scene::isRenderingThread() const {
+
+    return _render_thread == std::thread::id() || _render_thread == std::this_thread::get_id();
+  }
+
   inline
   double Scene::getElapsedTime() const {
 
@@ -0,0 +1,689 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#include "gmscenebvh.h"
+
+#include "gmscene.h"
+#include "gmsceneobject.h"
+#include "camera/gmcamera.h"
+
+// stl
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+
+namespace GMlib {
+
+  namespace {
+
+    // Leaf boxes are enlarged by this part of the radius
+    const float margin = 0.1f;
+
+
+    float area( const Box<float,3>& b ) {
+
+      const Vector<float,3> d = b.getPointDelta();
+      return 2.0f * ( d(0)*d(1) + d(1)*d(2) + d(2)*d(0) );
+    }
+
+
+    Box<float,3> unite( const Box<float,3>& a, const Box<float,3>& b ) {
+
+      Box<float,3> c( a );
+      c.insert( b );
+      return c;
+    }
+
+
+    Box<float,3> sphereBox( const Sphere<float,3>& s, float r ) {
+
+      const Vector<float,3> v( r, r, r );
+      return Box<float,3>( s.getPos() - v, s.getPos() + v );
+    }
+
+
+    // The slab test, t_enter is where the ray enters the box (clamped to 0)
+    bool hitBox( const Box<float,3>& box, const Point<float,3>& o, const Vector<float,3>& inv_d,
+                 float t_max, float& t_enter ) {
+
+      const Point<float,3> p0 = box.getPointMin();
+      const Point<float,3> p1 = box.getPointMax();
+
+      float t0 = 0.0f, t1 = t_max;
+      for( int k = 0; k < 3; k++ ) {
+        float a = (p0(k) - o(k)) * inv_d(k);
+        float b = (p1(k) - o(k)) * inv_d(k);
+        if( a > b ) std::swap( a, b );
+        if( a > t0 ) t0 = a;
+        if( b < t1 ) t1 = b;
+        if( t0 > t1 ) return false;
+      }
+      t_enter = t0;
+      return true;
+    }
+
+
+    /*! \brief Planes stored four by four, for testing a box against four planes at a time
+     *
+     *  Unused lanes have zero normal and infinite offset, they never cut off anything.
+     */
+    class PlaneSet {
+    public:
+      explicit PlaneSet( const std::vector<SceneBvh::Plane>& planes ) : _groups( (planes.size() + 3) / 4 ) {
+
+        for( Group& g : _groups )
+          for( int j = 0; j < 4; j++ ) {
+            g.nx[j] = g.ny[j] = g.nz[j] = g.ax[j] = g.ay[j] = g.az[j] = 0.0f;
+            g.d[j]  = std::numeric_limits<float>::max();
+          }
+
+        for( unsigned int i = 0; i < planes.size(); i++ ) {
+          Group& g = _groups[i/4];
+          const int j = i % 4;
+          g.nx[j] = planes[i].n(0);  g.ax[j] = std::abs( g.nx[j] );
+          g.ny[j] = planes[i].n(1);  g.ay[j] = std::abs( g.ny[j] );
+          g.nz[j] = planes[i].n(2);  g.az[j] = std::abs( g.nz[j] );
+          g.d[j]  = planes[i].d;
+        }
+      }
+
+      /*! \brief -1 if the box (center c, half size e) is outside a plane, 1 if it is inside all, else 0
+       *
+       *  A sphere is tested as a box with zero size and the radius added to the offsets,
+       *  see classify( c, r ).
+       */
+      int classify( const float c[3], const float e[3], float r = 0.0f ) const {
+
+        bool inside = true;
+
+#if defined(__SSE__)
+        const __m128 cx = _mm_set1_ps( c[0] ), cy = _mm_set1_ps( c[1] ), cz = _mm_set1_ps( c[2] );
+        const __m128 ex = _mm_set1_ps( e[0] ), ey = _mm_set1_ps( e[1] ), ez = _mm_set1_ps( e[2] );
+        const __m128 rr = _mm_set1_ps( r );
+        for( const Group& g : _groups ) {
+          const __m128 dist = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_load_ps( g.nx ), cx ),
+                                                                  _mm_mul_ps( _mm_load_ps( g.ny ), cy ) ),
+                                                      _mm_mul_ps( _mm_load_ps( g.nz ), cz ) ),
+                                          _mm_load_ps( g.d ) );
+          const __m128 rad  = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_load_ps( g.ax ), ex ),
+                                                                  _mm_mul_ps( _mm_load_ps( g.ay ), ey ) ),
+                                                      _mm_mul_ps( _mm_load_ps( g.az ), ez ) ),
+                                          rr );
+          if( _mm_movemask_ps( _mm_cmpge_ps( dist, rad ) ) ) return -1;
+          if( _mm_movemask_ps( _mm_cmpgt_ps( dist, _mm_sub_ps( _mm_setzero_ps(), rad ) ) ) ) inside = false;
+        }
+#else
+        for( const Group& g : _groups )
+          for( int j = 0; j < 4; j++ ) {
+            const float dist = g.nx[j]*c[0] + g.ny[j]*c[1] + g.nz[j]*c[2] - g.d[j];
+            const float rad  = g.ax[j]*e[0] + g.ay[j]*e[1] + g.az[j]*e[2] + r;
+            if( dist >= rad ) return -1;
+            if( dist > -rad ) inside = false;
+          }
+#endif
+        return inside ? 1 : 0;
+      }
+
+      int classify( const Box<float,3>& b ) const {
+
+        const Point<float,3> p0 = b.getPointMin(), p1 = b.getPointMax();
+        const float c[3] = { 0.5f*(p0(0)+p1(0)), 0.5f*(p0(1)+p1(1)), 0.5f*(p0(2)+p1(2)) };
+        const float e[3] = { 0.5f*(p1(0)-p0(0)), 0.5f*(p1(1)-p0(1)), 0.5f*(p1(2)-p0(2)) };
+        return classify( c, e );
+      }
+
+      int classify( const Sphere<float,3>& s ) const {
+
+        const float c[3] = { s.getPos()(0), s.getPos()(1), s.getPos()(2) };
+        const float e[3] = { 0.0f, 0.0f, 0.0f };
+        return classify( c, e, s.getRadius() );
+      }
+
+    private:
+      struct Group {
+        alignas(16) float nx[4];
+        alignas(16) float ny[4];
+        alignas(16) float nz[4];
+        alignas(16) float ax[4];
+        alignas(16) float ay[4];
+        alignas(16) float az[4];
+        alignas(16) float d[4];
+      };
+
+      std::vector<Group> _groups;
+    };
+
+
+    // The planes of the view frustum of the camera, as in Camera::isInsideFrustum()
+    std::vector<SceneBvh::Plane> frustumPlanes( const Camera& cam ) {
+
+      std::vector<SceneBvh::Plane> planes(6);
+      for( int i = 0; i < 6; i++ ) {
+        const Point<float,3>& p = cam._frustum_p[ i == 1 || i == 2 || i == 4 ? 0 : 1 ];
+        planes[i].n = cam._frustum_v[i];
+        planes[i].d = cam._frustum_v[i] * p;
+      }
+      return planes;
+    }
+
+  } // END anonymous namespace
+
+
+
+  SceneBvh::SceneBvh() : _root(-1), _free(-1), _no_objs(0) {}
+
+
+  SceneBvh::~SceneBvh() {
+
+    clear();
+  }
+
+
+  /*! void SceneBvh::update( SceneObject* obj )
+   *  \brief Inserts, moves or removes the leaf of an object, from its global surrounding sphere
+   *
+   *  Called by the Scene when the object is prepared. Objects without a valid
+   *  surrounding sphere have no leaf.
+   *
+   *  \param[in] obj  The object
+   */
+  void SceneBvh::update( SceneObject* obj ) {
+
+    const Sphere<float,3>& s = obj->getSurroundingSphereSelf();
+    const bool valid = obj->_sphere.isValid() && s.isValid();
+    int leaf = obj->_bvh_leaf;
+
+    // Not one of ours
+    if( leaf >= 0 && ( leaf >= int(_nodes.size()) || _nodes[leaf].obj != obj ) )
+      leaf = obj->_bvh_leaf = -1;
+
+    if( !valid ) {
+      if( leaf >= 0 ) remove( obj );
+      return;
+    }
+
+    if( leaf >= 0 ) {
+
+      Node& nd = _nodes[leaf];
+      nd.sphere = s;
+
+      // Still inside the box, and the box is not much too large
+      const Box<float,3> tight = sphereBox( s, s.getRadius() );
+      if( nd.box.isSurrounding( tight ) &&
+          nd.box.getValueDelta(0) <= 2.0f * (1.0f + margin) * ( tight.getValueDelta(0) + 1e-6f ) )
+        return;
+
+      removeLeaf( leaf );
+      _nodes[leaf].box = sphereBox( s, (1.0f + margin) * s.getRadius() );
+      insertLeaf( leaf );
+      return;
+    }
+
+    leaf = allocateNode();
+    Node& nd  = _nodes[leaf];
+    nd.box    = sphereBox( s, (1.0f + margin) * s.getRadius() );
+    nd.sphere = s;
+    nd.obj    = obj;
+    nd.height = 0;
+    obj->_bvh_leaf = leaf;
+    _no_objs++;
+
+    insertLeaf( leaf );
+  }
+
+
+  /*! void SceneBvh::remove( SceneObject* obj )
+   *  \brief Removes the leaf of an object, not the leaves of its children
+   */
+  void SceneBvh::remove( SceneObject* obj ) {
+
+    const int leaf = obj->_bvh_leaf;
+    if( leaf < 0 || leaf >= int(_nodes.size()) || _nodes[leaf].obj != obj ) return;
+
+    removeLeaf( leaf );
+    freeNode( leaf );
+    obj->_bvh_leaf = -1;
+    _no_objs--;
+  }
+
+
+  /*! void SceneBvh::clear()
+   *  \brief Removes all leaves
+   */
+  void SceneBvh::clear() {
+
+    for( Node& nd : _nodes )
+      if( nd.obj ) nd.obj->_bvh_leaf = -1;
+
+    _nodes.clear();
+    _root    = -1;
+    _free    = -1;
+    _no_objs = 0;
+  }
+
+
+  /*! void SceneBvh::getRenderList( Array<const SceneObject*>& objs, const Camera& cam ) const
+   *  \brief The visible objects with a global surrounding sphere inside or cutting the view frustum
+   *
+   *  Nodes outside a plane are skipped, nodes inside all planes are taken without
+   *  more testing, and the spheres in the leaves are tested as in
+   *  Camera::isInsideFrustum(). The frustum of the camera must be updated
+   *  (Camera::computeFrustumBounds()).
+   *
+   *  \param[out] objs  The objects found are added
+   *  \param[in]  cam   The camera
+   */
+  void SceneBvh::getRenderList( Array<const SceneObject*>& objs, const Camera& cam ) const {
+
+    if( _root < 0 ) return;
+
+    const PlaneSet planes( frustumPlanes( cam ) );
+
+    int stack[64];
+    int top = 0;
+    stack[top++] = _root;
+
+    while( top > 0 ) {
+
+      const Node& nd = _nodes[stack[--top]];
+
+      if( nd.isLeaf() ) {
+        if( nd.obj->isVisible() && planes.classify( nd.sphere ) >= 0 )
+          objs += nd.obj;
+        continue;
+      }
+
+      const int k = planes.classify( nd.box );
+      if( k < 0 ) continue;
+      if( k > 0 ) {
+        collect( nd.left,  objs );
+        collect( nd.right, objs );
+        continue;
+      }
+
+      stack[top++] = nd.right;
+      stack[top++] = nd.left;
+    }
+  }
+
+
+  /*! bool SceneBvh::intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit, int type_id ) const
+   *  \brief The nearest visible object hit by the ray o + t*d, t >= 0
+   *
+   *  The boxes along the ray are visited nearest first, and each object
+   *  is asked by SceneObject::intersectRay(). Nodes further away than the
+   *  nearest hit found so far are skipped.
+   *
+   *  \param[in]  o        The ray origin, in global coordinates
+   *  \param[in]  d        The ray direction
+   *  \param[out] hit      The nearest hit, hit.obj is nullptr if nothing is hit
+   *  \param[in]  type_id  Type id filter
+   *  \return true if an object is hit
+   */
+  bool SceneBvh::intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit, int type_id ) const {
+
+    hit = RayHit();
+    if( _root < 0 ) return false;
+
+    Vector<float,3> inv_d;
+    for( int k = 0; k < 3; k++ ) inv_d[k] = 1.0f / d(k);
+
+    float t0, t1;
+    int stack[64];
+    int top = 0;
+    stack[top++] = _root;
+
+    while( top > 0 ) {
+
+      const Node& nd = _nodes[stack[--top]];
+      if( !hitBox( nd.box, o, inv_d, hit.t, t0 ) ) continue;
+
+      if( nd.isLeaf() ) {
+        SceneObject* obj = nd.obj;
+        RayHit h;
+        if( obj->isVisible() && isOfType( obj, type_id ) && obj->intersectRay( o, d, h ) && h.t < hit.t ) {
+          hit     = h;
+          hit.obj = obj;
+        }
+        continue;
+      }
+
+      // The nearest child on top of the stack
+      const bool l = hitBox( _nodes[nd.left].box,  o, inv_d, hit.t, t0 );
+      const bool r = hitBox( _nodes[nd.right].box, o, inv_d, hit.t, t1 );
+      if( l && r ) {
+        stack[top++] = t0 <= t1 ? nd.right : nd.left;
+        stack[top++] = t0 <= t1 ? nd.left  : nd.right;
+      }
+      else if( l ) stack[top++] = nd.left;
+      else if( r ) stack[top++] = nd.right;
+    }
+
+    return hit.obj != nullptr;
+  }
+
+
+  /*! void SceneBvh::intersectFrustum( const std::vector<Plane>& planes, Array<SceneObject*>& objs, int type_id ) const
+   *  \brief The visible objects with a global surrounding sphere inside or cutting the convex volume given by the planes
+   *
+   *  \param[in]  planes   The planes, with outward normals
+   *  \param[out] objs     The objects found are added
+   *  \param[in]  type_id  Type id filter
+   */
+  void SceneBvh::intersectFrustum( const std::vector<Plane>& planes, Array<SceneObject*>& objs, int type_id ) const {
+
+    if( _root < 0 ) return;
+
+    const PlaneSet set( planes );
+
+    int stack[64];
+    int top = 0;
+    stack[top++] = _root;
+
+    while( top > 0 ) {
+
+      const Node& nd = _nodes[stack[--top]];
+
+      if( nd.isLeaf() ) {
+        if( nd.obj->isVisible() && isOfType( nd.obj, type_id ) && set.classify( nd.sphere ) >= 0 )
+          objs += nd.obj;
+        continue;
+      }
+
+      const int k = set.classify( nd.box );
+      if( k < 0 ) continue;
+      if( k > 0 ) {
+        collect( nd.left,  objs, type_id );
+        collect( nd.right, objs, type_id );
+        continue;
+      }
+
+      stack[top++] = nd.right;
+      stack[top++] = nd.left;
+    }
+  }
+
+
+  /*! bool SceneBvh::isValid() const
+   *  \brief Checks the structure: links, heights, boxes and the leaves of the objects
+   */
+  bool SceneBvh::isValid() const {
+
+    if( _root < 0 ) return _no_objs == 0;
+    if( _nodes[_root].parent != -1 ) return false;
+
+    int no_leaves = 0;
+    std::vector<int> stack( 1, _root );
+    while( !stack.empty() ) {
+
+      const int k = stack.back();
+      stack.pop_back();
+      const Node& nd = _nodes[k];
+
+      if( nd.isLeaf() ) {
+        if( nd.height != 0 || !nd.obj || nd.obj->_bvh_leaf != k ) return false;
+        if( !nd.box.isSurrounding( sphereBox( nd.sphere, nd.sphere.getRadius() ) ) ) return false;
+        no_leaves++;
+        continue;
+      }
+
+      const Node& l = _nodes[nd.left];
+      const Node& r = _nodes[nd.right];
+      if( nd.obj || l.parent != k || r.parent != k ) return false;
+      if( nd.height != 1 + std::max( l.height, r.height ) ) return false;
+      if( !nd.box.isSurrounding( l.box ) || !nd.box.isSurrounding( r.box ) ) return false;
+
+      stack.push_back( nd.left );
+      stack.push_back( nd.right );
+    }
+
+    return no_leaves == _no_objs;
+  }
+
+
+  /*! bool SceneBvh::isOfType( const SceneObject* obj, int type_id )
+   *  \brief The type id filter, see the class description
+   */
+  bool SceneBvh::isOfType( const SceneObject* obj, int type_id ) {
+
+    return type_id == 0 || type_id == obj->getTypeId() || ( type_id < 0 && type_id + obj->getTypeId() != 0 );
+  }
+
+
+  int SceneBvh::allocateNode() {
+
+    int k;
+    if( _free >= 0 ) {
+      k = _free;
+      _free = _nodes[k].parent;
+    }
+    else {
+      k = int(_nodes.size());
+      _nodes.push_back( Node() );
+    }
+
+    Node& nd  = _nodes[k];
+    nd.obj    = nullptr;
+    nd.parent = nd.left = nd.right = -1;
+    nd.height = 0;
+    return k;
+  }
+
+
+  void SceneBvh::freeNode( int k ) {
+
+    Node& nd  = _nodes[k];
+    nd.obj    = nullptr;
+    nd.height = -1;
+    nd.left   = nd.right = -1;
+    nd.parent = _free;
+    _free = k;
+  }
+
+
+  void SceneBvh::insertLeaf( int leaf ) {
+
+    if( _root < 0 ) {
+      _root = leaf;
+      _nodes[leaf].parent = -1;
+      return;
+    }
+
+    // Going down to the sibling giving the least increase in area
+    const Box<float,3> box = _nodes[leaf].box;
+    int k = _root;
+    while( !_nodes[k].isLeaf() ) {
+
+      const Node& nd = _nodes[k];
+      const float a        = area( nd.box );
+      const float combined = area( unite( nd.box, box ) );
+
+      // Cost of making a new parent here, and the increase pushed down to the children
+      const float cost        = 2.0f * combined;
+      const float inheritance = 2.0f * ( combined - a );
+
+      float cost_child[2];
+      const int child[2] = { nd.left, nd.right };
+      for( int i = 0; i < 2; i++ ) {
+        const Node& c = _nodes[child[i]];
+        const float ca = area( unite( c.box, box ) );
+        cost_child[i] = ( c.isLeaf() ? ca : ca - area( c.box ) ) + inheritance;
+      }
+
+      if( cost < cost_child[0] && cost < cost_child[1] ) break;
+      k = cost_child[0] < cost_child[1] ? child[0] : child[1];
+    }
+
+    // A new parent of the sibling and the leaf
+    const int sibling    = k;
+    const int old_parent = _nodes[sibling].parent;
+    const int parent     = allocateNode();
+    Node& p   = _nodes[parent];
+    p.parent  = old_parent;
+    p.box     = unite( _nodes[sibling].box, box );
+    p.height  = _nodes[sibling].height + 1;
+    p.left    = sibling;
+    p.right   = leaf;
+    _nodes[sibling].parent = parent;
+    _nodes[leaf].parent    = parent;
+
+    if( old_parent >= 0 ) {
+      if( _nodes[old_parent].left == sibling ) _nodes[old_parent].left  = parent;
+      else                                     _nodes[old_parent].right = parent;
+    }
+    else
+      _root = parent;
+
+    refit( _nodes[leaf].parent );
+  }
+
+
+  void SceneBvh::removeLeaf( int leaf ) {
+
+    if( leaf == _root ) {
+      _root = -1;
+      return;
+    }
+
+    const int parent      = _nodes[leaf].parent;
+    const int grandparent = _nodes[parent].parent;
+    const int sibling     = _nodes[parent].left == leaf ? _nodes[parent].right : _nodes[parent].left;
+
+    if( grandparent >= 0 ) {
+      if( _nodes[grandparent].left == parent ) _nodes[grandparent].left  = sibling;
+      else                                     _nodes[grandparent].right = sibling;
+      _nodes[sibling].parent = grandparent;
+      freeNode( parent );
+      refit( grandparent );
+    }
+    else {
+      _root = sibling;
+      _nodes[sibling].parent = -1;
+      freeNode( parent );
+    }
+  }
+
+
+  // Balances, and updates boxes and heights from node k to the root
+  void SceneBvh::refit( int k ) {
+
+    while( k >= 0 ) {
+
+      k = balance( k );
+
+      Node& nd  = _nodes[k];
+      const Node& l = _nodes[nd.left];
+      const Node& r = _nodes[nd.right];
+      nd.height = 1 + std::max( l.height, r.height );
+      nd.box    = unite( l.box, r.box );
+
+      k = nd.parent;
+    }
+  }
+
+
+  // A left or right rotation if node a is unbalanced, returns the new root of the subtree
+  int SceneBvh::balance( int a ) {
+
+    Node& na = _nodes[a];
+    if( na.isLeaf() || na.height < 2 ) return a;
+
+    const int b = na.left;
+    const int c = na.right;
+    Node& nb = _nodes[b];
+    Node& nc = _nodes[c];
+    const int bal = nc.height - nb.height;
+
+    // The higher child goes up, its higher child is kept and the other goes to a
+    if( bal > 1 || bal < -1 ) {
+
+      const int up = bal > 1 ? c : b;
+      Node& nu = _nodes[up];
+      const int f = nu.left;
+      const int g = nu.right;
+      Node& nf = _nodes[f];
+      Node& ng = _nodes[g];
+
+      // Swap a and up
+      nu.left   = a;
+      nu.parent = na.parent;
+      na.parent = up;
+      if( nu.parent >= 0 ) {
+        if( _nodes[nu.parent].left == a ) _nodes[nu.parent].left  = up;
+        else                              _nodes[nu.parent].right = up;
+      }
+      else
+        _root = up;
+
+      const int keep = nf.height > ng.height ? f : g;
+      const int move = nf.height > ng.height ? g : f;
+      nu.right = keep;
+      if( bal > 1 ) na.right = move;
+      else          na.left  = move;
+      _nodes[move].parent = a;
+
+      const Node& other = _nodes[ bal > 1 ? b : c ];
+      na.box    = unite( other.box, _nodes[move].box );
+      na.height = 1 + std::max( other.height, _nodes[move].height );
+      nu.box    = unite( na.box, _nodes[keep].box );
+      nu.height = 1 + std::max( na.height, _nodes[keep].height );
+
+      return up;
+    }
+
+    return a;
+  }
+
+
+  // All visible objects in the subtree of node k
+  void SceneBvh::collect( int k, Array<const SceneObject*>& objs ) const {
+
+    const Node& nd = _nodes[k];
+    if( nd.isLeaf() ) {
+      if( nd.obj->isVisible() ) objs += nd.obj;
+      return;
+    }
+    collect( nd.left,  objs );
+    collect( nd.right, objs );
+  }
+
+
+  void SceneBvh::collect( int k, Array<SceneObject*>& objs, int type_id ) const {
+
+    const Node& nd = _nodes[k];
+    if( nd.isLeaf() ) {
+      if( nd.obj->isVisible() && isOfType( nd.obj, type_id ) ) objs += nd.obj;
+      return;
+    }
+    collect( nd.left,  objs, type_id );
+    collect( nd.right, objs, type_id );
+  }
+
+
+} // END namespace GMlib
@@ -0,0 +1,166 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_SCENE_SCENEBVH_H
+#define GM_SCENE_SCENEBVH_H
+
+
+// gmlib
+#include <core/types/gmpoint.h>
+#include <core/containers/gmarray.h>
+
+// stl
+#include <vector>
+
+
+namespace GMlib {
+
+  class SceneObject;
+  class Camera;
+  struct RayHit;
+
+
+
+  /*! \class SceneBvh gmscenebvh.h <gmSceneBvh>
+   *  \brief Dynamic bounding volume hierarchy over the global surrounding spheres of scene objects
+   *
+   *  The Scene keeps one of these alongside its object tree (Scene::getBvh()). An
+   *  object is given a leaf the first time it is prepared with a valid surrounding
+   *  sphere, and loses it when it is removed from the scene or deleted. The leaf
+   *  holds a box around the global sphere of the object (without children), made a
+   *  little larger than needed so small movements do not change the tree. An object
+   *  moving out of its box, or shrinking well inside it, is reinserted, and the
+   *  boxes of the nodes above are refitted. Inserting picks the sibling giving the
+   *  least increase in surface area, and the tree is kept balanced by rotations.
+   *
+   *  Visibility is not a part of the tree, the queries skip invisible objects. The
+   *  type id filter of the queries have the same meaning as in
+   *  DefaultSelectRenderer::select(): 0 is all objects, a positive id is only
+   *  objects of that type and a negative id is all but objects of that type.
+   *
+   *  An object is in the hierarchy of one scene at a time, the hierarchy is not
+   *  copied with the scene.
+   */
+  class SceneBvh {
+  public:
+    struct Node {
+      Box<float,3>      box;        //!< Box around the children, or the enlarged box of the object
+      Sphere<float,3>   sphere;     //!< Global sphere of the object in leaves
+      SceneObject*      obj;        //!< The object in leaves, nullptr in inner nodes
+      int               parent;     //!< Parent node, or the next free node
+      int               left;       //!< Child nodes, -1 in leaves
+      int               right;
+      int               height;     //!< 0 in leaves, -1 in free nodes
+
+      bool              isLeaf() const { return left < 0; }
+    };
+
+    struct Plane {
+      Vector<float,3>   n;          //!< Outward normal
+      float             d;          //!< The points p with n*p > d are outside
+    };
+
+    SceneBvh();
+    ~SceneBvh();
+
+    void                  update( SceneObject* obj );
+    void                  remove( SceneObject* obj );
+    void                  clear();
+
+    void                  getRenderList( Array<const SceneObject*>& objs, const Camera& cam ) const;
+    bool                  intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit,
+                                        int type_id = 0 ) const;
+    void                  intersectFrustum( const std::vector<Plane>& planes, Array<SceneObject*>& objs,
+                                            int type_id = 0 ) const;
+
+    int                   getHeight() const;
+    int                   getNoNodes() const;
+    int                   getNoObjects() const;
+    const Node&           getNode( int k ) const;
+    int                   getRoot() const;
+    bool                  isValid() const;
+
+    static bool           isOfType( const SceneObject* obj, int type_id );
+
+  private:
+    std::vector<Node>     _nodes;
+    int                   _root;
+    int                   _free;
+    int                   _no_objs;
+
+    int                   allocateNode();
+    void                  freeNode( int k );
+    void                  insertLeaf( int leaf );
+    void                  removeLeaf( int leaf );
+    int                   balance( int a );
+    void                  refit( int k );
+    void                  collect( int k, Array<const SceneObject*>& objs ) const;
+    void                  collect( int k, Array<SceneObject*>& objs, int type_id ) const;
+
+    SceneBvh( const SceneBvh& ) = delete;
+    SceneBvh& operator = ( const SceneBvh& ) = delete;
+
+  }; // END class SceneBvh
+
+
+
+  inline
+  int SceneBvh::getHeight() const {
+
+    return _root < 0 ? 0 : _nodes[_root].height;
+  }
+
+
+  inline
+  int SceneBvh::getNoNodes() const {
+
+    return int(_nodes.size());
+  }
+
+
+  inline
+  int SceneBvh::getNoObjects() const {
+
+    return _no_objs;
+  }
+
+
+  inline
+  const SceneBvh::Node& SceneBvh::getNode( int k ) const {
+
+    return _nodes[k];
+  }
+
+
+  inline
+  int SceneBvh::getRoot() const {
+
+    return _root;
+  }
+
+
+} // END namespace GMlib
+
+
+#endif // GM_SCENE_SCENEBVH_H
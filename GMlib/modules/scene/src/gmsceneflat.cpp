@@ -0,0 +1,381 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#include "gmsceneflat.h"
+
+#include "gmscene.h"
+#include "gmsceneobject.h"
+#include "camera/gmcamera.h"
+
+// stl
+#include <cmath>
+
+
+namespace GMlib {
+
+
+  namespace {
+
+    // Packed affine matrices, the three upper rows of a HqMatrix
+    void pack( const HqMatrix<float,3>& m, float* a ) {
+
+      for( int r = 0; r < 3; r++ )
+        for( int c = 0; c < 4; c++ )
+          a[4*r + c] = m(r)(c);
+    }
+
+    void unpack( const float* a, HqMatrix<float,3>& m ) {
+
+      for( int r = 0; r < 3; r++ )
+        for( int c = 0; c < 4; c++ )
+          m[r][c] = a[4*r + c];
+    }
+
+    // a = b * c
+    void multiply( float* a, const float* b, const float* c ) {
+
+      for( int r = 0; r < 3; r++ ) {
+        const float* br = b + 4*r;
+        for( int k = 0; k < 4; k++ )
+          a[4*r + k] = br[0]*c[k] + br[1]*c[4 + k] + br[2]*c[8 + k];
+        a[4*r + 3] += br[3];
+      }
+    }
+
+
+    // As Sphere<float,3>::operator+=, a negative radius is an invalid sphere
+    void merge( float& x, float& y, float& z, float& r, float px, float py, float pz, float pr ) {
+
+      if( pr < 0.0f ) return;
+      if( r < 0.0f ) { x = px; y = py; z = pz; r = pr; return; }
+
+      const float vx = px - x, vy = py - y, vz = pz - z;
+      const float d = std::sqrt( vx*vx + vy*vy + vz*vz );
+
+      if( d > std::fabs( r - pr ) ) {
+        const float nr = ( d + r + pr ) / 2;
+        const float f = ( nr - r ) / d;
+        x += f*vx;  y += f*vy;  z += f*vz;
+        r = nr;
+      }
+      else if( pr >= r ) {
+        x = px; y = py; z = pz; r = pr;
+      }
+    }
+
+
+    // The planes of Camera::isInsideFrustum(), outward normals
+    struct Frustum {
+      float nx[6], ny[6], nz[6], d[6];
+
+      Frustum( const Camera& cam ) {
+        for( int i = 0; i < 6; i++ ) {
+          const Point<float,3>& p = cam._frustum_p[ i == 1 || i == 2 || i == 4 ? 0 : 1 ];
+          nx[i] = cam._frustum_v[i][0];
+          ny[i] = cam._frustum_v[i][1];
+          nz[i] = cam._frustum_v[i][2];
+          d[i]  = cam._frustum_v[i] * p;
+        }
+      }
+
+      // -1 outside, 0 intersecting, 1 inside
+      int classify( float x, float y, float z, float r ) const {
+        if( r < 0.0f ) return -1;
+        int ret = 1;
+        for( int i = 0; i < 6; i++ ) {
+          const float dv = nx[i]*x + ny[i]*y + nz[i]*z - d[i];
+          if( dv >= r ) return -1;
+          if( dv > -r ) ret = 0;
+        }
+        return ret;
+      }
+    };
+
+  } // END anonymous namespace
+
+
+
+  void SceneFlat::Spheres::resize( size_t n ) {
+
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    r.resize(n);
+  }
+
+
+  Sphere<float,3> SceneFlat::Spheres::get( int i ) const {
+
+    const size_t k = size_t(i);
+    if( r[k] < 0.0f ) return Sphere<float,3>( false );
+    return Sphere<float,3>( Point<float,3>( x[k], y[k], z[k] ), r[k] );
+  }
+
+
+
+  SceneFlat::SceneFlat() : _scene(0x0), _any_dirty(false), _built(false) {}
+
+
+  SceneFlat::~SceneFlat() {
+
+    clear();
+  }
+
+
+  /*! void SceneFlat::build( Scene* scene )
+   *  \brief Builds the view of the object hierarchy of the scene
+   *
+   *  All entries are marked, so the next prepare() computes the whole view.
+   */
+  void SceneFlat::build( Scene* scene ) {
+
+    clear();
+    _scene = scene;
+    for( int i = 0; i < scene->getSize(); i++ )
+      insert( (*scene)[i], -1 );
+
+    const size_t n = _objs.size();
+    _global.resize( 12*n );
+    _global_s.resize( n );
+    _total_s.resize( n );
+    _dirty.assign( n, 1 );
+    _any_dirty = n > 0;
+    _built = true;
+  }
+
+
+  void SceneFlat::insert( SceneObject* obj, int parent ) {
+
+    const int i = int(_objs.size());
+    obj->_flat_index = i;
+    obj->_scene      = _scene;
+    obj->_parent     = parent >= 0 ? _objs[size_t(parent)] : 0x0;
+
+    _objs.push_back( obj );
+    _parent.push_back( parent );
+    _end.push_back( i + 1 );
+    _local.resize( _local.size() + 12 );
+    _local_s.x.push_back( 0.0f );
+    _local_s.y.push_back( 0.0f );
+    _local_s.z.push_back( 0.0f );
+    _local_s.r.push_back( -1.0f );
+    _dirty.push_back( 0 );
+    update( i );
+
+    const Array<SceneObject*>& children = obj->getChildren();
+    for( int k = 0; k < children.getSize(); k++ )
+      insert( children(k), i );
+
+    _end[size_t(i)] = int(_objs.size());
+  }
+
+
+  /*! void SceneFlat::clear()
+   *  \brief Empties the view, the objects are no longer updating it
+   */
+  void SceneFlat::clear() {
+
+    for( SceneObject* obj : _objs )
+      obj->_flat_index = -1;
+
+    _objs.clear();
+    _parent.clear();
+    _end.clear();
+    _local.clear();
+    _global.clear();
+    _local_s.resize( 0 );
+    _global_s.resize( 0 );
+    _total_s.resize( 0 );
+    _dirty.clear();
+    _scene = 0x0;
+    _any_dirty = false;
+    _built = false;
+  }
+
+
+  /*! void SceneFlat::update( int i )
+   *  \brief Copies the local matrix and sphere of the object at entry i, and marks it
+   *
+   *  Called by the object when its matrix, scale or surrounding sphere changes.
+   */
+  void SceneFlat::update( int i ) {
+
+    const size_t k = size_t(i);
+    const SceneObject* obj = _objs[k];
+
+    pack( obj->getMatrix(), &_local[12*k] );
+
+    const Sphere<float,3>& s = obj->_sphere;
+    if( s.isValid() ) {
+      _local_s.x[k] = s.getPos()[0];
+      _local_s.y[k] = s.getPos()[1];
+      _local_s.z[k] = s.getPos()[2];
+      _local_s.r[k] = obj->_scale.isActive() ? s.getRadius() * obj->_scale.getMax() : s.getRadius();
+    }
+    else
+      _local_s.r[k] = -1.0f;
+
+    _dirty[k] = 1;
+    _any_dirty = true;
+  }
+
+
+  /*! void SceneFlat::prepare()
+   *  \brief Recomputes the matrices and spheres of the entries changed since the last call
+   *
+   *  Does the work of SceneObject::prepare() in two linear sweeps of the arrays.
+   *  The results are written to the objects that changed in a third sweep, so
+   *  each object is visited once, and their BVH leaves are updated.
+   */
+  void SceneFlat::prepare() {
+
+    if( !_any_dirty ) return;
+
+    const int n = getSize();
+
+    // Down: a marked entry marks its subtree
+    for( int i = 0; i < n; i++ ) {
+
+      const size_t k = size_t(i);
+      const int    p = _parent[k];
+      if( p >= 0 && _dirty[size_t(p)] ) _dirty[k] = 1;
+      if( !_dirty[k] ) continue;
+
+      float* g = &_global[12*k];
+      if( p >= 0 )
+        multiply( g, &_global[12*size_t(p)], &_local[12*k] );
+      else
+        for( int j = 0; j < 12; j++ ) g[j] = _local[12*k + size_t(j)];
+
+      const float lr = _local_s.r[k];
+      if( lr < 0.0f )
+        _global_s.r[k] = -1.0f;
+      else {
+        const float lx = _local_s.x[k], ly = _local_s.y[k], lz = _local_s.z[k];
+        _global_s.x[k] = g[0]*lx + g[1]*ly + g[2]*lz  + g[3];
+        _global_s.y[k] = g[4]*lx + g[5]*ly + g[6]*lz  + g[7];
+        _global_s.z[k] = g[8]*lx + g[9]*ly + g[10]*lz + g[11];
+        _global_s.r[k] = lr * std::sqrt( g[0]*g[0] + g[4]*g[4] + g[8]*g[8] );
+      }
+    }
+
+    // Up: refit the totals of the marked entries and their parents
+    for( int i = n-1; i >= 0; i-- ) {
+
+      const size_t k = size_t(i);
+      if( !_dirty[k] ) continue;
+
+      float& x = _total_s.x[k];
+      float& y = _total_s.y[k];
+      float& z = _total_s.z[k];
+      float& r = _total_s.r[k];
+      x = _global_s.x[k];  y = _global_s.y[k];  z = _global_s.z[k];  r = _global_s.r[k];
+
+      for( int j = i + 1; j < _end[k]; j = _end[size_t(j)] )
+        merge( x, y, z, r, _total_s.x[size_t(j)], _total_s.y[size_t(j)], _total_s.z[size_t(j)], _total_s.r[size_t(j)] );
+
+      const int p = _parent[k];
+      if( p >= 0 && !_dirty[size_t(p)] ) _dirty[size_t(p)] = 2;
+    }
+
+    // Write back, a parent before its children
+    for( int i = 0; i < n; i++ ) {
+
+      const size_t k = size_t(i);
+      if( !_dirty[k] ) continue;
+
+      SceneObject* obj = _objs[k];
+      if( _dirty[k] == 1 ) {
+        const int p = _parent[k];
+        if( p >= 0 )
+          obj->_matrix_scene = _objs[size_t(p)]->_present;
+        else
+          obj->_matrix_scene.reset();
+        obj->_matrix_scene_inv = obj->_matrix_scene;
+        obj->_matrix_scene_inv.invertOrthoNormal();
+        unpack( &_global[12*k], obj->_present );
+        obj->_global_sphere = _global_s.get(i);
+        _scene->updateBvh( obj );
+      }
+      obj->_global_total_sphere = _total_s.get(i);
+      obj->_dirty = obj->_dirty_child = false;
+      _dirty[k] = 0;
+    }
+
+    _any_dirty = false;
+  }
+
+
+  /*! void SceneFlat::getRenderList( Array<const SceneObject*>& objs, const Camera& cam ) const
+   *  \brief The objects seen by the camera, as by SceneObject::getRenderList()
+   *
+   *  A subtree whose total sphere is outside the frustum is skipped, and one
+   *  inside is taken whole. The frustum of the camera must be updated
+   *  (Camera::computeFrustumBounds()).
+   *
+   *  \param[out] objs  The objects found are added
+   *  \param[in]  cam   The camera
+   */
+  void SceneFlat::getRenderList( Array<const SceneObject*>& objs, const Camera& cam ) const {
+
+    const Frustum f( cam );
+    const int n = getSize();
+
+    int i = 0;
+    while( i < n ) {
+
+      const size_t k = size_t(i);
+      if( _local_s.r[k] < 0.0f ) { i = _end[k]; continue; }
+
+      const int c = f.classify( _total_s.x[k], _total_s.y[k], _total_s.z[k], _total_s.r[k] );
+      if( c < 0 ) { i = _end[k]; continue; }
+
+      if( c > 0 ) {
+        if( _objs[k]->isVisible() ) objs += _objs[k];
+        for( int j = i + 1; j < _end[k]; j++ )
+          if( _local_s.r[size_t(j)] >= 0.0f ) objs += _objs[size_t(j)];
+        i = _end[k];
+        continue;
+      }
+
+      if( _objs[k]->isVisible() &&
+          f.classify( _global_s.x[k], _global_s.y[k], _global_s.z[k], _global_s.r[k] ) >= 0 )
+        objs += _objs[k];
+      i++;
+    }
+  }
+
+
+  /*! HqMatrix<float,3> SceneFlat::getGlobalMatrix( int i ) const
+   *  \brief The matrix from the object at entry i to the scene, as SceneObject::getMatrixGlobal()
+   */
+  HqMatrix<float,3> SceneFlat::getGlobalMatrix( int i ) const {
+
+    HqMatrix<float,3> m;
+    unpack( &_global[12*size_t(i)], m );
+    return m;
+  }
+
+
+} // END namespace GMlib
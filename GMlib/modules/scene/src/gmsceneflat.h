@@ -0,0 +1,178 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_SCENE_SCENEFLAT_H
+#define GM_SCENE_SCENEFLAT_H
+
+
+// gmlib
+#include <core/types/gmpoint.h>
+#include <core/types/gmmatrix.h>
+#include <core/containers/gmarray.h>
+
+// stl
+#include <atomic>
+#include <vector>
+
+
+namespace GMlib {
+
+  class Scene;
+  class SceneObject;
+  class Camera;
+
+
+
+  /*! \class SceneFlat gmsceneflat.h <gmSceneFlat>
+   *  \brief Flattened depth first view of the object hierarchy of a scene
+   *
+   *  The objects are stored in depth first order with the index of the parent and
+   *  the end of the subtree of each, so a parent always comes before its children
+   *  and a subtree is a range of the arrays. The local and global matrices are
+   *  packed as their three upper rows, 12 floats per object. The local, global and
+   *  total (with the children) spheres are kept as separate arrays of the centers
+   *  and radii, an invalid sphere has a negative radius.
+   *
+   *  The view is built from the top level objects of a scene, and has to be
+   *  rebuilt when objects are inserted or removed. A changed matrix or sphere is
+   *  copied into the view at once by update(), which also marks the entry. Then
+   *  prepare() recomputes the marked entries, and the ones below them, in one
+   *  forward sweep, and refits the total spheres above them in a backward sweep.
+   *  getRenderList() is a forward sweep jumping past the culled subtrees.
+   *
+   *  The Scene keeps one when enabled (Scene::enableFlatView()), and then uses it
+   *  in place of the recursive SceneObject::prepare() and render list traversal.
+   *  An object is in the view of one scene at a time.
+   */
+  class SceneFlat {
+  public:
+    SceneFlat();
+    ~SceneFlat();
+
+    void                        build( Scene* scene );
+    void                        clear();
+    bool                        isBuilt() const;
+
+    void                        update( int i );
+    void                        prepare();
+
+    void                        getRenderList( Array<const SceneObject*>& objs, const Camera& cam ) const;
+
+    int                         getSize() const;
+    SceneObject*                getObject( int i ) const;
+    int                         getParent( int i ) const;
+    int                         getSubtreeEnd( int i ) const;
+    HqMatrix<float,3>           getGlobalMatrix( int i ) const;
+    Sphere<float,3>             getSphere( int i ) const;
+    Sphere<float,3>             getTotalSphere( int i ) const;
+
+    SceneFlat( const SceneFlat& ) = delete;
+    SceneFlat&                  operator = ( const SceneFlat& ) = delete;
+
+  private:
+    struct Spheres {
+      std::vector<float>        x, y, z, r;
+
+      void                      resize( size_t n );
+      Sphere<float,3>           get( int i ) const;
+    };
+
+    Scene*                      _scene;
+    std::vector<SceneObject*>   _objs;
+    std::vector<int>            _parent;    //!< Index of the parent, -1 for the top level objects
+    std::vector<int>            _end;       //!< One past the last index of the subtree
+    std::vector<float>          _local;     //!< Packed local matrices
+    std::vector<float>          _global;    //!< Packed matrices to the scene
+    Spheres                     _local_s;   //!< Surrounding spheres in local coordinates, scaled
+    Spheres                     _global_s;  //!< Global spheres of the objects
+    Spheres                     _total_s;   //!< Global spheres including the children
+    std::vector<unsigned char>  _dirty;     //!< 1: recompute, 2: refit the total sphere
+    std::atomic<bool>           _any_dirty; //!< Set by update(), also from the threads of a parallel simulate
+    bool                        _built;
+
+    void                        insert( SceneObject* obj, int parent );
+
+  }; // END class SceneFlat
+
+
+
+  /*! bool SceneFlat::isBuilt() const
+   *  \brief False after clear(), until the next build()
+   */
+  inline
+  bool SceneFlat::isBuilt() const {
+
+    return _built;
+  }
+
+
+  inline
+  int SceneFlat::getSize() const {
+
+    return int(_objs.size());
+  }
+
+
+  inline
+  SceneObject* SceneFlat::getObject( int i ) const {
+
+    return _objs[size_t(i)];
+  }
+
+
+  inline
+  int SceneFlat::getParent( int i ) const {
+
+    return _parent[size_t(i)];
+  }
+
+
+  /*! int SceneFlat::getSubtreeEnd( int i ) const
+   *  \brief One past the last entry below entry i, the subtree is [i, getSubtreeEnd(i))
+   */
+  inline
+  int SceneFlat::getSubtreeEnd( int i ) const {
+
+    return _end[size_t(i)];
+  }
+
+
+  inline
+  Sphere<float,3> SceneFlat::getSphere( int i ) const {
+
+    return _global_s.get(i);
+  }
+
+
+  inline
+  Sphere<float,3> SceneFlat::getTotalSphere( int i ) const {
+
+    return _total_s.get(i);
+  }
+
+
+} // END namespace GMlib
+
+
+#endif // GM_SCENE_SCENEFLAT_H
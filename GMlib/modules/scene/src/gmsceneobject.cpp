@@ -39,6 +39,7 @@
 
 
 // stl
+#include <cassert>
 #include <string>
 
 
@@ -48,6 +49,55 @@ namespace GMlib {
   unsigned int SceneObject::_free_name = 1;
 
 
+  namespace {
+
+    // Copies made on this thread leave out the children not part of the shape
+    thread_local bool tl_copy_shape_only = false;
+
+  } // END anonymous namespace
+
+
+  /*! bool SceneObject::_setCopyShapeOnly( bool shape_only )
+   *  \brief Copies made on this thread take only the shape
+   *
+   *  While set, the copy constructor leaves out the children of the basic
+   *  types (plain scene objects, cameras, lights and selectors), and keeps the
+   *  points, curves, surfaces etc. an object can be made of. For copies that are
+   *  only evaluated, see PSurf::replotAsync().
+   *
+   *  \return The previous setting, to be set back
+   */
+  bool SceneObject::_setCopyShapeOnly( bool shape_only ) {
+
+    const bool previous = tl_copy_shape_only;
+    tl_copy_shape_only = shape_only;
+    return previous;
+  }
+
+
+  /*! void SceneObject::_copyRayQueryData( const SceneObject& original )
+   *  \brief Takes what a ray query needs from the object this is a copy of
+   *
+   *  The global matrices and spheres made by prepare(), and the same for the
+   *  children, paired by the objects they are copies of. Objects keeping more
+   *  for their ray queries (e.g. the triangle hierarchy of PSurf) reimplement
+   *  this and call it. See Scene::intersectRays().
+   */
+  void SceneObject::_copyRayQueryData( const SceneObject& original ) {
+
+    _matrix_scene         = original._matrix_scene;
+    _matrix_scene_inv     = original._matrix_scene_inv;
+    _present              = original._present;
+    _global_sphere        = original._global_sphere;
+    _global_total_sphere  = original._global_total_sphere;
+    _visible              = original._visible;
+
+    for( int i = 0; i < _children.getSize(); i++ )
+      if( _children[i]->_copy_of )
+        _children[i]->_copyRayQueryData( *_children[i]->_copy_of );
+  }
+
+
   /*! SceneObject( const Vector<float,3>& trans  = Vector<float,3>(0,0,0), const Point<float,3>&  scale   = Point<float,3>(1,1,1), const Vector<float,3>& rotate = Vector<float,3>(1,0,0), Angle a=0 )
    *  \brief default and standard constructor
    *
@@ -135,10 +185,17 @@ namespace GMlib {
     _sphere           = copy._sphere;
     _scale            = copy._scale;
 
-    set( copy._pos, copy._dir, copy._up );
-
     _scene            = 0x0;
     _parent           = 0x0;
+    _dirty            = true;
+    _dirty_child      = false;
+    _dirty_listed     = false;
+    _flat_index       = -1;
+    _thread_safe      = copy._thread_safe;
+    _sim_deps         = copy._sim_deps;
+
+    set( copy._pos, copy._dir, copy._up );
+
     _name             = _free_name++;
     _local_cs         = copy._local_cs;
     _type_id          = copy._type_id;
@@ -147,6 +204,8 @@ namespace GMlib {
     _selected         = false;
     _is_editable      = copy._is_editable;
     _edit_done        = false;
+    _lod_level        = copy._lod_level;
+    _bvh_leaf         = -1;
 
     _lighted          = copy._lighted;
     _opaque           = copy._opaque;
@@ -156,6 +215,7 @@ namespace GMlib {
 
     // update children
     for( int i = 0; i < copy._children.getSize(); i++ ) {
+      if( tl_copy_shape_only && copy._children(i)->_type_id < GM_SO_TYPE_POINT ) continue;
       SceneObject *child_copy = copy._children(i)->makeCopy();
       if( child_copy )
         _children += child_copy;
@@ -169,12 +229,26 @@ namespace GMlib {
    *  Default Destructor
    */
   SceneObject::~SceneObject() {
-    for(int i=0; i < _children.getSize(); i++) {
-      if( _children[i] ) {
 
-        _children[i]->setParent(0);
-        remove( _children[i] );
-        delete _children[i];
+    // Deleted while in a scene
+    if( _flat_index >= 0 )
+      _scene->invalidateFlat();
+    if( _bvh_leaf >= 0 && _scene )
+      _scene->removeFromBvh(this);
+    if( _dirty_listed )
+      _scene->removeDirty(this);
+    if( Scene* scene = findTopScene() )
+      scene->removeNames(this);
+    if( !_parent && _scene )
+      _scene->remove(this);
+    _scene = 0x0;
+
+    // From the back, as remove() takes each child out of the array
+    for(int i = _children.getSize()-1; i >= 0; i--) {
+      if( SceneObject* child = _children[i] ) {
+
+        remove( child );
+        delete child;
       }
     }
 
@@ -189,6 +263,14 @@ namespace GMlib {
 
 
 
+  /*! int SceneObject::prepare(Array<HqMatrix<float,3> >& mat, Scene* s, SceneObject* parent)
+   *  \brief Updates the scene matrices and global spheres of this subtree
+   *
+   *  Only dirty objects are recomputed, and a dirty object makes its whole
+   *  subtree dirty. Children that are neither dirty nor have dirty children
+   *  are skipped, only their total spheres are used to refit this one.
+   *  Returns the number of objects visited.
+   */
   int SceneObject::prepare(Array<HqMatrix<float,3> >& mat, Scene* s, SceneObject* parent) {
 
     int nr = 1;
@@ -197,25 +279,71 @@ namespace GMlib {
     _parent = parent;
 
     mat.push();
-      _matrix_scene_inv = _matrix_scene = mat.back();
-      _matrix_scene_inv.invertOrthoNormal();
+      if(_dirty) {
+        _matrix_scene_inv = _matrix_scene = mat.back();
+        _matrix_scene_inv.invertOrthoNormal();
+
+        _present = mat.back() * getMatrix();
+        _global_sphere = _present * _sphere;
 
-      _present = mat.back() = mat.back() * getMatrix();
-      _global_total_sphere = _global_sphere = _present * _sphere;
+        if(_scale.isActive())
+          _global_sphere *= _scale.getMax();
+        s->updateBvh(this);
 
-      if(_scale.isActive()) {
-        _global_sphere *= _scale.getMax();
-        _global_total_sphere *= _scale.getMax();
+        for( int i = 0; i < _children.getSize(); i++ )
+          _children[i]->_dirty = true;
       }
+      mat.back() = _present;
 
+      _global_total_sphere = _global_sphere;
       for( int i = 0; i < _children.getSize(); i++ ) {
-        nr += _children[i]->prepare(mat,s,this);
+        if( _children[i]->_dirty || _children[i]->_dirty_child )
+          nr += _children[i]->prepare(mat,s,this);
         _global_total_sphere += _children[i]->getSurroundingSphere();
       }
     mat.pop();
+
+    _dirty = _dirty_child = false;
     return nr;
   }
 
+
+  /*! void SceneObject::markDirty( bool self ) const
+   *  \brief Marks this object (self) or a child of it dirty
+   *
+   *  The parents are marked as having a dirty child, up to the top level
+   *  object which is put in the dirty list of the scene. Stops at the first
+   *  object already marked, its parents are marked already. A change of the
+   *  object itself is also copied into the flat view of the scene, if any.
+   */
+  void SceneObject::markDirty( bool self ) const {
+
+    if( self && _flat_index >= 0 )
+      _scene->updateFlat(this);
+
+    const bool marked = _dirty || _dirty_child;
+    if(self) _dirty       = true;
+    else     _dirty_child = true;
+
+    if(marked) return;
+
+    if(_parent)
+      _parent->markDirty(false);
+    else if(_scene)
+      _scene->insertDirty(const_cast<SceneObject*>(this));
+  }
+
+
+  /*! Scene* SceneObject::findTopScene() const
+   *  \brief The scene of the top level object, if it is in one
+   */
+  Scene* SceneObject::findTopScene() const {
+
+    const SceneObject* top = this;
+    while(top->_parent) top = top->_parent;
+    return top->_scene;
+  }
+
   void
   SceneObject::getRenderList( Array<const SceneObject*>& objs ) const {
 
@@ -352,6 +480,12 @@ namespace GMlib {
     {
       _children.insert(obj);
       obj->_parent=this;
+      obj->_dirty=true;
+      markDirty(false);
+      if( Scene* scene = findTopScene() )
+        scene->insertNames(obj);
+      if(_flat_index >= 0)
+        _scene->invalidateFlat();
     }
   }
 
@@ -377,10 +511,24 @@ namespace GMlib {
    */
   void SceneObject::remove(SceneObject* obj) {
 
-    if(obj)
-      if(!_children.remove(obj))
+    if(obj) {
+      if(_children.remove(obj)) {
+        if(obj->_scene)
+          obj->_scene->removeFromBvh(obj);
+        if( Scene* scene = findTopScene() )
+          scene->removeNames(obj);
+        markDirty(false);
+        if(_flat_index >= 0)
+          _scene->invalidateFlat();
+
+        // Not linked to this or the scene any more, it may outlive both
+        obj->setParent(0);
+        obj->_scene = 0x0;
+      }
+      else
         for(int i=0; i< _children.getSize(); i++)
           _children[i]->remove(obj);
+    }
   }
 
 
@@ -392,6 +540,7 @@ namespace GMlib {
   void SceneObject::reset() {
 
     _matrix.reset();
+    markDirty(true);
   }
 
   void SceneObject::move( float d, bool propagate ) {
@@ -685,6 +834,7 @@ namespace GMlib {
   void SceneObject::scale(const Point<float,3>& scale_factor, bool propagate) {
 
       _scale.scale(scale_factor);
+      markDirty(true);
 
       if(propagate) {
           for(int i=0; i<_children.getSize(); i++)
@@ -731,6 +881,7 @@ namespace GMlib {
   void SceneObject::setSurroundingSphere(const Sphere<float,3>& b) const {
 
     _sphere = b;
+    markDirty(true);
   }
 
 
@@ -743,11 +894,102 @@ namespace GMlib {
    */
   void SceneObject::replot() const{
 
+    assert( isOnRenderingThread() );
     for(int i=0; i< _visualizers.size(); i++)
       _visualizers[i]->update();
   }
 
 
+  /*! bool SceneObject::isOnRenderingThread() const
+   *  \brief True if called on the rendering thread of the scene of the object
+   *
+   *  See Scene::isRenderingThread(), true on any thread while the object
+   *  is in no scene. The replots, which make OpenGL calls, assert it in debug builds.
+   */
+  bool SceneObject::isOnRenderingThread() const {
+
+    return !_scene || _scene->isRenderingThread();
+  }
+
+
+  /*! bool SceneObject::syncReplot()
+   *  \brief Takes in a replot made in the background, true if there was one
+   *
+   *  Called on the rendering thread, see Scene::syncReplots(). The default has
+   *  no background replot.
+   */
+  bool SceneObject::syncReplot() {
+
+    return false;
+  }
+
+
+
+
+  /*! int SceneObject::getLodLevels() const
+   *  \brief The number of levels of detail
+   *
+   *  Objects with level of detail (see LodController) reimplement this,
+   *  together with getLodSamples() and setLodLevel().
+   *
+   *  \return The number of levels, 0 (default) if the object has no level of detail
+   */
+  int SceneObject::getLodLevels() const {
+
+    return 0;
+  }
+
+
+
+
+  /*! int SceneObject::getLodSamples( int level ) const
+   *  \brief The number of samples (in the densest direction) at a level of detail
+   *
+   *  \param[in] level  The level of detail, 0 is the finest
+   *  \return The number of samples, 0 (default) if the object has no level of detail
+   */
+  int SceneObject::getLodSamples( int /*level*/ ) const {
+
+    return 0;
+  }
+
+
+
+
+  /*! void SceneObject::setLodLevel( int level )
+   *  \brief Set the level of detail
+   *
+   *  The default only stores the level, an object with level of detail
+   *  reimplements this to replot at the new level.
+   *
+   *  \param[in] level  The level of detail, 0 is the finest
+   */
+  void SceneObject::setLodLevel( int level ) {
+
+    _lod_level = level;
+  }
+
+
+
+
+  /*! bool SceneObject::intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit ) const
+   *  \brief The nearest hit of the ray o + t*d, t >= 0, with the object (children not included)
+   *
+   *  Objects with a shape to hit (e.g. surfaces, see PSurf::intersectRay())
+   *  reimplement this. The ray and the hit are in global coordinates,
+   *  hit.obj is left for the caller to set.
+   *
+   *  \param[in]  o    The ray origin
+   *  \param[in]  d    The ray direction
+   *  \param[out] hit  The hit, if any
+   *  \return true if the object is hit, false (default) if not
+   */
+  bool SceneObject::intersectRay( const Point<float,3>& /*o*/, const Vector<float,3>& /*d*/, RayHit& /*hit*/ ) const {
+
+    return false;
+  }
+
+
 
 
   /*! void SceneObject::simulate( double dt )
@@ -795,6 +1037,7 @@ namespace GMlib {
   void SceneObject::updateSurroundingSphere(const Point<float,3>& p) {
 
     _sphere += p;
+    markDirty(true);
   }
 
   void SceneObject::lock(SceneObject* obj) {
@@ -197,6 +197,7 @@ namespace GMlib{
 
     Scene*                              getScene();
     const Scene*                        getScene() const;
+    bool                                isOnRenderingThread() const;
 
     int                                 getTypeId() const;
     unsigned int                        getName() const;
@@ -267,6 +268,7 @@ namespace GMlib{
     // surrounding sphere
     const Sphere<float,3>&              getSurroundingSphere() const;
     const Sphere<float,3>&              getSurroundingSphereClean() const;
+    const Sphere<float,3>&              getSurroundingSphereSelf() const;
 
     // editing/interaction
     virtual void                        edit(int selector_id);
@@ -281,6 +283,18 @@ namespace GMlib{
     bool                                getEditDone() const { return _edit_done; }
     void                                getEditedObjects(Array<const SceneObject*>& e_obj) const;
 
+    // incremental prepare
+    bool                                isDirty() const;
+    void                                setDirty() const;
+
+    // parallel simulation, see Scene::enableParallelSimulate()
+    bool                                isThreadSafe() const;
+    void                                setThreadSafe( bool thread_safe );
+    const Array<SceneObject*>&          getSimulateDependencies() const;
+    void                                insertSimulateDependency( SceneObject* obj );
+    void                                removeSimulateDependency( SceneObject* obj );
+    SceneObject*                        getLockObject() const;
+
     // properties
     bool                                isSelected() const;
     bool                                toggleSelected();
@@ -343,6 +357,16 @@ namespace GMlib{
     virtual void                        insertVisualizer( Visualizer* visualizer );
     virtual void                        removeVisualizer( Visualizer* visualizer );
     virtual void                        replot() const;
+    virtual bool                        syncReplot();
+
+    // level of detail, see LodController
+    virtual int                         getLodLevels() const;
+    virtual int                         getLodSamples( int level ) const;
+    int                                 getLodLevel() const;
+    virtual void                        setLodLevel( int level );
+
+    // ray queries, see Scene::intersectRay()
+    virtual bool                        intersectRay( const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit ) const;
 
     virtual void                        simulate( double dt );
 
@@ -405,6 +429,14 @@ namespace GMlib{
     bool                                _visible;               //!< culling on invisible items
     mutable bool                        _edit_done;             //!< message that the object need to be replotted
     mutable bool                        _is_editable;           //!< This object is not editable
+    mutable int                         _lod_level;             //!< Current level of detail, 0 is the finest
+    int                                 _bvh_leaf;              //!< Leaf in the BVH of the scene, -1 if none
+    mutable bool                        _dirty;                 //!< Matrix, scale or surrounding sphere changed since the last prepare
+    mutable bool                        _dirty_child;           //!< Some child below is dirty, or the children have changed
+    bool                                _dirty_listed;          //!< In the dirty list of the scene (top level objects only)
+    int                                 _flat_index;            //!< Entry in the flat view of the scene, -1 if none
+    bool                                _thread_safe;           //!< localSimulate() may run on a worker thread
+    Array<SceneObject*>                 _sim_deps;              //!< Objects simulated before this one
 
     ArrayT<SceneObjectAttribute*>       _scene_object_attributes;
 
@@ -419,6 +451,8 @@ namespace GMlib{
 
   protected:
     static unsigned int                 _free_name;             //!< For automatisk name-generations.
+    static bool                         _setCopyShapeOnly( bool shape_only );
+    virtual void                        _copyRayQueryData( const SceneObject& original );
     unsigned int                        _name;                  //!< Unic name for this object, used for selecting
     mutable Sphere<float,3>             _sphere;                //!< Surrounding sphere for this object
 
@@ -430,8 +464,12 @@ namespace GMlib{
 
 
 
-  friend void Scene::prepare();
+  friend class Scene;
+  friend class SceneBvh;
+  friend class SceneFlat;
   int                                   prepare(Array<HqMatrix<float,3> >& mat, Scene* s, SceneObject* mother = 0);
+  void                                  markDirty( bool self ) const;
+  Scene*                                findTopScene() const;
 
   private:
   void                                  _init( const Point<float,3>&  pos, const Vector<float,3>& dir, const Vector<float,3>& up);
@@ -446,6 +484,14 @@ namespace GMlib{
     template <typename T_Stream>
     SceneObject( T_Stream& in, int /*st*/ ) {
 
+      _scene            = 0x0;
+      _parent           = 0x0;
+      _dirty            = true;
+      _dirty_child      = false;
+      _dirty_listed     = false;
+      _flat_index       = -1;
+      _thread_safe      = false;
+
       in >> *this;
 
       _name       = _free_name++;
@@ -460,6 +506,9 @@ namespace GMlib{
       _material         = GMmaterial::polishedCopper();
       _color            = GMcolor::red();
       _collapsed        = false;
+      _lod_level        = 0;
+      _bvh_leaf         = -1;
+      _scene            = 0x0;
       //init end
 
       _side	= _up^_dir;
@@ -552,6 +601,8 @@ namespace GMlib{
 
 
   inline bool SceneObject::isCollapsed() const  { return _collapsed; }
+
+  inline int SceneObject::getLodLevel() const { return _lod_level; }
   inline void SceneObject::setCollapsed(bool c) { _collapsed = c; }
   inline bool SceneObject::toggleCollapsed()    { return _collapsed = !_collapsed; }
 
@@ -610,7 +661,7 @@ namespace GMlib{
   inline
   void SceneObject::basisChange( const Vector<float,3>& x, const Vector<float,3>& y, const Vector<float,3>& z, const Vector<float,3>& p ) {
 
-    static Vector<float,4> nx, ny, nz, np;
+    Vector<float,4> nx, ny, nz, np;
     memcpy( nx.getPtr(), z.getPtr(), 12 );
     memcpy( ny.getPtr(), x.getPtr(), 12 );
     memcpy( nz.getPtr(), y.getPtr(), 12 );
@@ -622,6 +673,8 @@ namespace GMlib{
     _matrix.setCol( ny, 1 );
     _matrix.setCol( nz, 2 );
     _matrix.setCol( np, 3 );
+
+    markDirty(true);
   }
 
 
@@ -805,6 +858,16 @@ namespace GMlib{
   }
 
 
+  /*! Sphere<float,3>  SceneObject::getSurroundingSphereSelf() const
+   *  \brief The global surrounding sphere of this object, without the children
+   */
+  inline
+  const Sphere<float,3>& SceneObject::getSurroundingSphereSelf() const  {
+
+    return  _global_sphere;
+  }
+
+
   /*! int SceneObject::getTypeId()
    *  \brief Pending Documentation
    *
@@ -837,6 +900,100 @@ namespace GMlib{
   }
 
 
+  /*! bool SceneObject::isDirty() const
+   *  \brief True if the object must be recomputed by the next Scene::prepare()
+   *
+   *  The object is dirty when its matrix, scale or surrounding sphere has
+   *  been changed since the last prepare, or when one of its parents has.
+   */
+  inline
+  bool SceneObject::isDirty() const {
+
+    return _dirty;
+  }
+
+
+  /*! void SceneObject::setDirty() const
+   *  \brief Marks the object to be recomputed by the next Scene::prepare()
+   *
+   *  Done by basisChange(), scale() and the surrounding sphere setters.
+   *  Needed only when the matrix is changed through the non-const getMatrix().
+   */
+  inline
+  void SceneObject::setDirty() const {
+
+    markDirty(true);
+  }
+
+
+  /*! bool SceneObject::isThreadSafe() const
+   *  \brief True if the object may be simulated on a worker thread
+   */
+  inline
+  bool SceneObject::isThreadSafe() const {
+
+    return _thread_safe;
+  }
+
+
+  /*! void SceneObject::setThreadSafe( bool thread_safe )
+   *  \brief Marks that localSimulate() may run on a worker thread
+   *
+   *  With a parallel simulating scene (Scene::enableParallelSimulate()) a top
+   *  level object is simulated on a worker thread when it and all its children
+   *  are thread safe. Their localSimulate() must then only change the objects
+   *  of that subtree, and make no OpenGL calls. The replot is left to the main
+   *  thread by setEditDone(), see Scene::replotEdited().
+   */
+  inline
+  void SceneObject::setThreadSafe( bool thread_safe ) {
+
+    _thread_safe = thread_safe;
+  }
+
+
+  /*! const Array<SceneObject*>& SceneObject::getSimulateDependencies() const
+   *  \brief The objects that are simulated before this one
+   */
+  inline
+  const Array<SceneObject*>& SceneObject::getSimulateDependencies() const {
+
+    return _sim_deps;
+  }
+
+
+  /*! void SceneObject::insertSimulateDependency( SceneObject* obj )
+   *  \brief Makes obj simulated before this object in a parallel simulate
+   *
+   *  Needed when localSimulate() reads another object of the scene. An object
+   *  locked to another one depends on it without this. The dependency must be
+   *  removed before obj is deleted.
+   */
+  inline
+  void SceneObject::insertSimulateDependency( SceneObject* obj ) {
+
+    if( obj && obj != this )
+      _sim_deps.insert( obj );
+  }
+
+
+  inline
+  void SceneObject::removeSimulateDependency( SceneObject* obj ) {
+
+    _sim_deps.remove( obj );
+  }
+
+
+  /*! SceneObject* SceneObject::getLockObject() const
+   *  \brief The object this object is locked to, 0 if none
+   */
+  inline
+  SceneObject* SceneObject::getLockObject() const {
+
+    return _locked ? _lock_object : 0x0;
+  }
+
+
   /*! bool SceneObject::isVisible() const
    *  \brief Pending Documentation
    *
@@ -973,7 +1130,6 @@ namespace GMlib{
   inline
   void SceneObject::_init( const Point<float,3>&  pos, const Vector<float,3>& dir, const Vector<float,3>& up) {
 
-    set( pos, dir, up );
     _scene            = 0x0;
     _parent           = 0x0;
     _derived          = 0x0;
@@ -985,12 +1141,21 @@ namespace GMlib{
     _selected         = false;
     _is_editable      = false;
     _edit_done        = false;
+    _lod_level        = 0;
+    _bvh_leaf         = -1;
+    _dirty            = true;
+    _dirty_child      = false;
+    _dirty_listed     = false;
+    _flat_index       = -1;
+    _thread_safe      = false;
 
     _lighted          = true;
     _opaque           = true;
     _material         = GMmaterial::polishedCopper();
     _color            = GMcolor::red();
     _collapsed        = false;
+
+    set( pos, dir, up );
   }
 
 
@@ -48,6 +48,7 @@ namespace GMlib {
 
   DefaultRenderer::DefaultRenderer() : _select_color(GMcolor::beige()) {
 
+    _lod = 0x0;
 
     // Acquire programs
     initRenderProgram();
@@ -435,6 +436,24 @@ namespace GMlib {
     // Get displayable objects
     _objs.resetSize();
     scene->getRenderList( _objs, cam );
+
+    // Level of detail for the objects to render
+    if( _lod ) _lod->update( _objs, *cam );
+  }
+
+
+  LodController* DefaultRenderer::getLodController() const {
+
+    return _lod;
+  }
+
+  /*! void DefaultRenderer::setLodController( LodController* lod )
+   *  Set the level of detail controller used in the prepare pass,
+   *  0 (default) turns level of detail off. The controller is not owned by the renderer.
+   */
+  void DefaultRenderer::setLodController( LodController* lod ) {
+
+    _lod = lod;
   }
 
 
@@ -36,6 +36,7 @@
 //#include "../window/gmviewset.h"
 //#include "../window/gmwindow.h"
 #include "gmrendertarget.h"
+#include "gmlodcontroller.h"
 
 // gmlib
 #include <opengl/gmframebufferobject.h>
@@ -81,6 +82,9 @@ namespace GMlib {
     const GL::UniformBufferObject&    getPointLightUBO() const;
     const GL::UniformBufferObject&    getSpotLightUBO() const;
 
+    LodController*          getLodController() const;
+    void                    setLodController( LodController* lod );
+
     /* virtual from Renderer */
     void                    prepare() override {}
     void                    render()override ;
@@ -91,6 +95,7 @@ namespace GMlib {
     virtual void            prepare(Camera *cam);
 
     mutable Array<const SceneObject*>    _objs;
+    LodController                       *_lod;
 
 
   private:
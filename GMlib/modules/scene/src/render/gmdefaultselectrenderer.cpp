@@ -34,6 +34,7 @@
 
 // stl
 #include <cassert>
+#include <unordered_set>
 
 namespace GMlib {
 
@@ -100,12 +101,16 @@ namespace GMlib {
     GL_CHECK(::glReadPixels(xmin,ymin,dx-1,dy-1,GL_RGBA,GL_UNSIGNED_BYTE,reinterpret_cast<GLubyte*>(pixels)));
     _fbo.unbind();
 
+    // Each name is looked up once
+    std::unordered_set<unsigned int> seen;
+    const Scene* scene = getCamera()->getScene();
     int ct = 0;
-    Color c;
     for(int i = ymin; i < ymax; ++i) {
       for(int j = xmin; j < xmax; ++j) {
-        c = pixels[ct++];
-        const SceneObject *tmp = getCamera()->getScene()->find(c.get());
+        const unsigned int name = pixels[ct++].get();
+        if(!seen.insert(name).second)
+          continue;
+        const SceneObject *tmp = scene->find(name);
         if(tmp && !tmp->isSelected())
           sel.insertAlways(tmp);
       }
@@ -127,13 +132,16 @@ namespace GMlib {
     GL_CHECK(::glReadPixels(xmin,ymin,dx-1,dy-1,GL_RGBA,GL_UNSIGNED_BYTE,reinterpret_cast<GLubyte*>(pixels)));
     _fbo.unbind();
 
+    // Each name is looked up once
+    std::unordered_set<unsigned int> seen;
+    Scene* scene = getCamera()->getScene();
     int ct = 0;
-    Color c;
     for(int i = ymin; i < ymax; ++i) {
       for(int j = xmin; j < xmax; ++j) {
-        c = pixels[ct++];
-
-        SceneObject *tmp = getCamera()->getScene()->find(c.get());
+        const unsigned int name = pixels[ct++].get();
+        if(!seen.insert(name).second)
+          continue;
+        SceneObject *tmp = scene->find(name);
         if(tmp && !tmp->isSelected())
           sel.insertAlways(tmp);
       }
@@ -26,7 +26,7 @@
 
 
 
-#include "gmrenderer.h"
+#include "gmselectrenderer.h"
 
 
 // gmlib
@@ -38,18 +38,19 @@ namespace GMlib {
 
   class SceneObject;
 
-  class DefaultSelectRenderer : public Renderer {
+  class DefaultSelectRenderer : public SelectRenderer {
   public:
     explicit DefaultSelectRenderer();
     virtual ~DefaultSelectRenderer();
 
-    const SceneObject*            findObject(int x, int y) const;
-    SceneObject*                  findObject(int x, int y);
-    Array<const SceneObject*>     findObjects(int xmin, int ymin, int xmax, int ymax) const;
-    Array<SceneObject*>           findObjects(int xmin, int ymin, int xmax, int ymax);
+    /* Virtual from SelectRenderer */
+    const SceneObject*            findObject(int x, int y) const override;
+    SceneObject*                  findObject(int x, int y) override;
+    Array<const SceneObject*>     findObjects(int xmin, int ymin, int xmax, int ymax) const override;
+    Array<SceneObject*>           findObjects(int xmin, int ymin, int xmax, int ymax) override;
 
 
-    void                            select(int what);
+    void                            select(int what) override;
 
 
     void                            setSelectRboName( const std::string& name ) { _rbo_color.setName(name); }
@@ -0,0 +1,184 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#include "gmlodcontroller.h"
+
+// local
+#include "../camera/gmcamera.h"
+#include "../gmsceneobject.h"
+
+// stl
+#include <algorithm>
+#include <cmath>
+
+
+
+namespace GMlib {
+
+
+
+  /*! LodController::LodController( float pixel_error, float hysteresis )
+   *  \brief Default constructor
+   *
+   *  \param[in] pixel_error  The largest chord error allowed on screen, in pixels
+   *  \param[in] hysteresis   The relative margin needed before going to a coarser level
+   */
+  LodController::LodController( float pixel_error, float hysteresis ) {
+
+    setPixelError( pixel_error );
+    setHysteresis( hysteresis );
+  }
+
+
+  float LodController::getPixelError() const {
+
+    return _pixel_error;
+  }
+
+
+  void LodController::setPixelError( float pixel_error ) {
+
+    _pixel_error = std::max( pixel_error, 0.01f );
+  }
+
+
+  float LodController::getHysteresis() const {
+
+    return _hysteresis;
+  }
+
+
+  void LodController::setHysteresis( float hysteresis ) {
+
+    _hysteresis = std::max( hysteresis, 0.0f );
+  }
+
+
+  /*! float LodController::computeProjectedRadius( const Sphere<float,3>& s, const Camera& cam ) const
+   *  \brief The radius of a sphere on the screen, in pixels
+   *
+   *  The radius is projected at the distance of the point of the sphere
+   *  nearest to the camera, but not closer than the near plane.
+   *
+   *  \param[in] s    A sphere in scene coordinates
+   *  \param[in] cam  The camera
+   *  \return The projected radius in pixels, 0 if the sphere is not valid
+   */
+  float LodController::computeProjectedRadius( const Sphere<float,3>& s, const Camera& cam ) const {
+
+    if( !s.isValid() ) return 0.0f;
+
+    const Point<float,3> eye  = cam.getMatrixToScene() * cam.getPos();
+    const float          dist = std::max( (s.getPos() - eye).getLength() - s.getRadius(), cam.getNearPlane() );
+
+    return s.getRadius() * 0.5f * cam.getViewportH() / ( dist * cam.getAngleTan() );
+  }
+
+
+  /*! int LodController::computeRequiredSamples( float radius ) const
+   *  \brief The number of samples needed around a circle
+   *
+   *  The chord error of a circle with radius r sampled by m uniform segments
+   *  is r(1 - cos(pi/m)) ~ r pi^2 / 2m^2, this gives m = pi sqrt(r / 2e)
+   *  for a pixel error e.
+   *
+   *  \param[in] radius  The projected radius, in pixels
+   *  \return The number of samples, at least 2
+   */
+  int LodController::computeRequiredSamples( float radius ) const {
+
+    if( radius <= 0.0f ) return 2;
+
+    const double m = M_PI * std::sqrt( radius / ( 2.0 * _pixel_error ) );
+    return std::max( int( std::ceil( m ) ) + 1, 2 );
+  }
+
+
+  /*! int LodController::computeLevel( const SceneObject& obj, const Camera& cam ) const
+   *  \brief The level of detail the object should have
+   *
+   *  The coarsest level having enough samples is chosen. Going coarser than
+   *  the current level needs a margin given by the hysteresis.
+   *
+   *  \param[in] obj  The scene object
+   *  \param[in] cam  The camera
+   *  \return The level, or the current level if the object has no level of detail
+   */
+  int LodController::computeLevel( const SceneObject& obj, const Camera& cam ) const {
+
+    const int levels  = obj.getLodLevels();
+    const int current = obj.getLodLevel();
+    if( levels < 1 ) return current;
+
+    const Sphere<float,3>& s = obj.getSurroundingSphere();
+    if( !s.isValid() ) return current;
+
+    const int m = computeRequiredSamples( computeProjectedRadius( s, cam ) );
+
+    int level = 0;
+    while( level + 1 < levels && obj.getLodSamples( level + 1 ) >= m )
+      level++;
+
+    // Hysteresis: only go coarser when the new level has a margin
+    if( current >= 0 && current < levels && level > current ) {
+      const float mh = ( 1.0f + _hysteresis ) * m;
+      while( level > current && obj.getLodSamples( level ) < mh )
+        level--;
+    }
+
+    return level;
+  }
+
+
+  /*! int LodController::update( const Array<const SceneObject*>& objs, const Camera& cam ) const
+   *  \brief Set the level of detail of a set of objects
+   *
+   *  Normally called with the render list in the prepare pass.
+   *
+   *  \param[in] objs  The objects, typically the render list
+   *  \param[in] cam   The camera
+   *  \return The number of objects changing level
+   */
+  int LodController::update( const Array<const SceneObject*>& objs, const Camera& cam ) const {
+
+    int changes = 0;
+
+    for( int i = 0; i < objs.getSize(); i++ ) {
+
+      const SceneObject* obj = objs(i);
+      if( obj->getLodLevels() < 1 ) continue;
+
+      const int level = computeLevel( *obj, cam );
+      if( level == obj->getLodLevel() ) continue;
+
+      // The render list only holds const pointers, the objects themselves belong to the scene
+      const_cast<SceneObject*>(obj)->setLodLevel( level );
+      changes++;
+    }
+
+    return changes;
+  }
+
+
+} // END namespace GMlib
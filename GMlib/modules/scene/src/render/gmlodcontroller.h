@@ -0,0 +1,85 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_SCENE_RENDER_LODCONTROLLER_H
+#define GM_SCENE_RENDER_LODCONTROLLER_H
+
+
+// gmlib
+#include <core/containers/gmarray.h>
+#include <core/types/gmpoint.h>
+
+
+namespace GMlib {
+
+  class Camera;
+  class SceneObject;
+
+
+
+  /*! \class LodController gmlodcontroller.h <gmLodController>
+   *  \brief Level of detail for the sampling of scene objects
+   *
+   *  Picks a level of detail (sample resolution) for each object from
+   *  its surrounding sphere projected by the camera and a pixel error
+   *  target. The object is seen as a circle of the projected radius,
+   *  sampled uniformly around the circumference; the chord error of
+   *  the sampling shall not exceed the pixel error.
+   *
+   *  An object takes part through the level of detail interface of
+   *  SceneObject: getLodLevels(), getLodSamples() and setLodLevel().
+   *  Level 0 is the finest one. The controller goes to a finer level
+   *  at once when the current one is too coarse, but to a coarser one
+   *  only when it has more than (1 + hysteresis) times the samples needed.
+   *
+   *  The decisions do not draw anything, computeLevel() only needs a camera
+   *  with a viewport, while update() is called by the DefaultRenderer
+   *  prepare pass with the render list.
+   */
+  class LodController {
+  public:
+    LodController( float pixel_error = 0.5f, float hysteresis = 0.25f );
+
+    float             getPixelError() const;
+    void              setPixelError( float pixel_error );
+    float             getHysteresis() const;
+    void              setHysteresis( float hysteresis );
+
+    float             computeProjectedRadius( const Sphere<float,3>& s, const Camera& cam ) const;
+    int               computeRequiredSamples( float radius ) const;
+    int               computeLevel( const SceneObject& obj, const Camera& cam ) const;
+
+    int               update( const Array<const SceneObject*>& objs, const Camera& cam ) const;
+
+  private:
+    float             _pixel_error;
+    float             _hysteresis;
+
+  }; // END class LodController
+
+
+} // END namespace GMlib
+
+
+#endif // GM_SCENE_RENDER_LODCONTROLLER_H
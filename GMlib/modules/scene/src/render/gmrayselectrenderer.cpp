@@ -0,0 +1,161 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#include "gmrayselectrenderer.h"
+
+#include "../gmscene.h"
+#include "../gmsceneobject.h"
+#include "../camera/gmcamera.h"
+
+
+namespace GMlib {
+
+  RaySelectRenderer::RaySelectRenderer() : _what(0), _size(0,0) {}
+
+  RaySelectRenderer::~RaySelectRenderer() {}
+
+
+  /*! bool RaySelectRenderer::findHit(int x, int y, RayHit& hit) const
+   *  \brief The nearest hit of the ray through the pixel (x,y)
+   *
+   *  \param[in]  x    Pixel column
+   *  \param[in]  y    Pixel row
+   *  \param[out] hit  The hit, hit.obj is nullptr if nothing is hit
+   *  \return true if an object is hit
+   */
+  bool RaySelectRenderer::findHit(int x, int y, RayHit& hit) const {
+
+    Point<float,3>  o;
+    Vector<float,3> d;
+    const Camera* cam = getCamera();
+    cam->getRay( float(x), float(y), o, d );
+    return cam->getScene()->getBvh().intersectRay( o, d, hit, _what );
+  }
+
+
+  const SceneObject* RaySelectRenderer::findObject(int x, int y) const {
+
+    RayHit hit;
+    findHit( x, y, hit );
+    return hit.obj;
+  }
+
+
+  SceneObject* RaySelectRenderer::findObject(int x, int y) {
+
+    RayHit hit;
+    findHit( x, y, hit );
+    return hit.obj;
+  }
+
+
+  Array<const SceneObject*>
+  RaySelectRenderer::findObjects(int xmin, int ymin, int xmax, int ymax) const {
+
+    Array<SceneObject*> objs;
+    findObjects( xmin, ymin, xmax, ymax, objs );
+
+    Array<const SceneObject*> sel;
+    for( int i = 0; i < objs.getSize(); ++i )
+      sel.insertAlways( objs(i) );
+    return sel;
+  }
+
+
+  Array<SceneObject*>
+  RaySelectRenderer::findObjects(int xmin, int ymin, int xmax, int ymax) {
+
+    Array<SceneObject*> sel;
+    findObjects( xmin, ymin, xmax, ymax, sel );
+    return sel;
+  }
+
+
+  void RaySelectRenderer::select(int what) {
+
+    _what = what;
+  }
+
+
+  // Nothing to prepare, the scene keeps the hierarchy updated
+  void RaySelectRenderer::prepare() {}
+
+
+  void RaySelectRenderer::reshape(const Vector<int,2> &size) {
+
+    _size = size;
+  }
+
+
+  // The objects not already selected with the surrounding sphere
+  // in the frustum through the pixel rectangle
+  void RaySelectRenderer::findObjects(int xmin, int ymin, int xmax, int ymax, Array<SceneObject*>& objs) const {
+
+    const Camera* cam = getCamera();
+
+    // The corner rays counterclockwise, through the outer pixel edges
+    const float x[4] = { xmin - 0.5f, xmax + 0.5f, xmax + 0.5f, xmin - 0.5f };
+    const float y[4] = { ymin - 0.5f, ymin - 0.5f, ymax + 0.5f, ymax + 0.5f };
+    Point<float,3>  o[4];
+    Vector<float,3> d[4];
+    for( int i = 0; i < 4; ++i ) cam->getRay( x[i], y[i], o[i], d[i] );
+
+    Point<float,3>  oc;
+    Vector<float,3> dc;
+    cam->getRay( 0.5f*(xmin + xmax), 0.5f*(ymin + ymax), oc, dc );
+    const Point<float,3> pc = oc + cam->getNearPlane()*dc;
+
+    std::vector<SceneBvh::Plane> planes;
+    for( int i = 0; i < 4; ++i ) {
+      const int j = (i+1) % 4;
+      SceneBvh::Plane pl;
+      pl.n = d[i] ^ ( o[j] + d[j] - o[i] );
+      const float len = pl.n.getLength();
+      if( len <= 0.0f ) continue;
+      pl.n /= len;
+      if( pl.n * (pc - o[i]) > 0.0f ) pl.n = -pl.n;
+      pl.d = pl.n * o[i];
+      planes.push_back( pl );
+    }
+
+    // Near and far planes
+    Vector<float,3> f = cam->getGlobalDir();
+    f.setLength( 1.0f );
+    SceneBvh::Plane pl;
+    pl.n = -f;
+    pl.d = -( f * oc + cam->getNearPlane() );
+    planes.push_back( pl );
+    pl.n = f;
+    pl.d = f * oc + cam->getFarPlane();
+    planes.push_back( pl );
+
+    Array<SceneObject*> found;
+    cam->getScene()->getBvh().intersectFrustum( planes, found, _what );
+    for( int i = 0; i < found.getSize(); ++i )
+      if( found(i) != cam && !found(i)->isSelected() )
+        objs.insertAlways( found(i) );
+  }
+
+
+} // END namespace GMlib
@@ -0,0 +1,88 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_SCENE_RENDER_RAYSELECTRENDERER_H
+#define GM_SCENE_RENDER_RAYSELECTRENDERER_H
+
+
+
+#include "gmselectrenderer.h"
+
+
+namespace GMlib {
+
+  class SceneObject;
+  struct RayHit;
+
+
+  /*! \class RaySelectRenderer gmrayselectrenderer.h <gmRaySelectRenderer>
+   *  \brief Selection without OpenGL, by casting rays from the camera
+   *
+   *  The queries go to the SceneBvh of the scene of the camera (Scene::getBvh()).
+   *  findObject() follows the ray through the pixel (Camera::getRay()) down the
+   *  hierarchy, and the objects are hit on their own geometry by
+   *  SceneObject::intersectRay(), so only objects implementing it can be picked
+   *  (surfaces and selectors). findObjects() makes a frustum through the corners
+   *  of the rectangle and returns the objects with surrounding spheres in it.
+   *
+   *  The scene must be prepared, as for the other renderers.
+   */
+  class RaySelectRenderer : public SelectRenderer {
+  public:
+    explicit RaySelectRenderer();
+    virtual ~RaySelectRenderer();
+
+    bool                            findHit(int x, int y, RayHit& hit) const;
+
+    /* Virtual from SelectRenderer */
+    const SceneObject*              findObject(int x, int y) const override;
+    SceneObject*                    findObject(int x, int y) override;
+    Array<const SceneObject*>       findObjects(int xmin, int ymin, int xmax, int ymax) const override;
+    Array<SceneObject*>             findObjects(int xmin, int ymin, int xmax, int ymax) override;
+
+    void                            select(int what) override;
+
+    /* Virtual from Renderer */
+    void                            prepare() override;
+    void                            reshape(const Vector<int,2> &size) override;
+
+  protected:
+    /* Virtual from Renderer */
+    void                            render() override {}
+    void                            swap() override {}
+
+  private:
+    int                             _what;
+    Vector<int,2>                   _size;
+
+    void                            findObjects(int xmin, int ymin, int xmax, int ymax, Array<SceneObject*>& objs) const;
+
+  }; // END class RaySelectRenderer
+
+
+
+} // END namespace GMlib
+
+
+#endif // GM_SCENE_RENDER_RAYSELECTRENDERER_H
@@ -0,0 +1,64 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_SCENE_RENDER_SELECTRENDERER_H
+#define GM_SCENE_RENDER_SELECTRENDERER_H
+
+
+
+#include "gmrenderer.h"
+
+
+namespace GMlib {
+
+  class SceneObject;
+
+
+  /*! \class SelectRenderer gmselectrenderer.h <gmSelectRenderer>
+   *  \brief Interface of the renderers finding the objects at pixels of the camera view
+   *
+   *  The use is: setCamera(), reshape(), prepare(), select() and then one or more
+   *  calls of findObject() or findObjects(). The pixel coordinates are relative to
+   *  the viewport, with origo in the lower left corner.
+   *
+   *  DefaultSelectRenderer renders the object names into a color buffer and reads
+   *  the pixels back, RaySelectRenderer casts rays on the CPU.
+   */
+  class SelectRenderer : public Renderer {
+  public:
+    virtual const SceneObject*          findObject(int x, int y) const = 0;
+    virtual SceneObject*                findObject(int x, int y) = 0;
+    virtual Array<const SceneObject*>   findObjects(int xmin, int ymin, int xmax, int ymax) const = 0;
+    virtual Array<SceneObject*>         findObjects(int xmin, int ymin, int xmax, int ymax) = 0;
+
+    /*! \brief Type id filter: 0 is all objects, a positive id is only that type, a negative id all but that type */
+    virtual void                        select(int what) = 0;
+
+  }; // END class SelectRenderer
+
+
+} // END namespace GMlib
+
+
+#endif // GM_SCENE_RENDER_SELECTRENDERER_H
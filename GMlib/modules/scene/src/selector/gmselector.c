@@ -28,6 +28,9 @@
 #include "../sceneobjects/gmsphere3d.h"
 #include "../visualizers/gmselectorvisualizer.h"
 
+// stl
+#include <cmath>
+
 namespace GMlib {
 
 
@@ -341,6 +344,38 @@ namespace GMlib {
   }
 
 
+  /*! bool Selector<T,n>::intersectRay(const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit) const
+   *  \brief Hits the ball of the selector
+   *
+   *  The ray o + t*d, t >= 0, is intersected with the global surrounding sphere,
+   *  which is the ball drawn by the selector visualizer.
+   */
+  template <typename T, int n>
+  bool Selector<T,n>::intersectRay(const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit) const {
+
+    if( !_enabled || !_global_sphere.isValid() ) return false;
+
+    const Vector<float,3> oc = o - _global_sphere.getPos();
+    const float a = d*d;
+    const float b = oc*d;
+    const float c = oc*oc - _global_sphere.getRadius()*_global_sphere.getRadius();
+    const float disc = b*b - a*c;
+    if( a <= 0.0f || disc < 0.0f ) return false;
+
+    // The entry point, or the exit point if the ray starts inside
+    const float sq = std::sqrt(disc);
+    float t = (-b - sq)/a;
+    if( t < 0.0f ) t = (-b + sq)/a;
+    if( t < 0.0f ) return false;
+
+    hit.t      = t;
+    hit.pos    = o + t*d;
+    hit.normal = (hit.pos - _global_sphere.getPos())/_global_sphere.getRadius();
+    hit.uv     = Point<float,2>(0.0f, 0.0f);
+    return true;
+  }
+
+
   /*! void Selector<T,n>::update()
    *  \brief Pending Documentation
    *
@@ -69,6 +69,7 @@ namespace GMlib{
     // from SceneObject
     void                  editPos(Vector<float,3> dp) override;
     void                  edit() override;
+    bool                  intersectRay(const Point<float,3>& o, const Vector<float,3>& d, RayHit& hit) const override;
     void                  scale(const Point<float,3>& scale_factor, bool propagate = true ) override;
 
 
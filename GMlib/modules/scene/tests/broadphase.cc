@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <gmCoreModule>
+#include <event/gmbroadphase.h>
+using namespace GMlib;
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  struct Ball {
+    Sphere<float,3> s;
+    Vector<float,3> ds;
+    int             id;
+    bool            in;
+  };
+
+
+  bool isSwept( const Ball& a, const Ball& b ) {
+    const Vector<float,3> d = ( a.s.getPos() + 0.5f * a.ds ) - ( b.s.getPos() + 0.5f * b.ds );
+    const float r = a.s.getRadius() + 0.5f * a.ds.getLength() + b.s.getRadius() + 0.5f * b.ds.getLength();
+    return d * d <= r * r;
+  }
+
+
+  std::vector<std::pair<int,int>> bruteForce( const std::vector<Ball>& balls ) {
+    std::vector<std::pair<int,int>> pairs;
+    for( size_t i = 0; i < balls.size(); i++ )
+      for( size_t j = i + 1; j < balls.size(); j++ )
+        if( balls[i].in && balls[j].in && isSwept( balls[i], balls[j] ) )
+          pairs.emplace_back( std::min( balls[i].id, balls[j].id ), std::max( balls[i].id, balls[j].id ) );
+    std::sort( pairs.begin(), pairs.end() );
+    return pairs;
+  }
+
+
+  std::vector<int> bruteForce( const std::vector<Ball>& balls, size_t i ) {
+    std::vector<int> ids;
+    for( size_t j = 0; j < balls.size(); j++ )
+      if( j != i && balls[j].in && isSwept( balls[i], balls[j] ) )
+        ids.push_back( balls[j].id );
+    std::sort( ids.begin(), ids.end() );
+    return ids;
+  }
+
+
+  // Random moving spheres, updated, removed and inserted over a few steps
+  void expectAllPairs( BroadPhase::Method method ) {
+
+    std::mt19937 rng( 7 );
+    std::uniform_real_distribution<float> pos( -50.0f, 50.0f ), vel( -2.0f, 2.0f ), rad( 0.2f, 2.0f );
+    auto random = [&]( Ball& b ) {
+      b.s  = Sphere<float,3>( Point<float,3>( pos(rng), pos(rng), pos(rng) ), rad(rng) );
+      b.ds = Vector<float,3>( vel(rng), vel(rng), vel(rng) );
+    };
+
+    BroadPhase bp( method );
+    std::vector<Ball> balls( 1500 );
+    for( Ball& b : balls ) {
+      random( b );
+      b.id = bp.insert( b.s, b.ds );
+      b.in = true;
+    }
+    EXPECT_EQ( bp.getSize(), 1500 );
+
+    for( int step = 0; step < 4; step++ ) {
+      const std::vector<std::pair<int,int>> pairs = bp.findPairs();
+      EXPECT_FALSE( pairs.empty() );
+      EXPECT_EQ( pairs, bruteForce( balls ) );
+
+      // Handling events changes a few spheres
+      std::vector<int> ids;
+      for( int k = 0; k < 100; k++ ) {
+        const size_t i = rng() % balls.size();
+        if( !balls[i].in ) continue;
+        balls[i].ds = Vector<float,3>( vel(rng), vel(rng), vel(rng) );
+        bp.update( balls[i].id, balls[i].s, balls[i].ds );
+        bp.findCandidates( balls[i].id, ids );
+        EXPECT_EQ( ids, bruteForce( balls, i ) );
+      }
+
+      // Next step, some spheres leave and new ones come
+      for( Ball& b : balls ) {
+        b.s  = Sphere<float,3>( b.s.getPos() + b.ds, b.s.getRadius() );
+        if( b.in ) bp.update( b.id, b.s, b.ds );
+      }
+      for( int k = 0; k < 20; k++ ) {
+        Ball& b = balls[rng() % balls.size()];
+        if( b.in ) { bp.remove( b.id ); b.in = false; }
+        else       { random( b ); b.id = bp.insert( b.s, b.ds ); b.in = true; }
+      }
+    }
+
+    bp.setMethod( method == BroadPhase::SweepAndPrune ? BroadPhase::UniformGrid : BroadPhase::SweepAndPrune );
+    EXPECT_EQ( bp.findPairs(), bruteForce( balls ) );
+
+    bp.clear();
+    EXPECT_EQ( bp.getSize(), 0 );
+    EXPECT_TRUE( bp.findPairs().empty() );
+  }
+
+
+  TEST(BroadPhase, Sweep_and_prune_matches_all_pairs) {
+
+    expectAllPairs( BroadPhase::SweepAndPrune );
+  }
+
+
+  TEST(BroadPhase, Uniform_grid_matches_all_pairs) {
+
+    expectAllPairs( BroadPhase::UniformGrid );
+  }
+
+
+  // A sphere much larger, or much faster, than the cells is kept out of the grid
+  TEST(BroadPhase, Uniform_grid_with_large_spheres) {
+
+    std::mt19937 rng( 11 );
+    std::uniform_real_distribution<float> pos( -50.0f, 50.0f ), rad( 0.2f, 1.0f );
+
+    BroadPhase bp( BroadPhase::UniformGrid );
+    bp.setCellSize( 1.0f );
+    std::vector<Ball> balls( 500 );
+    for( Ball& b : balls ) {
+      b.s  = Sphere<float,3>( Point<float,3>( pos(rng), pos(rng), pos(rng) ), rad(rng) );
+      b.ds = Vector<float,3>( 0.0f );
+    }
+    balls[0].s  = Sphere<float,3>( Point<float,3>( 0.0f, 0.0f, 0.0f ), 1.0e6f );
+    balls[1].s  = Sphere<float,3>( Point<float,3>( 10.0f, 0.0f, 0.0f ), 20.0f );
+    balls[2].ds = Vector<float,3>( 1.0e5f, 0.0f, 0.0f );
+    for( Ball& b : balls ) {
+      b.id = bp.insert( b.s, b.ds );
+      b.in = true;
+    }
+
+    EXPECT_EQ( bp.findPairs(), bruteForce( balls ) );
+
+    std::vector<int> ids;
+    for( size_t i : { size_t(0), size_t(2), size_t(3) } ) {
+      bp.findCandidates( balls[i].id, ids );
+      EXPECT_EQ( ids, bruteForce( balls, i ) );
+    }
+
+    // Grows out of the grid after the build
+    balls[3].ds = Vector<float,3>( 0.0f, 1.0e4f, 0.0f );
+    bp.update( balls[3].id, balls[3].s, balls[3].ds );
+    bp.findCandidates( balls[3].id, ids );
+    EXPECT_EQ( ids, bruteForce( balls, 3 ) );
+    EXPECT_EQ( bp.findPairs(), bruteForce( balls ) );
+  }
+
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <gmCoreModule>
+#include <event/gmeventcontroller.h>
+#include <event/gmeventmanager.h>
+using namespace GMlib;
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  using Log = std::vector<std::pair<double,int>>;
+
+
+  // Events at given x, handling an event may add a later one
+  class ListController : public EventController {
+  public:
+    ListController( int id, Log& log, std::vector<double> xs, double follow = 0.0 )
+      : _id(id), _log(log), _xs(std::move(xs)), _follow(follow) {}
+
+    std::vector<double> pending;
+    int                 finalized = 0;
+
+  private:
+    void    clear() override { pending.clear(); }
+    bool    detect( double ) override {
+      pending = _xs;
+      std::sort( pending.begin(), pending.end(), std::greater<double>() );
+      return !pending.empty();
+    }
+    void    handleFirst() override {
+      const double x = pending.back();
+      pending.pop_back();
+      _log.emplace_back( x, _id );
+      if( _follow > 0.0 && x + _follow <= 1.0 ) {
+        pending.push_back( x + _follow );
+        std::sort( pending.begin(), pending.end(), std::greater<double>() );
+      }
+    }
+    void    doFinalize() override { finalized++; }
+    double  getFirstX() const override { return pending.empty() ? 0.0 : pending.back(); }
+
+    int                 _id;
+    Log&                _log;
+    std::vector<double> _xs;
+    double              _follow;
+  };
+
+
+  TEST(EventManager, Events_are_handled_in_order_of_x) {
+
+    std::mt19937 rng( 11 );
+    std::uniform_real_distribution<double> x( 0.01, 1.0 );
+
+    Log log;
+    std::vector<ListController*> ctls;
+    EventManager mgr;
+    for( int i = 0; i < 50; i++ ) {
+      std::vector<double> xs( rng() % 6 );
+      for( double& v : xs ) v = x(rng);
+      xs.push_back( 0.5 );   // Equal x in all controllers
+      ctls.push_back( new ListController( i, log, xs, i % 3 == 0 ? 0.07 : 0.0 ) );
+      EXPECT_TRUE( mgr.registerController( ctls.back() ) );
+    }
+    EXPECT_FALSE( mgr.registerController( ctls[0] ) );
+
+    for( int step = 0; step < 2; step++ ) {
+      log.clear();
+      mgr.processEvents( 0.016 );
+
+      ASSERT_FALSE( log.empty() );
+      EXPECT_TRUE( std::is_sorted( log.begin(), log.end() ) );
+      for( ListController* ctl : ctls ) {
+        EXPECT_TRUE( ctl->pending.empty() );
+        EXPECT_EQ( ctl->finalized, step + 1 );
+      }
+    }
+
+    // The events added while handling are handled too, 0.5 is followed by 0.57, ..., 0.99
+    int added = 0;
+    for( const auto& e : log ) added += e.second == 0 && e.first > 0.5;
+    EXPECT_GE( added, 7 );
+
+    for( ListController* ctl : ctls ) delete ctl;
+  }
+
+
+  using PairLog = std::vector<std::tuple<double,int,int,int>>;
+
+
+  // Points on a line moving towards each other, an event where two meet
+  class MeetController : public EventController {
+  public:
+    MeetController( int id, PairLog& log, unsigned int seed ) : _id(id), _log(log) {
+      std::mt19937 rng( seed );
+      std::uniform_int_distribution<int> pos( 0, 40 ), vel( -4, 4 );
+      for( int i = 0; i < 300; i++ ) { _p.push_back( pos(rng) ); _v.push_back( vel(rng) ); }
+      setThreadSafe( _id % 4 != 0 );
+    }
+
+  private:
+    struct Meet { double x; int a, b; };
+
+    void    clear() override { _events.clear(); }
+    bool    detect( double ) override {
+
+      // Events of each chunk apart, merged in chunk order
+      std::vector<std::vector<Meet>> chunks( ( _p.size() + 31 ) / 32 );
+      detectInChunks( int(_p.size()), 32, [this,&chunks]( int k, int begin, int end ) {
+        for( int a = begin; a < end; a++ )
+          for( int b = a + 1; b < int(_p.size()); b++ )
+            if( _v[a] != _v[b] ) {
+              const double x = double( _p[b] - _p[a] ) / double( _v[a] - _v[b] ) / 8.0;
+              if( x > 0.0 && x <= 1.0 ) chunks[k].push_back( { x, a, b } );
+            }
+      } );
+      for( const auto& c : chunks ) _events.insert( _events.end(), c.begin(), c.end() );
+      std::stable_sort( _events.begin(), _events.end(), []( const Meet& m, const Meet& n ) { return m.x > n.x; } );
+      return !_events.empty();
+    }
+    void    handleFirst() override {
+      const Meet m = _events.back();
+      _events.pop_back();
+      _log.emplace_back( m.x, _id, m.a, m.b );
+    }
+    double  getFirstX() const override { return _events.empty() ? 0.0 : _events.back().x; }
+
+    int               _id;
+    PairLog&          _log;
+    std::vector<int>  _p, _v;
+    std::vector<Meet> _events;
+  };
+
+
+  TEST(EventManager, Parallel_detection_gives_the_serial_order) {
+
+    setNoThreads( 4 );
+
+    PairLog serial, parallel;
+    std::vector<MeetController*> ctls;
+    EventManager mgr_s, mgr_p;
+    for( int i = 0; i < 12; i++ ) {
+      ctls.push_back( new MeetController( i, serial, 100u + unsigned(i) ) );
+      mgr_s.registerController( ctls.back() );
+      ctls.push_back( new MeetController( i, parallel, 100u + unsigned(i) ) );
+      mgr_p.registerController( ctls.back() );
+    }
+    mgr_p.enableParallelDetect();
+    EXPECT_TRUE( mgr_p.isParallelDetect() );
+    EXPECT_FALSE( mgr_s.isParallelDetect() );
+
+    for( int step = 0; step < 3; step++ ) {
+      mgr_s.processEvents( 0.016 );
+      mgr_p.processEvents( 0.016 );
+    }
+
+    // Many events at equal x, in the order of the controllers and the pairs
+    ASSERT_GT( serial.size(), 1000u );
+    EXPECT_EQ( serial, parallel );
+
+    for( MeetController* ctl : ctls ) delete ctl;
+  }
+
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <gmCoreModule>
+#include <gmscene.h>
+#include <gmsceneobject.h>
+#include <camera/gmcamera.h>
+using namespace GMlib;
+
+#include "testball.h"
+#include "testcamera.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+  // The render list found by testing every object
+  std::vector<const SceneObject*> bruteForce( const std::vector<BallObject*>& objs, Camera& cam ) {
+    cam.computeFrustumBounds();
+    std::vector<const SceneObject*> list;
+    for( const BallObject* obj : objs )
+      if( obj->isVisible() && cam.isInsideFrustum( obj->getSurroundingSphereSelf() ) >= 0 )
+        list.push_back( obj );
+    std::sort( list.begin(), list.end() );
+    return list;
+  }
+
+
+  std::vector<const SceneObject*> renderList( const Scene& scene, const Camera& cam ) {
+    Array<const SceneObject*> objs;
+    scene.getRenderList( objs, &cam );
+    std::vector<const SceneObject*> list;
+    for( int i = 0; i < objs.getSize(); i++ ) list.push_back( objs(i) );
+    std::sort( list.begin(), list.end() );
+    return list;
+  }
+
+
+  std::vector<BallObject*> scatter( Scene& scene, int n, std::mt19937& rng ) {
+    std::uniform_real_distribution<float> pos( -80.0f, 80.0f ), rad( 0.1f, 3.0f );
+    std::vector<BallObject*> objs;
+    for( int i = 0; i < n; i++ ) {
+      objs.push_back( new BallObject( Point<float,3>( pos(rng), pos(rng), pos(rng) ), rad(rng) ) );
+      scene.insert( objs.back() );
+    }
+    return objs;
+  }
+
+
+  TEST(SceneBvh, Render_list_matches_testing_every_object) {
+
+    std::mt19937 rng( 7 );
+    Scene scene;
+    Camera cam;
+    placeCamera( cam, Point<float,3>( 0.0f, 0.0f, 60.0f ), Vector<float,3>( 0.0f, 1.0f, 0.0f ), 100.0f );
+    cam.enableCulling( true );
+
+    std::vector<BallObject*> objs = scatter( scene, 2000, rng );
+    objs[3]->setVisible( false );
+    scene.prepare();
+
+    const SceneBvh& bvh = scene.getBvh();
+    EXPECT_TRUE( bvh.isValid() );
+    EXPECT_EQ( bvh.getNoObjects(), 2000 );
+    EXPECT_LE( bvh.getHeight(), 2 * int( std::log2( 2000.0 ) ) );
+
+    const std::vector<const SceneObject*> list = renderList( scene, cam );
+    EXPECT_FALSE( list.empty() );
+    EXPECT_LT( list.size(), objs.size() );
+    EXPECT_EQ( list, bruteForce( objs, cam ) );
+
+    for( BallObject* obj : objs ) { scene.remove( obj ); delete obj; }
+    EXPECT_EQ( bvh.getNoObjects(), 0 );
+  }
+
+
+  TEST(SceneBvh, Follows_moves_removals_and_deletes) {
+
+    std::mt19937 rng( 11 );
+    Scene scene;
+    Camera cam;
+    placeCamera( cam, Point<float,3>( 0.0f, 0.0f, 60.0f ), Vector<float,3>( 0.0f, 1.0f, 0.0f ), 100.0f );
+    cam.enableCulling( true );
+
+    std::vector<BallObject*> objs = scatter( scene, 500, rng );
+    scene.prepare();
+    const SceneBvh& bvh = scene.getBvh();
+
+    // A small move stays in the leaf box, larger moves are reinserted
+    std::uniform_real_distribution<float> step( -20.0f, 20.0f );
+    for( int k = 0; k < 5; k++ ) {
+      for( int i = 0; i < 100; i++ )
+        objs[rng() % objs.size()]->translateGlobal( Vector<float,3>( step(rng), step(rng), step(rng) ) );
+      objs[0]->translateGlobal( Vector<float,3>( 0.001f, 0.0f, 0.0f ) );
+      scene.prepare();
+      ASSERT_TRUE( bvh.isValid() );
+      EXPECT_EQ( renderList( scene, cam ), bruteForce( objs, cam ) );
+    }
+
+    // Removed, and deleted while in the scene, which relies on the
+    // destructor taking the object out of the scene for clear() below
+    scene.remove( objs[10] );
+    delete objs[10];
+    delete objs[11];
+    objs.erase( objs.begin() + 10, objs.begin() + 12 );
+    EXPECT_EQ( scene.getSize(), 498 );
+    EXPECT_EQ( bvh.getNoObjects(), 498 );
+    EXPECT_TRUE( bvh.isValid() );
+
+    // Children have their own leaves, and go with the parent
+    BallObject* child = new BallObject( Point<float,3>( 1.0f, 0.0f, 0.0f ), 0.5f );
+    objs[0]->insert( child );
+    scene.prepare();
+    EXPECT_EQ( bvh.getNoObjects(), 499 );
+    objs[0]->remove( child );
+    EXPECT_EQ( bvh.getNoObjects(), 498 );
+    objs[0]->insert( child );
+    scene.prepare();
+    scene.remove( objs[0] );
+    EXPECT_EQ( bvh.getNoObjects(), 497 );
+    EXPECT_TRUE( bvh.isValid() );
+    objs[0]->remove( child );
+    delete child;
+
+    scene.clear();
+    EXPECT_EQ( bvh.getNoObjects(), 0 );
+    for( BallObject* obj : objs ) delete obj;
+  }
+
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <gmCoreModule>
+#include <gmscene.h>
+#include <gmsceneobject.h>
+using namespace GMlib;
+
+#include "testball.h"
+
+
+namespace {
+
+  TEST(SceneFind, Follows_insert_remove_and_reparent) {
+
+    Scene scene;
+    BallObject* a  = new BallObject;
+    BallObject* b  = new BallObject;
+    BallObject* c1 = new BallObject;
+    BallObject* c2 = new BallObject;
+    a->insert( c1 );
+    scene.insert( a );
+    scene.insert( b );
+
+    const Scene& cscene = scene;
+    EXPECT_EQ( scene.find( a->getName() ), a );
+    EXPECT_EQ( scene.find( c1->getName() ), c1 );
+    EXPECT_EQ( cscene.find( b->getName() ), b );
+    EXPECT_EQ( scene.find( c2->getName() ), nullptr );
+
+    // Children inserted and removed below a top level object
+    c1->insert( c2 );
+    EXPECT_EQ( scene.find( c2->getName() ), c2 );
+    a->remove( c1 );
+    EXPECT_EQ( scene.find( c1->getName() ), nullptr );
+    EXPECT_EQ( scene.find( c2->getName() ), nullptr );
+
+    // Reparented to another top level object
+    b->insert( c1 );
+    EXPECT_EQ( scene.find( c1->getName() ), c1 );
+    EXPECT_EQ( scene.find( c2->getName() ), c2 );
+
+    // Removed from the scene and inserted again
+    scene.remove( b );
+    EXPECT_EQ( scene.find( b->getName() ), nullptr );
+    EXPECT_EQ( scene.find( c2->getName() ), nullptr );
+    EXPECT_EQ( scene.find( a->getName() ), a );
+    scene.insert( b );
+    EXPECT_EQ( scene.find( c2->getName() ), c2 );
+
+    // Deleted while in the scene, the destructor takes a top level object
+    // out of the scene, and nothing is left for clear()
+    const unsigned int name_c2 = c2->getName();
+    c1->remove( c2 );
+    delete c2;
+    EXPECT_EQ( scene.find( name_c2 ), nullptr );
+    const unsigned int name_a = a->getName();
+    delete a;
+    EXPECT_EQ( scene.find( name_a ), nullptr );
+    EXPECT_EQ( scene.find( c1->getName() ), c1 );
+    EXPECT_EQ( scene.getSize(), 1 );
+
+    // A removed child deleted after its former parent
+    BallObject* d = new BallObject;
+    BallObject* e = new BallObject;
+    d->insert( e );
+    scene.insert( d );
+    d->remove( e );
+    delete d;
+    EXPECT_EQ( scene.find( e->getName() ), nullptr );
+    delete e;
+    EXPECT_EQ( scene.getSize(), 1 );
+
+    scene.clear();
+    EXPECT_EQ( scene.find( b->getName() ), nullptr );
+    delete b;
+  }
+
+  class CountedBall : public BallObject {
+  public:
+    explicit CountedBall( int& deleted ) : _deleted(deleted) {}
+    ~CountedBall() { ++_deleted; }
+  private:
+    int& _deleted;
+  };
+
+  TEST(SceneFind, Deleting_a_parent_deletes_all_its_children) {
+
+    int deleted = 0;
+    Scene scene;
+    BallObject* a = new BallObject;
+    BallObject* c[3];
+    for( BallObject*& ci : c ) { ci = new CountedBall( deleted ); a->insert( ci ); }
+    scene.insert( a );
+
+    unsigned int names[3];
+    for( int i = 0; i < 3; ++i ) names[i] = c[i]->getName();
+
+    delete a;
+    EXPECT_EQ( deleted, 3 );
+    EXPECT_EQ( scene.getSize(), 0 );
+    for( unsigned int name : names )
+      EXPECT_EQ( scene.find( name ), nullptr );
+  }
+
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <gmCoreModule>
+#include <gmscene.h>
+#include <gmsceneobject.h>
+#include <camera/gmcamera.h>
+using namespace GMlib;
+
+#include "testball.h"
+#include "testcamera.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+  // Top level objects with 0-3 children each, some with grandchildren
+  std::vector<BallObject*> scatter( Scene& scene, int n, std::mt19937& rng ) {
+    std::uniform_real_distribution<float> pos( -80.0f, 80.0f ), off( -5.0f, 5.0f ), rad( 0.1f, 3.0f );
+    std::vector<BallObject*> objs;
+    for( int i = 0; i < n; i++ ) {
+      BallObject* top = new BallObject( Point<float,3>( pos(rng), pos(rng), pos(rng) ), rad(rng) );
+      top->rotate( Angle( pos(rng) ), Vector<float,3>( 0.0f, 0.0f, 1.0f ) );
+      objs.push_back( top );
+      for( int k = int( rng() % 4 ); k > 0; k-- ) {
+        objs.push_back( new BallObject( Point<float,3>( off(rng), off(rng), off(rng) ), rad(rng) ) );
+        ( k == 2 ? objs[objs.size()-2] : top )->insert( objs.back() );
+      }
+      scene.insert( top );
+    }
+    return objs;
+  }
+
+
+  std::vector<const SceneObject*> sorted( const Array<const SceneObject*>& objs ) {
+    std::vector<const SceneObject*> list;
+    for( int i = 0; i < objs.getSize(); i++ ) list.push_back( objs(i) );
+    std::sort( list.begin(), list.end() );
+    return list;
+  }
+
+
+  // The flat view against the recursive prepare and render list, the view is rebuilt after
+  void expectSameAsRecursive( Scene& scene, const Camera& cam ) {
+
+    const SceneFlat& flat = scene.getFlatView();
+    ASSERT_TRUE( flat.isBuilt() );
+
+    std::vector<SceneObject*>       objs;
+    std::vector<HqMatrix<float,3>>  matrices;
+    std::vector<Sphere<float,3>>    spheres;
+    for( int i = 0; i < flat.getSize(); i++ ) {
+      objs.push_back( flat.getObject(i) );
+      matrices.push_back( flat.getGlobalMatrix(i) );
+      spheres.push_back( flat.getTotalSphere(i) );
+      if( flat.getParent(i) >= 0 ) {
+        EXPECT_EQ( flat.getObject( flat.getParent(i) ), objs.back()->getParent() );
+      }
+    }
+    Array<const SceneObject*> lin;
+    flat.getRenderList( lin, cam );
+
+    scene.disableFlatView();
+    for( int i = 0; i < scene.getSize(); i++ ) scene[i]->setDirty();
+    scene.prepare();
+
+    for( size_t i = 0; i < objs.size(); i++ ) {
+      for( int r = 0; r < 3; r++ )
+        for( int c = 0; c < 4; c++ )
+          EXPECT_NEAR( matrices[i](r)(c), objs[i]->getMatrixGlobal()(r)(c), 1e-4f );
+      EXPECT_NEAR( ( spheres[i].getPos() - objs[i]->getSurroundingSphere().getPos() ).getLength(), 0.0f, 1e-3f );
+      EXPECT_NEAR( spheres[i].getRadius(), objs[i]->getSurroundingSphere().getRadius(), 1e-3f );
+    }
+
+    Array<const SceneObject*> rec;
+    for( int i = 0; i < scene.getSize(); i++ )
+      scene[i]->getRenderList( rec, cam );
+    EXPECT_FALSE( rec.empty() );
+    EXPECT_EQ( sorted( lin ), sorted( rec ) );
+
+    scene.enableFlatView();
+    scene.prepare();
+  }
+
+
+  TEST(SceneFlat, Matches_the_recursive_traversal) {
+
+    std::mt19937 rng( 5 );
+    Scene scene;
+    Camera cam;
+    placeCamera( cam, Point<float,3>( 0.0f, 0.0f, 60.0f ), Vector<float,3>( 0.0f, 1.0f, 0.0f ), 100.0f );
+    cam.computeFrustumBounds();
+
+    std::vector<BallObject*> objs = scatter( scene, 300, rng );
+    scene.enableFlatView();
+    scene.prepare();
+
+    const SceneFlat& flat = scene.getFlatView();
+    EXPECT_EQ( flat.getSize(), int( objs.size() ) );
+    EXPECT_EQ( flat.getSubtreeEnd(0), 1 + objs[0]->getChildren().getSize() +
+               ( objs[0]->getChildren().getSize() > 0 ? objs[0]->getChildren()(0)->getChildren().getSize() : 0 ) );
+    expectSameAsRecursive( scene, cam );
+
+    // Moves are updated in place
+    std::uniform_real_distribution<float> step( -20.0f, 20.0f );
+    for( int k = 0; k < 3; k++ ) {
+      for( int i = 0; i < 50; i++ )
+        objs[rng() % objs.size()]->translate( Vector<float,3>( step(rng), step(rng), step(rng) ) );
+      scene.prepare();
+      EXPECT_TRUE( flat.isBuilt() );
+      expectSameAsRecursive( scene, cam );
+    }
+
+    // A new child rebuilds the view
+    BallObject* child = new BallObject( Point<float,3>( 1.0f, 0.0f, 0.0f ), 0.5f );
+    objs[0]->insert( child );
+    EXPECT_FALSE( flat.isBuilt() );
+    scene.prepare();
+    EXPECT_EQ( flat.getSize(), int( objs.size() ) + 1 );
+    expectSameAsRecursive( scene, cam );
+
+    objs[0]->remove( child );
+    delete child;
+    std::vector<BallObject*> tops;
+    for( BallObject* obj : objs )
+      if( !obj->getParent() ) tops.push_back( obj );
+    scene.clear();
+    EXPECT_EQ( flat.getSize(), 0 );
+    for( BallObject* obj : tops ) delete obj;
+  }
+
+}
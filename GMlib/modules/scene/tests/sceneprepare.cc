@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <gmCoreModule>
+#include <gmscene.h>
+#include <gmsceneobject.h>
+using namespace GMlib;
+
+#include "testball.h"
+
+#include <vector>
+
+namespace {
+
+  // An object counting how many times prepare computes its scene matrix
+  class CountingBall : public BallObject {
+    GM_SCENEOBJECT(CountingBall)
+  public:
+    CountingBall( const Point<float,3>& p, float r ) : BallObject( p, r ), prepared(0) {}
+    void grow( float r ) { setSurroundingSphere( Sphere<float,3>( Point<float,3>( 0.0f, 0.0f, 0.0f ), r ) ); }
+
+    HqMatrix<float,3>& getMatrix() override { prepared++; return SceneObject::getMatrix(); }
+    int prepared;
+  };
+
+
+  int prepare( Scene& scene, const std::vector<CountingBall*>& objs ) {
+    for( CountingBall* obj : objs ) obj->prepared = 0;
+    scene.prepare();
+    int n = 0;
+    for( CountingBall* obj : objs ) n += obj->prepared;
+    return n;
+  }
+
+
+  void expectNear( const Point<float,3>& a, const Point<float,3>& b ) {
+    EXPECT_NEAR( ( a - b ).getLength(), 0.0f, 1e-5f );
+  }
+
+
+  TEST(ScenePrepare, Only_changed_objects_are_recomputed) {
+
+    Scene scene;
+    std::vector<CountingBall*> objs;
+    for( int i = 0; i < 100; i++ ) {
+      objs.push_back( new CountingBall( Point<float,3>( float(i), 0.0f, 0.0f ), 0.5f ) );
+      scene.insert( objs.back() );
+    }
+
+    EXPECT_EQ( prepare( scene, objs ), 100 );
+    EXPECT_EQ( prepare( scene, objs ), 0 );
+    EXPECT_FALSE( objs[7]->isDirty() );
+
+    objs[7]->translate( Vector<float,3>( 0.0f, 2.0f, 0.0f ) );
+    EXPECT_TRUE( objs[7]->isDirty() );
+    EXPECT_EQ( prepare( scene, objs ), 1 );
+    expectNear( objs[7]->getSurroundingSphere().getPos(), Point<float,3>( 7.0f, 2.0f, 0.0f ) );
+
+    objs[8]->grow( 3.0f );
+    EXPECT_EQ( prepare( scene, objs ), 1 );
+    EXPECT_FLOAT_EQ( objs[8]->getSurroundingSphere().getRadius(), 3.0f );
+
+    // Removed objects are not prepared, inserted ones are
+    scene.remove( objs[9] );
+    objs[9]->translate( Vector<float,3>( 1.0f, 0.0f, 0.0f ) );
+    EXPECT_EQ( prepare( scene, objs ), 0 );
+    scene.insert( objs[9] );
+    EXPECT_EQ( prepare( scene, objs ), 1 );
+
+    // Deleted while dirty, and taken out of the scene by that
+    objs[10]->translate( Vector<float,3>( 1.0f, 0.0f, 0.0f ) );
+    delete objs[10];
+    objs.erase( objs.begin() + 10 );
+    EXPECT_EQ( scene.getSize(), int( objs.size() ) );
+    EXPECT_EQ( prepare( scene, objs ), 0 );
+
+    scene.clear();
+    for( CountingBall* obj : objs ) delete obj;
+  }
+
+
+  TEST(ScenePrepare, Children_follow_and_totals_are_refit) {
+
+    Scene scene;
+    CountingBall* parent = new CountingBall( Point<float,3>( 10.0f, 0.0f, 0.0f ), 1.0f );
+    CountingBall* child  = new CountingBall( Point<float,3>( 0.0f, 5.0f, 0.0f ), 1.0f );
+    CountingBall* other  = new CountingBall( Point<float,3>( 0.0f, 0.0f, 0.0f ), 1.0f );
+    parent->insert( child );
+    scene.insert( parent );
+    scene.insert( other );
+    const std::vector<CountingBall*> objs = { parent, child, other };
+
+    EXPECT_EQ( prepare( scene, objs ), 3 );
+    expectNear( child->getSurroundingSphereSelf().getPos(), Point<float,3>( 10.0f, 5.0f, 0.0f ) );
+
+    // A moved child is recomputed alone, and the total of the parent follows
+    child->translate( Vector<float,3>( 0.0f, 5.0f, 0.0f ) );
+    EXPECT_FALSE( parent->isDirty() );
+    EXPECT_EQ( prepare( scene, objs ), 1 );
+    EXPECT_EQ( child->prepared, 1 );
+    EXPECT_GE( parent->getSurroundingSphere().getRadius(), 5.0f );
+
+    // A moved parent takes the child along
+    parent->translate( Vector<float,3>( 0.0f, 0.0f, 3.0f ) );
+    EXPECT_EQ( prepare( scene, objs ), 2 );
+    EXPECT_EQ( other->prepared, 0 );
+    expectNear( child->getSurroundingSphereSelf().getPos(), Point<float,3>( 10.0f, 10.0f, 3.0f ) );
+    expectNear( child->getMatrixToScene() * Point<float,3>( 0.0f, 0.0f, 0.0f ), Point<float,3>( 10.0f, 0.0f, 3.0f ) );
+
+    // A removed child shrinks the total
+    parent->remove( child );
+    EXPECT_EQ( child->getParent(), static_cast<SceneObject*>(0x0) );
+    EXPECT_EQ( prepare( scene, objs ), 0 );
+    EXPECT_FLOAT_EQ( parent->getSurroundingSphere().getRadius(), 1.0f );
+
+    // and outlives its former parent
+    scene.remove( parent );
+    delete parent;
+    child->translate( Vector<float,3>( 1.0f, 0.0f, 0.0f ) );
+    EXPECT_EQ( prepare( scene, { other } ), 0 );
+
+    scene.clear();
+    delete child;
+    delete other;
+  }
+
+}
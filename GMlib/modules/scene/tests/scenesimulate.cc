@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <gmCoreModule>
+#include <gmscene.h>
+#include <gmsceneobject.h>
+using namespace GMlib;
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+  // An object moving along x, and following an other object along y
+  class Mover : public SceneObject {
+    GM_SCENEOBJECT(Mover)
+  public:
+    Mover( float speed, const Mover* follow = 0x0 ) : speed(speed), follow(follow), steps(0) {
+      _sphere = Sphere<float,3>( Point<float,3>( 0.0f, 0.0f, 0.0f ), 1.0f );
+    }
+
+    float         speed;
+    const Mover*  follow;
+    int           steps;
+
+  protected:
+    void localSimulate( double dt ) override {
+      const float y = follow ? float( follow->steps ) - getPos()[1] : 0.0f;
+      translateParent( Vector<float,3>( speed * float(dt), y, 0.0f ) );
+      steps++;
+      setEditDone();
+    }
+  };
+
+
+  struct World {
+    Scene               scene;
+    std::vector<Mover*> objs;
+
+    // With the followers first the dependencies are needed to get the order right
+    World( bool thread_safe, bool leaders_first ) {
+      for( int i = 0; i < 40; i++ ) {
+        Mover* leader   = new Mover( float(i) );
+        Mover* follower = new Mover( 1.0f, leader );
+        Mover* child    = new Mover( 2.0f );
+        follower->insert( child );
+        follower->insertSimulateDependency( leader );
+        for( Mover* obj : { leader, follower, child } ) {
+          obj->setThreadSafe( thread_safe || i % 3 != 0 );
+          objs.push_back( obj );
+        }
+        if( leaders_first ) scene.insert( leader );
+        scene.insert( follower );
+        if( !leaders_first ) scene.insert( leader );
+      }
+      scene.enabledFixedDt();
+      scene.setFixedDt( 0.1 );
+      scene.start();
+    }
+    ~World() {
+      std::vector<Mover*> tops;
+      for( Mover* obj : objs ) if( !obj->getParent() ) tops.push_back( obj );
+      scene.clear();
+      for( Mover* obj : tops ) delete obj;
+    }
+  };
+
+
+  TEST(SceneSimulate, Parallel_matches_serial) {
+
+    setNoThreads( 4 );
+
+    World serial( false, true ), parallel( false, false ), all( true, false );
+    parallel.scene.enableParallelSimulate();
+    all.scene.enableParallelSimulate();
+    EXPECT_TRUE( all.scene.isParallelSimulate() );
+
+    for( int k = 0; k < 10; k++ ) {
+      serial.scene.simulate();
+      parallel.scene.simulate();
+      all.scene.simulate();
+    }
+
+    for( size_t i = 0; i < serial.objs.size(); i++ ) {
+      EXPECT_EQ( parallel.objs[i]->steps, 10 );
+      EXPECT_EQ( all.objs[i]->steps, 10 );
+      for( int d = 0; d < 3; d++ ) {
+        EXPECT_FLOAT_EQ( parallel.objs[i]->getPos()[d], serial.objs[i]->getPos()[d] );
+        EXPECT_FLOAT_EQ( all.objs[i]->getPos()[d], serial.objs[i]->getPos()[d] );
+      }
+    }
+
+    // The followers saw the leaders after their step
+    EXPECT_FLOAT_EQ( all.objs[1]->getPos()[1], 10.0f );
+
+    // The moved objects are listed for the next prepare
+    all.scene.prepare();
+    EXPECT_FALSE( all.objs[1]->isDirty() );
+
+    Array<const SceneObject*> edited;
+    all.scene.getEditedObjects( edited );
+    EXPECT_EQ( edited.getSize(), int( all.objs.size() ) );
+  }
+
+
+  TEST(SceneSimulate, Cyclic_dependencies_fall_back_to_serial) {
+
+    World world( true, false );
+    world.objs[0]->insertSimulateDependency( world.objs[1] );
+    world.scene.enableParallelSimulate();
+    world.scene.simulate();
+    world.scene.simulate();
+
+    for( Mover* obj : world.objs )
+      EXPECT_EQ( obj->steps, 2 );
+
+    world.objs[0]->removeSimulateDependency( world.objs[1] );
+    EXPECT_TRUE( world.objs[0]->getSimulateDependencies().empty() );
+  }
+
+
+  TEST(SceneSimulate, Changed_dependencies_are_followed) {
+
+    setNoThreads( 4 );
+
+    // The graph of the first frames has no edges
+    World world( true, false );
+    for( size_t i = 1; i < world.objs.size(); i += 3 )
+      world.objs[i]->removeSimulateDependency( world.objs[i-1] );
+    world.scene.enableParallelSimulate();
+    world.scene.simulate();
+    world.scene.simulate();
+
+    for( size_t i = 1; i < world.objs.size(); i += 3 )
+      world.objs[i]->insertSimulateDependency( world.objs[i-1] );
+    for( int k = 0; k < 5; k++ ) {
+      world.scene.simulate();
+      for( size_t i = 1; i < world.objs.size(); i += 3 )
+        EXPECT_FLOAT_EQ( world.objs[i]->getPos()[1], float( world.objs[i-1]->steps ) );
+    }
+  }
+
+
+  TEST(SceneSimulate, Rendering_thread_is_the_simulating_one) {
+
+    World world( true, false );
+    EXPECT_TRUE( world.scene.isRenderingThread() );
+
+    world.scene.enableParallelSimulate();
+    world.scene.simulate();
+    EXPECT_TRUE( world.scene.isRenderingThread() );
+    EXPECT_TRUE( world.objs[2]->isOnRenderingThread() );
+
+    bool scene = true, obj = true, outside = false;
+    Mover lone( 1.0f );
+    std::thread other( [&]{
+      scene   = world.scene.isRenderingThread();
+      obj     = world.objs[2]->isOnRenderingThread();
+      outside = lone.isOnRenderingThread();
+    } );
+    other.join();
+    EXPECT_FALSE( scene );
+    EXPECT_FALSE( obj );
+    EXPECT_TRUE( outside );
+  }
+
+}
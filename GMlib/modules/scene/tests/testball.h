@@ -0,0 +1,22 @@
+#ifndef GM_SCENE_TESTS_TESTBALL_H
+#define GM_SCENE_TESTS_TESTBALL_H
+
+#include <core/types/gmpoint.h>
+#include "../src/gmsceneobject.h"
+
+
+/*!
+ * An object with a surrounding sphere, and no visualization, for the tests
+ * and benchmarks of the scene.
+ */
+class BallObject : public GMlib::SceneObject {
+  GM_SCENEOBJECT(BallObject)
+public:
+  explicit BallObject( const GMlib::Point<float,3>& p = GMlib::Point<float,3>( 0.0f, 0.0f, 0.0f ), float r = 1.0f ) {
+    _sphere = GMlib::Sphere<float,3>( GMlib::Point<float,3>( 0.0f, 0.0f, 0.0f ), r );
+    translate( p );
+  }
+};
+
+
+#endif // GM_SCENE_TESTS_TESTBALL_H
@@ -0,0 +1,22 @@
+#ifndef GM_SCENE_TESTS_TESTCAMERA_H
+#define GM_SCENE_TESTS_TESTCAMERA_H
+
+#include <core/types/gmpoint.h>
+#include "../src/camera/gmcamera.h"
+
+
+/*!
+ * Camera at pos looking at origo, with a 800x600 viewport, for the tests
+ * of the scene and of the parametrics module.
+ */
+inline void placeCamera( GMlib::Camera& cam, const GMlib::Point<float,3>& pos,
+                         const GMlib::Vector<float,3>& up, float far_plane ) {
+  GMlib::Vector<float,3> dir = -pos;
+  dir.normalize();
+  cam.set( pos, dir, up );
+  cam.setCuttingPlanes( 1.0f, far_plane );
+  cam.reshape( 0, 0, 800, 600 );
+}
+
+
+#endif // GM_SCENE_TESTS_TESTCAMERA_H
@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+
+#include <gmTrianglesystemModule>
+using namespace GMlib;
+
+#include "../tests/testfacets.h"
+
+#include <vector>
+
+
+/*!
+ * n triangulated random vertices in the unit square, on a height field
+ */
+static Facets triangulated(int n)
+{
+  Facets f(n);
+  f.setHeights();
+  f.tf->triangulateDelaunay(true);
+  return f;
+}
+
+
+/*!
+ * \brief BM_MeshFromFacets
+ * Making the half-edge mesh of a triangulation of n vertices
+ */
+static void BM_MeshFromFacets(benchmark::State& state)
+{
+  Facets        f = triangulated(int(state.range(0)));
+  TSMesh<float> mesh;
+
+  for (auto _ : state) mesh.set(*f.tf);
+  state.counters["triangles"] = double(mesh.getNoTriangles());
+}
+BENCHMARK(BM_MeshFromFacets)
+  ->Unit(benchmark::kMillisecond)
+  ->Arg(100000)
+  ->Arg(1000000);
+
+
+/*!
+ * \brief BM_ComputeNormals
+ * Vertex normals of a triangulation of n vertices, by the facets (mesh 0)
+ * or by the half-edge mesh (mesh 1)
+ */
+static void BM_ComputeNormals(benchmark::State& state)
+{
+  Facets        f = triangulated(int(state.range(0)));
+  TSMesh<float> mesh(*f.tf);
+
+  for (auto _ : state) {
+    if (state.range(1))
+      mesh.computeNormals();
+    else
+      f.tf->computeNormals();
+  }
+}
+BENCHMARK(BM_ComputeNormals)
+  ->Unit(benchmark::kMillisecond)
+  ->ArgNames({"n", "mesh"})
+  ->ArgsProduct({{100000, 1000000}, {0, 1}});
+
+
+/*!
+ * \brief BM_EvalZ
+ * 100000 heights over a triangulation of n vertices, in rows, by the facets
+ * (mesh 0) or by the half-edge mesh walking from the previous one (mesh 1)
+ */
+static void BM_EvalZ(benchmark::State& state)
+{
+  Facets        f = triangulated(int(state.range(0)));
+  TSMesh<float> mesh(*f.tf);
+
+  const int m = 316;
+  std::vector<Point<float, 2>> p;
+  for (int i = 0; i < m; ++i)
+    for (int j = 0; j < m; ++j) p.push_back(Point<float, 2>((j + 0.5f) / m, (i + 0.5f) / m));
+
+  for (auto _ : state) {
+    float    z = 0.0f;
+    uint32_t t = 0;
+    for (const auto& q : p) {
+      if (state.range(1)) {
+        t = mesh.locate(q, t);
+        if (t == TSMesh<float>::NoIndex) t = 0;
+        else z += mesh.evalZ(t, q);
+      }
+      else
+        z += f.tf->evalZ(q);
+    }
+    benchmark::DoNotOptimize(z);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(p.size()));
+}
+BENCHMARK(BM_EvalZ)
+  ->Unit(benchmark::kMillisecond)
+  ->ArgNames({"n", "mesh"})
+  ->ArgsProduct({{100000, 1000000}, {0, 1}});
+
+
+/*!
+ * \brief BM_EvalZBatch
+ * The heights of a 1024x1024 raster over a triangulation of n vertices, by
+ * evalZ() at each (batch 0) or by evalZBatch() (batch 1)
+ */
+static void BM_EvalZBatch(benchmark::State& state)
+{
+  Facets f = triangulated(int(state.range(0)));
+
+  const int m = 1024;
+  std::vector<Point<float, 2>> p;
+  for (int i = 0; i < m; ++i)
+    for (int j = 0; j < m; ++j) p.push_back(Point<float, 2>((j + 0.5f) / m, (i + 0.5f) / m));
+  std::vector<float> z(p.size());
+
+  for (auto _ : state) {
+    if (state.range(1))
+      f.tf->evalZBatch(p.data(), z.data(), p.size());
+    else
+      for (size_t i = 0; i < p.size(); ++i) z[i] = f.tf->evalZ(p[i]);
+    benchmark::DoNotOptimize(z.data());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(p.size()));
+}
+BENCHMARK(BM_EvalZBatch)
+  ->Unit(benchmark::kMillisecond)
+  ->ArgNames({"n", "batch"})
+  ->ArgsProduct({{100000, 1000000}, {0, 1}});
+
+
+/*!
+ * \brief BM_CreateVoronoi
+ * The Voronoi diagram of a triangulation of n vertices
+ */
+static void BM_CreateVoronoi(benchmark::State& state)
+{
+  Facets f = triangulated(int(state.range(0)));
+
+  for (auto _ : state) f.tf->createVoronoi();
+  state.counters["edges"] = double(f.tf->getVoronoiEdges().getSize());
+}
+BENCHMARK(BM_CreateVoronoi)
+  ->Unit(benchmark::kMillisecond)
+  ->Arg(100000)
+  ->Arg(1000000);
+
+
+BENCHMARK_MAIN();
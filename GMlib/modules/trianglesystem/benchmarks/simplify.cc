@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include <gmTrianglesystemModule>
+using namespace GMlib;
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+
+/*!
+ * A height field on an m x m grid, two triangles in each cell
+ */
+struct Grid {
+  std::vector<Point<float, 3>> p;
+  std::vector<uint32_t>        tri;
+
+  explicit Grid(int m)
+  {
+    for (int i = 0; i <= m; ++i)
+      for (int j = 0; j <= m; ++j) {
+        const float x = float(j) / m, y = float(i) / m;
+        p.push_back(Point<float, 3>(x, y, 0.2f * std::sin(9 * x) * std::cos(7 * y) + 0.01f * std::sin(80 * x * y)));
+      }
+
+    for (int i = 0; i < m; ++i)
+      for (int j = 0; j < m; ++j) {
+        const uint32_t a = i * (m + 1) + j, b = a + 1, c = a + m + 2, d = a + m + 1;
+        tri.insert(tri.end(), {a, b, c, a, c, d});
+      }
+  }
+};
+
+
+/*!
+ * \brief BM_Simplify
+ * Simplifying a height field of about a million triangles down to the given
+ * percent of them, from setting the mesh to getting it back
+ */
+static void BM_Simplify(benchmark::State& state)
+{
+  Grid                          g(708);
+  TSSimplifier<float>           s;
+  std::vector<Point<float, 3>>  p;
+  std::vector<uint32_t>         tri;
+
+  const uint32_t n = uint32_t(g.tri.size() / 3);
+  for (auto _ : state) {
+    s.set(g.p, g.tri);
+    s.simplify(uint32_t(uint64_t(n) * state.range(0) / 100));
+    s.get(p, tri);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(n));
+  state.counters["triangles"] = double(n);
+  state.counters["left"]      = double(s.getNoTriangles());
+  state.counters["error"]     = s.getError();
+}
+BENCHMARK(BM_Simplify)
+  ->Unit(benchmark::kMillisecond)
+  ->ArgName("percent")
+  ->Arg(10)
+  ->Arg(1);
+
+
+BENCHMARK_MAIN();
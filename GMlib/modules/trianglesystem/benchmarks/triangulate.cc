@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+
+#include <gmTrianglesystemModule>
+using namespace GMlib;
+
+#include "../tests/testfacets.h"
+
+
+/*!
+ * \brief BM_TriangulateDelaunay
+ * Triangulating n random points
+ */
+static void BM_TriangulateDelaunay(benchmark::State& state)
+{
+  Facets f(int(state.range(0)));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    f.fill();
+    state.ResumeTiming();
+    f.tf->triangulateDelaunay();
+  }
+  state.counters["triangles"] = double(f.tf->getNoTriangles());
+}
+BENCHMARK(BM_TriangulateDelaunay)
+  ->Unit(benchmark::kMillisecond)
+  ->Arg(10000)
+  ->Arg(100000)
+  ->Arg(1000000);
+
+
+/*!
+ * \brief BM_TriangulateDistribution
+ * Triangulating n uniform, clustered or gridded points (dist), inserted
+ * one by one or in bulk. Gridded points in input order are slow to insert
+ * one by one, so the large sets are only inserted in bulk.
+ */
+static void BM_TriangulateDistribution(benchmark::State& state)
+{
+  Facets f(int(state.range(0)));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    f.fill(Distribution(state.range(1)));
+    state.ResumeTiming();
+    f.tf->triangulateDelaunay(state.range(2) != 0);
+  }
+  state.counters["triangles"] = double(f.tf->getNoTriangles());
+}
+BENCHMARK(BM_TriangulateDistribution)
+  ->Unit(benchmark::kMillisecond)
+  ->ArgNames({"n", "dist", "bulk"})
+  ->ArgsProduct({{10000, 50000}, {0, 1, 2}, {0, 1}})
+  ->Args({1000000, 0, 1})
+  ->Args({1000000, 1, 1})
+  ->Args({1000000, 2, 1});
+
+
+/*!
+ * \brief BM_TriangulateParallel
+ * Triangulating n uniform, clustered or gridded points (dist) in strips
+ * (partitions), see TriangleFacets::enableParallelTriangulation()
+ */
+static void BM_TriangulateParallel(benchmark::State& state)
+{
+  Facets f(int(state.range(0)));
+  f.tf->enableParallelTriangulation(int(state.range(2)));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    f.fill(Distribution(state.range(1)));
+    state.ResumeTiming();
+    f.tf->triangulateDelaunay();
+  }
+  state.counters["triangles"] = double(f.tf->getNoTriangles());
+}
+BENCHMARK(BM_TriangulateParallel)
+  ->Unit(benchmark::kMillisecond)
+  ->ArgNames({"n", "dist", "partitions"})
+  ->ArgsProduct({{100000, 1000000}, {0, 1, 2}, {1, 4}});
+
+
+/*!
+ * \brief BM_Clear
+ * Clearing a triangulation of n random points
+ */
+static void BM_Clear(benchmark::State& state)
+{
+  Facets f(int(state.range(0)));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    f.fill();
+    f.tf->triangulateDelaunay();
+    state.ResumeTiming();
+    f.tf->clear();
+  }
+}
+BENCHMARK(BM_Clear)
+  ->Unit(benchmark::kMillisecond)
+  ->Arg(10000)
+  ->Arg(100000)
+  ->Arg(1000000);
+
+
+BENCHMARK_MAIN();
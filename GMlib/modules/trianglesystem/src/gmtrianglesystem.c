@@ -24,9 +24,17 @@
 
 #include "visualizers/gmtrianglefacetsdefaultvisualizer.h"
 
+// gmlib
+#include <core/utils/gmparallel.h>
+
 // stl
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <utility>
 
 
 namespace GMlib {
@@ -34,6 +42,88 @@ namespace GMlib {
   template <class T>
   TriangleFacets<T>* TriangleSystem<T>::_tv = NULL;
 
+
+
+  template <typename E>
+  inline
+  TSArena<E>::TSArena() : _free(NULL), _used(_block_size), _size(0) {}
+
+
+  template <typename E>
+  inline
+  TSArena<E>::TSArena( const TSArena<E>& ) : _free(NULL), _used(_block_size), _size(0) {}
+
+
+  template <typename E>
+  inline
+  TSArena<E>::~TSArena() {}
+
+
+  template <typename E>
+  template <typename... Args>
+  inline
+  E* TSArena<E>::create( Args&&... args ) {
+
+    Slot* s;
+    if( _free ) {
+      s = _free;
+      _free = _free->next;
+    }
+    else {
+      if( _used == _block_size ) {
+        _blocks.emplace_back( new Slot[_block_size] );
+        _used = 0;
+      }
+      s = &_blocks.back()[_used++];
+    }
+
+    ++_size;
+    return new (s->data) E( std::forward<Args>(args)... );
+  }
+
+
+  template <typename E>
+  inline
+  void TSArena<E>::destroy( E* e ) {
+
+    e->~E();
+    Slot* s = reinterpret_cast<Slot*>(e);
+    s->next = _free;
+    _free = s;
+    --_size;
+  }
+
+
+  template <typename E>
+  inline
+  int TSArena<E>::getSize() const {
+
+    return _size;
+  }
+
+
+  /** void TSArena<E>::release()
+   *  \brief Drops all elements, without running their destructors
+   */
+  template <typename E>
+  inline
+  void TSArena<E>::release() {
+
+    _blocks.clear();
+    _free = NULL;
+    _used = _block_size;
+    _size = 0;
+  }
+
+
+  template <typename E>
+  inline
+  TSArena<E>& TSArena<E>::operator = ( const TSArena<E>& ) {
+
+    release();
+    return *this;
+  }
+
   template <typename T>
   inline
   TriangleFacets<T>::TriangleFacets( int d )
@@ -42,8 +132,11 @@ namespace GMlib {
 
     //setStreamMode();
     _dlist_name=0;
-    glGenBuffers( 1, &_vbo );
-    glGenBuffers( 1, &_ibo );
+    _bulk = false;
+    _last = 0x0;
+    _partitions = -1;
+    _vbo = 0;
+    _ibo = 0;
 
     _default_visualizer = 0x0;
   }
@@ -58,8 +151,11 @@ namespace GMlib {
     for(int i=0; i<v.size(); i++) (*this)[i] = v(i);
 
     _dlist_name = 0;
-    glGenBuffers( 1, &_vbo );
-    glGenBuffers( 1, &_ibo );
+    _bulk = false;
+    _last = 0x0;
+    _partitions = -1;
+    _vbo = 0;
+    _ibo = 0;
 
     _default_visualizer = 0x0;
   }
@@ -68,6 +164,7 @@ namespace GMlib {
   template <typename T>
   TriangleFacets<T>::~TriangleFacets() {
 
+  #ifdef DEBUG
     int k=0,r=0,s=0,p=0;
     int i,j;
     for(i=0; i < _tri_order.getDim1(); i++)
@@ -112,11 +209,14 @@ namespace GMlib {
     }
     std::cout << "Antall edger i snitt i Verticene: " << double(k)/i << std::endl;
     std::cout << "Max edger i snitt i Verticene   : " << double(r)/i << std::endl;
+  #endif
 
     clear();
 
-    glDeleteBuffers( 1, &_vbo );
-    glDeleteBuffers( 1, &_ibo );
+    if( _vbo ) {
+      glDeleteBuffers( 1, &_vbo );
+      glDeleteBuffers( 1, &_ibo );
+    }
 
     enableDefaultVisualizer( false );
     if( _default_visualizer )
@@ -127,6 +227,9 @@ namespace GMlib {
   template <typename T>
   void TriangleFacets<T>::_adjustTriangle( TSTriangle<T>* t, bool wider ) {
 
+    // The search grid is built after a bulk insertion
+    if( _bulk ) return;
+
     int i,j;
     Box<unsigned char,2> b	= t->_getBox();
     t->_updateBox( _u, _v, _d );
@@ -158,6 +261,96 @@ namespace GMlib {
   }
 
 
+  /** void TriangleFacets<T>::_compact()
+   *  \brief Takes the edges and triangles removed while _bulk out of the arrays
+   *
+   *  Once for all of them, instead of a linear search for each.
+   */
+  template <typename T>
+  void TriangleFacets<T>::_compact() {
+
+    auto compact = []( auto& a, auto& removed ) {
+      std::sort( removed.begin(), removed.end() );
+      int k = 0;
+      for( int i = 0; i < a.getSize(); i++ )
+        if( !std::binary_search( removed.begin(), removed.end(), a[i] ) )
+          a[k++] = a[i];
+      a.setSize( k );
+      removed.clear();
+    };
+
+    compact( _edges, _removed_edges );
+    compact( _triangles, _removed_triangles );
+  }
+
+
+  /** void TriangleFacets<T>::_fillConvexHull()
+   *  \brief Inserts edges and triangles to make a convex boundary
+   *
+   *  A triangle is added where the boundary turns inwards, by more than the
+   *  rounding of the turn, until a whole round of the boundary adds none.
+   *  The edges made inner are swapped to Delaunay after.
+   */
+  template <typename T>
+  void TriangleFacets<T>::_fillConvexHull() {
+
+    int i, n_bound=0;
+    for(i=0; i< _edges.getSize(); i++)
+      if(_edges[i]->boundary())
+      {
+        n_bound++;
+        TSTriangle<T>* t = _edges[i]->_getOther(NULL);
+        if (t) {
+          t->_reverse(_edges[i]);
+          Array<TSEdge<T>*> edges = t->getEdges();
+          if( _edges[i]->_isFirst( _edges[i]->getCommonVertex(*edges[1]) ) )
+            _edges[i]->_reverse();
+        }
+      }
+
+    for(i=0; i< _edges.getSize(); i++)
+      if( _edges[i]->boundary() )
+        break;
+
+    TSEdge<T> *a = _edges[i];
+    TSEdge<T> *b = a->_getNext();
+
+    Array<TSEdge<T>*> inner;
+
+    for(i=0; i<n_bound;)
+    {
+      const Vector<T,2> v = a->getVector2D();
+      const Vector<T,2> w = b->getVector2D();
+      const double      c = double(w[0]) * v[1] - double(w[1]) * v[0];
+      if( c > 1e-9 * std::sqrt( double(v*v) * double(w*w) ) ) {
+
+        TSEdge<T> *ne = _newEdge(*(a->getFirstVertex()),*(b->getLastVertex()));
+        TSTriangle<T> *nt = _newTriangle(ne,b,a);
+        a->_swapTriangle(NULL,nt);
+        b->_swapTriangle(NULL,nt);
+        ne->_setTriangle(nt,NULL);
+        _edges += ne;
+        _insertTriangle(nt);
+        inner += a;
+        inner += b;
+        a = ne;
+        b = a->_getNext();
+        n_bound--;
+        i = 0;
+      }
+      else
+      {
+        a = b;
+        b = a->_getNext();
+        i++;
+      }
+    }
+
+    for(i=0; i< inner.getSize(); i++)
+      inner[i]->_okDelaunay();
+  }
+
+
   template <typename T>
   bool TriangleFacets<T>::_fillPolygon( Array<TSEdge<T>*>& e ) {
 
@@ -221,8 +414,8 @@ namespace GMlib {
         a = e[k0];
         b = e[k1];
 
-        TSEdge<T> *ne = new TSEdge<T>(*(a->getFirstVertex()),*(b->getLastVertex()));
-        TSTriangle<T> *nt = new TSTriangle<T>(ne,b,a);
+        TSEdge<T> *ne = _newEdge(*(a->getFirstVertex()),*(b->getLastVertex()));
+        TSTriangle<T> *nt = _newTriangle(ne,b,a);
         a->swapTriangle(NULL,nt);
         b->swapTriangle(NULL,nt);
         ne->setTriangle(nt,NULL);
@@ -233,7 +426,7 @@ namespace GMlib {
       }
     }
 
-    TSTriangle<T> *nt = new TSTriangle<T>(e[2],e[1],e[0]);
+    TSTriangle<T> *nt = _newTriangle(e[2],e[1],e[0]);
     e[0]->swapTriangle(NULL,nt);
     e[1]->swapTriangle(NULL,nt);
     e[2]->swapTriangle(NULL,nt);
@@ -267,11 +460,109 @@ namespace GMlib {
   }
 
 
+  template <typename T>
+  inline
+  void TriangleFacets<T>::_deleteEdge( TSEdge<T>* e ) {
+
+    _edge_arena.destroy( e );
+  }
+
+
+  template <typename T>
+  inline
+  void TriangleFacets<T>::_deleteTriangle( TSTriangle<T>* t ) {
+
+    _triangle_arena.destroy( t );
+  }
+
+
+  template <typename T>
+  inline
+  TSEdge<T>* TriangleFacets<T>::_newEdge( TSVertex<T>& s, TSVertex<T>& e ) {
+
+    TSEdge<T>* edge = _edge_arena.create( s, e );
+    edge->_facets = this;
+    return edge;
+  }
+
+
+  template <typename T>
+  inline
+  TSTriangle<T>* TriangleFacets<T>::_newTriangle( TSEdge<T>* e1, TSEdge<T>* e2, TSEdge<T>* e3 ) {
+
+    TSTriangle<T>* t = _triangle_arena.create( e1, e2, e3 );
+    t->_facets = this;
+    return t;
+  }
+
+
+  /** void TriangleFacets<T>::_initTriOrder()
+   *  \brief Makes an empty search grid over the bounding box
+   */
+  template <typename T>
+  void TriangleFacets<T>::_initTriOrder() {
+
+    if(this->getSize() < 200)         _d = 2;
+    else if(this->getSize() < 800)    _d = 3;
+    else if(this->getSize() < 3200)   _d = 4;
+    else if(this->getSize() < 12800)  _d = 5;
+    else if(this->getSize() < 51200)  _d = 6;
+    else if(this->getSize() < 204800) _d = 7;
+    else                              _d = 8;
+
+    int n = 1 << _d;
+
+    _tri_order.setDim(n,n);
+    _u.setMaxSize(n+1);
+    _v.setMaxSize(n+1);
+    _u.resetSize();
+    _v.resetSize();
+
+    for(int i=0; i<= n; i++)
+    {
+      _u += _box.getValueMin(0) + i*_box.getValueDelta(0)/n;
+      _v += _box.getValueMin(1) + i*_box.getValueDelta(1)/n;
+    }
+
+    for(int i=0; i< n; i++)
+      for(int j=0; j< n; j++)
+        _tri_order[i][j].setMaxSize(20);//,10);
+  }
+
+
   template <typename T>
   void TriangleFacets<T>::_insertTriangle( TSTriangle<T>* t ) {
 
     _triangles += t;
 
+    if( !_bulk )
+      _insertTriOrder( t );
+  }
+
+
+  /** void TriangleFacets<T>::_insertionOrder( std::vector<int>& order ) const
+   *  \brief The order of the vertices in a bulk insertion
+   *
+   *  See TSDelaunay::insertionOrder().
+   */
+  template <typename T>
+  void TriangleFacets<T>::_insertionOrder( std::vector<int>& order ) const {
+
+    const int n = this->getSize();
+
+    std::vector< Point<T,2> > p( n );
+    for( int i = 0; i < n; i++ )
+      p[i] = (*this)(i).getParameter();
+
+    order.resize( n );
+    std::iota( order.begin(), order.end(), 0 );
+    TSDelaunay<T>::insertionOrder( p, order );
+  }
+
+
+  template <typename T>
+  void TriangleFacets<T>::_insertTriOrder( TSTriangle<T>* t ) {
+
     t->_updateBox( _u, _v, _d );
 
     Box<unsigned char,2> b	= t->_getBox();
@@ -290,9 +581,24 @@ namespace GMlib {
   }
 
 
+  template <typename T>
+  void TriangleFacets<T>::_removeEdge( TSEdge<T>* e ) {
+
+    if( _bulk )
+      _removed_edges.push_back(e);
+    else
+      _edges.remove(e);
+  }
+
+
   template <typename T>
   void TriangleFacets<T>::_removeTriangle( TSTriangle<T>* t ) {
 
+    if( _bulk ) {
+      _removed_triangles.push_back(t);
+      return;
+    }
+
     _triangles.remove(t);
 
     Box<unsigned char,2> b	= t->_getBox();
@@ -315,7 +621,7 @@ namespace GMlib {
   void TriangleFacets<T>::_set( int i ) {
 
     TSTriangle<T>* t;
-    int k = _surroundingTriangle(t, (*this)[i]);
+    int k = _bulk ? _walkToTriangle(t, (*this)[i]) : _surroundingTriangle(t, (*this)[i]);
 
     if (k < 0)
       t->getEdges()[-(k+1)]->_split((*this)[i]);		// Split an edge
@@ -328,28 +634,294 @@ namespace GMlib {
   }
 
 
+  /** void TriangleFacets<T>::_setTriangles( const std::vector<int>& tri )
+   *  \brief Makes the edges and triangles of a triangulation given by vertex indices
+   *
+   *  Three vertex indices for each triangle, counterclockwise. The sides of
+   *  the triangles are grouped by their lowest vertex to find the edges.
+   */
+  template <typename T>
+  void TriangleFacets<T>::_setTriangles( const std::vector<int>& tri ) {
+
+    const int n = this->getSize();
+    const int m = int( tri.size() ) / 3;
+
+    // Side h goes from vertex tri[h] to the next one in the triangle
+    auto next = [&tri]( int h ) { return tri[h - h%3 + (h%3+1)%3]; };
+
+    std::vector<int> start( n+1, 0 ), side( 3*m );
+    for( int h = 0; h < 3*m; h++ )
+      start[ std::min( tri[h], next(h) ) + 1 ]++;
+    std::partial_sum( start.begin(), start.end(), start.begin() );
+
+    std::vector<int> pos( start.begin(), start.end()-1 ), deg( n, 1 );
+    for( int h = 0; h < 3*m; h++ ) {
+      side[ pos[ std::min( tri[h], next(h) ) ]++ ] = h;
+      deg[tri[h]]++;
+    }
+
+    // Room for all edges of each vertex at once
+    for( int v = 0; v < n; v++ )
+      (*this)[v]._edges.setMaxSize( deg[v] );
+
+    std::vector< TSEdge<T>* > edge( 3*m, NULL );
+    for( int v = 0; v < n; v++ )
+      for( int i = start[v]; i < start[v+1]; i++ ) {
+
+        if( edge[side[i]] ) continue;
+
+        const int w = std::max( tri[side[i]], next(side[i]) );
+        TSEdge<T>* e = _newEdge( (*this)[v], (*this)[w] );
+        _edges += e;
+        edge[side[i]] = e;
+
+        for( int j = i+1; j < start[v+1]; j++ )
+          if( std::max( tri[side[j]], next(side[j]) ) == w ) {
+            edge[side[j]] = e;
+            break;
+          }
+      }
+
+    for( int i = 0; i < m; i++ ) {
+
+      TSTriangle<T>* t = _newTriangle( edge[3*i], edge[3*i+1], edge[3*i+2] );
+      for( int k = 0; k < 3; k++ ) {
+        TSEdge<T>* e = edge[3*i+k];
+        e->_triangle[ e->_triangle[0] == NULL ? 0 : 1 ] = t;
+      }
+      _insertTriangle( t );
+    }
+  }
+
+
+  /** void TriangleFacets<T>::_getCell( const Point<T,2>& p, int& i, int& j ) const
+   *  \brief The cell of the search grid p is in, by bisection
+   */
   template <typename T>
-  int  TriangleFacets<T>::_surroundingTriangle( TSTriangle<T>*& t, const TSVertex<T>& v ) {
+  void TriangleFacets<T>::_getCell( const Point<T,2>& p, int& i, int& j ) const {
 
     int k,s,n = 1 << _d;
-    Point<T,2>	nb = v.getParameter();
 
-    int i=0,j=0;
-    int it;
-    for(it=1; it <= _d; it++)
+    i=0;
+    j=0;
+    for(int it=1; it <= _d; it++)
     {
       s = n >> it;
       k = i + s;
-      if ( _u(k) < nb[0]) i = k;
+      if ( _u(k) < p(0)) i = k;
       k = j + s;
-      if ( _v(k) < nb[1]) j = k;
+      if ( _v(k) < p(1)) j = k;
     }
+  }
+
+
+  template <typename T>
+  int  TriangleFacets<T>::_surroundingTriangle( TSTriangle<T>*& t, const TSVertex<T>& v ) const {
+
+    int i,j;
+    _getCell( v.getParameter(), i, j );
 
-    k=0;
-    for (it=_tri_order[i][j].getSize()-1; it>=0; it--)
-      if( ( k = v.isInside( _tri_order[i][j](it) ) ) ) break;
+    const ArrayT<TSTriangle<T>*>& cell = _tri_order(i)(j);
 
-    t = (it >= 0 ? _tri_order[i][j](it) : NULL);
+    int k=0;
+    int it;
+    for (it=cell.getSize()-1; it>=0; it--)
+      if( ( k = v.isInside( cell(it) ) ) ) break;
+
+    t = (it >= 0 ? cell(it) : NULL);
+
+    return k;
+  }
+
+
+  /** void TriangleFacets<T>::_triangulateParallel()
+   *  \brief The Delaunay triangulation by strips, see enableParallelTriangulation()
+   *
+   *  The vertices are sorted by x and split in strips that are triangulated
+   *  at the same time. The triangles of a strip with their circumcircle well
+   *  inside it are kept, see TSDelaunay::split(). The rest of the vertices
+   *  are triangulated together, and the triangles of that which cover the
+   *  kept ones are removed. If the two do not fit, because of cocircular
+   *  vertices on the border, all vertices are triangulated in one piece.
+   */
+  template <typename T>
+  void TriangleFacets<T>::_triangulateParallel() {
+
+    const int n = this->getSize();
+
+    std::vector< Point<T,2> > p( n );
+    for( int i = 0; i < n; i++ )
+      p[i] = (*this)(i).getParameter();
+
+    std::vector<int> ids( n );
+    std::iota( ids.begin(), ids.end(), 0 );
+    std::sort( ids.begin(), ids.end(), [&p]( int i, int j ) { return p[i][0] < p[j][0]; } );
+
+    int k = _partitions > 0 ? _partitions : getNoThreads();
+    k = std::max( 1, std::min( k, n / 256 ) );
+
+    std::vector<int> tri;
+    tri.reserve( 6*n );
+
+    bool merged = false;
+    if( k > 1 ) {
+
+      std::vector< std::vector<int> > inner( k ), border( k );
+      std::vector<char>               rest( n, 0 );
+
+      parallelFor( 0, k, [&]( int b, int e ) {
+        for( int s = b; s < e; s++ ) {
+
+          const int    f  = int( int64_t(n) * s / k );
+          const int    l  = int( int64_t(n) * (s+1) / k );
+          const double x0 = s > 0   ? double(p[ids[f-1]][0]) : -std::numeric_limits<double>::infinity();
+          const double x1 = s < k-1 ? double(p[ids[l]][0])   :  std::numeric_limits<double>::infinity();
+
+          TSDelaunay<T> dt( p );
+          if( dt.triangulate( std::vector<int>( ids.begin() + f, ids.begin() + l ) ) )
+            dt.split( x0, x1, inner[s], border[s], rest );
+          else
+            for( int i = f; i < l; i++ ) rest[ids[i]] = 1;
+        }
+      } );
+
+      std::vector<int> r, wall;
+      for( int i = 0; i < n; i++ )
+        if( rest[i] ) r.push_back( i );
+      for( int s = 0; s < k; s++ )
+        wall.insert( wall.end(), border[s].begin(), border[s].end() );
+
+      TSDelaunay<T> dt( p );
+      dt.triangulate( r );
+      if( dt.removeInside( wall ) ) {
+
+        for( int s = 0; s < k; s++ ) {
+          tri.insert( tri.end(), inner[s].begin(), inner[s].end() );
+          std::vector<int>().swap( inner[s] );
+        }
+        dt.getTriangles( tri );
+        merged = true;
+      }
+    }
+
+    if( !merged ) {
+
+      TSDelaunay<T> dt( p );
+      dt.triangulate( ids );
+      dt.getTriangles( tri );
+    }
+
+    _initTriOrder();
+    _setTriangles( tri );
+  }
+
+
+  /** bool TriangleFacets<T>::_walk( TSTriangle<T>*& t, const Point<T,2>& p ) const
+   *  \brief Walks from t to the triangle containing p
+   *
+   *  Crosses an edge whenever p is strictly on the other side of it than
+   *  the opposite vertex, not back over the last edge and from a random
+   *  edge in each triangle, so that it does not cycle. It still may among
+   *  the slivers of nearly collinear vertices, hence the limit. It gives
+   *  up, returning false with t where it stopped, where it would leave the
+   *  triangulation, meets a degenerate triangle or is too long. Nothing is
+   *  changed, so that it can run in several threads at once.
+   */
+  template <typename T>
+  bool TriangleFacets<T>::_walk( TSTriangle<T>*& t, const Point<T,2>& p ) const {
+
+    auto orient = []( const Point<T,2>& a, const Point<T,2>& b, const Point<T,2>& c ) {
+      return double( b[0] - a[0] ) * double( c[1] - a[1] ) - double( b[1] - a[1] ) * double( c[0] - a[0] );
+    };
+
+    TSEdge<T>* last = 0x0;
+    uint32_t   r    = 1;
+    const int max_steps = 8 * int( std::sqrt( double( _triangles.getSize() ) ) ) + 64;
+    for( int step = 0; step < max_steps; step++ ) {
+
+      r = r * 1664525u + 1013904223u;
+      TSTriangle<T>* next = 0x0;
+      for( int k = 0; k < 3 && !next; k++ ) {
+
+        const int e = int( ( r >> 16 ) + k ) % 3;
+        TSEdge<T>* edge = t->_edge[e];
+        if( edge == last ) continue;
+
+        const Point<T,2> a = edge->getFirstVertex()->getParameter();
+        const Point<T,2> b = edge->getLastVertex()->getParameter();
+        const Point<T,2> c = t->_edge[(e+1)%3]->getCommonVertex( *t->_edge[(e+2)%3] )->getParameter();
+
+        const double oc = orient( a, b, c );
+        if( oc == 0.0 ) return false;
+
+        if( orient( a, b, p ) * oc < 0.0 ) {
+          next = edge->_getOther( t );
+          last = edge;
+          if( !next ) return false;
+        }
+      }
+
+      if( !next ) return true;
+      t = next;
+    }
+
+    return false;
+  }
+
+
+  /** int TriangleFacets<T>::_walkToTriangle( TSTriangle<T>*& t, const TSVertex<T>& v )
+   *  \brief Finds the triangle containing v by walking, in a bulk insertion
+   *
+   *  The walk, see _walk(), starts from the last triangle found, which is
+   *  next to the previous vertex in the insertion order. A walk that gives
+   *  up ends in a search around where it stopped, and then through all
+   *  triangles. The result is given as for _surroundingTriangle().
+   */
+  template <typename T>
+  int TriangleFacets<T>::_walkToTriangle( TSTriangle<T>*& t, const TSVertex<T>& v ) {
+
+    const Point<T,2> p = v.getParameter();
+    const int        n = _triangles.getSize();
+
+    t = _last ? _last : _triangles[0];
+    int k = _walk( t, p ) ? v.isInside( t ) : 0;
+
+    // Where the walk is stuck, search the triangles around it
+    std::vector<TSTriangle<T>*> near;
+    if( !k ) near.push_back( t );
+    for( size_t i = 0; !k && i < near.size() && i < 256; i++ ) {
+
+      if( ( k = v.isInside( near[i] ) ) ) {
+        t = near[i];
+        break;
+      }
+
+      for( int e = 0; e < 3; e++ ) {
+        TSTriangle<T>* s = near[i]->_edge[e]->_getOther( near[i] );
+        if( s && std::find( near.begin(), near.end(), s ) == near.end() )
+          near.push_back( s );
+      }
+    }
+
+    // and then through all of them
+    for( int i = n-1; !k && i >= 0; i-- ) {
+
+      TSTriangle<T>* s = _triangles[i];
+      const Point<T,2> a = s->_edge[0]->getFirstVertex()->getParameter();
+      const Point<T,2> b = s->_edge[0]->getLastVertex()->getParameter();
+      const Point<T,2> c = s->_edge[1]->getCommonVertex( *s->_edge[2] )->getParameter();
+
+      bool in_box = true;
+      for( int j = 0; j < 2; j++ ) {
+        const T tol = T(POS_TOLERANCE) * ( std::abs(a[j]) + std::abs(b[j]) + std::abs(c[j]) + T(1) );
+        in_box = in_box && p[j] >= std::min( a[j], std::min( b[j], c[j] ) ) - tol
+                        && p[j] <= std::max( a[j], std::max( b[j], c[j] ) ) + tol;
+      }
+
+      if( in_box && ( k = v.isInside( s ) ) ) t = s;
+    }
+
+    _last = t;
 
     return k;
   }
@@ -380,14 +952,14 @@ namespace GMlib {
 
 
   template <typename T>
-  T TriangleFacets<T>::evalZ( const Point<T,2>& p, int deg ) {
+  T TriangleFacets<T>::evalZ( const Point<T,2>& p, int deg ) const {
 
     T z = 0;
     TSTriangle<T>* t;
     int idx = _surroundingTriangle( t, TSVertex<T>(p) );
 
     if( idx )
-      z=t->evalZ( p, deg );
+      z=t->_evalZ( p, deg );
 
     return z;
   }
@@ -395,25 +967,114 @@ namespace GMlib {
 
   template <typename T>
   inline
-  T TriangleFacets<T>::evalZ( T x, T y, int deg ) {
+  T TriangleFacets<T>::evalZ( T x, T y, int deg ) const {
 
     return evalZ( Point<T,2>( x, y ), deg );
   }
 
 
+  /** void TriangleFacets<T>::evalZBatch( const Point<T,2>* p, T* z, size_t n, int deg ) const
+   *  \brief The heights z of the n points p, as by evalZ()
+   *
+   *  The points are taken in blocks, a few for each thread, which are
+   *  shared between the threads, see parallelFor(). In a block they are
+   *  sorted by the cell of the search grid they are in, in Z-order, and the
+   *  triangle of each is found by walking from the one of the point before,
+   *  see _walk(). Small blocks are sorted by larger cells. Where the walk
+   *  does not find it, the search grid is used, as by evalZ(). Nothing is
+   *  changed, so the function can be called from several threads at once
+   *  on a triangulation that is not changed meanwhile.
+   */
+  template <typename T>
+  void TriangleFacets<T>::evalZBatch( const Point<T,2>* p, T* z, size_t n, int deg ) const {
+
+    if( _triangles.getSize() == 0 ) {
+      std::fill( z, z + n, T(0) );
+      return;
+    }
+
+    const size_t per    = 4 * size_t( getNoThreads() );
+    const size_t block  = std::max( size_t(256), std::min( size_t(1) << 16, ( n + per - 1 ) / per ) );
+    const int    blocks = int( ( n + block - 1 ) / block );
+
+    int d = _d;
+    while( d > 1 && ( size_t(1) << 2*d ) > block ) d--;
+    const int shift = _d - d;
+
+    parallelFor( 0, blocks, [&]( int b, int e ) {
+
+      std::vector<uint32_t> key( block ), order( block ), first( ( size_t(1) << 2*d ) + 1 );
+      TSTriangle<T>* t = 0x0;
+
+      for( int k = b; k < e; k++ ) {
+
+        const size_t f = k * block;
+        const size_t m = std::min( block, n - f );
+
+        // Counting sort by the Z-order of the cells
+        std::fill( first.begin(), first.end(), 0u );
+        for( size_t i = 0; i < m; i++ ) {
+
+          int u, v;
+          _getCell( p[f+i], u, v );
+          u >>= shift;
+          v >>= shift;
+
+          uint32_t c = 0;
+          for( int j = 0; j < d; j++ )
+            c |= ( ( uint32_t(u) >> j & 1u ) << (2*j+1) ) | ( ( uint32_t(v) >> j & 1u ) << (2*j) );
+
+          key[i] = c;
+          first[c+1]++;
+        }
+        std::partial_sum( first.begin(), first.end(), first.begin() );
+        for( size_t i = 0; i < m; i++ )
+          order[ first[key[i]]++ ] = uint32_t(i);
+
+        for( size_t i = 0; i < m; i++ ) {
+
+          const size_t q = f + order[i];
+
+          TSTriangle<T>* s = t;
+          if( !s || !_walk( s, p[q] ) ) {
+            s = 0x0;
+            _surroundingTriangle( s, TSVertex<T>( p[q] ) );
+          }
+
+          if( s ) {
+            z[q] = s->_evalZ( p[q], deg );
+            t    = s;
+          }
+          else
+            z[q] = T(0);
+        }
+      }
+    } );
+  }
+
+
+  /** void TriangleFacets<T>::clear( int d )
+   *  \brief Removes all vertices, edges and triangles
+   *
+   *  The edges and triangles are released with their arenas at once,
+   *  instead of unlinking them from each other one by one.
+   */
   template <typename T>
   void TriangleFacets<T>::clear( int d ) {
 
     __e.set(*this);
 
-    while( _triangles.getSize() > 0 )
-      delete _triangles[0];
+    for( int i = 0; i < this->getSize(); i++ )
+      (*this)[i]._edges.clear();
 
-    while( _edges.getSize() > 0 )
-      delete _edges[0];
+    for( int i = 0; i < _tri_order.getDim1(); i++ )
+      for( int j = 0; j < _tri_order.getDim2(); j++ )
+        _tri_order[i][j].clear();
 
     _triangles.clear();
     _edges.clear();
+    _triangle_arena.release();
+    _edge_arena.release();
 
   _vorpnts.clear();
   _voredges.clear();
@@ -430,68 +1091,117 @@ namespace GMlib {
   }
 
 
+  /** void TriangleFacets<T>::computeNormals()
+   *  \brief The normal of each vertex, as the mean of the normals of its triangles
+   *
+   *  The normals of the triangles, of length twice their area, are computed
+   *  once, in parallel. Then each vertex gathers those of its triangles, also
+   *  in parallel, taking each triangle from the first of its edges at the
+   *  vertex only, so that no vertex is written by more than one thread.
+   */
   template <typename T>
   void TriangleFacets<T>::computeNormals() {
 
-    for( int i = 0; i < this->getSize(); i++ )
-      (*this)[i]._computeNormal();
+    parallelFor( 0, _triangles.getSize(), [this]( int b, int e ) {
+      for( int i = b; i < e; i++ ) {
+
+        TSTriangle<T>* t = _triangles(i);
+        const Point<T,3> p0 = t->_edge[2]->getCommonVertex( *t->_edge[0] )->getPosition();
+        const Point<T,3> p1 = t->_edge[0]->getCommonVertex( *t->_edge[1] )->getPosition();
+        const Point<T,3> p2 = t->_edge[1]->getCommonVertex( *t->_edge[2] )->getPosition();
+
+        Vector<T,3> a = p1 - p0;
+        Vector<T,3> c = p2 - p0;
+        t->_nor = a^c;
+      }
+    }, 1024 );
+
+    parallelFor( 0, this->getSize(), [this]( int b, int e ) {
+      for( int i = b; i < e; i++ ) {
+
+        TSVertex<T>& v = (*this)[i];
+
+        Vector<T,3> nor(T(0));
+        int         n = 0;
+        for( int j = 0; j < v._edges.getSize(); j++ ) {
+
+          TSEdge<T>* edge = v._edges(j);
+          for( int k = 0; k < 2; k++ ) {
+
+            TSTriangle<T>* t = edge->_triangle[k];
+            if( !t ) continue;
+
+            int m = 0;
+            while( t->_edge[m]->_vertex[0] != &v && t->_edge[m]->_vertex[1] != &v ) m++;
+            if( t->_edge[m] != edge ) continue;
+
+            nor += t->_nor;
+            n++;
+          }
+        }
+        if( n ) nor /= T(n);
+
+        v.setDir( nor );
+      }
+    }, 1024 );
   }
 
 
+  /** void TriangleFacets<T>::createVoronoi()
+   *  \brief The Voronoi diagram, as the dual of the triangulation
+   *
+   *  The Voronoi points are the circumcenters of the triangles, in the order
+   *  of the triangles, and there is one Voronoi edge for each edge between
+   *  two triangles, in the order of the edges. Both are computed in parallel
+   *  into arrays that are sized first.
+   */
   template <typename T>
-  inline
   void TriangleFacets<T>::createVoronoi() {
 
-    for (int i=0; i<_triangles.size(); i++) {
-      Point<T,2> c;
+    const int nt = _triangles.getSize();
+    _vorpnts.setSize( nt );
 
-      Array<TSVertex<T> *> v = _triangles(i)->getVertices();
+    parallelFor( 0, nt, [this]( int begin, int end ) {
+      for( int i = begin; i < end; i++ ) {
 
-      Point<T,2> p1 = Point<T,2>(v(0)->getPosition());
-      Point<T,2> p2 = Point<T,2>(v(1)->getPosition());
-      Point<T,2> p3 = Point<T,2>(v(2)->getPosition());
+        TSTriangle<T>* t = _triangles(i);
 
-      T b1 = p1*p1;
-      T b2 = p2*p2;
-      T b3 = p3*p3;
+        Point<T,2> p1 = Point<T,2>(t->_edge[2]->getCommonVertex( *t->_edge[0] )->getPosition());
+        Point<T,2> p2 = Point<T,2>(t->_edge[0]->getCommonVertex( *t->_edge[1] )->getPosition());
+        Point<T,2> p3 = Point<T,2>(t->_edge[1]->getCommonVertex( *t->_edge[2] )->getPosition());
 
-      Point<T,2> b(b2-b1,b3-b2);
-      Point<T,2> a1 = p2 - p1;
-      Point<T,2> a2 = p3 - p2;
+        T b1 = p1*p1;
+        T b2 = p2*p2;
+        T b3 = p3*p3;
 
-          c = (0.5/(a1^a2))*
-            Point<T,2>(Point<T,2>(a2[1],-a1[1])*b,Point<T,2>(-a2[0],a1[0])*b);
-      _triangles(i)->_vorpnt = c;
-    }
+        Point<T,2> b(b2-b1,b3-b2);
+        Point<T,2> a1 = p2 - p1;
+        Point<T,2> a2 = p3 - p2;
 
-    int k = 0;
-    for (int i=0; i<_triangles.size(); i++) {
-      for (int j=0; j<_triangles(i)->getEdges().size(); j++) {
-        Array<TSTriangle<T> *> tt = _triangles(i)->getEdges()(j)->getTriangle();
-
-        if (tt.size() > 1) {
-          if (tt[0] == _triangles[i]) k=1; else k=0;
-          //int m = _triangles.getIndex(tt[k]);
-         // std::cout << "triangle found: " << m << "--" << i << std::endl;
-          //if (m!=-1)
-
-          //_voredges.insert(TSVEdge<T>(_vorpnts(i),_vorpnts(m)));
-          _voredges.insert(TSVEdge<T>(_triangles(i)->_vorpnt,tt[k]->_vorpnt));
-        } else {
-          // insert a voronoi edge splitting boundary edge
-          /*
-          Point<T,2> p = _triangles(i)->getEdges()(j)->getCenterPos2D();
-          T length = max(T(1),T(2)*(p-_vorpnts(i)).getLength());
-        //  int res = _triangles(i)->isAround(new TSVertex<T>(_vorpnts(i)));
-          if ((_vorpnts(i)-p).getLength() > T(0)) {
-            p = (p-_vorpnts(i))*length+_vorpnts(i);
-         // else p = length*(_vorpnts(i)-_triangles(i)->getCenterPos2D())+_vorpnts(i);
-            _voredges.insert(TSVEdge<T>(_vorpnts(i),p));
-          }
-          */
-        }
+        Point<T,2> c = (0.5/(a1^a2))*
+              Point<T,2>(Point<T,2>(a2[1],-a1[1])*b,Point<T,2>(-a2[0],a1[0])*b);
+        t->_vorpnt  = c;
+        _vorpnts[i] = c;
       }
-    }
+    }, 1024 );
+
+    // The edges between two triangles, counted before they are made
+    const int ne = _edges.getSize();
+    std::vector<int> first( ne+1, 0 );
+
+    parallelFor( 0, ne, [this,&first]( int b, int e ) {
+      for( int i = b; i < e; i++ )
+        first[i+1] = _edges(i)->_triangle[0] && _edges(i)->_triangle[1] ? 1 : 0;
+    }, 4096 );
+    std::partial_sum( first.begin(), first.end(), first.begin() );
+
+    _voredges.setSize( first[ne] );
+
+    parallelFor( 0, ne, [this,&first]( int b, int e ) {
+      for( int i = b; i < e; i++ )
+        if( first[i+1] > first[i] )
+          _voredges[first[i]] = TSVEdge<T>( _edges(i)->_triangle[0]->_vorpnt, _edges(i)->_triangle[1]->_vorpnt );
+    }, 4096 );
 
     // Ikke fungerende versjon
     //std::cout << "tiles: " << _tmptiles.size() << std::endl;
@@ -503,6 +1213,34 @@ namespace GMlib {
   }
 
 
+  /** void TriangleFacets<T>::disableParallelTriangulation()
+   *  \brief triangulateDelaunay() triangulates all vertices in one piece
+   */
+  template <typename T>
+  inline
+  void TriangleFacets<T>::disableParallelTriangulation() {
+
+    _partitions = -1;
+  }
+
+
+  /** void TriangleFacets<T>::enableParallelTriangulation( int partitions )
+   *  \brief triangulateDelaunay() triangulates strips of the vertices at the same time
+   *
+   *  The vertices are split in partitions strips along the x-axis, or one
+   *  strip per thread if partitions is 0, and the strips are merged along
+   *  their borders. The triangulation is the same as the one made in one
+   *  piece, but where vertices are cocircular. The bulk argument of
+   *  triangulateDelaunay() is not used.
+   */
+  template <typename T>
+  inline
+  void TriangleFacets<T>::enableParallelTriangulation( int partitions ) {
+
+    _partitions = partitions > 0 ? partitions : 0;
+  }
+
+
   template <typename T>
   inline
   Box<T,3> TriangleFacets<T>::getBoundBox() const	{
@@ -678,7 +1416,7 @@ namespace GMlib {
 
     if (i<0) {
 
-      insertAlways(v);
+      this->insertAlways(v);
       i = this->getSize()-1;
     }
     else
@@ -700,6 +1438,14 @@ namespace GMlib {
   }
 
 
+  template <typename T>
+  inline
+  bool TriangleFacets<T>::isParallelTriangulation() const {
+
+    return _partitions >= 0;
+  }
+
+
 
   template <typename T>
   bool TriangleFacets<T>::removeVertex( TSVertex<T>& v ) {
@@ -832,8 +1578,18 @@ namespace GMlib {
   }
 
 
+  /** void TriangleFacets<T>::triangulateDelaunay( bool bulk )
+   *  \brief Computes the Delaunay triangulation of the vertices
+   *
+   *  With bulk, the vertices are inserted in a spatially sorted order
+   *  (see _insertionOrder()) and located by walking from the previous one.
+   *  The search grid used by evalZ() and insertVertex() is then built once
+   *  at the end, instead of being kept up to date for every new triangle.
+   *  The result may differ from an insertion in input order only where
+   *  vertices are cocircular.
+   */
   template <typename T>
-  void TriangleFacets<T>::triangulateDelaunay() {
+  void TriangleFacets<T>::triangulateDelaunay( bool bulk ) {
 
     __e.set( *this );
 
@@ -856,6 +1612,16 @@ namespace GMlib {
     for (i=1; i<vertex.getSize(); i++)
       _box += vertex[i].getPosition();
 
+    if( _partitions >= 0 ) {
+      _triangulateParallel();
+      _fillConvexHull();
+      return;
+    }
+
+    std::vector<int> order;
+    if( bulk )
+      _insertionOrder( order );
+
     double dx	  = _box.getValueDelta(0);
     double dy	  = _box.getValueDelta(1);
     double delta  = dx>dy?dx:dy;
@@ -870,13 +1636,13 @@ namespace GMlib {
 
     // Make tree Edges.
 
-    _edges += new TSEdge<T>(vertex[vertex.getSize()-3], vertex[vertex.getSize()-2]);
-    _edges += new TSEdge<T>(vertex[vertex.getSize()-2], vertex[vertex.getSize()-1]);
-    _edges += new TSEdge<T>(vertex[vertex.getSize()-1], vertex[vertex.getSize()-3]);
+    _edges += _newEdge(vertex[vertex.getSize()-3], vertex[vertex.getSize()-2]);
+    _edges += _newEdge(vertex[vertex.getSize()-2], vertex[vertex.getSize()-1]);
+    _edges += _newEdge(vertex[vertex.getSize()-1], vertex[vertex.getSize()-3]);
 
     // Make a triangle.
 
-    _triangles += new TSTriangle<T>(_edges[0],_edges[1],_edges[2]);
+    _triangles += _newTriangle(_edges[0],_edges[1],_edges[2]);
 
     _edges[0]->_setTriangle(_triangles[0],NULL);
     _edges[1]->_setTriangle(_triangles[0],NULL);
@@ -886,32 +1652,13 @@ namespace GMlib {
     // Here we constuct the dervided structure for speeding up the algoritm
     //**********************************************************************
 
-    if(this->getSize() < 200)         _d = 2;
-    else if(this->getSize() < 800)    _d = 3;
-    else if(this->getSize() < 3200)   _d = 4;
-    else if(this->getSize() < 12800)  _d = 5;
-    else if(this->getSize() < 51200)  _d = 6;
-    else if(this->getSize() < 204800) _d = 7;
-    else                              _d = 8;
+    _initTriOrder();
 
     int n = 1 << _d;
 
-    _tri_order.setDim(n,n);
-    _u.setMaxSize(n+1);
-    _v.setMaxSize(n+1);
-
-    for(i=0; i<= n; i++)
-    {
-      _u += _box.getValueMin(0) + i*_box.getValueDelta(0)/n;
-      _v += _box.getValueMin(1) + i*_box.getValueDelta(1)/n;
-    }
-
     for(i=0; i< n; i++)
       for(j=0; j< n; j++)
-      {
-        _tri_order[i][j].setMaxSize(20);//,10);
         _tri_order[i][j] += _triangles[0];
-      }
 
     //*****************************************************
     // End dervided structure for speeding up the algoritm
@@ -922,61 +1669,40 @@ namespace GMlib {
     // and the two neighbour triangles, or if the vertex is inside one triangle
     // split the triangle into tree treangles.
 
-    for ( i = 0; i < vertex.getSize()-3; i++ ) _set(i);
+    if( bulk ) {
 
-    // remove constructed outer triangles
+      _bulk = true;
+      _last = 0x0;
+      for ( i = 0; i < int(order.size()); i++ ) _set(order[i]);
 
-    _removeLastVertex();
-    _removeLastVertex();
-    _removeLastVertex();
+      // remove constructed outer triangles
 
-    // Insert Edges and Triangles to make a convecs boundary
+      _removeLastVertex();
+      _removeLastVertex();
+      _removeLastVertex();
 
-    int n_bound=0;
-    for(i=0; i< _edges.getSize(); i++)
-      if(_edges[i]->boundary())
-      {
-        n_bound++;
-        TSTriangle<T>* t = _edges[i]->_getOther(NULL);
-        if (t) {
-          t->_reverse(_edges[i]);
-          Array<TSEdge<T>*> edges = t->getEdges();
-          if( _edges[i]->_isFirst( _edges[i]->getCommonVertex(*edges[1]) ) )
-            _edges[i]->_reverse();
-        }
-      }
+      _compact();
+      _bulk = false;
 
-    for(i=0; i< _edges.getSize(); i++)
-      if( _edges[i]->boundary() )
-        break;
+      for(i=0; i< n; i++)
+        for(j=0; j< n; j++)
+          _tri_order[i][j].resetSize();
 
-    TSEdge<T> *a = _edges[i];
-    TSEdge<T> *b = a->_getNext();
+      for(i=0; i< _triangles.getSize(); i++)
+        _insertTriOrder(_triangles[i]);
+    }
+    else {
 
+      for ( i = 0; i < vertex.getSize()-3; i++ ) _set(i);
 
-    for(i=0; i<n_bound;i++)
-    {
-      Vector<T,2>		v = a->getVector2D();
-      UnitVector<T,2>	u = v + b->getVector2D();
-      if((u^v) > POS_TOLERANCE) {
+      // remove constructed outer triangles
 
-        TSEdge<T> *ne = new TSEdge<T>(*(a->getFirstVertex()),*(b->getLastVertex()));
-        TSTriangle<T> *nt = new TSTriangle<T>(ne,b,a);
-        a->_swapTriangle(NULL,nt);
-        b->_swapTriangle(NULL,nt);
-        ne->_setTriangle(nt,NULL);
-        _edges += ne;
-        _insertTriangle(nt);
-        a = ne;
-        b = a->_getNext();
-        i--;
-      }
-      else
-      {
-        a = b;
-        b = a->_getNext();
-      }
+      _removeLastVertex();
+      _removeLastVertex();
+      _removeLastVertex();
     }
+
+    _fillConvexHull();
   }
 
 
@@ -1081,6 +1807,12 @@ namespace GMlib {
     if( _tf_visualizers.exist( visu ) )
       return;
 
+    // Made with the first visualizer, the facets itself needs no GL context
+    if( !_vbo ) {
+      glGenBuffers( 1, &_vbo );
+      glGenBuffers( 1, &_ibo );
+    }
+
     _tf_visualizers += visu;
   }
 
@@ -1108,7 +1840,23 @@ namespace GMlib {
   inline
   void TriangleSystem<T>::adjust( TSTriangle<T> *t, bool wider )	{
 
-    _tv->_adjustTriangle(t,wider);
+    t->_facets->_adjustTriangle(t,wider);
+  }
+
+
+  template <typename T>
+  inline
+  void TriangleSystem<T>::deleteEdge( TSEdge<T> *e ) {
+
+    e->_facets->_deleteEdge(e);
+  }
+
+
+  template <typename T>
+  inline
+  void TriangleSystem<T>::deleteTriangle( TSTriangle<T> *t ) {
+
+    t->_facets->_deleteTriangle(t);
   }
 
 
@@ -1140,7 +1888,7 @@ namespace GMlib {
   inline
   void TriangleSystem<T>::insert( TSEdge<T> *e ) {
 
-    (_tv->_getEdges()) += e;
+    (e->_facets->_getEdges()) += e;
   }
 
 
@@ -1148,7 +1896,23 @@ namespace GMlib {
   inline
   void TriangleSystem<T>::insert( TSTriangle<T> *t) {
 
-    _tv->_insertTriangle(t);
+    t->_facets->_insertTriangle(t);
+  }
+
+
+  template <typename T>
+  inline
+  TSEdge<T>* TriangleSystem<T>::newEdge( TriangleFacets<T>& tf, TSVertex<T>& s, TSVertex<T>& e ) {
+
+    return tf._newEdge(s,e);
+  }
+
+
+  template <typename T>
+  inline
+  TSTriangle<T>* TriangleSystem<T>::newTriangle( TriangleFacets<T>& tf, TSEdge<T>* e1, TSEdge<T>* e2, TSEdge<T>* e3 ) {
+
+    return tf._newTriangle(e1,e2,e3);
   }
 
 
@@ -1156,7 +1920,7 @@ namespace GMlib {
   inline
   void TriangleSystem<T>::remove( TSEdge<T> *e) {
 
-    (_tv->_getEdges()).remove(e);
+    e->_facets->_removeEdge(e);
   }
 
 
@@ -1164,7 +1928,7 @@ namespace GMlib {
   inline
   void TriangleSystem<T>::remove( TSTriangle<T> *t) {
 
-    _tv->_removeTriangle(t);
+    t->_facets->_removeTriangle(t);
   }
 
 
@@ -1245,7 +2009,7 @@ namespace GMlib {
   void TSVertex<T>::_deleteEdges() {
 
     while( _edges.getSize() > 0 )
-      delete _edges[0];
+      this->deleteEdge( _edges[0] );
 
     _edges.clear();
   }
@@ -1564,6 +2328,7 @@ namespace GMlib {
     _vertex[0] = _vertex[1] = NULL;
     _triangle[0] = _triangle[1] = NULL;
     _const = false;
+    _facets = NULL;
   }
 
 
@@ -1574,6 +2339,7 @@ namespace GMlib {
     _vertex[0] = &s;
     _vertex[1] = &e;
     _const = false;
+    _facets = NULL;
     _upv();
   }
 
@@ -1588,6 +2354,7 @@ namespace GMlib {
     }
 
     _const = e._const;
+    _facets = NULL;
     _upv();
   }
 
@@ -1595,12 +2362,12 @@ namespace GMlib {
   template <typename T>
   TSEdge<T>::~TSEdge() {
 
-    if( _triangle[0] != NULL )  delete _triangle[0];
-    if( _triangle[1] != NULL )  delete _triangle[1];
+    if( _triangle[0] != NULL )  this->deleteTriangle( _triangle[0] );
+    if( _triangle[1] != NULL )  this->deleteTriangle( _triangle[1] );
     if( _vertex[0] != NULL )  _vertex[0]->_removeEdge(this);
     if( _vertex[1] != NULL )  _vertex[1]->_removeEdge(this);
 
-    this->remove(this);
+    if( _facets != NULL )  this->remove(this);
   }
 
 
@@ -1673,14 +2440,30 @@ namespace GMlib {
     a.remove( _vertex[1] );
 
     Point<T,2> pt = a[0]->getParameter();
+    Point<T,2> q  = a[1]->getParameter();
+    Point<T,2> v0 = _vertex[0]->getParameter();
+    Point<T,2> v1 = _vertex[1]->getParameter();
+
+    // The new diagonal must cross this edge, a swap in a quadrilateral that
+    // is not convex would fold the two triangles over each other
+    const double o0 = double(q[0]-pt[0]) * double(v0[1]-pt[1]) - double(q[1]-pt[1]) * double(v0[0]-pt[0]);
+    const double o1 = double(q[0]-pt[0]) * double(v1[1]-pt[1]) - double(q[1]-pt[1]) * double(v1[0]-pt[0]);
+    if( !( o0 * o1 < 0.0 ) )
+      return;
+
+    // pt inside the circle through v0, q and v1, by more than the rounding
+    const double adx = double(v0[0]) - pt[0], ady = double(v0[1]) - pt[1];
+    const double bdx = double(q[0])  - pt[0], bdy = double(q[1])  - pt[1];
+    const double cdx = double(v1[0]) - pt[0], cdy = double(v1[1]) - pt[1];
+    const double a2 = adx*adx + ady*ady, b2 = bdx*bdx + bdy*bdy, c2 = cdx*cdx + cdy*cdy;
+    const double det = a2 * ( bdx*cdy - cdx*bdy ) + b2 * ( cdx*ady - adx*cdy ) + c2 * ( adx*bdy - bdx*ady );
+    const double per = a2 * ( std::fabs(bdx*cdy) + std::fabs(cdx*bdy) )
+                     + b2 * ( std::fabs(cdx*ady) + std::fabs(adx*cdy) )
+                     + c2 * ( std::fabs(adx*bdy) + std::fabs(bdx*ady) );
+    const double o = double(q[0]-v0[0]) * double(v1[1]-v0[1]) - double(q[1]-v0[1]) * double(v1[0]-v0[0]);
 
-    if(
-      pt.isInsideCircle(
-        _vertex[0]->getParameter(),
-        a[1]->getParameter(),
-        _vertex[1]->getParameter()
-      ) == 1
-    )	this->_swap();
+    if( ( o > 0.0 ? det : -det ) > 1e-12 * per )
+      this->_swap();
   }
 
 
@@ -1772,7 +2555,7 @@ namespace GMlib {
 
     // Splitt edge in two
     TSEdge<T>* e1 = this;
-    TSEdge<T>* e2 = new TSEdge<T>(*(_vertex[1]),p);
+    TSEdge<T>* e2 = this->newEdge(*_facets,*(_vertex[1]),p);
     _vertex[1]->_removeEdge(this);
     _vertex[1] = &p;
     p._insertEdge(this);
@@ -1783,9 +2566,9 @@ namespace GMlib {
     if( _triangle[0] != NULL ) {
 
       v = edg1[1]->getCommonVertex(*(edg1[2]));
-      e = new TSEdge<T>(p,*v);
+      e = this->newEdge(*_facets,p,*v);
 
-      t1 = new TSTriangle<T>( e2, edg1[1], e );
+      t1 = this->newTriangle( *_facets, e2, edg1[1], e );
       _triangle[0]->_setEdges( e1, e, edg1[2] );
       e->_setTriangle( t1, _triangle[0] );
       edg1[1]->_swapTriangle( _triangle[0], t1 );
@@ -1800,9 +2583,9 @@ namespace GMlib {
     if( _triangle[1] != NULL ) {
 
       v = edg2[1]->getCommonVertex(*(edg2[2]));
-      e = new TSEdge<T>(p,*v);
+      e = this->newEdge(*_facets,p,*v);
 
-      t2 = new TSTriangle<T>(e2,e,edg2[2]);
+      t2 = this->newTriangle(*_facets,e2,e,edg2[2]);
       _triangle[1]->_setEdges(e1,edg2[1],e);
       e->_setTriangle(t2,_triangle[1]);
 
@@ -2159,6 +2942,7 @@ namespace GMlib {
     _edge[0] = NULL;
     _edge[1] = NULL;
     _edge[2] = NULL;
+    _facets  = NULL;
   }
 
 
@@ -2169,6 +2953,7 @@ namespace GMlib {
     _edge[0] = e1;
     _edge[1] = e2;
     _edge[2] = e3;
+    _facets  = NULL;
   }
 
 
@@ -2178,6 +2963,7 @@ namespace GMlib {
 
     for( int i = 0; i < 3; ++i )
       _edge[i]  = t._edge[i];
+    _facets = NULL;
   }
 
 
@@ -2194,7 +2980,8 @@ namespace GMlib {
       if( _edge[2] )
         _edge[2]->_removeTriangle( this );
 
-      this->remove(this);
+      if( _facets )
+        this->remove(this);
     }
   }
 
@@ -2323,12 +3110,12 @@ namespace GMlib {
   template <typename T>
   bool TSTriangle<T>::_split( TSVertex<T>& p ) {
 
-    TSEdge<T>* edg1 = new TSEdge<T>(p,*(_edge[0]->getCommonVertex(*(_edge[1]))));
-    TSEdge<T>* edg2 = new TSEdge<T>(p,*(_edge[1]->getCommonVertex(*(_edge[2]))));
-    TSEdge<T>* edg3 = new TSEdge<T>(p,*(_edge[2]->getCommonVertex(*(_edge[0]))));
+    TSEdge<T>* edg1 = this->newEdge(*_facets,p,*(_edge[0]->getCommonVertex(*(_edge[1]))));
+    TSEdge<T>* edg2 = this->newEdge(*_facets,p,*(_edge[1]->getCommonVertex(*(_edge[2]))));
+    TSEdge<T>* edg3 = this->newEdge(*_facets,p,*(_edge[2]->getCommonVertex(*(_edge[0]))));
 
-    TSTriangle<T>* t2 = new TSTriangle<T>( edg1, _edge[1], edg2 );
-    TSTriangle<T>* t3 = new TSTriangle<T>( edg2, _edge[2], edg3 );
+    TSTriangle<T>* t2 = this->newTriangle( *_facets, edg1, _edge[1], edg2 );
+    TSTriangle<T>* t3 = this->newTriangle( *_facets, edg2, _edge[2], edg3 );
 
     edg1->_setTriangle( this, t2 );
     edg2->_setTriangle( t2, t3 );
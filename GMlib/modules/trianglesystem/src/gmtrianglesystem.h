@@ -36,6 +36,14 @@
 #include <core/containers/gmarraylx.h>
 #include <core/containers/gmdmatrix.h>
 #include <scene/gmsceneobject.h>
+#include "gmtsdelaunay.h"
+#include "gmtsmesh.h"
+#include "gmtssimplifier.h"
+
+// stl
+#include <cstddef>
+#include <memory>
+#include <vector>
 
 
 namespace GMlib {
@@ -76,6 +84,49 @@ namespace GMlib {
   class TSVEdge;
 
 
+
+  /** \class  TSArena gmtrianglesystem.h <gmTriangleSystem>
+   *  \brief  Block storage for the edges and triangles of a TriangleFacets
+   *
+   *  Elements are made in blocks of fixed size and never moved, so pointers
+   *  to them are valid until they are destroyed. The memory of destroyed
+   *  elements is kept in a free list and used again. release() drops all
+   *  blocks at once without running any destructors, for elements that only
+   *  unlink themselves from each other when destroyed.
+   *
+   *  A copy of an arena is empty, it does not own the elements of the original.
+   */
+  template <typename E>
+  class TSArena {
+  public:
+    TSArena();
+    TSArena( const TSArena<E>& );
+    ~TSArena();
+
+    template <typename... Args>
+    E*                      create( Args&&... args );
+    void                    destroy( E* e );
+    int                     getSize() const;
+    void                    release();
+
+    TSArena<E>&             operator = ( const TSArena<E>& );
+
+  private:
+    union Slot {
+      Slot*                 next;
+      alignas(E) unsigned char data[sizeof(E)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>>  _blocks;
+    Slot*                   _free;      //!< Destroyed elements
+    int                     _used;      //!< Slots used in the last block
+    int                     _size;      //!< Live elements
+
+    static const int        _block_size = 4096;
+  };
+
+
+
   /** \class  TriangleFacets gmtrianglesystem.h <gmTriangleSystem>
    *  \brief  The storage class of the Triangle system
    *
@@ -98,13 +149,16 @@ namespace GMlib {
     Point<T,3>                        eval(const Point<T,2>& p, int deg=1) const;
 
 
-    T                                 evalZ(const Point<T,2>&, int deg=1); //const
-    T                                 evalZ(T x, T y, int deg=1);
+    T                                 evalZ(const Point<T,2>&, int deg=1) const;
+    T                                 evalZ(T x, T y, int deg=1) const;
+    void                              evalZBatch( const Point<T,2>* p, T* z, size_t n, int deg = 1 ) const;
 
     void                              clear(int d=-1);
     void                              computeNormals();
 
     void                              createVoronoi();
+    void                              disableParallelTriangulation();
+    void                              enableParallelTriangulation( int partitions = 0 );
     Box<T,3>                          getBoundBox() const;
 
     TSEdge<T>*                        getEdge(int i) const;
@@ -120,6 +174,7 @@ namespace GMlib {
 
     void                              insertLine( TSLine<T>& );
     bool                              insertVertex( TSVertex<T>&, bool c = false );
+    bool                              isParallelTriangulation() const;
     bool                              removeVertex( TSVertex<T>& v );
     bool                              removeVertexNew( TSVertex<T>& v);
 
@@ -128,7 +183,7 @@ namespace GMlib {
 
     bool                              setConstEdge(TSVertex<T> v1, TSVertex<T> v2);
 
-    void                              triangulateDelaunay();
+    void                              triangulateDelaunay( bool bulk = false );
 
 
     void                              enableDefaultVisualizer( bool enable = true );
@@ -138,7 +193,7 @@ namespace GMlib {
 
    protected:
     int	                              _dlist_name;
-    GLuint                            _vbo;
+    GLuint                            _vbo;       //!< Made by the first insertVisualizer(), else 0
     GLuint                            _ibo;
 
     mutable Array< TriangleFacetsVisualizer<T>*>  _tf_visualizers;
@@ -152,29 +207,53 @@ namespace GMlib {
     Array<Point<T,2> >                _vorpnts;
 
     int                               _d;
+    bool                              _bulk;      //!< Inserting by triangulateDelaunay(true)
+    TSTriangle<T>*                    _last;      //!< Last triangle found by _walkToTriangle()
+    int                               _partitions;        //!< Strips of triangulateDelaunay(), 0 for one per thread, -1 for serial
+    std::vector<TSEdge<T>*>           _removed_edges;     //!< Removed while _bulk, see _compact()
+    std::vector<TSTriangle<T>*>       _removed_triangles; //!< Removed while _bulk, see _compact()
 
     DMatrix<ArrayT<TSTriangle<T>*> >  _tri_order;
     ArrayT<T>                         _u;
     ArrayT<T>                         _v;
     Box<T,3>                          _box;
 
+    TSArena< TSEdge<T> >              _edge_arena;
+    TSArena< TSTriangle<T> >          _triangle_arena;
+
     TSVertex<T>                       __v;  // dummy because of MS-VC++ compiler
     TSEdge<T>                         __e;  // dummy because of MS-VC++ compiler
     TSTriangle<T>                     __t;  // dummy because of MS-VC++ compiler
 
+    void                              _compact();
+    void                              _fillConvexHull();
     bool                              _fillPolygon(Array<TSEdge<T>*>&);
+    void                              _getCell( const Point<T,2>& p, int& i, int& j ) const;
+    void                              _initTriOrder();
+    void                              _insertionOrder( std::vector<int>& order ) const;
+    void                              _insertTriOrder( TSTriangle<T>* t );
     bool                              _removeLastVertex();
     void                              _set(int i);
-    int                               _surroundingTriangle(TSTriangle<T>*&, const TSVertex<T>&);// const;
+    void                              _setTriangles( const std::vector<int>& tri );
+    int                               _surroundingTriangle(TSTriangle<T>*&, const TSVertex<T>&) const;
+    void                              _triangulateParallel();
+    bool                              _walk( TSTriangle<T>*& t, const Point<T,2>& p ) const;
+    int                               _walkToTriangle( TSTriangle<T>*&, const TSVertex<T>& );
 
 
   friend class TriangleSystem<T>;
+  friend class TSMesh<T>;
   private:
     void                              _adjustTriangle( TSTriangle<T>*, bool wider = false );
+    void                              _deleteEdge( TSEdge<T>* e );
+    void                              _deleteTriangle( TSTriangle<T>* t );
     ArrayLX<TSEdge<T>* >&             _getEdges();
     TSVertex<T>*                      _find( const Point<T,3>& ) const;
     TSEdge<T>*                        _find( const Point<T,3>&, const Point<T,3>& ) const;
     void                              _insertTriangle( TSTriangle<T>* );
+    TSEdge<T>*                        _newEdge( TSVertex<T>& s, TSVertex<T>& e );
+    TSTriangle<T>*                    _newTriangle( TSEdge<T>* e1, TSEdge<T>* e2, TSEdge<T>* e3 );
+    void                              _removeEdge( TSEdge<T>* );
     void                              _removeTriangle( TSTriangle<T>* );
     ArrayLX<TSTriangle<T>* >&         _triangle();
 
@@ -216,7 +295,9 @@ namespace GMlib {
   /** \class TriangleSystem gmtrianglesystem.h <gmTriangleSystem>
    *  \brief The TriangleSystem base class
    *
-   *  The base class for vertices, edges and triangles
+   *  The base class for vertices, edges and triangles. Edges and triangles
+   *  are made, linked and destroyed through the facets owning them, set()
+   *  only gives the facets searched by find().
    */
   template <typename T>
   class TriangleSystem {
@@ -225,6 +306,8 @@ namespace GMlib {
 
   protected:
     void                        adjust( TSTriangle<T> *t, bool wider = false );
+    void                        deleteEdge( TSEdge<T> *e );
+    void                        deleteTriangle( TSTriangle<T> *t );
     TSVertex<T>*                find( const Point<T,3>& p ) const;
     TSEdge<T>*                  find( const Point<T,3>& p1, const Point<T,3>& p2 );
 
@@ -232,12 +315,14 @@ namespace GMlib {
 
     void                        insert( TSEdge<T> *e );
     void                        insert( TSTriangle<T> *t );
+    TSEdge<T>*                  newEdge( TriangleFacets<T>& tf, TSVertex<T>& s, TSVertex<T>& e );
+    TSTriangle<T>*              newTriangle( TriangleFacets<T>& tf, TSEdge<T>* e1, TSEdge<T>* e2, TSEdge<T>* e3 );
     void                        remove( TSEdge<T> *e );
     void                        remove( TSTriangle<T> *t );
 
 
   private:
-    static TriangleFacets<T>    *_tv;
+    static TriangleFacets<T>    *_tv;     //!< Searched by find()
   };
 
   /** \class VEdge
@@ -385,6 +470,7 @@ namespace GMlib {
     TSVertex<T>             *_vertex[2];
     TSTriangle<T>           *_triangle[2];
     bool                    _const;
+    TriangleFacets<T>       *_facets;   //!< Owner of the edge, set by newEdge()
 
     bool                    _swap();
     void                    _upv();
@@ -392,6 +478,7 @@ namespace GMlib {
 
   friend class TSTriangle<T>;
   friend class TriangleFacets<T>;
+  friend class TriangleSystem<T>;
   private:
 
     TSEdge<T>*              _getNext();
@@ -462,12 +549,16 @@ namespace GMlib {
   private:
     TSEdge<T>              *_edge[3];
     Box<unsigned char,2>    _box;
+    TriangleFacets<T>      *_facets;    //!< Owner of the triangle, set by newTriangle()
 
 
 
   friend class TSEdge<T>;
   friend class TriangleFacets<T>;
+  friend class TriangleSystem<T>;
+  friend class TSMesh<T>;
     Point<T,2>              _vorpnt;
+    Vector<T,3>             _nor;       //!< The normal, by TriangleFacets::computeNormals()
   private:
 
     T                       _evalZ( const Point<T,2>& p, int deg = 1 ) const;
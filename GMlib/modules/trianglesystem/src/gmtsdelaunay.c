@@ -0,0 +1,567 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+// stl
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+
+
+namespace GMlib {
+
+
+
+  template <typename T>
+  inline
+  TSDelaunay<T>::TSDelaunay( const std::vector< Point<T,2> >& p ) : _p(p), _last(0), _rnd(1) {}
+
+
+  /** void TSDelaunay<T>::getTriangles( std::vector<int>& tri ) const
+   *  \brief Appends the vertices of the triangles that are not outer or removed
+   *
+   *  Three point indices for each triangle, in counterclockwise order.
+   */
+  template <typename T>
+  void TSDelaunay<T>::getTriangles( std::vector<int>& tri ) const {
+
+    const int nt = int( _tri.size() / 3 );
+    for( int t = 0; t < nt; t++ )
+      if( !_isOuter(t) && ( _removed.empty() || !_removed[t] ) )
+        tri.insert( tri.end(), _tri.begin() + 3*t, _tri.begin() + 3*t+3 );
+  }
+
+
+  /** void TSDelaunay<T>::insertionOrder( const std::vector< Point<T,2> >& p, std::vector<int>& ids )
+   *  \brief Sorts the point indices in an order suited for insertion
+   *
+   *  A biased randomized insertion order (BRIO): the points are shuffled
+   *  with a fixed seed and split in rounds of doubling size, and each round
+   *  is sorted along a Hilbert curve over the bounding box. Consecutive
+   *  points are then close, and the random rounds keep the expected
+   *  number of swaps of a randomized insertion.
+   */
+  template <typename T>
+  void TSDelaunay<T>::insertionOrder( const std::vector< Point<T,2> >& p, std::vector<int>& ids ) {
+
+    const int n = int( ids.size() );
+    if( n == 0 ) return;
+
+    std::mt19937 rng( 1 );
+    std::shuffle( ids.begin(), ids.end(), rng );
+
+    double x0 = p[ids[0]][0], x1 = x0;
+    double y0 = p[ids[0]][1], y1 = y0;
+    for( int i = 1; i < n; i++ ) {
+      x0 = std::min( x0, double(p[ids[i]][0]) );  x1 = std::max( x1, double(p[ids[i]][0]) );
+      y0 = std::min( y0, double(p[ids[i]][1]) );  y1 = std::max( y1, double(p[ids[i]][1]) );
+    }
+
+    // Hilbert index on a 2^16 x 2^16 grid
+    const uint32_t m  = 1u << 16;
+    const double   su = x1 > x0 ? (m-1) / ( x1 - x0 ) : 0.0;
+    const double   sv = y1 > y0 ? (m-1) / ( y1 - y0 ) : 0.0;
+
+    std::vector< std::pair<uint64_t,int> > key( n );
+    for( int i = 0; i < n; i++ ) {
+
+      uint32_t x = uint32_t( ( p[ids[i]][0] - x0 ) * su );
+      uint32_t y = uint32_t( ( p[ids[i]][1] - y0 ) * sv );
+
+      uint64_t d = 0;
+      for( uint32_t s = m >> 1; s > 0; s >>= 1 ) {
+        const uint32_t rx = ( x & s ) > 0;
+        const uint32_t ry = ( y & s ) > 0;
+        d += uint64_t(s) * s * ( ( 3 * rx ) ^ ry );
+        if( ry == 0 ) {
+          if( rx == 1 ) {
+            x = m-1 - x;
+            y = m-1 - y;
+          }
+          std::swap( x, y );
+        }
+      }
+      key[i] = std::make_pair( d, ids[i] );
+    }
+
+    for( int e = n, b; e > 0; e = b ) {
+      b = e > 64 ? e / 2 : 0;
+      std::sort( key.begin() + b, key.begin() + e );
+    }
+
+    for( int i = 0; i < n; i++ )
+      ids[i] = key[i].second;
+  }
+
+
+  /** bool TSDelaunay<T>::removeInside( const std::vector<int>& border )
+   *  \brief Removes the triangles enclosed by the border edges
+   *
+   *  The border is pairs of point indices (a,b), with the region to remove
+   *  to the left of a->b. Triangles are removed from each border edge and
+   *  on through all edges that are not on the border. Returns false, and
+   *  removes nothing, if a border edge is not in the triangulation or the
+   *  border does not close the region off from the outer triangles.
+   */
+  template <typename T>
+  bool TSDelaunay<T>::removeInside( const std::vector<int>& border ) {
+
+    auto key = []( int a, int b ) { return uint64_t(uint32_t(a)) << 32 | uint32_t(b); };
+
+    const int nt = int( _tri.size() / 3 );
+
+    std::vector< std::pair<uint64_t,int> > half;
+    half.reserve( 3*nt );
+    for( int t = 0; t < nt; t++ )
+      for( int k = 0; k < 3; k++ ) {
+        const int a = _tri[3*t+(k+1)%3], b = _tri[3*t+(k+2)%3];
+        if( a >= 0 && b >= 0 )
+          half.push_back( std::make_pair( key( a, b ), t ) );
+      }
+    std::sort( half.begin(), half.end() );
+
+    std::vector<uint64_t> wall;
+    wall.reserve( border.size() / 2 );
+    for( size_t i = 0; i+1 < border.size(); i += 2 )
+      wall.push_back( key( std::min( border[i], border[i+1] ), std::max( border[i], border[i+1] ) ) );
+    std::sort( wall.begin(), wall.end() );
+
+    _removed.assign( nt, 0 );
+    std::vector<int> stack;
+    for( size_t i = 0; i+1 < border.size(); i += 2 ) {
+
+      const uint64_t h = key( border[i], border[i+1] );
+      auto it = std::lower_bound( half.begin(), half.end(), std::make_pair( h, -1 ) );
+      if( it == half.end() || it->first != h ) {
+        _removed.clear();
+        return false;
+      }
+      if( !_removed[it->second] ) {
+        _removed[it->second] = 1;
+        stack.push_back( it->second );
+      }
+    }
+
+    while( !stack.empty() ) {
+
+      const int t = stack.back();
+      stack.pop_back();
+      if( _isOuter(t) ) {
+        _removed.clear();
+        return false;
+      }
+
+      for( int k = 0; k < 3; k++ ) {
+        const int a = _tri[3*t+(k+1)%3], b = _tri[3*t+(k+2)%3];
+        const int u = _nbr[3*t+k];
+        if( u < 0 || _removed[u] ||
+            std::binary_search( wall.begin(), wall.end(), key( std::min( a, b ), std::max( a, b ) ) ) )
+          continue;
+        _removed[u] = 1;
+        stack.push_back( u );
+      }
+    }
+
+    return true;
+  }
+
+
+  /** void TSDelaunay<T>::split( double x0, double x1, std::vector<int>& inner, std::vector<int>& border, std::vector<char>& rest ) const
+   *  \brief Splits the triangles by the slab x0 < x < x1
+   *
+   *  A triangle is inner if its circumcircle lies strictly inside the slab,
+   *  and the opposite vertices of its neighbours are clearly outside of it.
+   *  Inner triangles are then also triangles of the Delaunay triangulation
+   *  with any number of points added outside the slab, and a rounding error
+   *  in the circle test can not change that.
+   *
+   *  The inner triangles are appended to inner, the edges between them and
+   *  the other triangles are appended to border as pairs (a,b) with the
+   *  inner triangle to the left, and rest[i] is set for the vertices of
+   *  the other triangles.
+   */
+  template <typename T>
+  void TSDelaunay<T>::split( double x0, double x1, std::vector<int>& inner,
+                             std::vector<int>& border, std::vector<char>& rest ) const {
+
+    const int nt = int( _tri.size() / 3 );
+
+    std::vector<char> in( nt, 0 );
+    for( int t = 0; t < nt; t++ ) {
+
+      if( _isOuter(t) ) continue;
+
+      const Point<T,2>& a = _p[_tri[3*t]];
+      const Point<T,2>& b = _p[_tri[3*t+1]];
+      const Point<T,2>& c = _p[_tri[3*t+2]];
+      const double ax = a[0], ay = a[1];
+      const double bx = b[0] - ax, by = b[1] - ay;
+      const double cx = c[0] - ax, cy = c[1] - ay;
+      const double d  = 2.0 * ( bx*cy - by*cx );
+      if( d <= 0.0 ) continue;
+
+      const double b2 = bx*bx + by*by, c2 = cx*cx + cy*cy;
+      const double ux = ( cy*b2 - by*c2 ) / d;
+      const double uy = ( bx*c2 - cx*b2 ) / d;
+      const double r2 = ux*ux + uy*uy;
+      const double r  = std::sqrt( r2 ) * ( 1.0 + 1e-9 );
+      const double mx = ax + ux, my = ay + uy;
+      if( mx - r <= x0 || mx + r >= x1 ) continue;
+
+      bool robust = true;
+      for( int k = 0; k < 3 && robust; k++ ) {
+        const int u = _nbr[3*t+k];
+        if( u < 0 ) continue;
+
+        int j = 0;
+        while( _nbr[3*u+j] != t ) j++;
+        const int q = _tri[3*u+j];
+        if( q < 0 ) continue;
+
+        const double qx = _p[q][0] - mx, qy = _p[q][1] - my;
+        robust = qx*qx + qy*qy > r2 * ( 1.0 + 1e-8 );
+      }
+      in[t] = robust;
+    }
+
+    for( int t = 0; t < nt; t++ ) {
+
+      if( !in[t] ) {
+        for( int k = 0; k < 3; k++ )
+          if( _tri[3*t+k] >= 0 ) rest[_tri[3*t+k]] = 1;
+        continue;
+      }
+
+      inner.insert( inner.end(), _tri.begin() + 3*t, _tri.begin() + 3*t+3 );
+      for( int k = 0; k < 3; k++ ) {
+        const int u = _nbr[3*t+k];
+        if( u < 0 || !in[u] ) {
+          border.push_back( _tri[3*t+(k+1)%3] );
+          border.push_back( _tri[3*t+(k+2)%3] );
+        }
+      }
+    }
+  }
+
+
+  /** bool TSDelaunay<T>::triangulate( const std::vector<int>& ids )
+   *  \brief Computes the Delaunay triangulation of the points ids
+   *
+   *  Returns false, with no triangles, if all the points are on a line.
+   */
+  template <typename T>
+  bool TSDelaunay<T>::triangulate( const std::vector<int>& ids ) {
+
+    _tri.clear();
+    _nbr.clear();
+    _removed.clear();
+    _last = 0;
+    _rnd  = 1;
+
+    std::vector<int> order( ids );
+    insertionOrder( _p, order );
+
+    // The first triangle, from the first points not on a line
+    const int n = int( order.size() );
+    int ib = 1, ic;
+    while( ib < n && _p[order[ib]] == _p[order[0]] ) ib++;
+    for( ic = ib+1; ic < n; ic++ )
+      if( _orient( order[0], order[ib], order[ic] ) != 0.0 ) break;
+    if( ic >= n ) return false;
+
+    int a = order[0], b = order[ib], c = order[ic];
+    if( _orient( a, b, c ) < 0.0 )
+      std::swap( b, c );
+
+    _tri.reserve( 6*n + 6 );
+    _nbr.reserve( 6*n + 6 );
+    _tri.assign( { a, b, c,   c, b, -1,   a, c, -1,   b, a, -1 } );
+    _nbr.assign( { 1, 2, 3,   3, 2, 0,    1, 3, 0,    2, 1, 0 } );
+
+    for( int i = 1; i < n; i++ )
+      if( i != ib && i != ic )
+        _insert( order[i] );
+
+    return true;
+  }
+
+
+  /** bool TSDelaunay<T>::_inCircle( int a, int b, int c, int d ) const
+   *  \brief If d is strictly inside the circumcircle of the counterclockwise triangle a, b, c
+   *
+   *  The circle of an outer triangle is the open half plane outside its
+   *  hull edge, and the part of the hull edge between its end points.
+   */
+  template <typename T>
+  bool TSDelaunay<T>::_inCircle( int a, int b, int c, int d ) const {
+
+    if( d < 0 ) return false;
+
+    if( a < 0 || b < 0 || c < 0 ) {
+
+      const int p = a < 0 ? b : ( b < 0 ? c : a );
+      const int q = a < 0 ? c : ( b < 0 ? a : b );
+      const double o = _orient( p, q, d );
+      if( o != 0.0 ) return o > 0.0;
+
+      const Point<T,2>& pp = _p[p];
+      const Point<T,2>& pq = _p[q];
+      const Point<T,2>& pd = _p[d];
+      return ( double(pd[0]) - pp[0] ) * ( double(pq[0]) - pp[0] ) + ( double(pd[1]) - pp[1] ) * ( double(pq[1]) - pp[1] ) > 0.0 &&
+             ( double(pd[0]) - pq[0] ) * ( double(pp[0]) - pq[0] ) + ( double(pd[1]) - pq[1] ) * ( double(pp[1]) - pq[1] ) > 0.0;
+    }
+
+    const double dx  = _p[d][0], dy = _p[d][1];
+    const double adx = _p[a][0] - dx, ady = _p[a][1] - dy;
+    const double bdx = _p[b][0] - dx, bdy = _p[b][1] - dy;
+    const double cdx = _p[c][0] - dx, cdy = _p[c][1] - dy;
+
+    return ( adx*adx + ady*ady ) * ( bdx*cdy - cdx*bdy )
+         + ( bdx*bdx + bdy*bdy ) * ( cdx*ady - adx*cdy )
+         + ( cdx*cdx + cdy*cdy ) * ( adx*bdy - bdx*ady ) > 0.0;
+  }
+
+
+  /** void TSDelaunay<T>::_insert( int v )
+   *  \brief Splits the triangle, or the two triangles of the edge, that v is in, and swaps to Delaunay
+   *
+   *  A point outside the hull is in an outer triangle, which is then split
+   *  into a triangle with its hull edge and two new outer triangles.
+   */
+  template <typename T>
+  void TSDelaunay<T>::_insert( int v ) {
+
+    int e;
+    const int t = _locate( v, e );
+    if( t < 0 || e == 3 ) return;
+
+    const int nt = int( _tri.size() / 3 );
+
+    if( e < 0 ) {
+
+      const int a  = _tri[3*t],   b  = _tri[3*t+1], c  = _tri[3*t+2];
+      const int na = _nbr[3*t],   nb = _nbr[3*t+1], nc = _nbr[3*t+2];
+      const int t1 = nt, t2 = nt+1;
+
+      const int tri[6] = { v, b, c,   v, c, a };
+      const int nbr[6] = { na, t2, t,   nb, t, t1 };
+      _tri[3*t] = v;   _tri[3*t+1] = a;   _tri[3*t+2] = b;
+      _nbr[3*t] = nc;  _nbr[3*t+1] = t1;  _nbr[3*t+2] = t2;
+      _tri.insert( _tri.end(), tri, tri+6 );
+      _nbr.insert( _nbr.end(), nbr, nbr+6 );
+
+      _link( na, t, t1 );
+      _link( nb, t, t2 );
+
+      _stack.assign( { t, t1, t2 } );
+    }
+    else {
+
+      const int u = _nbr[3*t+e];
+      if( u < 0 ) return;
+
+      const int a  = _tri[3*t+e], b = _tri[3*t+(e+1)%3], c = _tri[3*t+(e+2)%3];
+      const int tb = _nbr[3*t+(e+1)%3], tc = _nbr[3*t+(e+2)%3];
+
+      int j = 0;
+      while( _nbr[3*u+j] != t ) j++;
+      const int d  = _tri[3*u+j];
+      const int uc = _nbr[3*u+(j+1)%3], ub = _nbr[3*u+(j+2)%3];
+      const int t2 = nt, t4 = nt+1;
+
+      const int tri[6] = { v, c, a,   v, b, d };
+      const int nbr[6] = { tb, t, u,   uc, u, t };
+      _tri[3*t] = v;   _tri[3*t+1] = a;   _tri[3*t+2] = b;
+      _nbr[3*t] = tc;  _nbr[3*t+1] = t4;  _nbr[3*t+2] = t2;
+      _tri[3*u] = v;   _tri[3*u+1] = d;   _tri[3*u+2] = c;
+      _nbr[3*u] = ub;  _nbr[3*u+1] = t2;  _nbr[3*u+2] = t4;
+      _tri.insert( _tri.end(), tri, tri+6 );
+      _nbr.insert( _nbr.end(), nbr, nbr+6 );
+
+      _link( tb, t, t2 );
+      _link( uc, u, t4 );
+
+      _stack.assign( { t, t2, u, t4 } );
+    }
+
+    _legalize( _stack );
+    _last = t;
+  }
+
+
+  template <typename T>
+  inline
+  bool TSDelaunay<T>::_isOuter( int t ) const {
+
+    return _tri[3*t] < 0 || _tri[3*t+1] < 0 || _tri[3*t+2] < 0;
+  }
+
+
+  /** void TSDelaunay<T>::_legalize( std::vector<int>& stack )
+   *  \brief Swaps the edges opposite the new vertex, at index 0 of the triangles on the stack, until they are Delaunay
+   *
+   *  An edge is only swapped if both new triangles are counterclockwise,
+   *  so a rounding error in the circle test can not fold the triangulation.
+   *  Swaps with outer triangles are how the hull grows around a new point.
+   */
+  template <typename T>
+  void TSDelaunay<T>::_legalize( std::vector<int>& stack ) {
+
+    while( !stack.empty() ) {
+
+      const int t = stack.back();
+      stack.pop_back();
+
+      const int u = _nbr[3*t];
+      if( u < 0 ) continue;
+
+      const int p = _tri[3*t], b = _tri[3*t+1], c = _tri[3*t+2];
+
+      int j = 0;
+      while( _nbr[3*u+j] != t ) j++;
+      const int d = _tri[3*u+j];
+
+      if( !_inCircle( p, b, c, d ) ||
+          ( b >= 0 && _orient( p, b, d ) <= 0.0 ) || ( c >= 0 && _orient( p, d, c ) <= 0.0 ) )
+        continue;
+
+      const int tb = _nbr[3*t+1], tc = _nbr[3*t+2];
+      const int uc = _nbr[3*u+(j+1)%3], ub = _nbr[3*u+(j+2)%3];
+
+      _tri[3*t] = p;   _tri[3*t+1] = b;   _tri[3*t+2] = d;
+      _nbr[3*t] = uc;  _nbr[3*t+1] = u;   _nbr[3*t+2] = tc;
+      _tri[3*u] = p;   _tri[3*u+1] = d;   _tri[3*u+2] = c;
+      _nbr[3*u] = ub;  _nbr[3*u+1] = tb;  _nbr[3*u+2] = t;
+
+      _link( uc, u, t );
+      _link( tb, t, u );
+
+      stack.push_back( t );
+      stack.push_back( u );
+    }
+  }
+
+
+  template <typename T>
+  inline
+  void TSDelaunay<T>::_link( int t, int from, int to ) {
+
+    if( t < 0 ) return;
+
+    for( int k = 0; k < 3; k++ )
+      if( _nbr[3*t+k] == from ) {
+        _nbr[3*t+k] = to;
+        return;
+      }
+  }
+
+
+  /** int TSDelaunay<T>::_locate( int v, int& e )
+   *  \brief Finds the triangle v is in, by a walk from the last new triangle
+   *
+   *  A stochastic walk, that does not test the edge it came through, and
+   *  stops in the first outer triangle it comes to. If it is too long all
+   *  triangles are searched. e is -1 if v is inside the triangle, the
+   *  vertex opposite the edge v is on, or 3 if v is on a vertex. Returns -1
+   *  if no triangle is found.
+   */
+  template <typename T>
+  int TSDelaunay<T>::_locate( int v, int& e ) {
+
+    auto classify = [this,v]( int t ) {
+      if( _isOuter(t) ) {
+        const int k = _tri[3*t] < 0 ? 0 : ( _tri[3*t+1] < 0 ? 1 : 2 );
+        return _orient( _tri[3*t+(k+1)%3], _tri[3*t+(k+2)%3], v ) > 0.0 ? -1 : -2;
+      }
+      int r = -1, zero = 0;
+      for( int k = 0; k < 3; k++ ) {
+        const double o = _orient( _tri[3*t+(k+1)%3], _tri[3*t+(k+2)%3], v );
+        if( o < 0.0 )  return -2;
+        if( o == 0.0 ) { r = k; zero++; }
+      }
+      return zero > 1 ? 3 : r;
+    };
+
+    const int nt        = int( _tri.size() / 3 );
+    const int max_steps = 64 + 4 * int( std::sqrt( double(nt) ) );
+
+    int t = _last, prev = -1;
+    if( _isOuter(t) )
+      for( int k = 0; k < 3; k++ )
+        if( _tri[3*t+k] < 0 ) t = _nbr[3*t+k];
+
+    e = -1;
+    for( int s = 0; s < max_steps; s++ ) {
+
+      _rnd = _rnd * 1103515245u + 12345u;
+      const int r = int( ( _rnd >> 16 ) % 3 );
+
+      int next = -1;
+      for( int i = 0; i < 3 && next < 0; i++ ) {
+        const int k = ( r + i ) % 3;
+        const int u = _nbr[3*t+k];
+        if( u != prev && _orient( _tri[3*t+(k+1)%3], _tri[3*t+(k+2)%3], v ) < 0.0 )
+          next = u;
+      }
+
+      if( next < 0 ) {
+        e = classify( t );
+        if( e > -2 ) return t;
+        break;
+      }
+
+      if( _isOuter(next) )
+        return next;
+
+      prev = t;
+      t    = next;
+    }
+
+    for( t = 0; t < nt; t++ ) {
+      e = classify( t );
+      if( e > -2 ) return t;
+    }
+
+    return -1;
+  }
+
+
+  /** double TSDelaunay<T>::_orient( int a, int b, int c ) const
+   *  \brief Twice the signed area of a, b, c, positive if they are counterclockwise
+   *
+   *  Computed from the lowest index of a and b, so the two triangles of an
+   *  edge always agree on which side a point is.
+   */
+  template <typename T>
+  inline
+  double TSDelaunay<T>::_orient( int a, int b, int c ) const {
+
+    if( b < a ) return -_orient( b, a, c );
+
+    const double ax = _p[a][0], ay = _p[a][1];
+    return ( _p[b][0] - ax ) * ( double(_p[c][1]) - ay ) - ( _p[b][1] - ay ) * ( double(_p[c][0]) - ax );
+  }
+
+
+} // end namespace GMlib
@@ -0,0 +1,97 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_TRIANGLESYSTEM_TSDELAUNAY_H
+#define GM_TRIANGLESYSTEM_TSDELAUNAY_H
+
+
+// gmlib
+#include <core/types/gmpoint.h>
+
+// stl
+#include <cstdint>
+#include <vector>
+
+
+namespace GMlib {
+
+
+
+  /** \class  TSDelaunay gmtsdelaunay.h <gmTriangleSystem>
+   *  \brief  A compact Delaunay triangulation of a subset of a point array
+   *
+   *  The triangles are kept as index triples with links to their neighbours,
+   *  and nothing is shared between two objects, so several subsets of the
+   *  same points can be triangulated at the same time. TriangleFacets uses
+   *  it for its parallel triangulation, see
+   *  TriangleFacets::enableParallelTriangulation().
+   *
+   *  The points are inserted in the order of insertionOrder(). Outside the
+   *  convex hull there are outer triangles, each with a hull edge and a
+   *  vertex at infinity (index -1), so the hull is made exactly as the rest
+   *  and there is no enclosing triangle to leave non-Delaunay triangles
+   *  along it. Outer triangles are not reported. Duplicated points are
+   *  skipped.
+   */
+  template <typename T>
+  class TSDelaunay {
+  public:
+    TSDelaunay( const std::vector< Point<T,2> >& p );
+
+    void                    getTriangles( std::vector<int>& tri ) const;
+    bool                    removeInside( const std::vector<int>& border );
+    void                    split( double x0, double x1, std::vector<int>& inner,
+                                   std::vector<int>& border, std::vector<char>& rest ) const;
+    bool                    triangulate( const std::vector<int>& ids );
+
+    static void             insertionOrder( const std::vector< Point<T,2> >& p, std::vector<int>& ids );
+
+  private:
+    const std::vector< Point<T,2> >&  _p;
+    std::vector<int>        _tri;       //!< Three vertices per triangle, counterclockwise, -1 at infinity
+    std::vector<int>        _nbr;       //!< The triangle across the edge opposite each vertex, -1 if none
+    std::vector<char>       _removed;   //!< Triangles taken away by removeInside()
+    std::vector<int>        _stack;     //!< Triangles to legalize
+    int                     _last;      //!< Where the next walk starts
+    uint32_t                _rnd;
+
+    bool                    _inCircle( int a, int b, int c, int d ) const;
+    void                    _insert( int v );
+    bool                    _isOuter( int t ) const;
+    void                    _legalize( std::vector<int>& stack );
+    void                    _link( int t, int from, int to );
+    int                     _locate( int v, int& e );
+    double                  _orient( int a, int b, int c ) const;
+  };
+
+
+} // end namespace
+
+
+
+// Include implementations
+#include "gmtsdelaunay.c"
+
+
+#endif // GM_TRIANGLESYSTEM_TSDELAUNAY_H
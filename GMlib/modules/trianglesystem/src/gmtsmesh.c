@@ -0,0 +1,498 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+// stl
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+
+
+namespace GMlib {
+
+
+  template <typename T>
+  const uint32_t TSMesh<T>::NoIndex;
+
+
+
+  template <typename T>
+  inline
+  TSMesh<T>::TSMesh() {}
+
+
+  template <typename T>
+  inline
+  TSMesh<T>::TSMesh( const TriangleFacets<T>& tf ) {
+
+    set( tf );
+  }
+
+
+  /** void TSMesh<T>::_link()
+   *  \brief Finds the opposite half-edges and one half-edge out of each vertex
+   *
+   *  The half-edges are grouped by the vertex they go out of, so the
+   *  opposite of a->b is looked for among those out of b. Half-edges with
+   *  no opposite, or where more than two triangles share an edge, are left
+   *  on the boundary.
+   */
+  template <typename T>
+  void TSMesh<T>::_link() {
+
+    const uint32_t n = getNoVertices();
+    const uint32_t m = uint32_t( _vertex.size() );
+
+    // The half-edges out of each vertex, with the vertex they go to
+    std::vector<uint32_t> start( n+1, 0 ), out( m ), to( m );
+    for( uint32_t h = 0; h < m; h++ )
+      start[ _vertex[h] + 1 ]++;
+    std::partial_sum( start.begin(), start.end(), start.begin() );
+
+    std::vector<uint32_t> pos( start.begin(), start.end()-1 );
+    for( uint32_t h = 0; h < m; h++ ) {
+      const uint32_t i = pos[_vertex[h]]++;
+      out[i] = h;
+      to[i]  = _vertex[getNext(h)];
+    }
+
+    // Each edge from its lower vertex, in the order of the vertices
+    _twin.assign( m, NoIndex );
+    for( uint32_t a = 0; a < n; a++ )
+      for( uint32_t i = start[a]; i < start[a+1]; i++ ) {
+
+        const uint32_t b = to[i];
+        if( b <= a ) continue;
+
+        for( uint32_t j = start[b]; j < start[b+1]; j++ )
+          if( to[j] == a && _twin[out[j]] == NoIndex && _twin[out[i]] == NoIndex ) {
+            _twin[out[i]] = out[j];
+            _twin[out[j]] = out[i];
+            break;
+          }
+      }
+
+    _out.assign( n, NoIndex );
+    for( uint32_t h = 0; h < m; h++ )
+      if( _out[_vertex[h]] == NoIndex || _twin[h] == NoIndex )
+        _out[_vertex[h]] = h;
+  }
+
+
+  template <typename T>
+  inline
+  double TSMesh<T>::_orient( uint32_t a, uint32_t b, const Point<T,2>& p ) const {
+
+    const double ax = _pos[0][a], ay = _pos[1][a];
+    return ( double(_pos[0][b]) - ax ) * ( double(p[1]) - ay ) - ( double(_pos[1][b]) - ay ) * ( double(p[0]) - ax );
+  }
+
+
+  /** void TSMesh<T>::computeNormals()
+   *  \brief Sets the normal of each vertex to the mean of the normals of its triangles
+   *
+   *  The triangle normals are not normalized, so larger triangles weigh
+   *  more, as for TriangleFacets::computeNormals().
+   */
+  template <typename T>
+  void TSMesh<T>::computeNormals() {
+
+    const uint32_t n = getNoVertices();
+    for( uint32_t v = 0; v < n; v++ ) {
+
+      Vector<T,3> nor( T(0) );
+      int         k = 0;
+      forEachHalfEdge( v, [this,&nor,&k]( uint32_t h ) {
+        const Point<T,3> p = getPosition( _vertex[h] );
+        nor += ( getPosition( _vertex[getNext(h)] ) - p ) ^ ( getPosition( _vertex[getPrev(h)] ) - p );
+        k++;
+      } );
+      if( k ) nor /= T(k);
+
+      for( int i = 0; i < 3; i++ )
+        _nor[i][v] = nor[i];
+    }
+  }
+
+
+  /** T TSMesh<T>::evalZ( const Point<T,2>& p, int deg ) const
+   *  \brief The height at p, 0 outside the triangles
+   *
+   *  Walks from the first triangle, see locate(). For many nearby points,
+   *  locate() from the triangle of the previous one and evalZ( t, p, deg ).
+   */
+  template <typename T>
+  inline
+  T TSMesh<T>::evalZ( const Point<T,2>& p, int deg ) const {
+
+    const uint32_t t = locate( p );
+    return t == NoIndex ? T(0) : evalZ( t, p, deg );
+  }
+
+
+  /** T TSMesh<T>::evalZ( uint32_t t, const Point<T,2>& p, int deg ) const
+   *  \brief The height at p over triangle t
+   *
+   *  Linear for deg 1, and otherwise the cubic Bezier triangle given by the
+   *  vertex normals, as for the triangles of a TriangleFacets.
+   */
+  template <typename T>
+  T TSMesh<T>::evalZ( uint32_t t, const Point<T,2>& p, int deg ) const {
+
+    Point<T,2> par[3];
+    Point<T,3> pos[3];
+    for( int i = 0; i < 3; i++ ) {
+      pos[i] = getPosition( _vertex[3*t+i] );
+      par[i] = Point<T,2>( pos[i][0], pos[i][1] );
+    }
+
+    T a = p^par[0];
+    T b = p^par[1];
+    T c = p^par[2];
+    T d = par[0]^par[1];
+    T e = par[0]^par[2];
+    T f = par[1]^par[2];
+    T det = d-e+f;
+    T u = (b-c+f)/det;
+    T v = (-a+c-e)/det;
+    T w = (a-b+d)/det;
+
+    if( deg == 1 )
+      return u*pos[0][2] + v*pos[1][2] + w*pos[2][2];
+
+    T pt[7];
+    pt[6] = 0;
+
+    for( int i = 0; i < 3; i++ ) {
+
+      const int j = (i+1)%3;
+      const int k = 2*i;
+
+      Vector<T,3> vec = pos[j] - pos[i];
+      vec[2] = 0;
+      UnitVector<T,3> uv   = vec;
+      T               vec2 = 0.33333333333333333333*(vec*vec);
+
+      const Vector<T,3> ni = getNormal( _vertex[3*t+i] );
+      const Vector<T,3> nj = getNormal( _vertex[3*t+j] );
+
+      Vector<T,3> vv = ni[2]*uv;
+      vv[2]  -= ni*uv;
+      pt[k]   = pos[i][2] + vec2/(vv*vec)*vv[2];
+
+      vv      = nj[2]*uv;
+      vv[2]  -= nj*uv;
+      pt[k+1] = pos[j][2] - vec2/(vv*vec)*vv[2];
+
+      pt[6]  += pt[k] + pt[k+1];
+    }
+
+    pt[6] /= 6;
+
+    a = u*u;
+    b = v*v;
+    c = w*w;
+    return a*u*pos[0][2] +   3*a*v*pt[0] + 3*u*b*pt[1] + b*v*pos[1][2] +
+           3*a*w*pt[5]   + 6*u*v*w*pt[6] + 3*b*w*pt[2] +
+           3*u*c*pt[4]   +   3*v*c*pt[3] +
+           c*w*pos[2][2];
+  }
+
+
+  /** void TSMesh<T>::forEachHalfEdge( uint32_t v, F f ) const
+   *  \brief Calls f for each half-edge going out of v, counterclockwise
+   *
+   *  One half-edge for each triangle around v, the triangle of h being
+   *  getTriangle(h). At a boundary vertex the first is on the boundary.
+   */
+  template <typename T>
+  template <typename F>
+  inline
+  void TSMesh<T>::forEachHalfEdge( uint32_t v, F f ) const {
+
+    const uint32_t first = _out[v];
+    if( first == NoIndex ) return;
+
+    uint32_t h = first;
+    do {
+      f( h );
+      h = _twin[getPrev(h)];
+    } while( h != NoIndex && h != first );
+  }
+
+
+  /** void TSMesh<T>::get( TriangleFacets<T>& tf ) const
+   *  \brief Replaces the vertices, edges and triangles of tf by those of the mesh
+   *
+   *  The triangles are not completed to the convex hull, so tf is only
+   *  searched properly, as by TriangleFacets::evalZ(), if the mesh covers it.
+   */
+  template <typename T>
+  void TSMesh<T>::get( TriangleFacets<T>& tf ) const {
+
+    const uint32_t n = getNoVertices();
+
+    tf.clear();
+    tf.setMaxSize( int(n) );
+    for( uint32_t v = 0; v < n; v++ )
+      tf.insertAlways( TSVertex<T>( getPosition(v), getNormal(v) ) );
+
+    if( n == 0 ) return;
+
+    tf._box.reset( getPosition(0) );
+    for( uint32_t v = 1; v < n; v++ )
+      tf._box += getPosition(v);
+
+    tf._edges.setMaxSize( int( _vertex.size() ) );
+    tf._triangles.setMaxSize( int( getNoTriangles() ) );
+
+    tf._initTriOrder();
+    tf._setTriangles( std::vector<int>( _vertex.begin(), _vertex.end() ) );
+  }
+
+
+  template <typename T>
+  inline
+  uint32_t TSMesh<T>::getHalfEdge( uint32_t v ) const {
+
+    return _out[v];
+  }
+
+
+  /** const std::vector<uint32_t>& TSMesh<T>::getIndices() const
+   *  \brief The vertex each half-edge goes out of, three for each triangle
+   */
+  template <typename T>
+  inline
+  const std::vector<uint32_t>& TSMesh<T>::getIndices() const {
+
+    return _vertex;
+  }
+
+
+  template <typename T>
+  inline
+  uint32_t TSMesh<T>::getNext( uint32_t h ) {
+
+    return h % 3 == 2 ? h-2 : h+1;
+  }
+
+
+  template <typename T>
+  inline
+  Vector<T,3> TSMesh<T>::getNormal( uint32_t v ) const {
+
+    return Vector<T,3>( _nor[0][v], _nor[1][v], _nor[2][v] );
+  }
+
+
+  template <typename T>
+  inline
+  uint32_t TSMesh<T>::getNoTriangles() const {
+
+    return uint32_t( _vertex.size() / 3 );
+  }
+
+
+  template <typename T>
+  inline
+  uint32_t TSMesh<T>::getNoVertices() const {
+
+    return uint32_t( _pos[0].size() );
+  }
+
+
+  template <typename T>
+  inline
+  Point<T,3> TSMesh<T>::getPosition( uint32_t v ) const {
+
+    return Point<T,3>( _pos[0][v], _pos[1][v], _pos[2][v] );
+  }
+
+
+  template <typename T>
+  inline
+  uint32_t TSMesh<T>::getPrev( uint32_t h ) {
+
+    return h % 3 == 0 ? h+2 : h-1;
+  }
+
+
+  template <typename T>
+  inline
+  uint32_t TSMesh<T>::getTriangle( uint32_t h ) {
+
+    return h / 3;
+  }
+
+
+  template <typename T>
+  inline
+  uint32_t TSMesh<T>::getTwin( uint32_t h ) const {
+
+    return _twin[h];
+  }
+
+
+  template <typename T>
+  inline
+  uint32_t TSMesh<T>::getVertex( uint32_t h ) const {
+
+    return _vertex[h];
+  }
+
+
+  template <typename T>
+  inline
+  bool TSMesh<T>::isBoundary( uint32_t v ) const {
+
+    return _out[v] == NoIndex || _twin[_out[v]] == NoIndex;
+  }
+
+
+  /** uint32_t TSMesh<T>::locate( const Point<T,2>& p, uint32_t t ) const
+   *  \brief The triangle containing p, found by walking from triangle t
+   *
+   *  The walk crosses an edge, from a random one in each triangle, whenever
+   *  p is strictly on the other side of it. NoIndex is returned if it leaves
+   *  through the boundary, which means that p is outside if the triangles
+   *  cover a convex region, as those of a TriangleFacets do. A walk that
+   *  does not end ends in a search through all triangles. It changes
+   *  nothing, so it can be called from several threads at once.
+   */
+  template <typename T>
+  uint32_t TSMesh<T>::locate( const Point<T,2>& p, uint32_t t ) const {
+
+    const uint32_t nt = getNoTriangles();
+    if( nt == 0 ) return NoIndex;
+    if( t >= nt ) t = 0;
+
+    uint32_t  r = t;
+    const int max_steps = 64 + 8 * int( std::sqrt( double(nt) ) );
+    for( int step = 0; step < max_steps; step++ ) {
+
+      r = r * 1664525u + 1013904223u;
+      uint32_t next = NoIndex;
+      for( uint32_t k = 0; k < 3; k++ ) {
+
+        const uint32_t h = 3*t + ( ( r >> 16 ) + k ) % 3;
+        if( _orient( _vertex[h], _vertex[getNext(h)], p ) < 0.0 ) {
+          if( _twin[h] == NoIndex ) return NoIndex;
+          next = getTriangle( _twin[h] );
+          break;
+        }
+      }
+
+      if( next == NoIndex ) return t;
+      t = next;
+    }
+
+    for( t = 0; t < nt; t++ )
+      if( _orient( _vertex[3*t],   _vertex[3*t+1], p ) >= 0.0 &&
+          _orient( _vertex[3*t+1], _vertex[3*t+2], p ) >= 0.0 &&
+          _orient( _vertex[3*t+2], _vertex[3*t],   p ) >= 0.0 )
+        return t;
+
+    return NoIndex;
+  }
+
+
+  /** void TSMesh<T>::set( const TriangleFacets<T>& tf )
+   *  \brief Makes the mesh of the vertices and triangles of tf
+   *
+   *  Vertex i of the mesh is vertex i of tf. The triangles are turned
+   *  counterclockwise in the xy-plane.
+   */
+  template <typename T>
+  void TSMesh<T>::set( const TriangleFacets<T>& tf ) {
+
+    const uint32_t n = uint32_t( tf.getSize() );
+    const uint32_t m = uint32_t( tf.getNoTriangles() );
+
+    std::unordered_map<const TSVertex<T>*,uint32_t> index;
+    index.reserve( n );
+    for( int i = 0; i < 3; i++ ) {
+      _pos[i].resize( n );
+      _nor[i].resize( n );
+    }
+
+    for( uint32_t v = 0; v < n; v++ ) {
+
+      const TSVertex<T>& tv  = *tf.getVertex( int(v) );
+      const Point<T,3>   pos = tv.getPosition();
+      const Vector<T,3>  nor = tv.getNormal();
+      for( int i = 0; i < 3; i++ ) {
+        _pos[i][v] = pos[i];
+        _nor[i][v] = nor[i];
+      }
+      index[&tv] = v;
+    }
+
+    auto find = [&index]( const TSVertex<T>* v ) {
+      auto i = index.find( v );
+      assert( i != index.end() );
+      return i == index.end() ? NoIndex : i->second;
+    };
+
+    _vertex.resize( 3*m );
+    for( uint32_t t = 0; t < m; t++ ) {
+
+      TSEdge<T>* const* e = tf.getTriangle( int(t) )->_edge;
+      uint32_t* c = &_vertex[3*t];
+      c[0] = find( e[2]->getCommonVertex( *e[0] ) );
+      c[1] = find( e[0]->getCommonVertex( *e[1] ) );
+      c[2] = find( e[1]->getCommonVertex( *e[2] ) );
+
+      if( _orient( c[0], c[1], Point<T,2>( _pos[0][c[2]], _pos[1][c[2]] ) ) < 0.0 )
+        std::swap( c[1], c[2] );
+    }
+    _link();
+  }
+
+
+  /** void TSMesh<T>::set( const std::vector< Point<T,3> >& p, const std::vector<uint32_t>& tri )
+   *  \brief Makes the mesh of points p and triangles tri
+   *
+   *  Three point indices for each triangle, all turned the same way. The
+   *  normals are set to 0, see computeNormals().
+   */
+  template <typename T>
+  void TSMesh<T>::set( const std::vector< Point<T,3> >& p, const std::vector<uint32_t>& tri ) {
+
+    const size_t n = p.size();
+    for( int i = 0; i < 3; i++ ) {
+      _pos[i].resize( n );
+      _nor[i].assign( n, T(0) );
+      for( size_t v = 0; v < n; v++ )
+        _pos[i][v] = p[v][i];
+    }
+
+    _vertex = tri;
+    _link();
+  }
+
+
+} // end namespace
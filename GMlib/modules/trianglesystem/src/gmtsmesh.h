@@ -0,0 +1,121 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_TRIANGLESYSTEM_TSMESH_H
+#define GM_TRIANGLESYSTEM_TSMESH_H
+
+
+// gmlib
+#include <core/types/gmpoint.h>
+
+// stl
+#include <cstdint>
+#include <vector>
+
+
+namespace GMlib {
+
+
+  template <typename T>
+  class TriangleFacets;
+
+  template <typename T>
+  class TSEdge;
+
+  template <typename T>
+  class TSVertex;
+
+
+
+  /** \class  TSMesh gmtsmesh.h <gmTriangleSystem>
+   *  \brief  A compact half-edge mesh of triangles
+   *
+   *  The half-edges of triangle t are 3t, 3t+1 and 3t+2, each going out of
+   *  its vertex to the vertex of the next one, so only the vertex and the
+   *  opposite half-edge of each are stored, as 32-bit indices. The vertices
+   *  of the half-edges are then also the index array of the triangles.
+   *  Positions and normals are stored by coordinate.
+   *
+   *  Unlike the TSVertex, TSEdge and TSTriangle objects of a TriangleFacets,
+   *  nothing is allocated for each element, and the triangles around a
+   *  vertex are visited without making arrays, see forEachHalfEdge(). Each
+   *  vertex refers to one half-edge going out of it, one on the boundary if
+   *  there is one. Where two fans of triangles meet in one vertex, only one
+   *  of them is visited around it.
+   */
+  template <typename T>
+  class TSMesh {
+  public:
+    TSMesh();
+    TSMesh( const TriangleFacets<T>& tf );
+
+    void                    computeNormals();
+    T                       evalZ( const Point<T,2>& p, int deg = 1 ) const;
+    T                       evalZ( uint32_t t, const Point<T,2>& p, int deg = 1 ) const;
+    template <typename F>
+    void                    forEachHalfEdge( uint32_t v, F f ) const;
+    void                    get( TriangleFacets<T>& tf ) const;
+
+    uint32_t                getHalfEdge( uint32_t v ) const;
+    const std::vector<uint32_t>&  getIndices() const;
+    Vector<T,3>             getNormal( uint32_t v ) const;
+    uint32_t                getNoTriangles() const;
+    uint32_t                getNoVertices() const;
+    Point<T,3>              getPosition( uint32_t v ) const;
+    uint32_t                getTwin( uint32_t h ) const;
+    uint32_t                getVertex( uint32_t h ) const;
+
+    bool                    isBoundary( uint32_t v ) const;
+    uint32_t                locate( const Point<T,2>& p, uint32_t t = 0 ) const;
+
+    void                    set( const TriangleFacets<T>& tf );
+    void                    set( const std::vector< Point<T,3> >& p, const std::vector<uint32_t>& tri );
+
+    static uint32_t         getNext( uint32_t h );
+    static uint32_t         getPrev( uint32_t h );
+    static uint32_t         getTriangle( uint32_t h );
+
+    static const uint32_t   NoIndex = 0xffffffff;
+
+  private:
+    std::vector<T>          _pos[3];    //!< x, y and z of the vertices
+    std::vector<T>          _nor[3];    //!< x, y and z of the vertex normals
+    std::vector<uint32_t>   _vertex;    //!< The vertex each half-edge goes out of
+    std::vector<uint32_t>   _twin;      //!< The opposite half-edge, NoIndex on the boundary
+    std::vector<uint32_t>   _out;       //!< A half-edge going out of each vertex
+
+    void                    _link();
+    double                  _orient( uint32_t a, uint32_t b, const Point<T,2>& p ) const;
+  };
+
+
+} // end namespace
+
+
+
+// Include implementations
+#include "gmtsmesh.c"
+
+
+#endif // GM_TRIANGLESYSTEM_TSMESH_H
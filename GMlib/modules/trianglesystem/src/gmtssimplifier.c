@@ -0,0 +1,788 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+// gmlib
+#include <core/utils/gmparallel.h>
+
+// stl
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+
+namespace GMlib {
+
+
+
+  template <typename T>
+  inline
+  TSSimplifier<T>::Quadric::Quadric() {
+
+    std::fill( a, a + 10, 0.0 );
+  }
+
+
+  /** TSSimplifier<T>::Quadric::Quadric( const Point<T,3>& p, const Vector<T,3>& n, double w )
+   *  \brief w times the squared distance to the plane through p with normal n, 0 if n is
+   */
+  template <typename T>
+  TSSimplifier<T>::Quadric::Quadric( const Point<T,3>& p, const Vector<T,3>& n, double w ) {
+
+    double m[4] = { n(0), n(1), n(2), 0.0 };
+
+    const double l = std::sqrt( m[0]*m[0] + m[1]*m[1] + m[2]*m[2] );
+    if( l == 0.0 ) {
+      std::fill( a, a + 10, 0.0 );
+      return;
+    }
+
+    for( int i = 0; i < 3; i++ ) m[i] /= l;
+    m[3] = -( m[0]*p(0) + m[1]*p(1) + m[2]*p(2) );
+
+    for( int i = 0, k = 0; i < 4; i++ )
+      for( int j = i; j < 4; j++ )
+        a[k++] = w * m[i] * m[j];
+  }
+
+
+  template <typename T>
+  inline
+  typename TSSimplifier<T>::Quadric& TSSimplifier<T>::Quadric::operator += ( const Quadric& q ) {
+
+    for( int i = 0; i < 10; i++ ) a[i] += q.a[i];
+    return *this;
+  }
+
+
+  template <typename T>
+  inline
+  typename TSSimplifier<T>::Quadric TSSimplifier<T>::Quadric::operator + ( const Quadric& q ) const {
+
+    return Quadric(*this) += q;
+  }
+
+
+  template <typename T>
+  inline
+  double TSSimplifier<T>::Quadric::operator () ( const Point<T,3>& p ) const {
+
+    const double x = p(0), y = p(1), z = p(2);
+    return a[0]*x*x + 2*a[1]*x*y + 2*a[2]*x*z + 2*a[3]*x
+         + a[4]*y*y + 2*a[5]*y*z + 2*a[6]*y
+         + a[7]*z*z + 2*a[8]*z
+         + a[9];
+  }
+
+
+  /** bool TSSimplifier<T>::Quadric::getMinimum( Point<T,3>& p ) const
+   *  \brief The point p where the quadric is smallest, false if there is no single one
+   */
+  template <typename T>
+  bool TSSimplifier<T>::Quadric::getMinimum( Point<T,3>& p ) const {
+
+    const double c00 = a[4]*a[7] - a[5]*a[5];
+    const double c01 = a[2]*a[5] - a[1]*a[7];
+    const double c02 = a[1]*a[5] - a[2]*a[4];
+    const double det = a[0]*c00 + a[1]*c01 + a[2]*c02;
+    const double tr  = a[0] + a[4] + a[7];
+
+    if( !( std::fabs(det) > 1e-9 * tr*tr*tr ) )
+      return false;
+
+    const double c11 = a[0]*a[7] - a[2]*a[2];
+    const double c12 = a[1]*a[2] - a[0]*a[5];
+    const double c22 = a[0]*a[4] - a[1]*a[1];
+
+    p[0] = T( -( c00*a[3] + c01*a[6] + c02*a[8] ) / det );
+    p[1] = T( -( c01*a[3] + c11*a[6] + c12*a[8] ) / det );
+    p[2] = T( -( c02*a[3] + c12*a[6] + c22*a[8] ) / det );
+
+    return true;
+  }
+
+
+
+  template <typename T>
+  inline
+  TSSimplifier<T>::TSSimplifier()
+    : _tag(0), _no_tri(0), _no_ver(0), _error(0.0), _preserve_boundary(false), _feature_angle(T(0)) {}
+
+
+  template <typename T>
+  inline
+  TSSimplifier<T>::TSSimplifier( const TSMesh<T>& mesh )
+    : _tag(0), _no_tri(0), _no_ver(0), _error(0.0), _preserve_boundary(false), _feature_angle(T(0)) {
+
+    set( mesh );
+  }
+
+
+  /** bool TSSimplifier<T>::_collapse( const Collapse& c )
+   *  \brief Collapses an edge, if the mesh stays manifold and no triangle is turned over
+   *
+   *  The edge is collapsed into the vertex that is locked, if one is. The
+   *  other vertices of the two must only be shared by the triangles of the
+   *  edge, and an edge inside the mesh between two boundary vertices is
+   *  kept.
+   */
+  template <typename T>
+  bool TSSimplifier<T>::_collapse( const Collapse& c ) {
+
+    uint32_t a = c.v[0], b = c.v[1];
+    if( _state[b] & Locked ) std::swap( a, b );
+
+    Point<T,3> x;
+    _evaluate( a, b, x );
+
+    // The triangles of the edge, and the other vertices of a seen by b
+    const uint32_t tag = _nextTag();
+    for( uint32_t i = _first[a]; i < _first[a] + _count[a]; i++ ) {
+      const uint32_t t = _ref[i];
+      if( _removed[t] ) continue;
+      for( int k = 0; k < 3; k++ ) _mark[_tri[3*t+k]] = tag;
+    }
+
+    uint32_t opp[2];
+    int      shared = 0;
+    for( uint32_t i = _first[b]; i < _first[b] + _count[b]; i++ ) {
+      const uint32_t t = _ref[i];
+      if( _removed[t] ) continue;
+
+      const uint32_t* v = &_tri[3*t];
+      if( v[0] != a && v[1] != a && v[2] != a ) continue;
+      if( shared == 2 ) return false;
+      opp[shared++] = v[0] != a && v[0] != b ? v[0] : ( v[1] != a && v[1] != b ? v[1] : v[2] );
+    }
+    if( shared == 0 ) return false;
+    if( shared == 2 && ( _state[a] & Boundary ) && ( _state[b] & Boundary ) ) return false;
+
+    for( uint32_t i = _first[b]; i < _first[b] + _count[b]; i++ ) {
+      const uint32_t t = _ref[i];
+      if( _removed[t] ) continue;
+
+      for( int k = 0; k < 3; k++ ) {
+        const uint32_t w = _tri[3*t+k];
+        if( w != a && w != b && _mark[w] == tag && w != opp[0] && ( shared == 1 || w != opp[1] ) )
+          return false;
+      }
+    }
+
+    if( _turns( a, b, x ) || _turns( b, a, x ) ) return false;
+
+    // Collapse b into a
+    _scratch.clear();
+    for( uint32_t i = _first[a]; i < _first[a] + _count[a]; i++ )
+      if( !_removed[_ref[i]] ) _scratch.push_back( _ref[i] );
+
+    for( uint32_t i = _first[b]; i < _first[b] + _count[b]; i++ ) {
+      const uint32_t t = _ref[i];
+      if( _removed[t] ) continue;
+
+      uint32_t* v = &_tri[3*t];
+      if( v[0] == a || v[1] == a || v[2] == a ) {
+        _removed[t] = 1;
+        _no_tri--;
+      }
+      else {
+        for( int k = 0; k < 3; k++ )
+          if( v[k] == b ) v[k] = a;
+        _scratch.push_back( t );
+      }
+    }
+
+    _first[a] = uint32_t( _ref.size() );
+    _count[a] = 0;
+    for( uint32_t t : _scratch )
+      if( !_removed[t] ) {
+        _ref.push_back( t );
+        _count[a]++;
+      }
+
+    _pos[a]    = x;
+    _q[a]     += _q[b];
+    _state[a] |= _state[b] & Boundary;
+    _state[b] |= Removed;
+    _count[b]  = 0;
+    _stamp[a]++;
+    _stamp[b]++;
+    _no_ver--;
+
+    return true;
+  }
+
+
+  /** double TSSimplifier<T>::_evaluate( uint32_t a, uint32_t b, Point<T,3>& x ) const
+   *  \brief The error of collapsing edge ab, and the point x it is collapsed into
+   *
+   *  A locked vertex stays where it is, and the error is infinite if both
+   *  are locked. Otherwise the point of the smallest error is used, if it
+   *  is well defined and not further from the edge than its length, and
+   *  else the best of the ends and the middle of the edge.
+   */
+  template <typename T>
+  double TSSimplifier<T>::_evaluate( uint32_t a, uint32_t b, Point<T,3>& x ) const {
+
+    const bool la = _state[a] & Locked, lb = _state[b] & Locked;
+    if( la && lb ) return std::numeric_limits<double>::infinity();
+
+    const Quadric q = _q[a] + _q[b];
+
+    if( la || lb ) {
+      x = _pos[ la ? a : b ];
+      return std::max( 0.0, q( x ) );
+    }
+
+    const Point<T,3> m = ( _pos[a] + _pos[b] ) / T(2);
+    const T          l = ( _pos[b] - _pos[a] ).getLength();
+
+    if( q.getMinimum( x ) && ( x - m ).getLength() <= l )
+      return std::max( 0.0, q( x ) );
+
+    double e = std::numeric_limits<double>::infinity();
+    const Point<T,3>* c[3] = { &_pos[a], &_pos[b], &m };
+    for( int i = 0; i < 3; i++ ) {
+      const double f = q( *c[i] );
+      if( f < e ) {
+        e = f;
+        x = *c[i];
+      }
+    }
+
+    return std::max( 0.0, e );
+  }
+
+
+  /** void TSSimplifier<T>::_forEachEdge( uint32_t v, std::vector<uint64_t>& s, F f ) const
+   *  \brief Calls f( w, n, t0, t1 ) for each edge vw
+   *
+   *  n is the number of triangles of the edge, and t0 and t1 are the first
+   *  two of them, the same if there is only one. s is scratch space.
+   */
+  template <typename T>
+  template <typename F>
+  void TSSimplifier<T>::_forEachEdge( uint32_t v, std::vector<uint64_t>& s, F f ) const {
+
+    s.clear();
+    for( uint32_t i = _first[v]; i < _first[v] + _count[v]; i++ ) {
+      const uint32_t t = _ref[i];
+      if( _removed[t] ) continue;
+
+      for( int k = 0; k < 3; k++ )
+        if( _tri[3*t+k] != v ) s.push_back( uint64_t( _tri[3*t+k] ) << 32 | t );
+    }
+    std::sort( s.begin(), s.end() );
+
+    for( size_t i = 0, j; i < s.size(); i = j ) {
+      for( j = i+1; j < s.size() && ( s[j] >> 32 ) == ( s[i] >> 32 ); j++ ) {}
+      f( uint32_t( s[i] >> 32 ), uint32_t( j-i ), uint32_t( s[i] ), uint32_t( s[ j-i > 1 ? i+1 : i ] ) );
+    }
+  }
+
+
+  /** Vector<T,3> TSSimplifier<T>::_getNormal( uint32_t t ) const
+   *  \brief The normal of triangle t, of length twice its area
+   */
+  template <typename T>
+  inline
+  Vector<T,3> TSSimplifier<T>::_getNormal( uint32_t t ) const {
+
+    const uint32_t* w = &_tri[3*t];
+    Vector<T,3> u = _pos[w[1]] - _pos[w[0]];
+    Vector<T,3> v = _pos[w[2]] - _pos[w[0]];
+    return u^v;
+  }
+
+
+  /** void TSSimplifier<T>::_init()
+   *  \brief Makes the lists of triangles of the vertices, and their quadrics
+   *
+   *  The quadric of a vertex is that of the planes of its triangles, and of
+   *  the planes through its boundary edges normal to their triangle, which
+   *  weigh 1000 times more, as by Garland and Heckbert, so the boundary is
+   *  kept in shape. They are summed in parallel, each vertex from its own
+   *  list of triangles.
+   */
+  template <typename T>
+  void TSSimplifier<T>::_init() {
+
+    const uint32_t n = uint32_t( _pos.size() );
+    const uint32_t m = uint32_t( _tri.size() / 3 );
+    _tri.resize( 3*size_t(m) );
+
+    std::vector<uint32_t> first( n+1, 0 );
+    for( uint32_t v : _tri ) first[v+1]++;
+    std::partial_sum( first.begin(), first.end(), first.begin() );
+
+    _count.assign( n, 0 );
+    _ref.resize( _tri.size() );
+    _removed.assign( m, 0 );
+    for( uint32_t t = 0; t < m; t++ )
+      for( int k = 0; k < 3; k++ ) {
+        const uint32_t v = _tri[3*t+k];
+        _ref[ first[v] + _count[v]++ ] = t;
+      }
+    first.pop_back();
+    _first.swap( first );
+
+    _q.assign( n, Quadric() );
+    parallelFor( 0, int(n), [this]( int b, int e ) {
+
+      std::vector<uint64_t> s;
+      for( int v = b; v < e; v++ ) {
+
+        for( uint32_t i = _first[v]; i < _first[v] + _count[v]; i++ )
+          _q[v] += Quadric( _pos[v], _getNormal( _ref[i] ) );
+
+        _forEachEdge( v, s, [this,v]( uint32_t w, uint32_t m, uint32_t t, uint32_t ) {
+          if( m != 1 ) return;
+          Vector<T,3> d = _pos[w] - _pos[v];
+          _q[v] += Quadric( _pos[v], d ^ _getNormal(t), 1000.0 );
+        } );
+      }
+    }, 1024 );
+
+    _stamp.assign( n, 0 );
+    _state.assign( n, 0 );
+    _mark.assign( n, 0 );
+    _tag    = 0;
+
+    _no_tri = m;
+    _no_ver = 0;
+    for( uint32_t v = 0; v < n; v++ )
+      if( _count[v] ) _no_ver++;
+    _error  = 0.0;
+  }
+
+
+  template <typename T>
+  inline
+  uint32_t TSSimplifier<T>::_nextTag() {
+
+    if( ++_tag == 0 ) {
+      std::fill( _mark.begin(), _mark.end(), 0 );
+      _tag = 1;
+    }
+    return _tag;
+  }
+
+
+  /** void TSSimplifier<T>::_queue()
+   *  \brief Finds the collapses of all edges, in parallel
+   *
+   *  The lists of triangles are compacted first. Then each vertex finds if
+   *  it is on the boundary and if it is to be locked, on a boundary that is
+   *  preserved, a feature edge or an edge of more than two triangles, and
+   *  counts its edges to vertices of higher index. The errors of those are
+   *  computed after, into their places in _collapses.
+   */
+  template <typename T>
+  void TSSimplifier<T>::_queue() {
+
+    const uint32_t n = uint32_t( _pos.size() );
+
+    std::vector<uint32_t> ref;
+    ref.reserve( 3*size_t(_no_tri) );
+    for( uint32_t v = 0; v < n; v++ ) {
+      const uint32_t f = uint32_t( ref.size() );
+      for( uint32_t i = _first[v]; i < _first[v] + _count[v]; i++ )
+        if( !_removed[_ref[i]] ) ref.push_back( _ref[i] );
+      _first[v] = f;
+      _count[v] = uint32_t( ref.size() ) - f;
+    }
+    _ref.swap( ref );
+
+    const T cos_feature = std::cos( _feature_angle );
+
+    std::vector<uint32_t> first( n+1, 0 );
+    parallelFor( 0, int(n), [&]( int b, int e ) {
+
+      std::vector<uint64_t> s;
+      for( int v = b; v < e; v++ ) {
+
+        char     state = _state[v] & Removed;
+        uint32_t k     = 0;
+        _forEachEdge( v, s, [&]( uint32_t w, uint32_t m, uint32_t t0, uint32_t t1 ) {
+
+          if( m == 1 ) {
+            state |= Boundary;
+            if( _preserve_boundary ) state |= Locked;
+          }
+          else if( m > 2 )
+            state |= Locked;
+          else if( _feature_angle > T(0) ) {
+            const Vector<T,3> n0 = _getNormal(t0), n1 = _getNormal(t1);
+            if( n0 * n1 < cos_feature * n0.getLength() * n1.getLength() ) state |= Locked;
+          }
+
+          if( w > uint32_t(v) ) k++;
+        } );
+
+        _state[v]  = state;
+        first[v+1] = k;
+      }
+    }, 1024 );
+    std::partial_sum( first.begin(), first.end(), first.begin() );
+
+    _collapses.resize( first[n] );
+    parallelFor( 0, int(n), [&]( int b, int e ) {
+
+      std::vector<uint64_t> s;
+      for( int v = b; v < e; v++ ) {
+
+        uint32_t k = first[v];
+        _forEachEdge( v, s, [&]( uint32_t w, uint32_t, uint32_t, uint32_t ) {
+
+          if( w < uint32_t(v) ) return;
+
+          Point<T,3> x;
+          Collapse&  c = _collapses[k++];
+          c.error    = _evaluate( v, w, x );
+          c.v[0]     = v;
+          c.v[1]     = w;
+          c.stamp[0] = _stamp[v];
+          c.stamp[1] = _stamp[w];
+        } );
+      }
+    }, 1024 );
+
+    _collapses.erase( std::remove_if( _collapses.begin(), _collapses.end(), []( const Collapse& c ) {
+      return c.error == std::numeric_limits<double>::infinity(); } ), _collapses.end() );
+  }
+
+
+  /** bool TSSimplifier<T>::_turns( uint32_t v, uint32_t other, const Point<T,3>& x ) const
+   *  \brief True if moving v to x turns a triangle of v, not of the edge to other, too much
+   *
+   *  That is, if its normal turns by more than 60 degrees, or it gets next
+   *  to no area for its longest edge. Less strict, slivers along the
+   *  boundary may be stood on end.
+   */
+  template <typename T>
+  bool TSSimplifier<T>::_turns( uint32_t v, uint32_t other, const Point<T,3>& x ) const {
+
+    for( uint32_t i = _first[v]; i < _first[v] + _count[v]; i++ ) {
+      const uint32_t t = _ref[i];
+      if( _removed[t] ) continue;
+
+      const uint32_t* w = &_tri[3*t];
+      if( w[0] == other || w[1] == other || w[2] == other ) continue;
+
+      Point<T,3> p[3] = { _pos[w[0]], _pos[w[1]], _pos[w[2]] };
+      Vector<T,3> u = p[1] - p[0], s = p[2] - p[0];
+      const Vector<T,3> n0 = u^s;
+
+      for( int k = 0; k < 3; k++ )
+        if( w[k] == v ) p[k] = x;
+      u = p[1] - p[0];
+      s = p[2] - p[0];
+      const Vector<T,3> n1 = u^s;
+      const Vector<T,3> r  = p[2] - p[1];
+
+      const double l0 = n0.getLength(), l1 = n1.getLength();
+      const double e  = std::max( std::max( u * u, s * s ), r * r );
+      if( l1 <= 1e-6 * e || double( n0 * n1 ) < 0.5 * l0 * l1 ) return true;
+    }
+
+    return false;
+  }
+
+
+  /** void TSSimplifier<T>::get( std::vector< Point<T,3> >& p, std::vector<uint32_t>& tri ) const
+   *  \brief The points p still in use, in their order, and the triangles tri of them
+   */
+  template <typename T>
+  void TSSimplifier<T>::get( std::vector< Point<T,3> >& p, std::vector<uint32_t>& tri ) const {
+
+    const uint32_t n = uint32_t( _pos.size() );
+    const uint32_t m = uint32_t( _removed.size() );
+
+    std::vector<uint32_t> index( n, 0 );
+    for( uint32_t t = 0; t < m; t++ )
+      if( !_removed[t] )
+        for( int k = 0; k < 3; k++ ) index[_tri[3*t+k]] = 1;
+
+    p.clear();
+    p.reserve( _no_ver );
+    for( uint32_t v = 0; v < n; v++ )
+      if( index[v] ) {
+        index[v] = uint32_t( p.size() );
+        p.push_back( _pos[v] );
+      }
+
+    tri.clear();
+    tri.reserve( 3*size_t(_no_tri) );
+    for( uint32_t t = 0; t < m; t++ )
+      if( !_removed[t] )
+        for( int k = 0; k < 3; k++ ) tri.push_back( index[_tri[3*t+k]] );
+  }
+
+
+  /** void TSSimplifier<T>::get( Array< Point<T,3> >& p, Array< Vector<T,3> >& n ) const
+   *  \brief The triangles as in an StlObject, three points p and one unit normal n each
+   */
+  template <typename T>
+  void TSSimplifier<T>::get( Array< Point<T,3> >& p, Array< Vector<T,3> >& n ) const {
+
+    p.setSize( 3*int(_no_tri) );
+    n.setSize( int(_no_tri) );
+
+    for( uint32_t t = 0, j = 0; t < uint32_t( _removed.size() ); t++ ) {
+      if( _removed[t] ) continue;
+
+      for( int k = 0; k < 3; k++ ) p[3*j+k] = _pos[_tri[3*t+k]];
+
+      Vector<T,3> u = p[3*j+1] - p[3*j];
+      Vector<T,3> v = p[3*j+2] - p[3*j];
+      Vector<T,3> nor = u^v;
+      const T l = nor.getLength();
+      if( l > T(0) ) nor /= l;
+      n[j++] = nor;
+    }
+  }
+
+
+  /** void TSSimplifier<T>::get( TSMesh<T>& mesh ) const
+   *  \brief The mesh, with its normals computed
+   */
+  template <typename T>
+  void TSSimplifier<T>::get( TSMesh<T>& mesh ) const {
+
+    std::vector< Point<T,3> > p;
+    std::vector<uint32_t>     tri;
+    get( p, tri );
+
+    mesh.set( p, tri );
+    mesh.computeNormals();
+  }
+
+
+  /** void TSSimplifier<T>::get( TriangleFacets<T>& tf ) const
+   *  \brief The mesh as the triangles of tf, for a height field over the xy-plane
+   *
+   *  See TSMesh::get().
+   */
+  template <typename T>
+  void TSSimplifier<T>::get( TriangleFacets<T>& tf ) const {
+
+    TSMesh<T> mesh;
+    get( mesh );
+    mesh.get( tf );
+  }
+
+
+  /** double TSSimplifier<T>::getError() const
+   *  \brief The largest error of the collapses made, see simplify()
+   */
+  template <typename T>
+  inline
+  double TSSimplifier<T>::getError() const {
+
+    return _error;
+  }
+
+
+  template <typename T>
+  inline
+  T TSSimplifier<T>::getFeatureAngle() const {
+
+    return _feature_angle;
+  }
+
+
+  template <typename T>
+  inline
+  uint32_t TSSimplifier<T>::getNoTriangles() const {
+
+    return _no_tri;
+  }
+
+
+  /** uint32_t TSSimplifier<T>::getNoVertices() const
+   *  \brief The number of vertices of the triangles left
+   */
+  template <typename T>
+  inline
+  uint32_t TSSimplifier<T>::getNoVertices() const {
+
+    return _no_ver;
+  }
+
+
+  template <typename T>
+  inline
+  bool TSSimplifier<T>::isBoundaryPreserved() const {
+
+    return _preserve_boundary;
+  }
+
+
+  /** void TSSimplifier<T>::set( const std::vector< Point<T,3> >& p, const std::vector<uint32_t>& tri )
+   *  \brief The mesh of points p and triangles tri, three point indices each
+   */
+  template <typename T>
+  void TSSimplifier<T>::set( const std::vector< Point<T,3> >& p, const std::vector<uint32_t>& tri ) {
+
+    _pos = p;
+    _tri = tri;
+    _init();
+  }
+
+
+  /** void TSSimplifier<T>::set( const Array< Point<T,3> >& p )
+   *  \brief The mesh of a triangle soup, three points each, as StlObject::getPoints()
+   *
+   *  Points that are exactly equal are made one vertex, and triangles that
+   *  are left with less than three vertices by that are skipped.
+   */
+  template <typename T>
+  void TSSimplifier<T>::set( const Array< Point<T,3> >& p ) {
+
+    const uint32_t n = uint32_t( p.getSize() / 3 * 3 );
+
+    std::vector<uint32_t> ids( n );
+    std::iota( ids.begin(), ids.end(), 0u );
+    std::sort( ids.begin(), ids.end(), [&p]( uint32_t i, uint32_t j ) {
+      for( int k = 0; k < 3; k++ )
+        if( p(i)(k) != p(j)(k) ) return p(i)(k) < p(j)(k);
+      return i < j;
+    } );
+
+    std::vector<uint32_t> index( n );
+    _pos.clear();
+    for( uint32_t i = 0; i < n; i++ ) {
+      const Point<T,3>& q = p(ids[i]);
+      if( _pos.empty() || q(0) != _pos.back()(0) || q(1) != _pos.back()(1) || q(2) != _pos.back()(2) )
+        _pos.push_back( q );
+      index[ids[i]] = uint32_t( _pos.size() - 1 );
+    }
+
+    _tri.clear();
+    _tri.reserve( n );
+    for( uint32_t i = 0; i < n; i += 3 ) {
+      const uint32_t a = index[i], b = index[i+1], c = index[i+2];
+      if( a == b || b == c || c == a ) continue;
+
+      _tri.push_back( a );
+      _tri.push_back( b );
+      _tri.push_back( c );
+    }
+
+    _init();
+  }
+
+
+  template <typename T>
+  void TSSimplifier<T>::set( const TSMesh<T>& mesh ) {
+
+    _pos.resize( mesh.getNoVertices() );
+    for( uint32_t v = 0; v < mesh.getNoVertices(); v++ )
+      _pos[v] = mesh.getPosition(v);
+
+    _tri = mesh.getIndices();
+    _init();
+  }
+
+
+  /** void TSSimplifier<T>::setBoundaryPreserved( bool preserve )
+   *  \brief Keeps the vertices on the boundary where they are
+   */
+  template <typename T>
+  inline
+  void TSSimplifier<T>::setBoundaryPreserved( bool preserve ) {
+
+    _preserve_boundary = preserve;
+  }
+
+
+  /** void TSSimplifier<T>::setFeatureAngle( T angle )
+   *  \brief Keeps the vertices of edges where the normals differ by more than angle
+   *
+   *  In radians, 0 for no feature edges, which is the default.
+   */
+  template <typename T>
+  inline
+  void TSSimplifier<T>::setFeatureAngle( T angle ) {
+
+    _feature_angle = angle;
+  }
+
+
+  /** uint32_t TSSimplifier<T>::simplify( uint32_t no_triangles, double max_error )
+   *  \brief Collapses edges until no more than no_triangles are left, or no edge is within max_error
+   *
+   *  The error is the sum of the squared distances from the moved vertices
+   *  to the planes of the triangles they have been part of. Returns the
+   *  number of triangles left, which may be more than asked for where no
+   *  more edges can be collapsed. Can be called again, with other limits.
+   *
+   *  The edges are collapsed in passes. In each, the errors of all edges are
+   *  computed, see _queue(), and those up to 1.5 times the error of the last
+   *  collapse needed, if each went, are tried in order. A collapse puts the
+   *  edges of its vertices out of date, so they wait for the next pass.
+   */
+  template <typename T>
+  uint32_t TSSimplifier<T>::simplify( uint32_t no_triangles, double max_error ) {
+
+    auto less = []( const Collapse& p, const Collapse& q ) { return p.error < q.error; };
+
+    bool limited = true;
+    while( _no_tri > no_triangles ) {
+
+      _queue();
+
+      double limit = max_error;
+      const size_t goal = std::max( uint32_t(1), ( _no_tri - no_triangles ) / 2 );
+      if( limited && goal < _collapses.size() ) {
+        std::nth_element( _collapses.begin(), _collapses.begin() + goal, _collapses.end(), less );
+        limit = std::min( limit, 1.5 * _collapses[goal].error );
+      }
+
+      const auto end = std::partition( _collapses.begin(), _collapses.end(), [limit]( const Collapse& c ) {
+        return c.error <= limit; } );
+      std::sort( _collapses.begin(), end, less );
+
+      uint32_t done = 0;
+      for( auto c = _collapses.begin(); c != end && _no_tri > no_triangles; ++c ) {
+
+        if( _stamp[c->v[0]] != c->stamp[0] || _stamp[c->v[1]] != c->stamp[1] ) continue;
+
+        if( _collapse( *c ) ) {
+          _error = std::max( _error, c->error );
+          done++;
+        }
+      }
+
+      // Where none within the limit could be made, try all once
+      if( !done && !limited ) break;
+      limited = done > 0;
+    }
+
+    std::vector<Collapse>().swap( _collapses );
+
+    return _no_tri;
+  }
+
+
+} // end namespace
@@ -0,0 +1,158 @@
+/**********************************************************************************
+**
+** Copyright (C) 1994 Narvik University College
+** Contact: GMlib Online Portal at http://episteme.hin.no
+**
+** This file is part of the Geometric Modeling Library, GMlib.
+**
+** GMlib is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** GMlib is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with GMlib.  If not, see <http://www.gnu.org/licenses/>.
+**
+**********************************************************************************/
+
+
+
+#ifndef GM_TRIANGLESYSTEM_TSSIMPLIFIER_H
+#define GM_TRIANGLESYSTEM_TSSIMPLIFIER_H
+
+
+// gmlib
+#include <core/containers/gmarray.h>
+#include <core/types/gmpoint.h>
+
+// stl
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+namespace GMlib {
+
+
+  template <typename T>
+  class TriangleFacets;
+
+  template <typename T>
+  class TSMesh;
+
+
+
+  /** \class  TSSimplifier gmtssimplifier.h <gmTriangleSystem>
+   *  \brief  Simplifies a triangle mesh by edge collapses, by the quadric error metric
+   *
+   *  Each vertex has the quadric of the planes of its triangles, giving the
+   *  sum of the squared distances to them. An edge is collapsed into the
+   *  point where the sum of the quadrics of its vertices is smallest, and
+   *  that sum is its error. The edge of the smallest error goes first, as
+   *  long as the mesh stays manifold and no triangle is turned over.
+   *
+   *  The mesh is indexed, and is read from a TSMesh, from points and index
+   *  triples, or from a triangle soup as StlObject::getPoints(), where equal
+   *  points are joined. It is given back in the same forms, as a triangle
+   *  soup with one normal per triangle as in an StlObject, and, for a height
+   *  field, as a TriangleFacets. Vertices on the boundary, and on edges where
+   *  the triangles meet at a larger angle than the feature angle, can be
+   *  kept where they are.
+   *
+   *  The edges are collapsed in passes, see simplify(), and before each the
+   *  errors of all edges are computed in parallel, see parallelFor().
+   */
+  template <typename T>
+  class TSSimplifier {
+  public:
+    TSSimplifier();
+    TSSimplifier( const TSMesh<T>& mesh );
+
+    void                    get( std::vector< Point<T,3> >& p, std::vector<uint32_t>& tri ) const;
+    void                    get( Array< Point<T,3> >& p, Array< Vector<T,3> >& n ) const;
+    void                    get( TSMesh<T>& mesh ) const;
+    void                    get( TriangleFacets<T>& tf ) const;
+
+    double                  getError() const;
+    T                       getFeatureAngle() const;
+    uint32_t                getNoTriangles() const;
+    uint32_t                getNoVertices() const;
+
+    bool                    isBoundaryPreserved() const;
+
+    void                    set( const std::vector< Point<T,3> >& p, const std::vector<uint32_t>& tri );
+    void                    set( const Array< Point<T,3> >& p );
+    void                    set( const TSMesh<T>& mesh );
+    void                    setBoundaryPreserved( bool preserve = true );
+    void                    setFeatureAngle( T angle );
+
+    uint32_t                simplify( uint32_t no_triangles, double max_error = std::numeric_limits<double>::max() );
+
+  private:
+    /** The sum of the squared distances to planes, by its upper triangle */
+    struct Quadric {
+      double                a[10];
+
+      Quadric();
+      Quadric( const Point<T,3>& p, const Vector<T,3>& n, double w = 1.0 );
+
+      Quadric&              operator += ( const Quadric& q );
+      Quadric               operator +  ( const Quadric& q ) const;
+      double                operator () ( const Point<T,3>& p ) const;
+      bool                  getMinimum( Point<T,3>& p ) const;
+    };
+
+    struct Collapse {
+      double                error;
+      uint32_t              v[2];       //!< The vertices of the edge
+      uint32_t              stamp[2];   //!< of the vertices when queued
+    };
+
+    enum { Boundary = 1, Locked = 2, Removed = 4 };
+
+    std::vector< Point<T,3> >   _pos;
+    std::vector<uint32_t>   _tri;       //!< Three vertices per triangle, turned as given
+    std::vector<char>       _removed;   //!< Triangles collapsed
+    std::vector<uint32_t>   _first;     //!< Where the triangles of each vertex start in _ref
+    std::vector<uint32_t>   _count;     //!< and how many there are, the removed ones included
+    std::vector<uint32_t>   _ref;       //!< The triangles of the vertices
+    std::vector<Quadric>    _q;
+    std::vector<uint32_t>   _stamp;     //!< Counts the collapses of each vertex
+    std::vector<char>       _state;     //!< Boundary, Locked and Removed
+    std::vector<uint32_t>   _mark;      //!< Vertices seen, by _tag
+    uint32_t                _tag;
+    std::vector<uint32_t>   _scratch;
+    std::vector<Collapse>   _collapses; //!< The collapses to try in a pass
+
+    uint32_t                _no_tri;
+    uint32_t                _no_ver;
+    double                  _error;
+    bool                    _preserve_boundary;
+    T                       _feature_angle;
+
+    bool                    _collapse( const Collapse& c );
+    double                  _evaluate( uint32_t a, uint32_t b, Point<T,3>& x ) const;
+    template <typename F>
+    void                    _forEachEdge( uint32_t v, std::vector<uint64_t>& s, F f ) const;
+    Vector<T,3>             _getNormal( uint32_t t ) const;
+    void                    _init();
+    uint32_t                _nextTag();
+    void                    _queue();
+    bool                    _turns( uint32_t v, uint32_t other, const Point<T,3>& x ) const;
+  };
+
+
+} // end namespace
+
+
+
+// Include implementations
+#include "gmtssimplifier.c"
+
+
+#endif // GM_TRIANGLESYSTEM_TSSIMPLIFIER_H
@@ -104,10 +104,12 @@ namespace GMlib {
   inline
   void TriangleFacetsDefaultVisualizer<T>::replot(const TriangleFacets<T> *tf)  {
 
-    TriangleFacetsVisualizer<T>::fillStandardVBO( _vbo, tf );
-    TriangleFacetsVisualizer<T>::fillStandardIBO( _ibo, tf );
+    const TSMesh<T> mesh( *tf );
 
-    _no_elements = tf->getNoTriangles() * 3;
+    TriangleFacetsVisualizer<T>::fillStandardVBO( _vbo, mesh );
+    TriangleFacetsVisualizer<T>::fillStandardIBO( _ibo, mesh );
+
+    _no_elements = int( mesh.getNoTriangles() ) * 3;
   }
 
   template <typename T>
@@ -32,17 +32,24 @@ namespace GMlib {
   TriangleFacetsVisualizer<T>::~TriangleFacetsVisualizer() {}
 
   template <typename T>
+  inline
   void TriangleFacetsVisualizer<T>::fillStandardVBO(
       GL::VertexBufferObject &vbo, const TriangleFacets<T> *tf) {
 
-    int no_vertices = tf->getSize();
+    fillStandardVBO( vbo, TSMesh<T>( *tf ) );
+  }
+
+  template <typename T>
+  void TriangleFacetsVisualizer<T>::fillStandardVBO(
+      GL::VertexBufferObject &vbo, const TSMesh<T>& mesh ) {
+
+    int no_vertices = int( mesh.getNoVertices() );
     DVector<GL::GLVertexNormal> vertices(no_vertices);
 
     for( int i = 0; i < no_vertices; i++ ) {
 
-      TSVertex<float> *v = tf->getVertex(i);
-      const Point<float,3> &pos = v->getPos();
-      Vector<float,3> nor = v->getDir();
+      const Point<T,3>  pos = mesh.getPosition(i);
+      const Vector<T,3> nor = mesh.getNormal(i);
 
       vertices[i].x = pos(0);
       vertices[i].y = pos(1);
@@ -61,26 +68,22 @@ namespace GMlib {
   }
 
   template <typename T>
+  inline
   void TriangleFacetsVisualizer<T>::fillStandardIBO(
       GL::IndexBufferObject& ibo, const TriangleFacets<T>* tf ) {
 
-    int no_indices = tf->getNoTriangles() * 3;
-
-    DVector<GLuint> indices(no_indices);
-    GLuint *iptr = indices.getPtr();
+    fillStandardIBO( ibo, TSMesh<T>( *tf ) );
+  }
 
-    for( int i = 0; i < tf->getNoTriangles(); i++ ) {
+  template <typename T>
+  void TriangleFacetsVisualizer<T>::fillStandardIBO(
+      GL::IndexBufferObject& ibo, const TSMesh<T>& mesh ) {
 
-      Array< TSVertex<float>* > tri_verts = tf->getTriangle(i)->getVertices();
-      for( int j = 0; j < tri_verts.getSize(); j++ )
-        for( int k = 0; k < tf->getSize(); k++ )
-          if( tri_verts[j] == tf->getVertex(k) )
-            *iptr++ = k;
-    }
+    const std::vector<uint32_t>& indices = mesh.getIndices();
 
-    ibo.bufferData( no_indices * sizeof(GLuint), indices.getPtr(), GL_STATIC_DRAW );
+    ibo.bufferData( indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW );
 
-//    std::cout << "TriangleFacetsVisualizer: No. Indices: " << no_indices << std::endl;
+//    std::cout << "TriangleFacetsVisualizer: No. Indices: " << indices.size() << std::endl;
   }
 
   template <typename T>
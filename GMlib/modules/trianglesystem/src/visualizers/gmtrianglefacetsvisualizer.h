@@ -39,6 +39,9 @@ namespace GMlib {
   template <typename T>
   class TriangleFacets;
 
+  template <typename T>
+  class TSMesh;
+
   template <typename T>
   class TriangleFacetsVisualizer : public Visualizer {
   public:
@@ -50,8 +53,12 @@ namespace GMlib {
 
     static void   fillStandardVBO( GL::VertexBufferObject& vbo,
                                    const TriangleFacets<T>* tf );
+    static void   fillStandardVBO( GL::VertexBufferObject& vbo,
+                                   const TSMesh<T>& mesh );
     static void   fillStandardIBO( GL::IndexBufferObject& ibo,
                                    const TriangleFacets<T>* tf );
+    static void   fillStandardIBO( GL::IndexBufferObject& ibo,
+                                   const TSMesh<T>& mesh );
 
   }; // END class TriangleFacetsVisualizer
 
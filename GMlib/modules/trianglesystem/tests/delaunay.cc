@@ -0,0 +1,337 @@
+#include <gtest/gtest.h>
+
+#include <gmTrianglesystemModule>
+#include <core/utils/gmparallel.h>
+using namespace GMlib;
+
+#include "testfacets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+namespace {
+
+  double orient( const Point<float,2>& a, const Point<float,2>& b, const Point<float,2>& c ) {
+    return ( double(b[0]) - a[0] ) * ( double(c[1]) - a[1] ) - ( double(b[1]) - a[1] ) * ( double(c[0]) - a[0] );
+  }
+
+
+  // True if d is inside the circle through a, b and c, counterclockwise, by
+  // more than the rounding error of the determinant
+  bool inCircle( const Point<float,2>& a, const Point<float,2>& b, const Point<float,2>& c, const Point<float,2>& d ) {
+
+    const double adx = double(a[0]) - d[0], ady = double(a[1]) - d[1];
+    const double bdx = double(b[0]) - d[0], bdy = double(b[1]) - d[1];
+    const double cdx = double(c[0]) - d[0], cdy = double(c[1]) - d[1];
+    const double det = ( adx*adx + ady*ady ) * ( bdx*cdy - cdx*bdy )
+                     + ( bdx*bdx + bdy*bdy ) * ( cdx*ady - adx*cdy )
+                     + ( cdx*cdx + cdy*cdy ) * ( adx*bdy - bdx*ady );
+    const double per = ( adx*adx + ady*ady ) * ( std::fabs(bdx*cdy) + std::fabs(cdx*bdy) )
+                     + ( bdx*bdx + bdy*bdy ) * ( std::fabs(cdx*ady) + std::fabs(adx*cdy) )
+                     + ( cdx*cdx + cdy*cdy ) * ( std::fabs(adx*bdy) + std::fabs(bdx*ady) );
+    return det > 1e-12 * per;
+  }
+
+
+  // Area of the convex hull, by the monotone chain
+  double hullArea( TriangleFacets<float>& tf ) {
+
+    std::vector<Point<float,2>> p;
+    for( int i = 0; i < tf.getSize(); i++ ) p.push_back( tf[i].getParameter() );
+    std::sort( p.begin(), p.end(), []( const Point<float,2>& a, const Point<float,2>& b ) {
+      return a[0] < b[0] || ( a[0] == b[0] && a[1] < b[1] ); } );
+
+    std::vector<Point<float,2>> h( 2*p.size() );
+    int k = 0;
+    for( size_t i = 0; i < p.size(); i++ ) {
+      while( k >= 2 && orient( h[k-2], h[k-1], p[i] ) <= 0.0 ) k--;
+      h[k++] = p[i];
+    }
+    for( int i = int(p.size())-2, l = k+1; i >= 0; i-- ) {
+      while( k >= l && orient( h[k-2], h[k-1], p[i] ) <= 0.0 ) k--;
+      h[k++] = p[i];
+    }
+
+    double area = 0.0;
+    for( int i = 1; i+1 < k; i++ ) area += orient( h[0], h[i], h[i+1] );
+    return area / 2;
+  }
+
+
+  // The Delaunay property checker: the triangles are counterclockwise, refer
+  // to their edges and back, cover the convex hull once, and no vertex
+  // across an edge is inside the circumcircle of a triangle
+  void expectDelaunay( TriangleFacets<float>& tf ) {
+
+    double area = 0.0;
+    int    flipped = 0, unlinked = 0, inside = 0;
+
+    for( int i = 0; i < tf.getNoTriangles(); i++ ) {
+
+      TSTriangle<float>*         t = tf.getTriangle(i);
+      Array<TSVertex<float>*>    v = t->getVertices();
+      Array<TSEdge<float>*>      e = t->getEdges();
+      const Point<float,2> a = v[0]->getParameter(), b = v[1]->getParameter(), c = v[2]->getParameter();
+
+      const double o = orient( a, b, c );
+      if( o <= 0.0 ) flipped++;
+      area += o / 2;
+
+      for( int k = 0; k < 3; k++ ) {
+
+        Array<TSTriangle<float>*> nt = e[k]->getTriangle();
+        if( !nt.exist( t ) ) unlinked++;
+
+        for( int j = 0; j < nt.getSize(); j++ ) {
+          if( nt[j] == t ) continue;
+
+          Array<TSVertex<float>*> w = nt[j]->getVertices();
+          for( int q = 0; q < 3; q++ ) {
+            if( w[q] == e[k]->getFirstVertex() || w[q] == e[k]->getLastVertex() ) continue;
+
+            if( inCircle( a, b, c, w[q]->getParameter() ) ) inside++;
+          }
+        }
+      }
+    }
+
+    EXPECT_EQ( flipped, 0 );
+    EXPECT_EQ( unlinked, 0 );
+    EXPECT_EQ( inside, 0 );
+    EXPECT_NEAR( area, hullArea( tf ), 1e-6 );
+  }
+
+
+  TEST(Delaunay, Parallel_is_the_same_as_in_one_piece) {
+
+    setNoThreads( 4 );
+
+    Facets one( 20000, Uniform );
+    one.tf->enableParallelTriangulation( 1 );
+    EXPECT_TRUE( one.tf->isParallelTriangulation() );
+    one.tf->triangulateDelaunay();
+    expectDelaunay( *one.tf );
+    const std::vector<Triangle> tri = triangles( *one.tf );
+
+    for( int partitions : { 0, 4, 7 } ) {
+      Facets f( 20000, Uniform );
+      f.tf->enableParallelTriangulation( partitions );
+      f.tf->triangulateDelaunay();
+      expectDelaunay( *f.tf );
+      EXPECT_EQ( triangles( *f.tf ), tri );
+    }
+  }
+
+
+  TEST(Delaunay, Parallel_matches_the_serial_triangulation) {
+
+    // Without cocircular vertices the triangulation is unique
+    for( Distribution dist : { Uniform, Clustered } ) {
+
+      Facets f( 2000, dist );
+      f.tf->enableParallelTriangulation( 4 );
+      f.tf->triangulateDelaunay();
+      expectDelaunay( *f.tf );
+
+      for( bool bulk : { false, true } ) {
+        Facets serial( 2000, dist );
+        serial.tf->triangulateDelaunay( bulk );
+        EXPECT_EQ( triangles( *serial.tf ), triangles( *f.tf ) );
+      }
+    }
+  }
+
+
+  TEST(Delaunay, Serial_one_by_one_and_in_bulk) {
+
+    for( bool bulk : { false, true } )
+      for( Distribution dist : { Uniform, Clustered, Gridded } ) {
+
+        Facets f( 3000, dist );
+        f.tf->triangulateDelaunay( bulk );
+        expectDelaunay( *f.tf );
+      }
+  }
+
+
+  TEST(Delaunay, Convex_and_concave_quadrilaterals) {
+
+    for( bool bulk : { false, true } ) {
+
+      // A flat rhombus, swapped to the short diagonal whatever the first one
+      Facets f( 0, Uniform );
+      f.tf->insertAlways( TSVertex<float>( 0.0f,  0.0f ) );
+      f.tf->insertAlways( TSVertex<float>( 0.5f, -0.1f ) );
+      f.tf->insertAlways( TSVertex<float>( 1.0f,  0.0f ) );
+      f.tf->insertAlways( TSVertex<float>( 0.5f,  0.1f ) );
+      f.tf->triangulateDelaunay( bulk );
+      expectDelaunay( *f.tf );
+      ASSERT_EQ( f.tf->getNoTriangles(), 2 );
+      for( const Triangle& t : triangles( *f.tf ) ) {
+        EXPECT_NE( std::find( t.begin(), t.end(), std::make_pair( 0.5f, -0.1f ) ), t.end() );
+        EXPECT_NE( std::find( t.begin(), t.end(), std::make_pair( 0.5f,  0.1f ) ), t.end() );
+      }
+
+      // A vertex inside a triangle, where each quadrilateral of two of the
+      // three triangles is concave and must not be swapped
+      Facets g( 0, Uniform );
+      g.tf->insertAlways( TSVertex<float>( 0.0f, 0.0f ) );
+      g.tf->insertAlways( TSVertex<float>( 1.0f, 0.0f ) );
+      g.tf->insertAlways( TSVertex<float>( 0.5f, 1.0f ) );
+      g.tf->insertAlways( TSVertex<float>( 0.5f, 0.1f ) );
+      g.tf->triangulateDelaunay( bulk );
+      expectDelaunay( *g.tf );
+      EXPECT_EQ( g.tf->getNoTriangles(), 3 );
+    }
+  }
+
+
+  TEST(Delaunay, Triangulate_again_after_clear) {
+
+    for( bool bulk : { false, true } ) {
+
+      Facets f( 2000, Clustered );
+      std::vector<Point<float,2>> p;
+      for( int i = 0; i < f.tf->getSize(); i++ ) p.push_back( (*f.tf)[i].getParameter() );
+
+      f.tf->triangulateDelaunay( bulk );
+      const std::vector<Triangle> tri = triangles( *f.tf );
+
+      f.tf->clear();
+      EXPECT_EQ( f.tf->getSize(), 0 );
+      EXPECT_EQ( f.tf->getNoTriangles(), 0 );
+
+      for( const Point<float,2>& q : p )
+        f.tf->insertAlways( TSVertex<float>( q[0], q[1], 0.0f ) );
+      f.tf->triangulateDelaunay( bulk );
+      expectDelaunay( *f.tf );
+      EXPECT_EQ( triangles( *f.tf ), tri );
+    }
+  }
+
+
+  TEST(Delaunay, Insert_vertices_after_triangulation) {
+
+    // The edges and triangles of the three outer vertices, removed at the
+    // end of the triangulation, are in the free lists of the arenas and
+    // used again by the splits
+    Facets f( 500, Uniform );
+    f.tf->triangulateDelaunay();
+
+    std::mt19937                          rng( 7 );
+    std::uniform_real_distribution<float> u( 0.25f, 0.75f );
+    for( int i = 0; i < 500; ) {
+
+      // Not within the position tolerance of a vertex, which would only
+      // move that vertex
+      TSVertex<float> v( u(rng), u(rng), 0.0f );
+      bool apart = true;
+      for( int j = 0; j < f.tf->getSize(); j++ )
+        apart = apart && ( (*f.tf)[j].getParameter() - v.getParameter() ).getLength() > 2e-3f;
+      if( !apart ) continue;
+
+      const int no_tri = f.tf->getNoTriangles();
+      EXPECT_TRUE( f.tf->insertVertex( v ) );
+      EXPECT_EQ( f.tf->getNoTriangles(), no_tri + 2 );
+      i++;
+    }
+    EXPECT_EQ( f.tf->getSize(), 1000 );
+    expectDelaunay( *f.tf );
+
+    // A vertex on top of another one is not inserted
+    TSVertex<float> w( (*f.tf)[0] );
+    EXPECT_FALSE( f.tf->insertVertex( w ) );
+    EXPECT_EQ( f.tf->getSize(), 1000 );
+  }
+
+
+  TEST(Delaunay, Two_facets_edited_in_turns) {
+
+    // The edges and triangles are made in, and given back to, the arenas of
+    // their own facets, whichever facets was used last
+    Facets f( 300, Uniform, 5 );
+    f.tf->triangulateDelaunay();
+    const int no_tri = f.tf->getNoTriangles();
+    {
+      Facets g( 300, Clustered, 6 );
+      g.tf->triangulateDelaunay();
+      const int no_g = g.tf->getNoTriangles();
+
+      // Removing a vertex leaves a hole of its triangles
+      TSVertex<float> v( 0.5f, 0.5f, 0.0f );
+      EXPECT_TRUE( f.tf->insertVertex( v ) );
+      EXPECT_TRUE( g.tf->removeVertex( (*g.tf)[0] ) );
+      EXPECT_LT( g.tf->getNoTriangles(), no_g );
+      EXPECT_EQ( g.tf->getSize(), 299 );
+    }
+    EXPECT_EQ( f.tf->getNoTriangles(), no_tri + 2 );
+    expectDelaunay( *f.tf );
+  }
+
+
+  struct Counted {
+    static int alive;
+    int        id;
+    explicit Counted( int i ) : id(i) { alive++; }
+    ~Counted() { alive--; }
+  };
+  int Counted::alive = 0;
+
+
+  TEST(TSArena, Size_and_reuse_of_freed_elements) {
+
+    TSArena<Counted> a;
+    EXPECT_EQ( a.getSize(), 0 );
+
+    // More than one block
+    std::vector<Counted*> e;
+    for( int i = 0; i < 5000; i++ ) e.push_back( a.create( i ) );
+    EXPECT_EQ( a.getSize(), 5000 );
+    EXPECT_EQ( Counted::alive, 5000 );
+    for( int i = 0; i < 5000; i++ ) EXPECT_EQ( e[i]->id, i );
+
+    // Freed memory is used again, the last freed first
+    a.destroy( e[10] );
+    a.destroy( e[4500] );
+    EXPECT_EQ( a.getSize(), 4998 );
+    EXPECT_EQ( Counted::alive, 4998 );
+    EXPECT_EQ( a.create( -1 ), e[4500] );
+    EXPECT_EQ( a.create( -2 ), e[10] );
+    EXPECT_EQ( a.getSize(), 5000 );
+    EXPECT_EQ( e[10]->id, -2 );
+
+    // Released without the destructors, and usable after
+    a.release();
+    EXPECT_EQ( a.getSize(), 0 );
+    EXPECT_EQ( Counted::alive, 5000 );
+    Counted* c = a.create( 3 );
+    EXPECT_EQ( c->id, 3 );
+    EXPECT_EQ( a.getSize(), 1 );
+
+    // A copy is empty
+    TSArena<Counted> b( a );
+    EXPECT_EQ( b.getSize(), 0 );
+    a = b;
+    EXPECT_EQ( a.getSize(), 0 );
+    Counted::alive = 0;
+  }
+
+
+  TEST(Delaunay, Parallel_with_strips_on_a_line) {
+
+    // One column of the grid in each strip, all merged
+    Facets f( 256*256, Gridded );
+    f.tf->enableParallelTriangulation( 256 );
+    f.tf->triangulateDelaunay();
+    expectDelaunay( *f.tf );
+    EXPECT_EQ( f.tf->getNoTriangles(), 2*255*255 );
+
+    f.tf->disableParallelTriangulation();
+    EXPECT_FALSE( f.tf->isParallelTriangulation() );
+  }
+
+}
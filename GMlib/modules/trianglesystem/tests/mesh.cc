@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+
+#include <gmTrianglesystemModule>
+#include <core/utils/gmparallel.h>
+using namespace GMlib;
+
+#include "testfacets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+  // A triangulated height field over the unit square. The hull of the
+  // random vertices has long and thin triangles, over which the linear
+  // height is far from the exact one, unless framed by vertices just
+  // outside the square.
+  Facets heightField( int n, bool framed = false ) {
+
+    Facets f( n, Uniform, 7 );
+    if( framed ) {
+      const int   m = 32;
+      const float a = -0.05f, l = 1.1f;
+      f.n += 4*m;
+      f.tf->setMaxSize( f.n + 3 );
+      for( int i = 0; i < m; i++ ) {
+        const float s = l * i / m;
+        f.tf->insertAlways( TSVertex<float>( a + s,     a,         0.0f ) );
+        f.tf->insertAlways( TSVertex<float>( a + l,     a + s,     0.0f ) );
+        f.tf->insertAlways( TSVertex<float>( a + l - s, a + l,     0.0f ) );
+        f.tf->insertAlways( TSVertex<float>( a,         a + l - s, 0.0f ) );
+      }
+    }
+    f.setHeights();
+    f.tf->triangulateDelaunay( true );
+    f.tf->computeNormals();
+    return f;
+  }
+
+
+  TEST(TSMesh, Half_edges_match_the_facets) {
+
+    Facets f = heightField( 3000 );
+    TSMesh<float> mesh( *f.tf );
+
+    ASSERT_EQ( int( mesh.getNoVertices() ), f.tf->getSize() );
+    ASSERT_EQ( int( mesh.getNoTriangles() ), f.tf->getNoTriangles() );
+
+    int boundary = 0;
+    for( uint32_t h = 0; h < 3*mesh.getNoTriangles(); h++ ) {
+
+      const uint32_t g = mesh.getTwin(h);
+      if( g == TSMesh<float>::NoIndex ) {
+        boundary++;
+        continue;
+      }
+      EXPECT_EQ( mesh.getTwin(g), h );
+      EXPECT_EQ( mesh.getVertex(g), mesh.getVertex( TSMesh<float>::getNext(h) ) );
+      EXPECT_EQ( mesh.getVertex( TSMesh<float>::getNext(g) ), mesh.getVertex(h) );
+    }
+
+    int edges_on_boundary = 0;
+    for( int i = 0; i < f.tf->getNoEdges(); i++ )
+      if( f.tf->getEdge(i)->boundary() ) edges_on_boundary++;
+    EXPECT_EQ( boundary, edges_on_boundary );
+
+    // The same triangles around each vertex, in turn
+    for( uint32_t v = 0; v < mesh.getNoVertices(); v++ ) {
+
+      int k = 0;
+      uint32_t last = TSMesh<float>::NoIndex;
+      mesh.forEachHalfEdge( v, [&]( uint32_t h ) {
+        EXPECT_EQ( mesh.getVertex(h), v );
+        if( last != TSMesh<float>::NoIndex ) {
+          EXPECT_EQ( mesh.getVertex( TSMesh<float>::getNext(h) ), mesh.getVertex( TSMesh<float>::getPrev(last) ) );
+        }
+        last = h;
+        k++;
+      } );
+      EXPECT_EQ( k, f.tf->getVertex( int(v) )->getTriangles().getSize() );
+      EXPECT_EQ( mesh.isBoundary(v), f.tf->getVertex( int(v) )->boundary() );
+    }
+  }
+
+
+  TEST(TSMesh, Back_to_facets) {
+
+    Facets f = heightField( 3000 );
+    TSMesh<float> mesh( *f.tf );
+
+    Facets g;
+    mesh.get( *g.tf );
+
+    ASSERT_EQ( g.tf->getSize(), f.tf->getSize() );
+    EXPECT_EQ( triangles( *g.tf ), triangles( *f.tf ) );
+
+    for( int i = 0; i < f.tf->getSize(); i++ ) {
+      EXPECT_EQ( g.tf->getVertex(i)->getPosition(), f.tf->getVertex(i)->getPosition() );
+      EXPECT_EQ( g.tf->getVertex(i)->getNormal(), f.tf->getVertex(i)->getNormal() );
+    }
+
+    // and again, into facets that are in use
+    mesh.get( *f.tf );
+    EXPECT_EQ( triangles( *f.tf ), triangles( *g.tf ) );
+    EXPECT_NEAR( f.tf->evalZ( 0.5f, 0.5f ), Facets::height( 0.5f, 0.5f ), 1e-3 );
+  }
+
+
+  TEST(TSMesh, Normals_as_the_facets) {
+
+    Facets f = heightField( 3000 );
+    TSMesh<float> mesh( *f.tf );
+    mesh.computeNormals();
+    for( uint32_t v = 0; v < mesh.getNoVertices(); v++ ) {
+
+      // The facets do not keep all triangles counterclockwise
+      const Vector<float,3> a = mesh.getNormal(v);
+      const Vector<float,3> b = f.tf->getVertex( int(v) )->getNormal();
+      EXPECT_GT( a[2], 0.0f );
+      EXPECT_NEAR( std::fabs( a * b ), a.getLength() * b.getLength(), 1e-4 * a.getLength() * b.getLength() );
+    }
+  }
+
+
+  TEST(TSMesh, Height_as_the_facets) {
+
+    // The facets do not keep all triangles counterclockwise, so the cubic
+    // height is compared on facets with the normals of the mesh
+    Facets f = heightField( 3000, true );
+    TSMesh<float> mesh( *f.tf );
+    mesh.computeNormals();
+    mesh.get( *f.tf );
+
+    std::mt19937                          rng( 3 );
+    std::uniform_real_distribution<float> u( -0.1f, 1.1f );
+
+    uint32_t t = 0;
+    for( int i = 0; i < 1000; i++ ) {
+
+      const Point<float,2> p( u(rng), u(rng) );
+      t = mesh.locate( p, t );
+      if( t == TSMesh<float>::NoIndex ) {
+        EXPECT_EQ( mesh.evalZ( p ), 0.0f );
+        EXPECT_EQ( f.tf->evalZ( p ), 0.0f );
+        t = 0;
+        continue;
+      }
+
+      EXPECT_NEAR( mesh.evalZ( t, p ), f.tf->evalZ( p ), 1e-5 );
+      EXPECT_NEAR( mesh.evalZ( t, p, 3 ), f.tf->evalZ( p, 3 ), 1e-5 );
+      EXPECT_NEAR( mesh.evalZ( p ), Facets::height( p[0], p[1] ), 1e-2 );
+    }
+  }
+
+
+  TEST(TSMesh, From_indexed_triangles) {
+
+    // A square of two triangles, and a third one hanging on a corner
+    std::vector< Point<float,3> > p = { Point<float,3>( 0, 0, 0 ), Point<float,3>( 1, 0, 0 ),
+                                        Point<float,3>( 1, 1, 0 ), Point<float,3>( 0, 1, 0 ),
+                                        Point<float,3>( 2, 1, 0 ), Point<float,3>( 2, 2, 0 ) };
+    TSMesh<float> mesh;
+    mesh.set( p, { 0, 1, 2,  0, 2, 3,  2, 4, 5 } );
+
+    EXPECT_EQ( mesh.getNoTriangles(), 3u );
+    EXPECT_EQ( mesh.getTwin(2), 3u );
+    EXPECT_EQ( mesh.getTwin(3), 2u );
+    for( uint32_t h : { 0u, 1u, 4u, 5u, 6u, 7u, 8u } )
+      EXPECT_EQ( mesh.getTwin(h), TSMesh<float>::NoIndex );
+
+    for( uint32_t v = 0; v < mesh.getNoVertices(); v++ )
+      EXPECT_TRUE( mesh.isBoundary(v) );
+
+    mesh.computeNormals();
+    EXPECT_EQ( mesh.getNormal(0)[2], 1.0f );
+    EXPECT_EQ( mesh.getNormal(0).getLength(), 1.0f );
+    EXPECT_EQ( mesh.locate( Point<float,2>( 0.9f, 0.2f ), 1 ), 0u );
+    EXPECT_EQ( mesh.locate( Point<float,2>( 0.5f, -0.5f ), 1 ), TSMesh<float>::NoIndex );
+  }
+
+
+  TEST(TriangleFacets, Heights_in_a_batch) {
+
+    setNoThreads( 4 );
+    Facets f = heightField( 3000 );
+
+    // A raster over more than the triangulation, and random points after it
+    const int m = 300;
+    std::vector< Point<float,2> > p;
+    for( int i = 0; i < m; i++ )
+      for( int j = 0; j < m; j++ )
+        p.push_back( Point<float,2>( -0.1f + 1.2f * j / m, -0.1f + 1.2f * i / m ) );
+
+    std::mt19937                          rng( 3 );
+    std::uniform_real_distribution<float> u( -0.1f, 1.1f );
+    for( int i = 0; i < 10000; i++ )
+      p.push_back( Point<float,2>( u(rng), u(rng) ) );
+
+    for( int deg : { 1, 3 } ) {
+
+      std::vector<float> z( p.size() ), w( p.size() );
+      f.tf->evalZBatch( p.data(), z.data(), p.size(), deg );
+
+      // and at the same time, from two threads
+      std::thread other( [&]() { f.tf->evalZBatch( p.data(), w.data(), p.size(), deg ); } );
+      std::vector<float> v( p.size() );
+      f.tf->evalZBatch( p.data(), v.data(), p.size(), deg );
+      other.join();
+
+      int outside = 0;
+      for( size_t i = 0; i < p.size(); i++ ) {
+
+        // The triangle can differ on an edge
+        EXPECT_NEAR( z[i], f.tf->evalZ( p[i], deg ), 1e-6 );
+        EXPECT_EQ( v[i], z[i] );
+        EXPECT_EQ( w[i], z[i] );
+        if( f.tf->evalZ( p[i], deg ) == 0.0f ) outside++;
+      }
+      EXPECT_GT( outside, 0 );
+    }
+
+    f.tf->evalZBatch( p.data(), nullptr, 0 );
+  }
+
+
+  TEST(TriangleFacets, Normals_as_the_mean_of_the_triangles) {
+
+    setNoThreads( 4 );
+    Facets f = heightField( 3000 );
+
+    for( int i = 0; i < f.tf->getSize(); i++ ) {
+
+      Array<TSTriangle<float>*> t = f.tf->getVertex(i)->getTriangles();
+      Vector<float,3> nor( 0.0f );
+      for( int j = 0; j < t.getSize(); j++ ) nor += t[j]->getNormal();
+      nor /= float( t.getSize() );
+
+      const Vector<float,3> n = f.tf->getVertex(i)->getNormal();
+      for( int k = 0; k < 3; k++ )
+        EXPECT_NEAR( n[k], nor[k], 1e-6 );
+    }
+  }
+
+
+  TEST(TriangleFacets, Voronoi_as_the_dual) {
+
+    setNoThreads( 4 );
+    Facets f = heightField( 3000 );
+
+    for( int pass = 0; pass < 2; pass++ ) {
+
+      f.tf->createVoronoi();
+
+      const Array< Point<float,2> >& p = f.tf->getVoronoiPoints();
+      ASSERT_EQ( p.getSize(), f.tf->getNoTriangles() );
+
+      // The circumcenters
+      for( int i = 0; i < p.getSize(); i++ ) {
+        Array<TSVertex<float>*> v = f.tf->getTriangle(i)->getVertices();
+        const float r = ( v[0]->getParameter() - p(i) ).getLength();
+        EXPECT_NEAR( ( v[1]->getParameter() - p(i) ).getLength(), r, 1e-3 * ( r + 1 ) );
+        EXPECT_NEAR( ( v[2]->getParameter() - p(i) ).getLength(), r, 1e-3 * ( r + 1 ) );
+      }
+
+      // one edge between those of two triangles next to each other
+      std::map<TSTriangle<float>*,int> index;
+      for( int i = 0; i < f.tf->getNoTriangles(); i++ ) index[f.tf->getTriangle(i)] = i;
+
+      const Array< TSVEdge<float> >& e = f.tf->getVoronoiEdges();
+      int k = 0;
+      for( int i = 0; i < f.tf->getNoEdges(); i++ ) {
+
+        Array<TSTriangle<float>*> t = f.tf->getEdge(i)->getTriangle();
+        if( t.getSize() < 2 ) continue;
+
+        ASSERT_LT( k, e.getSize() );
+        const Point<float,2> a = p( index[t[0]] ), b = p( index[t[1]] );
+        const bool same = ( e(k)(0) == a && e(k)(1) == b ) || ( e(k)(0) == b && e(k)(1) == a );
+        EXPECT_TRUE( same );
+        k++;
+      }
+      EXPECT_EQ( k, e.getSize() );
+    }
+  }
+
+}
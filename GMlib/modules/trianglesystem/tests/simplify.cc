@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <gmTrianglesystemModule>
+#include <core/utils/gmparallel.h>
+using namespace GMlib;
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+namespace {
+
+  // An m x m grid over the unit square, two triangles in each cell,
+  // counterclockwise seen from above
+  void grid( int m, float (*height)( float, float ),
+             std::vector< Point<float,3> >& p, std::vector<uint32_t>& tri ) {
+
+    p.clear();
+    tri.clear();
+    for( int i = 0; i <= m; i++ )
+      for( int j = 0; j <= m; j++ ) {
+        const float x = float(j) / m, y = float(i) / m;
+        p.push_back( Point<float,3>( x, y, height( x, y ) ) );
+      }
+
+    for( int i = 0; i < m; i++ )
+      for( int j = 0; j < m; j++ ) {
+        const uint32_t a = i*(m+1) + j, b = a+1, c = a+m+2, d = a+m+1;
+        tri.insert( tri.end(), { a, b, c,  a, c, d } );
+      }
+  }
+
+  float flat( float, float )     { return 0.0f; }
+  float bump( float x, float y ) { return 0.2f * std::sin( 3*x ) * std::cos( 2*y ); }
+  float roof( float x, float )   { return 0.5f - std::fabs( x - 0.5f ); }
+
+
+  // The mesh is manifold, and all triangles face up
+  void expectHeightField( const std::vector< Point<float,3> >& p, const std::vector<uint32_t>& tri ) {
+
+    TSMesh<float> mesh;
+    mesh.set( p, tri );
+
+    int down = 0, unlinked = 0;
+    for( uint32_t t = 0; t < mesh.getNoTriangles(); t++ ) {
+
+      Vector<float,3> u = p[tri[3*t+1]] - p[tri[3*t]];
+      Vector<float,3> v = p[tri[3*t+2]] - p[tri[3*t]];
+      if( (u^v)[2] <= 0.0f ) down++;
+
+      for( uint32_t h = 3*t; h < 3*t+3; h++ ) {
+        const uint32_t g = mesh.getTwin(h);
+        if( g != TSMesh<float>::NoIndex && mesh.getTwin(g) != h ) unlinked++;
+      }
+    }
+    EXPECT_EQ( down, 0 );
+    EXPECT_EQ( unlinked, 0 );
+  }
+
+
+  TEST(TSSimplifier, Plane_to_two_triangles) {
+
+    setNoThreads( 4 );
+
+    std::vector< Point<float,3> > p;
+    std::vector<uint32_t>         tri;
+    grid( 40, flat, p, tri );
+
+    TSSimplifier<float> s;
+    s.set( p, tri );
+    EXPECT_EQ( s.getNoTriangles(), 2u*40*40 );
+    EXPECT_EQ( s.getNoVertices(), 41u*41 );
+
+    EXPECT_EQ( s.simplify( 2 ), 2u );
+    EXPECT_EQ( s.getNoVertices(), 4u );
+    EXPECT_LT( s.getError(), 1e-10 );
+
+    s.get( p, tri );
+    ASSERT_EQ( p.size(), 4u );
+    expectHeightField( p, tri );
+    for( const Point<float,3>& q : p ) {
+      EXPECT_TRUE( q[0] == 0.0f || q[0] == 1.0f );
+      EXPECT_TRUE( q[1] == 0.0f || q[1] == 1.0f );
+    }
+  }
+
+
+  TEST(TSSimplifier, Boundary_preserved) {
+
+    std::vector< Point<float,3> > p;
+    std::vector<uint32_t>         tri;
+    grid( 40, bump, p, tri );
+
+    TSSimplifier<float> s;
+    s.set( p, tri );
+    s.setBoundaryPreserved();
+    EXPECT_TRUE( s.isBoundaryPreserved() );
+    s.simplify( 0 );
+
+    // All the vertices on the boundary are left, where they were
+    std::vector< Point<float,3> > q;
+    s.get( q, tri );
+    expectHeightField( q, tri );
+
+    int on_boundary = 0;
+    for( const Point<float,3>& r : q )
+      if( r[0] == 0.0f || r[0] == 1.0f || r[1] == 0.0f || r[1] == 1.0f ) on_boundary++;
+    EXPECT_EQ( on_boundary, 4*40 );
+    EXPECT_LT( s.getNoTriangles(), 2u*40*40 / 4 );
+  }
+
+
+  TEST(TSSimplifier, Height_field_within_the_error) {
+
+    std::vector< Point<float,3> > p;
+    std::vector<uint32_t>         tri;
+    grid( 100, bump, p, tri );
+
+    TSSimplifier<float> s;
+    s.set( p, tri );
+    EXPECT_LE( s.simplify( 2000 ), 2000u );
+    s.get( p, tri );
+    expectHeightField( p, tri );
+
+    // As facets, close to the height field
+    TriangleFacets<float> tf;
+    s.get( tf );
+    EXPECT_EQ( tf.getNoTriangles(), int( s.getNoTriangles() ) );
+    for( int i = 1; i < 20; i++ )
+      for( int j = 1; j < 20; j++ ) {
+        const float x = i / 20.0f, y = j / 20.0f;
+        EXPECT_NEAR( tf.evalZ( x, y ), bump( x, y ), 2e-3 );
+      }
+
+    // and by an error bound, which stops it
+    TSSimplifier<float> b;
+    grid( 100, bump, p, tri );
+    b.set( p, tri );
+    b.simplify( 0, 1e-8 );
+    EXPECT_GT( b.getNoTriangles(), 100u );
+    EXPECT_LE( b.getError(), 1e-8 );
+    EXPECT_GT( b.getError(), 0.0 );
+
+    const uint32_t n = b.getNoTriangles();
+    EXPECT_LT( b.simplify( 0, 1e-6 ), n );
+  }
+
+
+  TEST(TSSimplifier, Features_preserved) {
+
+    std::vector< Point<float,3> > p;
+    std::vector<uint32_t>         tri;
+    grid( 40, roof, p, tri );
+
+    TSSimplifier<float> s;
+    s.set( p, tri );
+    s.setFeatureAngle( float( M_PI / 6 ) );
+    EXPECT_FLOAT_EQ( s.getFeatureAngle(), float( M_PI / 6 ) );
+    s.simplify( 0 );
+
+    // The ridge is kept, vertex by vertex
+    s.get( p, tri );
+    expectHeightField( p, tri );
+
+    int ridge = 0;
+    for( const Point<float,3>& q : p )
+      if( q[0] == 0.5f ) ridge++;
+    EXPECT_EQ( ridge, 41 );
+    EXPECT_LT( s.getNoTriangles(), 400u );
+  }
+
+
+  TEST(TSSimplifier, Triangle_soup) {
+
+    // The faces of a cube, as an StlObject has them, each face a 10 x 10 grid
+    Array< Point<float,3> > soup;
+    const int m = 10;
+    for( int f = 0; f < 6; f++ ) {
+
+      const int   a = f % 3, b = ( f+1 ) % 3, c = ( f+2 ) % 3;
+      const float w = f < 3 ? 1.0f : 0.0f;
+      auto corner = [&]( int i, int j ) {
+        Point<float,3> q;
+        q[a] = w;
+        q[b] = float(i) / m;
+        q[c] = float(j) / m;
+        return q;
+      };
+
+      for( int i = 0; i < m; i++ )
+        for( int j = 0; j < m; j++ ) {
+          Point<float,3> q[4] = { corner( i, j ), corner( i+1, j ), corner( i+1, j+1 ), corner( i, j+1 ) };
+          if( f >= 3 ) std::swap( q[1], q[3] );
+          for( int k : { 0, 1, 2,  0, 2, 3 } ) soup += q[k];
+        }
+    }
+
+    TSSimplifier<float> s;
+    s.set( soup );
+    EXPECT_EQ( s.getNoVertices(), uint32_t( 6*(m+1)*(m+1) - 12*(m+1) + 8 ) );
+    EXPECT_EQ( s.getNoTriangles(), uint32_t( 12*m*m ) );
+
+    s.setFeatureAngle( float( M_PI / 4 ) );
+    s.simplify( 0 );
+
+    // Closed, with the edges of the cube kept. A vertex inside a face can be
+    // left, where any collapse of it would make a triangle along an edge.
+    TSMesh<float> mesh;
+    s.get( mesh );
+    for( uint32_t h = 0; h < 3*mesh.getNoTriangles(); h++ )
+      EXPECT_NE( mesh.getTwin(h), TSMesh<float>::NoIndex );
+
+    uint32_t on_edges = 0;
+    for( uint32_t v = 0; v < mesh.getNoVertices(); v++ ) {
+      int k = 0;
+      for( int i = 0; i < 3; i++ )
+        if( mesh.getPosition(v)[i] == 0.0f || mesh.getPosition(v)[i] == 1.0f ) k++;
+      if( k >= 2 ) on_edges++;
+    }
+    EXPECT_EQ( on_edges, uint32_t( 12*(m-1) + 8 ) );
+    EXPECT_LE( mesh.getNoVertices(), on_edges + 6 );
+
+    Array< Point<float,3> >  q;
+    Array< Vector<float,3> > n;
+    s.get( q, n );
+    ASSERT_EQ( q.getSize(), 3*n.getSize() );
+    ASSERT_EQ( n.getSize(), int( s.getNoTriangles() ) );
+    for( int i = 0; i < n.getSize(); i++ ) {
+
+      // the normals point out of the cube
+      EXPECT_NEAR( n[i].getLength(), 1.0f, 1e-5 );
+      const Point<float,3> c = ( q[3*i] + q[3*i+1] + q[3*i+2] ) / 3.0f - Point<float,3>( 0.5f, 0.5f, 0.5f );
+      EXPECT_GT( n[i] * c, 0.0f );
+    }
+  }
+
+}
@@ -0,0 +1,99 @@
+#ifndef GM_TRIANGLESYSTEM_TESTS_TESTFACETS_H
+#define GM_TRIANGLESYSTEM_TESTS_TESTFACETS_H
+
+#include <gmTrianglesystemModule>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+/*!
+ * Vertices in the unit square for the trianglesystem tests and benchmarks.
+ * The same n, distribution and seed give the same vertices.
+ */
+enum Distribution { Uniform, Clustered, Gridded };
+
+struct Facets {
+  std::unique_ptr<GMlib::TriangleFacets<float>>  tf;
+  int                                            n;
+
+  Facets() : tf( new GMlib::TriangleFacets<float>() ), n(0) {}
+
+  explicit Facets( int no_vertices, Distribution dist = Uniform, unsigned int seed = 5 )
+    : tf( new GMlib::TriangleFacets<float>( no_vertices ) ), n(no_vertices) {
+
+    fill( dist, seed );
+  }
+
+  // Clears the facets and inserts the n vertices, at height 0
+  void fill( Distribution dist = Uniform, unsigned int seed = 5 ) {
+
+    tf->clear();
+    tf->setMaxSize( n + 3 );
+
+    std::mt19937                          rng( seed );
+    std::uniform_real_distribution<float> u( 0.0f, 1.0f );
+    std::normal_distribution<float>       g( 0.0f, 0.01f );
+
+    if( dist == Gridded ) {
+      const int m = int( std::ceil( std::sqrt( double(n) ) ) );
+      for( int i = 0; i < n; i++ )
+        tf->insertAlways( GMlib::TSVertex<float>( float( i % m ) / m, float( i / m ) / m, 0.0f ) );
+    }
+    else if( dist == Clustered ) {
+      std::vector<GMlib::Point<float,2>> c( 20 );
+      for( auto& p : c ) {
+        const float x = u(rng), y = u(rng);
+        p = GMlib::Point<float,2>( x, y );
+      }
+      for( int i = 0; i < n; i++ ) {
+        const GMlib::Point<float,2>& p = c[rng() % c.size()];
+        const float x = p[0] + g(rng), y = p[1] + g(rng);
+        tf->insertAlways( GMlib::TSVertex<float>( x, y, 0.0f ) );
+      }
+    }
+    else
+      for( int i = 0; i < n; i++ ) {
+        const float x = u(rng), y = u(rng);
+        tf->insertAlways( GMlib::TSVertex<float>( x, y, 0.0f ) );
+      }
+  }
+
+  // Lifts the vertices to the height field height()
+  void setHeights() {
+
+    for( int i = 0; i < tf->getSize(); i++ ) {
+      const GMlib::Point<float,2> p = (*tf)[i].getParameter();
+      (*tf)[i].setZ( height( p[0], p[1] ) );
+    }
+  }
+
+  static float height( float x, float y ) { return 0.2f * std::sin( 3*x ) * std::cos( 2*y ); }
+};
+
+
+typedef std::array<std::pair<float,float>,3> Triangle;
+
+// The corners of each triangle, sorted, as the vertices can be reordered
+inline std::vector<Triangle> triangles( GMlib::TriangleFacets<float>& tf ) {
+
+  std::vector<Triangle> tri;
+  for( int i = 0; i < tf.getNoTriangles(); i++ ) {
+    GMlib::Array<GMlib::TSVertex<float>*> v = tf.getTriangle(i)->getVertices();
+    Triangle t;
+    for( int k = 0; k < 3; k++ )
+      t[k] = std::make_pair( v[k]->getParameter()[0], v[k]->getParameter()[1] );
+    std::sort( t.begin(), t.end() );
+    tri.push_back( t );
+  }
+  std::sort( tri.begin(), tri.end() );
+  return tri;
+}
+
+
+#endif // GM_TRIANGLESYSTEM_TESTS_TESTFACETS_H
@@ -78,6 +78,7 @@ void GMlibWrapper::timerEvent(QTimerEvent* e) {
   e->accept();
 
   _scene->simulate();
+  _scene->syncReplots();
   prepare();
 }
 
@@ -109,10 +110,29 @@ void GMlibWrapper::initialize() {
   _scene = std::make_shared<GMlib::Scene>();
 
   // Setup Select Renderer
-  _select_renderer = std::make_shared<GMlib::DefaultSelectRenderer>();
+  setSelectBackend( _select_backend );
 //  _select_renderer->setSelectRboName("select_render_color_rbo");
 }
 
+void GMlibWrapper::setSelectBackend(SelectBackend backend) {
+
+  _select_backend = backend;
+
+  // The renderers are made in initialize(), the color picking one needs the GL backend
+  if(!_scene) return;
+
+  if(_select_backend == SelectBackend::RayPicking)
+    _select_renderer = std::make_shared<GMlib::RaySelectRenderer>();
+  else
+    _select_renderer = std::make_shared<GMlib::DefaultSelectRenderer>();
+}
+
+GMlibWrapper::SelectBackend
+GMlibWrapper::selectBackend() const {
+
+  return _select_backend;
+}
+
 void GMlibWrapper::cleanUp() {
 
   stop();
@@ -14,7 +14,7 @@ namespace GMlib {
   class Camera;
   class PointLight;
   class DefaultRenderer;
-  class DefaultSelectRenderer;
+  class SelectRenderer;
   class RenderTarget;
 
   template<typename T, int n>
@@ -52,6 +52,11 @@ struct RenderCamPair {
 class GMlibWrapper : public QObject {
   Q_OBJECT
 public:
+  enum class SelectBackend {
+    ColorPicking,       // GMlib::DefaultSelectRenderer, renders to a color buffer and reads it back
+    RayPicking          // GMlib::RaySelectRenderer, casts rays on the CPU
+  };
+
   explicit GMlibWrapper();
   ~GMlibWrapper();
 
@@ -64,6 +69,9 @@ public:
   void                                              initialize();
   void                                              cleanUp();
 
+  void                                              setSelectBackend( SelectBackend backend );
+  SelectBackend                                     selectBackend() const;
+
   GMlib::SceneObject*                               findSceneObject( const QString& rc_name, const GMlib::Point<int,2>& pos );
   QStringListModel&                                 rcNameModel();
 
@@ -92,7 +100,8 @@ private:
   std::shared_ptr<GMlib::Scene>                     _scene;
 
   std::unordered_map<std::string, RenderCamPair>    _rc_pairs;
-  std::shared_ptr<GMlib::DefaultSelectRenderer>     _select_renderer;
+  std::shared_ptr<GMlib::SelectRenderer>            _select_renderer;
+  SelectBackend                                     _select_backend {SelectBackend::ColorPicking};
 
   int                                               _replot_low_medium_high {1};
   bool                                              _move_object_button_pressed {false};
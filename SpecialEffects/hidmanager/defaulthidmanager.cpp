@@ -304,12 +304,12 @@ void DefaultHidManager::heReplotQuick(int factor)
 
       GMlib::PERBSSurf<float>* erbs = dynamic_cast<GMlib::PERBSSurf<float>*>(surf);
       if (erbs)
-        erbs->replot(
+        erbs->replotAsync(
             (erbs->getLocalPatches().getDim1() - 1) * factor + 1,
             (erbs->getLocalPatches().getDim2() - 1) * factor + 1,
             2, 2);
       else {
-        surf->replot(10 * factor, 10 * factor, 2, 2);
+        surf->replotAsync(10 * factor, 10 * factor, 2, 2);
       }
     }
   }
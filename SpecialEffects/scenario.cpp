@@ -295,10 +295,5 @@ void Scenario::initSurface()
 
 void Scenario::callDefferedGL()
 {
-  GMlib::Array<const GMlib::SceneObject*> e_obj;
-  this->scene()->getEditedObjects(e_obj);
-
-  for (int i = 0; i < e_obj.getSize(); i++)
-    if (e_obj(i)->isVisible())
-      e_obj(i)->replot();
+  this->scene()->replotEdited();
 }